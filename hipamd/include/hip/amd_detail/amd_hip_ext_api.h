@@ -0,0 +1,113 @@
+/*
+Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef HIP_INCLUDE_HIP_AMD_DETAIL_AMD_HIP_EXT_API_H
+#define HIP_INCLUDE_HIP_AMD_DETAIL_AMD_HIP_EXT_API_H
+
+#if !defined(__HIPCC_RTC__)
+#include <hip/hip_runtime_api.h>
+#include <hip/library_types.h>
+
+/**
+ * @addtogroup Extension AMD specific extension APIs
+ * @{
+ */
+
+/** Saturate out of range values to the largest finite value of an fp8 destination format,
+ *  matches __HIP_SATFINITE. Without it out of range values become Inf/NaN. */
+#define hipExtConvertSaturateFinite 0x1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Converts an array of elements between fp32 and a reduced precision format on the host.
+ *
+ * Supported conversions are HIP_R_32F to and from HIP_R_16F, HIP_R_16BF, HIP_R_8F_E4M3,
+ * HIP_R_8F_E5M2, HIP_R_8F_E4M3_FNUZ and HIP_R_8F_E5M2_FNUZ. The results are bit-identical to
+ * the scalar host conversions in hip_fp16.h, hip_bf16.h and hip_fp8.h (round to nearest even).
+ * The conversion runs on the calling thread and uses the widest SIMD extension the CPU supports.
+ *
+ * @param [out] dst      Host pointer to the converted elements
+ * @param [in]  dstType  Element type of @p dst
+ * @param [in]  src      Host pointer to the source elements
+ * @param [in]  srcType  Element type of @p src
+ * @param [in]  count    Number of elements to convert
+ * @param [in]  flags    0 or hipExtConvertSaturateFinite
+ *
+ * @returns #hipSuccess, #hipErrorInvalidValue, #hipErrorNotSupported
+ */
+hipError_t hipExtConvertHostArray(void* dst, hipDataType dstType, const void* src,
+                                  hipDataType srcType, size_t count, unsigned int flags);
+
+/**
+ * @brief Copies an array from host to device memory, converting its elements on the way.
+ *
+ * The conversion happens while the runtime fills its staging buffers, so the host data is read
+ * once and the converted data is written once, without a temporary host array. Supports the
+ * same conversions as hipExtConvertHostArray. The call returns once the copy has completed.
+ *
+ * @param [out] dst      Device pointer to the converted elements
+ * @param [in]  dstType  Element type of @p dst
+ * @param [in]  src      Host pointer to the source elements
+ * @param [in]  srcType  Element type of @p src
+ * @param [in]  count    Number of elements to copy
+ * @param [in]  flags    0 or hipExtConvertSaturateFinite
+ * @param [in]  stream   Stream the copy is ordered in
+ *
+ * @returns #hipSuccess, #hipErrorInvalidValue, #hipErrorNotSupported,
+ *          #hipErrorStreamCaptureUnsupported
+ */
+hipError_t hipExtMemcpyHtoDConvert(void* dst, hipDataType dstType, const void* src,
+                                   hipDataType srcType, size_t count, unsigned int flags,
+                                   hipStream_t stream);
+
+/**
+ * @brief Launches an array of kernels into one stream as a single batch.
+ *
+ * All launches are validated and their arguments captured before any of them is submitted, so
+ * an invalid descriptor launches nothing. The kernels are then submitted in array order under
+ * one lock of the stream and the hardware queue is notified once for the whole batch.
+ * The stream member of the descriptors is ignored. If @p stream is capturing, every launch is
+ * recorded as a separate kernel node.
+ *
+ * @param [in] launchParamsList  Array of launch descriptors
+ * @param [in] numLaunches       Number of descriptors in @p launchParamsList
+ * @param [in] stream            Stream all kernels are launched into
+ *
+ * @returns #hipSuccess, #hipErrorInvalidValue, #hipErrorInvalidConfiguration,
+ *          #hipErrorInvalidDeviceFunction, #hipErrorLaunchFailure
+ */
+hipError_t hipExtLaunchKernelBatch(const hipLaunchParams* launchParamsList,
+                                   unsigned int numLaunches, hipStream_t stream);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+ * @}
+ */
+#endif  // !defined(__HIPCC_RTC__)
+
+#endif  // HIP_INCLUDE_HIP_AMD_DETAIL_AMD_HIP_EXT_API_H
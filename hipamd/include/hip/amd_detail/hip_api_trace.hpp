@@ -22,6 +22,7 @@
 #pragma once
 
 #include <hip/hip_runtime.h>
+#include <hip/amd_detail/amd_hip_ext_api.h>
 
 // Define some version macros for the API table. Use similar naming conventions to HSA-runtime
 // (MAJOR and STEP versions). Three groups at this time:
@@ -61,7 +62,7 @@
 // - Reset any of the *_STEP_VERSION defines to zero if the corresponding *_MAJOR_VERSION increases
 #define HIP_API_TABLE_STEP_VERSION 0
 #define HIP_COMPILER_API_TABLE_STEP_VERSION 0
-#define HIP_RUNTIME_API_TABLE_STEP_VERSION 6
+#define HIP_RUNTIME_API_TABLE_STEP_VERSION 9
 
 // HIP API interface
 typedef hipError_t (*t___hipPopCallConfiguration)(dim3* gridDim, dim3* blockDim, size_t* sharedMem,
@@ -1004,6 +1005,15 @@ typedef hipError_t (*t_hipExtHostAlloc)(void **ptr, size_t size,
 typedef hipError_t (*t_hipDeviceGetTexture1DLinearMaxWidth)(size_t *maxWidthInElements,
                                                             const hipChannelFormatDesc *fmtDesc,
                                                             int device);
+
+typedef hipError_t (*t_hipExtConvertHostArray)(void* dst, hipDataType dstType, const void* src,
+                                               hipDataType srcType, size_t count,
+                                               unsigned int flags);
+typedef hipError_t (*t_hipExtMemcpyHtoDConvert)(void* dst, hipDataType dstType, const void* src,
+                                                hipDataType srcType, size_t count,
+                                                unsigned int flags, hipStream_t stream);
+typedef hipError_t (*t_hipExtLaunchKernelBatch)(const hipLaunchParams* launchParamsList,
+                                                unsigned int numLaunches, hipStream_t stream);
 // HIP Compiler dispatch table
 struct HipCompilerDispatchTable {
   // HIP_COMPILER_API_TABLE_STEP_VERSION == 0
@@ -1519,8 +1529,17 @@ struct HipDispatchTable {
   // HIP_RUNTIME_API_TABLE_STEP_VERSION == 6
   t_hipDeviceGetTexture1DLinearMaxWidth hipDeviceGetTexture1DLinearMaxWidth_fn;
 
-  // DO NOT EDIT ABOVE!
   // HIP_RUNTIME_API_TABLE_STEP_VERSION == 7
+  t_hipExtConvertHostArray hipExtConvertHostArray_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 8
+  t_hipExtMemcpyHtoDConvert hipExtMemcpyHtoDConvert_fn;
+
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 9
+  t_hipExtLaunchKernelBatch hipExtLaunchKernelBatch_fn;
+
+  // DO NOT EDIT ABOVE!
+  // HIP_RUNTIME_API_TABLE_STEP_VERSION == 10
 
   // ******************************************************************************************* //
   //
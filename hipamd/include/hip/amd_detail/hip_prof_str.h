@@ -438,6 +438,9 @@ enum hip_api_id_t {
   HIP_API_ID_hipDestroyTextureObject = HIP_API_ID_NONE,
   HIP_API_ID_hipDeviceGetCount = HIP_API_ID_NONE,
   HIP_API_ID_hipDeviceGetTexture1DLinearMaxWidth = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtConvertHostArray = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemcpyHtoDConvert = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtLaunchKernelBatch = HIP_API_ID_NONE,
   HIP_API_ID_hipGetTextureAlignmentOffset = HIP_API_ID_NONE,
   HIP_API_ID_hipGetTextureObjectResourceDesc = HIP_API_ID_NONE,
   HIP_API_ID_hipGetTextureObjectResourceViewDesc = HIP_API_ID_NONE,
@@ -6045,6 +6048,12 @@ typedef struct hip_api_data_s {
 #define INIT_hipDeviceGetCount_CB_ARGS_DATA(cb_data) {};
 // hipDeviceGetTexture1DLinearMaxWidth()
 #define INIT_hipDeviceGetTexture1DLinearMaxWidth_CB_ARGS_DATA(cb_data) {};
+// hipExtConvertHostArray()
+#define INIT_hipExtConvertHostArray_CB_ARGS_DATA(cb_data) {};
+// hipExtMemcpyHtoDConvert()
+#define INIT_hipExtMemcpyHtoDConvert_CB_ARGS_DATA(cb_data) {};
+// hipExtLaunchKernelBatch()
+#define INIT_hipExtLaunchKernelBatch_CB_ARGS_DATA(cb_data) {};
 // hipGetTextureAlignmentOffset()
 #define INIT_hipGetTextureAlignmentOffset_CB_ARGS_DATA(cb_data) {};
 // hipGetTextureObjectResourceDesc()
@@ -802,7 +802,13 @@ hipError_t hipExternalMemoryGetMappedMipmappedArray(
     const hipExternalMemoryMipmappedArrayDesc* mipmapDesc);
 hipError_t hipDrvGraphMemcpyNodeGetParams(hipGraphNode_t hNode, HIP_MEMCPY3D* nodeParams);
 hipError_t hipDrvGraphMemcpyNodeSetParams(hipGraphNode_t hNode, const HIP_MEMCPY3D* nodeParams);
-
+hipError_t hipExtConvertHostArray(void* dst, hipDataType dstType, const void* src,
+                                  hipDataType srcType, size_t count, unsigned int flags);
+hipError_t hipExtMemcpyHtoDConvert(void* dst, hipDataType dstType, const void* src,
+                                   hipDataType srcType, size_t count, unsigned int flags,
+                                   hipStream_t stream);
+hipError_t hipExtLaunchKernelBatch(const hipLaunchParams* launchParamsList,
+                                   unsigned int numLaunches, hipStream_t stream);
 }  // namespace hip
 
 namespace hip {
@@ -1298,6 +1304,9 @@ void UpdateDispatchTable(HipDispatchTable* ptrDispatchTable) {
       hip::hipExternalMemoryGetMappedMipmappedArray;
   ptrDispatchTable->hipDrvGraphMemcpyNodeGetParams_fn = hip::hipDrvGraphMemcpyNodeGetParams;
   ptrDispatchTable->hipDrvGraphMemcpyNodeSetParams_fn = hip::hipDrvGraphMemcpyNodeSetParams;
+  ptrDispatchTable->hipExtConvertHostArray_fn = hip::hipExtConvertHostArray;
+  ptrDispatchTable->hipExtMemcpyHtoDConvert_fn = hip::hipExtMemcpyHtoDConvert;
+  ptrDispatchTable->hipExtLaunchKernelBatch_fn = hip::hipExtLaunchKernelBatch;
 }
 
 #if HIP_ROCPROFILER_REGISTER > 0
@@ -1887,6 +1896,12 @@ HIP_ENFORCE_ABI(HipDispatchTable, hipDrvGraphMemcpyNodeSetParams_fn, 460)
 HIP_ENFORCE_ABI(HipDispatchTable, hipExtHostAlloc_fn, 461)
 // HIP_RUNTIME_API_TABLE_STEP_VERSION == 6
 HIP_ENFORCE_ABI(HipDispatchTable, hipDeviceGetTexture1DLinearMaxWidth_fn, 462)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 7
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtConvertHostArray_fn, 463)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 8
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtMemcpyHtoDConvert_fn, 464)
+// HIP_RUNTIME_API_TABLE_STEP_VERSION == 9
+HIP_ENFORCE_ABI(HipDispatchTable, hipExtLaunchKernelBatch_fn, 465)
 
 // if HIP_ENFORCE_ABI entries are added for each new function pointer in the table, the number below
 // will be +1 of the number in the last HIP_ENFORCE_ABI line. E.g.:
@@ -1894,9 +1909,9 @@ HIP_ENFORCE_ABI(HipDispatchTable, hipDeviceGetTexture1DLinearMaxWidth_fn, 462)
 //  HIP_ENFORCE_ABI(<table>, <functor>, 8)
 //
 //  HIP_ENFORCE_ABI_VERSIONING(<table>, 9) <- 8 + 1 = 9
-HIP_ENFORCE_ABI_VERSIONING(HipDispatchTable, 463)
+HIP_ENFORCE_ABI_VERSIONING(HipDispatchTable, 466)
 
-static_assert(HIP_RUNTIME_API_TABLE_MAJOR_VERSION == 0 && HIP_RUNTIME_API_TABLE_STEP_VERSION == 6,
+static_assert(HIP_RUNTIME_API_TABLE_MAJOR_VERSION == 0 && HIP_RUNTIME_API_TABLE_STEP_VERSION == 9,
               "If you get this error, add new HIP_ENFORCE_ABI(...) code for the new function "
               "pointers and then update this check so it is true");
 #endif
@@ -0,0 +1,104 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#include "hip_callback_executor.hpp"
+
+namespace hip {
+
+// ================================================================================================
+CallbackExecutor* CallbackExecutor::Get() {
+  if (HIP_HOST_CALLBACK_THREADS == 0) {
+    return nullptr;
+  }
+  // The workers wait for the tasks until the process exit, so the executor is never destroyed
+  static CallbackExecutor* executor = []() {
+    CallbackExecutor* executor = new CallbackExecutor();
+    if (!executor->Create(HIP_HOST_CALLBACK_THREADS)) {
+      LogWarning("Couldn't start the host callback threads, callbacks run in place");
+      delete executor;
+      executor = nullptr;
+    }
+    return executor;
+  }();
+  return executor;
+}
+
+// ================================================================================================
+bool CallbackExecutor::Create(uint32_t numWorkers) {
+  for (uint32_t i = 0; i < numWorkers; ++i) {
+    Worker* worker = new Worker(this);
+    if ((worker == nullptr) || (worker->state() < amd::Thread::INITIALIZED) ||
+        !worker->start(this)) {
+      delete worker;
+      break;
+    }
+    workers_.push_back(worker);
+  }
+  return !workers_.empty();
+}
+
+// ================================================================================================
+void CallbackExecutor::Enqueue(const void* key, const Task& task) {
+  amd::ScopedLock lock(lock_);
+  auto it = lanes_.find(key);
+  if (it != lanes_.end()) {
+    // A worker owns the key and picks up the task after the earlier ones
+    it->second.push_back(task);
+    return;
+  }
+  lanes_[key].push_back(task);
+  ready_.push_back(key);
+  lock_.notify();
+}
+
+// ================================================================================================
+void CallbackExecutor::Process() {
+  for (;;) {
+    const void* key = nullptr;
+    Task task;
+    {
+      amd::ScopedLock lock(lock_);
+      while (ready_.empty()) {
+        lock_.wait();
+      }
+      key = ready_.front();
+      ready_.pop_front();
+      std::deque<Task>& lane = lanes_[key];
+      task = lane.front();
+      lane.pop_front();
+    }
+    task.run_(task.data_);
+    task.done_(task.doneData_);
+    {
+      amd::ScopedLock lock(lock_);
+      auto it = lanes_.find(key);
+      if (it->second.empty()) {
+        lanes_.erase(it);
+      } else {
+        // Requeue the key behind the other keys, so one queue doesn't starve the rest
+        ready_.push_back(key);
+        lock_.notify();
+      }
+    }
+  }
+}
+
+}  // namespace hip
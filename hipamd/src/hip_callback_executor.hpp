@@ -0,0 +1,93 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#pragma once
+
+#include "top.hpp"
+#include "thread/monitor.hpp"
+#include "thread/thread.hpp"
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace hip {
+
+/*! \brief Runs the host callbacks of the streams and the graph host nodes off the completion path.
+ *
+ *  The device invokes the callbacks from the thread, which processes the completion signals of
+ *  all queues, so a slow callback delays the completion of every command. With
+ *  HIP_HOST_CALLBACK_THREADS workers the callback only passes the host function to the executor
+ *  and keeps the HW queue blocked. The worker runs the function and unblocks the queue, so the
+ *  dependent GPU work starts when the function returns, as with the callback in place.
+ *  The functions of one queue run in the order of their callbacks, one at a time.
+ */
+class CallbackExecutor {
+ public:
+  //! Host function of one callback
+  struct Task {
+    void (*run_)(void* data);   //!< Host function
+    void* data_;                //!< Argument of the host function
+    void (*done_)(void* data);  //!< Called after the host function, unblocks the HW queue
+    void* doneData_;            //!< Argument of the done function
+  };
+
+  //! Returns the executor or nullptr if HIP_HOST_CALLBACK_THREADS disables it
+  static CallbackExecutor* Get();
+
+  /*! \brief Passes the host function of the callback on the event to the executor.
+   *
+   *  \return false if the function has to run in the callback, since the executor is disabled
+   *  or the device doesn't block the HW queue until the callback is done
+   */
+  static bool Submit(cl_event event, void (*run)(void* data), void* data);
+
+  CallbackExecutor() : lock_(true) /* Host callback executor lock */ {}
+
+  //! Starts the workers, returns false if none started
+  bool Create(uint32_t numWorkers);
+
+  //! Queues the task after the earlier tasks with the same key
+  void Enqueue(const void* key, const Task& task);
+
+ private:
+  class Worker : public amd::Thread {
+   public:
+    explicit Worker(CallbackExecutor* executor)
+        : amd::Thread("Host Callback Thread", CQ_THREAD_STACK_SIZE), executor_(executor) {}
+
+    //! The worker thread entry point
+    void run(void* data) { executor_->Process(); }
+
+   private:
+    CallbackExecutor* executor_;  //!< Owner of the worker
+  };
+
+  //! Runs the tasks of the ready keys, never returns
+  void Process();
+
+  amd::Monitor lock_;           //!< Guards the lanes and the wake up of the workers
+  //! Pending tasks by key, the key is present while a worker processes it or it's ready
+  std::unordered_map<const void*, std::deque<Task>> lanes_;
+  std::deque<const void*> ready_;   //!< Keys with tasks, which no worker processes
+  std::vector<Worker*> workers_;    //!< Worker threads
+};
+
+}  // namespace hip
@@ -22,8 +22,10 @@
 #include <hip/hip_deprecated.h>
 
 #include "hip_internal.hpp"
+#include "hip_graph_cache.hpp"
 #include "hip_mempool_impl.hpp"
 #include "hip_platform.hpp"
+#include "hip_stream_sync.hpp"
 
 #undef hipGetDeviceProperties
 #undef hipDeviceProp_t
@@ -150,6 +152,11 @@ void Device::Reset() {
     mem_pools_.clear();
   }
   flags_ = hipDeviceScheduleSpin;
+  // The idle streams of the cached graph schedules are destroyed with all streams
+  GraphInstantiateCache* cache = GraphInstantiateCache::Get();
+  if (cache != nullptr) {
+    cache->DropStreams(deviceId());
+  }
   destroyAllStreams();
   amd::MemObjMap::Purge(devices()[0]);
   Create();
@@ -217,13 +224,52 @@ void Device::WaitActiveStreams(hip::Stream* blocking_stream, bool wait_null_stre
 // ================================================================================================
 void Device::AddStream(Stream* stream) {
   amd::ScopedLock lock(streamSetLock);
-  streamSet.insert(stream);
+  if (streamSet.insert(stream).second) {
+    stream->registered_ = true;
+    if (stream->IsBlockingCapture()) {
+      ++blockingCaptureStreams_;
+    }
+    if (stream->GetQueueStatus()) {
+      ++activeStreams_;
+    }
+  }
 }
 
 // ================================================================================================
 void Device::RemoveStream(Stream* stream){
   amd::ScopedLock lock(streamSetLock);
-  streamSet.erase(stream);
+  if (streamSet.erase(stream) != 0) {
+    stream->registered_ = false;
+    if (stream->IsBlockingCapture()) {
+      --blockingCaptureStreams_;
+    }
+    if (stream->GetQueueStatus()) {
+      --activeStreams_;
+    }
+  }
+}
+
+// ================================================================================================
+void Device::SetStreamCaptureStatus(Stream* stream, hipStreamCaptureStatus captureStatus) {
+  // The lock keeps the counter consistent with the stream set
+  amd::ScopedLock lock(streamSetLock);
+  const bool blocking = stream->IsBlockingCapture();
+  stream->captureStatus_ = captureStatus;
+  if (stream->registered_ && (blocking != stream->IsBlockingCapture())) {
+    if (blocking) {
+      --blockingCaptureStreams_;
+    } else {
+      ++blockingCaptureStreams_;
+    }
+  }
+}
+
+// ================================================================================================
+void Device::AddActiveStream(Stream* stream) {
+  amd::ScopedLock lock(streamSetLock);
+  if (stream->registered_) {
+    ++activeStreams_;
+  }
 }
 
 // ================================================================================================
@@ -264,8 +310,9 @@ void Device::SyncAllStreams( bool cpu_wait) {
       it->retain();
     }
   }
+  // Submit the finish markers of all streams first, so the streams drain in parallel
+  FinishQueues(streams, cpu_wait);
   for (auto it : streams) {
-    it->finish(cpu_wait);
     it->release();
   }
   // Release freed memory for all memory pools on the device
@@ -274,28 +321,6 @@ void Device::SyncAllStreams( bool cpu_wait) {
   ReleaseGraphExec(hip::getCurrentDevice()->deviceId());
 }
 
-// ================================================================================================
-bool Device::StreamCaptureBlocking() {
-  amd::ScopedLock lock(streamSetLock);
-  for (auto& it : streamSet) {
-    if (it->GetCaptureStatus() == hipStreamCaptureStatusActive && it->Flags() != hipStreamNonBlocking) {
-      return true;
-    }
-  }
-  return false;
-}
-
-// ================================================================================================
-bool Device::existsActiveStreamForDevice() {
-  amd::ScopedLock lock(streamSetLock);
-  for (const auto& active_stream : streamSet) {
-    if (active_stream->GetQueueStatus()) {
-      return true;
-    }
-  }
-  return false;
-}
-
 // ================================================================================================
 Device::~Device() {
   if (default_mem_pool_ != nullptr) {
@@ -20,6 +20,8 @@
 
 #include "top.hpp"
 #include "hip_graph_internal.hpp"
+#include "hip_graph_passes.hpp"
+#include "hip_graph_cache.hpp"
 #include "platform/command.hpp"
 #include "hip_conversions.hpp"
 #include "hip_platform.hpp"
@@ -57,16 +59,22 @@ inline hipError_t ihipGraphAddNode(hip::GraphNode* graphNode, hip::Graph* graph,
                                    hip::GraphNode* const* pDependencies, size_t numDependencies,
                                    bool capture = true) {
   graph->AddNode(graphNode);
+  // A captured stream mostly forms a chain, so a single dependency skips the duplicate check
+  // and a short list is scanned instead of hashed
+  constexpr size_t kMaxScannedDeps = 16;
   std::unordered_set<hip::GraphNode*> DuplicateDep;
   for (size_t i = 0; i < numDependencies; i++) {
     if ((!hip::GraphNode::isNodeValid(pDependencies[i])) ||
         (graph != pDependencies[i]->GetParentGraph())) {
       return hipErrorInvalidValue;
     }
-    if (DuplicateDep.find(pDependencies[i]) != DuplicateDep.end()) {
+    if (numDependencies <= kMaxScannedDeps) {
+      if (std::find(pDependencies, pDependencies + i, pDependencies[i]) != pDependencies + i) {
+        return hipErrorInvalidValue;
+      }
+    } else if (!DuplicateDep.insert(pDependencies[i]).second) {
       return hipErrorInvalidValue;
     }
-    DuplicateDep.insert(pDependencies[i]);
     pDependencies[i]->AddEdgeDep(graphNode);
   }
   if (capture == false) {
@@ -116,7 +124,7 @@ hipError_t ihipGraphAddKernelNode(hip::GraphNode** pGraphNode, hip::Graph* graph
     return hipErrorInvalidConfiguration;
   }
 
-  *pGraphNode = new hip::GraphKernelNode(pNodeParams, pNodeEvents);
+  *pGraphNode = new hip::GraphKernelNode(pNodeParams, pNodeEvents, func);
   status = ihipGraphAddNode(*pGraphNode, graph, pDependencies, numDependencies, capture);
   return status;
 }
@@ -586,8 +594,8 @@ hipError_t capturehipMemcpy(hipStream_t stream, void* dst, const void* src, size
     return hipErrorContextIsDestroyed;
   }
   hip::Stream* s = reinterpret_cast<hip::Stream*>(stream);
-  std::vector<hip::GraphNode*> pDependencies = s->GetLastCapturedNodes();
-  size_t numDependencies = s->GetLastCapturedNodes().size();
+  const std::vector<hip::GraphNode*>& pDependencies = s->GetLastCapturedNodes();
+  size_t numDependencies = pDependencies.size();
   hip::Graph* graph = s->GetCaptureGraph();
   hipError_t status = ihipMemcpy_validate(dst, src, sizeBytes, kind);
   if (status != hipSuccess) {
@@ -1303,26 +1311,49 @@ hipError_t ihipGraphInstantiate(hip::GraphExec** pGraphExec, hip::Graph* graph,
       }
     }
   }
-  std::unordered_map<hip::GraphNode*, hip::GraphNode*> clonedNodes;
+  std::vector<hip::GraphNode*> originalNodes = graph->GetNodes();
+  std::vector<hip::GraphNode*> clonedNodes;
   hip::Graph* clonedGraph = graph->clone(clonedNodes);
-  clonedGraph->memAllocNodePtrs_ = graph->memAllocNodePtrs_;
   if (clonedGraph == nullptr) {
     return hipErrorInvalidValue;
   }
-  std::vector<hip::GraphNode*> graphNodes;
-  if (false == clonedGraph->TopologicalOrder(graphNodes)) {
+  clonedGraph->CopyMemAllocPtrs(graph);
+  // The updates of the executable graph compare against the graph as created by the app
+  std::vector<hip::GraphNode*> updateOrder;
+  std::vector<size_t> updateDeps;
+  if (false == hip::graph_passes::RecordUpdateOrder(clonedGraph, updateOrder, updateDeps)) {
     return hipErrorInvalidValue;
   }
+  hip::GraphPassManager passManager;
+  passManager.Run(clonedGraph);
+  std::vector<hip::GraphNode*> graphNodes;
   std::vector<std::vector<hip::GraphNode*>> parallelLists;
   std::unordered_map<hip::GraphNode*, std::vector<hip::GraphNode*>> nodeWaitLists;
-  clonedGraph->GetRunList(parallelLists, nodeWaitLists);
-  if (DEBUG_HIP_FORCE_GRAPH_QUEUES != 0) {
-    clonedGraph->ScheduleNodes();
+  hip::GraphInstantiateCache* cache = hip::GraphInstantiateCache::Get();
+  hip::GraphInstantiateCache::Key cacheKey;
+  uint64_t cacheEntry = 0;
+  if (cache != nullptr) {
+    cacheEntry = cache->Lookup(clonedGraph, cacheKey, graphNodes, parallelLists, nodeWaitLists);
+  }
+  if (cacheEntry == 0) {
+    if (false == clonedGraph->TopologicalOrder(graphNodes)) {
+      return hipErrorInvalidValue;
+    }
+    clonedGraph->GetRunList(parallelLists, nodeWaitLists);
+    if (DEBUG_HIP_FORCE_GRAPH_QUEUES != 0) {
+      clonedGraph->ScheduleNodes();
+    }
+    if (cache != nullptr) {
+      cacheEntry = cache->Insert(clonedGraph, cacheKey, graphNodes, parallelLists,
+                                 nodeWaitLists);
+    }
   }
   *pGraphExec =
-      new hip::GraphExec(graphNodes, parallelLists, nodeWaitLists, clonedGraph, clonedNodes,
-                         flags);
+      new hip::GraphExec(graphNodes, parallelLists, nodeWaitLists, clonedGraph, originalNodes,
+                         clonedNodes, flags);
   if (*pGraphExec != nullptr) {
+    (*pGraphExec)->SetUpdateOrder(updateOrder, updateDeps);
+    (*pGraphExec)->SetCacheEntry(cacheEntry);
     graph->SetGraphInstantiated(true);
     if (DEBUG_HIP_GRAPH_DOT_PRINT) {
       static int i = 1;
@@ -2465,8 +2496,10 @@ hipError_t hipGraphExecUpdate(hipGraphExec_t hGraphExec, hipGraph_t hGraph,
 
   std::vector<hip::GraphNode*> newGraphNodes;
   reinterpret_cast<hip::Graph*>(hGraph)->TopologicalOrder(newGraphNodes);
-  std::vector<hip::GraphNode*>& oldGraphExecNodes =
-      reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetNodes();
+  hip::GraphExec* graphExec = reinterpret_cast<hip::GraphExec*>(hGraphExec);
+  std::vector<hip::GraphNode*>& oldGraphExecNodes = graphExec->GetNodes();
+  size_t updatedNodes = 0;
+  size_t updatedPackets = 0;
   if (newGraphNodes.size() != oldGraphExecNodes.size()) {
     *updateResult_out = hipGraphExecUpdateErrorTopologyChanged;
     *hErrorNode_out = nullptr;
@@ -2504,14 +2537,23 @@ hipError_t hipGraphExecUpdate(hipGraphExec_t hGraphExec, hipGraph_t hGraph,
       // Checks if all the node's dependencies are same
       const std::vector<hip::GraphNode*>& newGraphDependencies =
                         newGraphNodes[i]->GetDependencies();
-      const std::vector<hip::GraphNode*>& oldGraphDependencies =
-                        oldGraphExecNodes[i]->GetDependencies();
-      if (newGraphDependencies.size() != oldGraphDependencies.size()) {
+      if (newGraphDependencies.size() != graphExec->GetNodeDependencyCount(i)) {
         *hErrorNode_out = reinterpret_cast<hipGraphNode_t>(newGraphNodes[i]);
         *updateResult_out = hipGraphExecUpdateErrorTopologyChanged;
         HIP_RETURN(hipErrorGraphExecUpdateFailure);
       }
 
+      // The application may change the kernel arguments through the pointers of
+      // hipGraphKernelNodeGetParams(), so the new node is hashed on every update. The exec
+      // node keeps its hash until the next change of its parameters. Different hashes skip
+      // the comparison, equal ones are confirmed with the parameters
+      uint64_t newHash = 0;
+      uint64_t oldHash = 0;
+      if (newGraphNodes[i]->HashParams(&newHash) &&
+          oldGraphExecNodes[i]->GetParamsHash(&oldHash) && (newHash == oldHash) &&
+          oldGraphExecNodes[i]->EqualParams(newGraphNodes[i])) {
+        continue;
+      }
       hipError_t status = oldGraphExecNodes[i]->SetParams(newGraphNodes[i]);
       if (status != hipSuccess) {
         *hErrorNode_out = reinterpret_cast<hipGraphNode_t>(newGraphNodes[i]);
@@ -2523,10 +2565,11 @@ hipError_t hipGraphExecUpdate(hipGraphExec_t hGraphExec, hipGraph_t hGraph,
           *updateResult_out = hipGraphExecUpdateErrorNotSupported;
         }
         HIP_RETURN(hipErrorGraphExecUpdateFailure);
-      } else if (DEBUG_CLR_GRAPH_PACKET_CAPTURE && newGraphNodes[i]->GraphCaptureEnabled()) {
-        status =
-            reinterpret_cast<hip::GraphExec*>(hGraphExec)
-                ->UpdateAQLPacket(reinterpret_cast<hip::GraphKernelNode*>(oldGraphExecNodes[i]));
+      }
+      updatedNodes++;
+      if (DEBUG_CLR_GRAPH_PACKET_CAPTURE && oldGraphExecNodes[i]->GraphCaptureEnabled()) {
+        status = graphExec->UpdateAQLPacket(oldGraphExecNodes[i]);
+        updatedPackets++;
       }
     } else {
       *hErrorNode_out = reinterpret_cast<hipGraphNode_t>(newGraphNodes[i]);
@@ -2534,6 +2577,12 @@ hipError_t hipGraphExecUpdate(hipGraphExec_t hGraphExec, hipGraph_t hGraph,
       HIP_RETURN(hipErrorGraphExecUpdateFailure);
     }
   }
+  if (updatedPackets > 0) {
+    graphExec->FlushKernelArgs();
+    graphExec->DumpAQLPackets();
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Exec update: %zu of %zu nodes changed, "
+          "%zu packets patched", updatedNodes, newGraphNodes.size(), updatedPackets);
   *updateResult_out = hipGraphExecUpdateSuccess;
   HIP_RETURN(hipSuccess);
 }
@@ -2571,8 +2620,7 @@ hipError_t hipGraphAddMemAllocNode(hipGraphNode_t* pGraphNode, hipGraph_t graph,
   pNodeParams->dptr =
       (HIP_MEM_POOL_USE_VM) ? mem_alloc_node->ReserveAddress() : mem_alloc_node->Execute();
   *pGraphNode = reinterpret_cast<hipGraphNode_t>(node);
-  amd::ScopedLock lock(hip::Graph::graphSetLock_);
-  hgraph->memAllocNodePtrs_.insert(pNodeParams->dptr);
+  hgraph->AddMemAllocPtr(pNodeParams->dptr);
   HIP_RETURN(status);
 }
 
@@ -2623,22 +2671,11 @@ hipError_t hipGraphAddMemFreeNode(hipGraphNode_t* pGraphNode, hipGraph_t graph,
     HIP_RETURN(hipErrorInvalidValue);
   }
   // memAllocNodePtrs_ stores only local to graph alloc dptrs whose free node is not added.
-  // and so we need to traverse all graphs of graphSet_ and below cases are handled.
+  // The owners of these allocations are looked up by the address and below cases are handled.
   // 1) Free node cannot be added twice to the same graph
   // 2) Free node if it part of another graph cannot be added to this graph
   hip::GraphNode* pNode;
-  bool bGraphFound = false;
-  {
-    amd::ScopedLock lock(hip::Graph::graphSetLock_);
-    for (auto itGraph : hip::Graph::graphSet_) {
-      std::unordered_set<void*>::iterator itDevPtr = itGraph->memAllocNodePtrs_.find(dev_ptr);
-      if (itDevPtr != itGraph->memAllocNodePtrs_.end()) {
-        bGraphFound = true;
-        itGraph->memAllocNodePtrs_.erase(itDevPtr);
-        break;
-      }
-    }
-  }
+  bool bGraphFound = hip::Graph::ReleaseMemAllocPtr(dev_ptr);
   if (bGraphFound == false) {
     HIP_RETURN(hipErrorInvalidValue);
   }
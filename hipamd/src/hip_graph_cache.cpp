@@ -0,0 +1,283 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#include "hip_graph_cache.hpp"
+
+namespace hip {
+
+// ================================================================================================
+GraphInstantiateCache* GraphInstantiateCache::Get() {
+  if (DEBUG_HIP_GRAPH_INSTANTIATE_CACHE == 0) {
+    return nullptr;
+  }
+  // The cache is never destroyed, since the idle streams can't be released at the process exit
+  static GraphInstantiateCache* cache =
+      new GraphInstantiateCache(DEBUG_HIP_GRAPH_INSTANTIATE_CACHE);
+  return cache;
+}
+
+// ================================================================================================
+void GraphInstantiateCache::BuildKey(const Graph* graph, Key& key) {
+  const std::vector<Node>& vertices = graph->vertices_;
+  key.valid_ = false;
+  if (vertices.size() >= std::numeric_limits<uint32_t>::max()) {
+    return;
+  }
+  key.device_ = hip::getCurrentDevice()->deviceId();
+  key.types_.reserve(vertices.size());
+  key.edgeStart_.reserve(vertices.size() + 1);
+  for (auto node : vertices) {
+    // A child graph is scheduled into its own lists and streams, which the entry doesn't keep
+    if (node->GetType() == hipGraphNodeTypeGraph) {
+      return;
+    }
+    key.types_.push_back(node->GetType());
+    key.edgeStart_.push_back(key.edges_.size());
+    for (auto edge : node->GetEdges()) {
+      key.edges_.push_back(graph->GetNodeIndex(edge));
+    }
+  }
+  key.edgeStart_.push_back(key.edges_.size());
+  uint64_t hash = HashValue(kHashSeed, key.device_);
+  hash = HashBytes(hash, key.types_.data(), key.types_.size() * sizeof(uint32_t));
+  hash = HashBytes(hash, key.edgeStart_.data(), key.edgeStart_.size() * sizeof(uint32_t));
+  hash = HashBytes(hash, key.edges_.data(), key.edges_.size() * sizeof(uint32_t));
+  key.hash_ = hash;
+  key.valid_ = true;
+}
+
+// ================================================================================================
+std::list<GraphInstantiateCache::Entry>::iterator GraphInstantiateCache::FindEntry(
+    const Key& key) {
+  auto range = index_.equal_range(key.hash_);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second->key_ == key) {
+      return it->second;
+    }
+  }
+  return entries_.end();
+}
+
+// ================================================================================================
+GraphInstantiateCache::Entry* GraphInstantiateCache::FindEntry(uint64_t id) {
+  // The capacity is small, so a scan is cheaper than another index
+  for (auto& entry : entries_) {
+    if (entry.id_ == id) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+// ================================================================================================
+void GraphInstantiateCache::DestroyStreams(Entry& entry) {
+  for (auto stream : entry.streams_) {
+    hip::Stream::Destroy(stream);
+  }
+  entry.streams_.clear();
+}
+
+// ================================================================================================
+uint64_t GraphInstantiateCache::Lookup(Graph* graph, Key& key, std::vector<Node>& topoOrder,
+                                       std::vector<std::vector<Node>>& parallelLists,
+                                       std::unordered_map<Node, std::vector<Node>>& nodeWaitLists) {
+  BuildKey(graph, key);
+  amd::ScopedLock lock(lock_);
+  if (!key.valid_) {
+    stats_.bypasses_++;
+    return 0;
+  }
+  auto it = FindEntry(key);
+  if (it == entries_.end()) {
+    stats_.misses_++;
+    ClPrint(amd::LOG_INFO, amd::LOG_CODE,
+            "[hipGraph] Instantiate cache miss, hits %llu, misses %llu, evictions %llu",
+            static_cast<unsigned long long>(stats_.hits_),
+            static_cast<unsigned long long>(stats_.misses_),
+            static_cast<unsigned long long>(stats_.evictions_));
+    return 0;
+  }
+  entries_.splice(entries_.begin(), entries_, it);
+  const Entry& entry = *it;
+  const std::vector<Node>& vertices = graph->vertices_;
+  topoOrder.reserve(entry.topoOrder_.size());
+  for (auto index : entry.topoOrder_) {
+    topoOrder.push_back(vertices[index]);
+  }
+  parallelLists.resize(entry.parallelLists_.size());
+  for (size_t i = 0; i < entry.parallelLists_.size(); ++i) {
+    parallelLists[i].reserve(entry.parallelLists_[i].size());
+    for (auto index : entry.parallelLists_[i]) {
+      parallelLists[i].push_back(vertices[index]);
+    }
+  }
+  for (const auto& wait : entry.waitLists_) {
+    std::vector<Node>& list = nodeWaitLists[vertices[wait.first]];
+    list.reserve(wait.second.size());
+    for (auto index : wait.second) {
+      list.push_back(vertices[index]);
+    }
+  }
+  if (!entry.streamIds_.empty()) {
+    for (size_t i = 0; i < vertices.size(); ++i) {
+      vertices[i]->stream_id_ = entry.streamIds_[i];
+      vertices[i]->signal_is_required_ = entry.signals_[i];
+    }
+    for (size_t i = 0; i < entry.roots_.size(); ++i) {
+      graph->roots_[i] = (entry.roots_[i] < 0) ? nullptr : vertices[entry.roots_[i]];
+    }
+    graph->max_streams_ = entry.maxStreams_;
+  }
+  stats_.hits_++;
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE,
+          "[hipGraph] Instantiate cache hit, entry %llu, hits %llu, misses %llu, evictions %llu",
+          static_cast<unsigned long long>(entry.id_),
+          static_cast<unsigned long long>(stats_.hits_),
+          static_cast<unsigned long long>(stats_.misses_),
+          static_cast<unsigned long long>(stats_.evictions_));
+  return entry.id_;
+}
+
+// ================================================================================================
+uint64_t GraphInstantiateCache::Insert(Graph* graph, Key& key,
+                                       const std::vector<Node>& topoOrder,
+                                       const std::vector<std::vector<Node>>& parallelLists,
+                                       const std::unordered_map<Node, std::vector<Node>>&
+                                           nodeWaitLists) {
+  if (!key.valid_) {
+    return 0;
+  }
+  const std::vector<Node>& vertices = graph->vertices_;
+  Entry entry;
+  // The schedule refers to the graph vertices only, otherwise the graph can't be cached
+  bool valid = true;
+  auto index = [&](Node node) {
+    size_t i = graph->GetNodeIndex(node);
+    valid &= (i < vertices.size());
+    return static_cast<uint32_t>(i);
+  };
+  entry.topoOrder_.reserve(topoOrder.size());
+  for (auto node : topoOrder) {
+    entry.topoOrder_.push_back(index(node));
+  }
+  entry.parallelLists_.resize(parallelLists.size());
+  for (size_t i = 0; i < parallelLists.size(); ++i) {
+    entry.parallelLists_[i].reserve(parallelLists[i].size());
+    for (auto node : parallelLists[i]) {
+      entry.parallelLists_[i].push_back(index(node));
+    }
+  }
+  entry.waitLists_.reserve(nodeWaitLists.size());
+  for (const auto& wait : nodeWaitLists) {
+    std::vector<uint32_t> list;
+    list.reserve(wait.second.size());
+    for (auto node : wait.second) {
+      list.push_back(index(node));
+    }
+    entry.waitLists_.emplace_back(index(wait.first), std::move(list));
+  }
+  if (DEBUG_HIP_FORCE_GRAPH_QUEUES != 0) {
+    entry.streamIds_.reserve(vertices.size());
+    entry.signals_.reserve(vertices.size());
+    for (auto node : vertices) {
+      entry.streamIds_.push_back(node->stream_id_);
+      entry.signals_.push_back(node->signal_is_required_);
+    }
+    entry.roots_.reserve(graph->roots_.size());
+    for (auto root : graph->roots_) {
+      entry.roots_.push_back((root == nullptr) ? -1 : static_cast<int64_t>(index(root)));
+    }
+    entry.maxStreams_ = graph->max_streams_;
+  }
+  if (!valid) {
+    return 0;
+  }
+
+  amd::ScopedLock lock(lock_);
+  // Another thread could instantiate the same structure, which has the same schedule
+  auto it = FindEntry(key);
+  if (it != entries_.end()) {
+    return it->id_;
+  }
+  if (entries_.size() >= capacity_) {
+    Entry& last = entries_.back();
+    auto range = index_.equal_range(last.key_.hash_);
+    for (auto item = range.first; item != range.second; ++item) {
+      if (&*item->second == &last) {
+        index_.erase(item);
+        break;
+      }
+    }
+    DestroyStreams(last);
+    entries_.pop_back();
+    stats_.evictions_++;
+  }
+  entry.id_ = nextId_++;
+  entry.key_ = std::move(key);
+  entries_.push_front(std::move(entry));
+  index_.emplace(entries_.front().key_.hash_, entries_.begin());
+  return entries_.front().id_;
+}
+
+// ================================================================================================
+void GraphInstantiateCache::TakeStreams(uint64_t id, size_t num,
+                                        std::vector<hip::Stream*>& streams) {
+  amd::ScopedLock lock(lock_);
+  Entry* entry = FindEntry(id);
+  if (entry == nullptr) {
+    return;
+  }
+  while ((num-- > 0) && !entry->streams_.empty()) {
+    streams.push_back(entry->streams_.back());
+    entry->streams_.pop_back();
+    stats_.reusedStreams_++;
+  }
+}
+
+// ================================================================================================
+bool GraphInstantiateCache::ReturnStreams(uint64_t id, std::vector<hip::Stream*>& streams) {
+  amd::ScopedLock lock(lock_);
+  Entry* entry = FindEntry(id);
+  // Keep the streams of one executable graph only, the schedule needs no more
+  if ((entry == nullptr) || !entry->streams_.empty()) {
+    return false;
+  }
+  entry->streams_.swap(streams);
+  return true;
+}
+
+// ================================================================================================
+void GraphInstantiateCache::DropStreams(int device) {
+  amd::ScopedLock lock(lock_);
+  for (auto& entry : entries_) {
+    if (entry.key_.device_ == device) {
+      entry.streams_.clear();
+    }
+  }
+}
+
+// ================================================================================================
+GraphInstantiateCacheStats GraphInstantiateCache::Stats() {
+  amd::ScopedLock lock(lock_);
+  return stats_;
+}
+
+}  // namespace hip
@@ -0,0 +1,128 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#pragma once
+
+#include "hip_graph_internal.hpp"
+#include <list>
+
+namespace hip {
+
+//! Statistics of the instantiate cache
+struct GraphInstantiateCacheStats {
+  uint64_t hits_ = 0;             //!< Instantiations, which reused a cached schedule
+  uint64_t misses_ = 0;           //!< Instantiations, which scheduled the graph
+  uint64_t bypasses_ = 0;         //!< Instantiations of graphs, which can't be cached
+  uint64_t evictions_ = 0;        //!< Entries dropped by the LRU policy
+  uint64_t reusedStreams_ = 0;    //!< Parallel streams taken from the cache
+};
+
+/*! \brief Reuses the scheduling of structurally equal graphs at instantiate.
+ *
+ *  The key is the graph after the instantiate passes: the device, the node types and the edges
+ *  by the node index. The entry keeps the topological order, the parallel lists, the wait lists
+ *  and the stream assignment as node indices, so a hit maps them onto the nodes of the new clone
+ *  and skips the scheduling. The parallel streams of a destroyed executable graph return to its
+ *  entry and the next instantiation of the same structure takes them instead of creating new
+ *  ones. The node parameters aren't a part of the key, since the packets and the kernel
+ *  arguments are captured from the nodes of every instantiation.
+ */
+class GraphInstantiateCache {
+ public:
+  //! Returns the cache or nullptr if DEBUG_HIP_GRAPH_INSTANTIATE_CACHE disables it
+  static GraphInstantiateCache* Get();
+
+  //! Structure of the graph in the index form
+  struct Key {
+    bool valid_ = false;                //!< The graph can be cached
+    int device_ = -1;                   //!< Device of the instantiation
+    std::vector<uint32_t> types_;       //!< Node types in the order of the vertices
+    std::vector<uint32_t> edgeStart_;   //!< Start of the node edges in edges_
+    std::vector<uint32_t> edges_;       //!< Edges of all nodes by the node index
+    uint64_t hash_ = 0;                 //!< Hash of the fields above
+
+    bool operator==(const Key& rhs) const {
+      return (hash_ == rhs.hash_) && (device_ == rhs.device_) && (types_ == rhs.types_) &&
+             (edgeStart_ == rhs.edgeStart_) && (edges_ == rhs.edges_);
+    }
+  };
+
+  /*! \brief Finds the schedule of the graph and applies it to the graph nodes
+   *
+   *  \return the entry ID, 0 if the graph isn't in the cache or can't be cached
+   */
+  uint64_t Lookup(Graph* graph, Key& key, std::vector<Node>& topoOrder,
+                  std::vector<std::vector<Node>>& parallelLists,
+                  std::unordered_map<Node, std::vector<Node>>& nodeWaitLists);
+
+  //! Records the schedule of the graph and returns the entry ID, 0 if the graph can't be cached
+  uint64_t Insert(Graph* graph, Key& key, const std::vector<Node>& topoOrder,
+                  const std::vector<std::vector<Node>>& parallelLists,
+                  const std::unordered_map<Node, std::vector<Node>>& nodeWaitLists);
+
+  //! Moves up to num idle parallel streams of the entry to streams
+  void TakeStreams(uint64_t id, size_t num, std::vector<hip::Stream*>& streams);
+
+  //! Keeps the idle streams in the entry, returns false if the caller has to destroy them
+  bool ReturnStreams(uint64_t id, std::vector<hip::Stream*>& streams);
+
+  //! Forgets the idle streams of the device, which the device reset destroys
+  void DropStreams(int device);
+
+  //! Returns a snapshot of the statistics
+  GraphInstantiateCacheStats Stats();
+
+ private:
+  struct Entry {
+    uint64_t id_;                                    //!< Unique ID, held by the executable graph
+    Key key_;                                        //!< Structure of the cached graph
+    std::vector<uint32_t> topoOrder_;                //!< Topological order
+    std::vector<std::vector<uint32_t>> parallelLists_;  //!< Parallel lists
+    //! Wait lists of the nodes, which start parallel lists
+    std::vector<std::pair<uint32_t, std::vector<uint32_t>>> waitLists_;
+    std::vector<int32_t> streamIds_;                 //!< Stream of every node
+    std::vector<bool> signals_;                      //!< Nodes, which require a signal
+    std::vector<int64_t> roots_;                     //!< First root on every stream, -1 if none
+    int maxStreams_ = 0;                             //!< Max extra streams of the schedule
+    std::vector<hip::Stream*> streams_;              //!< Idle parallel streams
+  };
+
+  explicit GraphInstantiateCache(size_t capacity) : capacity_(capacity) {}
+
+  //! Builds the key of the graph, leaves it invalid if the graph can't be cached
+  static void BuildKey(const Graph* graph, Key& key);
+  //! Returns the entry with the key or entries_.end()
+  std::list<Entry>::iterator FindEntry(const Key& key);
+  //! Returns the entry with the ID or nullptr
+  Entry* FindEntry(uint64_t id);
+  //! Releases the idle streams of the entry
+  static void DestroyStreams(Entry& entry);
+
+  amd::Monitor lock_;             //!< Guards all fields below
+  size_t capacity_;               //!< Max number of entries
+  uint64_t nextId_ = 1;           //!< ID of the next entry
+  std::list<Entry> entries_;      //!< Entries from the most to the least recently used
+  //! Entries by the key hash
+  std::unordered_multimap<uint64_t, std::list<Entry>::iterator> index_;
+  GraphInstantiateCacheStats stats_;
+};
+
+}  // namespace hip
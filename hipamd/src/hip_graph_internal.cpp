@@ -19,6 +19,11 @@
  THE SOFTWARE. */
 
 #include "hip_graph_internal.hpp"
+#include "hip_graph_cache.hpp"
+#include "hip_graph_mem_planner.hpp"
+#include "hip_graph_packet_dump.hpp"
+#include "hip_graph_profiler.hpp"
+#include <fstream>
 #include <queue>
 
 #define CASE_STRING(X, C)                                                                          \
@@ -58,18 +63,13 @@ amd::Monitor GraphExecStatusLock_ ROCCLR_INIT_PRIORITY(101){true};
 
 int GraphNode::nextID = 0;
 int Graph::nextID = 0;
-std::unordered_set<GraphNode*> GraphNode::nodeSet_;
-// Guards global node set
-amd::Monitor GraphNode::nodeSetLock_{};
-std::unordered_set<Graph*> Graph::graphSet_;
-// Guards global graph set
+amd::ConcurrentHandleSet<GraphNode> GraphNode::nodeSet_;
+amd::ConcurrentHandleSet<Graph> Graph::graphSet_;
+// Guards the graph allocations and the user objects of the graphs
 amd::Monitor Graph::graphSetLock_{};
-std::unordered_set<GraphExec*> GraphExec::graphExecSet_;
-// Guards global exec graph set
-amd::Monitor GraphExec::graphExecSetLock_{};
-std::unordered_set<UserObject*> UserObject::ObjectSet_;
-// Guards global user object
-amd::Monitor UserObject::UserObjectLock_{};
+std::unordered_multimap<void*, Graph*> Graph::memAllocOwners_;
+amd::ConcurrentHandleSet<GraphExec> GraphExec::graphExecSet_;
+amd::ConcurrentHandleSet<UserObject> UserObject::ObjectSet_;
 // Guards mem map add/remove against work thread
 amd::Monitor GraphNode::WorkerThreadLock_{};
 
@@ -113,14 +113,11 @@ hipError_t GraphMemcpyNode::ValidateParams(const hipMemcpy3DParms* pNodeParams)
 }
 
 bool Graph::isGraphValid(Graph* pGraph) {
-  amd::ScopedLock lock(graphSetLock_);
-  if (graphSet_.find(pGraph) == graphSet_.end()) {
-    return false;
-  }
-  return true;
+  return graphSet_.contains(pGraph);
 }
 
 void Graph::AddNode(const Node& node) {
+  node->SetIndex(vertices_.size());
   vertices_.emplace_back(node);
   ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Add %s(%p)",
           GetGraphNodeTypeString(node->GetType()), node);
@@ -128,10 +125,43 @@ void Graph::AddNode(const Node& node) {
 }
 
 void Graph::RemoveNode(const Node& node) {
-  vertices_.erase(std::remove(vertices_.begin(), vertices_.end(), node), vertices_.end());
+  size_t index = GetNodeIndex(node);
+  if (index < vertices_.size()) {
+    vertices_.erase(vertices_.begin() + index);
+    for (size_t i = index; i < vertices_.size(); ++i) {
+      vertices_[i]->SetIndex(i);
+    }
+  }
   delete node;
 }
 
+void Graph::DetachNode(const Node& node, const Node& replacement) {
+  // Copy the lists, since the edge removal updates them
+  const std::vector<Node> dependencies = node->GetDependencies();
+  for (auto dep : dependencies) {
+    dep->RemoveEdgeDep(node);
+  }
+  const std::vector<Node> edges = node->GetEdges();
+  for (auto edge : edges) {
+    node->RemoveEdgeDep(edge);
+  }
+  size_t index = GetNodeIndex(node);
+  if (index < vertices_.size()) {
+    if (replacement != nullptr) {
+      vertices_[index] = replacement;
+      replacement->SetIndex(index);
+    } else {
+      vertices_.erase(vertices_.begin() + index);
+      for (size_t i = index; i < vertices_.size(); ++i) {
+        vertices_[i]->SetIndex(i);
+      }
+    }
+  }
+  detached_.push_back(node);
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Detach %s(%p)",
+          GetGraphNodeTypeString(node->GetType()), node);
+}
+
 // root nodes are all vertices with 0 in-degrees
 std::vector<Node> Graph::GetRootNodes() const {
   std::vector<Node> roots;
@@ -330,32 +360,37 @@ bool Graph::TopologicalOrder(std::vector<Node>& TopoOrder) {
   return false;
 }
 
-Graph* Graph::clone(std::unordered_map<Node, Node>& clonedNodes) const {
+Graph* Graph::clone(std::vector<Node>& clonedNodes) const {
   Graph* newGraph = new Graph(device_, this);
+  clonedNodes.clear();
+  clonedNodes.reserve(vertices_.size());
+  newGraph->vertices_.reserve(vertices_.size());
   for (auto entry : vertices_) {
     GraphNode* node = entry->clone();
     node->SetParentGraph(newGraph);
+    node->SetIndex(newGraph->vertices_.size());
     newGraph->vertices_.push_back(node);
-    clonedNodes[entry] = node;
+    clonedNodes.push_back(node);
   }
 
+  // The clones take the positions of the originals, so the edges map by the node index
   std::vector<Node> clonedEdges;
   std::vector<Node> clonedDependencies;
-  for (auto node : vertices_) {
-    const std::vector<Node>& edges = node->GetEdges();
+  for (size_t i = 0; i < vertices_.size(); ++i) {
+    const std::vector<Node>& edges = vertices_[i]->GetEdges();
     clonedEdges.clear();
     for (auto edge : edges) {
-      clonedEdges.push_back(clonedNodes[edge]);
+      clonedEdges.push_back(clonedNodes[GetNodeIndex(edge)]);
     }
-    clonedNodes[node]->SetEdges(clonedEdges);
+    clonedNodes[i]->SetEdges(clonedEdges);
   }
-  for (auto node : vertices_) {
-    const std::vector<Node>& dependencies = node->GetDependencies();
+  for (size_t i = 0; i < vertices_.size(); ++i) {
+    const std::vector<Node>& dependencies = vertices_[i]->GetDependencies();
     clonedDependencies.clear();
     for (auto dep : dependencies) {
-      clonedDependencies.push_back(clonedNodes[dep]);
+      clonedDependencies.push_back(clonedNodes[GetNodeIndex(dep)]);
     }
-    clonedNodes[node]->SetDependencies(clonedDependencies);
+    clonedNodes[i]->SetDependencies(clonedDependencies);
   }
   for (auto userObj : graphUserObj_) {
     userObj->retain();
@@ -369,21 +404,20 @@ Graph* Graph::clone(std::unordered_map<Node, Node>& clonedNodes) const {
 }
 
 Graph* Graph::clone() const {
-  std::unordered_map<Node, Node> clonedNodes;
+  std::vector<Node> clonedNodes;
   return clone(clonedNodes);
 }
 
 bool GraphExec::isGraphExecValid(GraphExec* pGraphExec) {
-  amd::ScopedLock lock(graphExecSetLock_);
-  if (graphExecSet_.find(pGraphExec) == graphExecSet_.end()) {
-    return false;
-  }
-  return true;
+  return graphExecSet_.contains(pGraphExec);
 }
 
 hipError_t GraphExec::CreateStreams(uint32_t num_streams) {
   parallel_streams_.reserve(num_streams);
-  for (uint32_t i = 0; i < num_streams; ++i) {
+  if (cacheEntry_ != 0) {
+    GraphInstantiateCache::Get()->TakeStreams(cacheEntry_, num_streams, parallel_streams_);
+  }
+  for (uint32_t i = parallel_streams_.size(); i < num_streams; ++i) {
     auto stream = new hip::Stream(hip::getCurrentDevice(),
                                   hip::Stream::Priority::Normal, hipStreamNonBlocking);
     if (stream == nullptr || !stream->Create()) {
@@ -401,9 +435,38 @@ hipError_t GraphExec::CreateStreams(uint32_t num_streams) {
   return hipSuccess;
 }
 
+// ================================================================================================
+void GraphExec::ReleaseStreams() {
+  for (auto stream : parallel_streams_) {
+    stream->finish();
+  }
+  if ((cacheEntry_ != 0) &&
+      GraphInstantiateCache::Get()->ReturnStreams(cacheEntry_, parallel_streams_)) {
+    return;
+  }
+  for (auto stream : parallel_streams_) {
+    hip::Stream::Destroy(stream);
+  }
+  parallel_streams_.clear();
+}
+
+// ================================================================================================
+void GraphExec::ReportProfile() {
+  if (profiler_ != nullptr) {
+    profiler_->Report();
+    delete profiler_;
+    profiler_ = nullptr;
+    clonedGraph_->profiler_ = nullptr;
+  }
+}
+
 // ================================================================================================
 hipError_t GraphExec::Init() {
   hipError_t status = hipSuccess;
+  if (!flagIsDefault(DEBUG_HIP_GRAPH_PROFILE)) {
+    profiler_ = new GraphProfiler(clonedGraph_);
+    clonedGraph_->profiler_ = profiler_;
+  }
   size_t min_num_streams = 1;
   if ((DEBUG_HIP_FORCE_GRAPH_QUEUES == 0) || (parallelLists_.size() == 1)) {
     for (auto& node : topoOrder_) {
@@ -419,6 +482,10 @@ hipError_t GraphExec::Init() {
   if (status != hipSuccess) {
     return status;
   }
+  status = PlanMemory();
+  if (status != hipSuccess) {
+    return status;
+  }
   if (DEBUG_CLR_GRAPH_PACKET_CAPTURE) {
     // For graph nodes capture AQL packets to dispatch them directly during graph launch.
     status = CaptureAQLPackets();
@@ -427,6 +494,139 @@ hipError_t GraphExec::Init() {
   return status;
 }
 
+// ================================================================================================
+hipError_t GraphExec::PlanMemory() {
+  // Auto free releases all graph memory on launch, including the arena
+  if (!HIP_MEM_POOL_USE_VM || !DEBUG_HIP_GRAPH_MEM_PLAN ||
+      (flags_ & hipGraphInstantiateFlagAutoFreeOnLaunch)) {
+    return hipSuccess;
+  }
+  std::unordered_map<Node, size_t> index;
+  std::unordered_map<void*, size_t> allocs;
+  for (size_t i = 0; i < topoOrder_.size(); ++i) {
+    index[topoOrder_[i]] = i;
+    if (topoOrder_[i]->GetType() == hipGraphNodeTypeMemAlloc) {
+      hipMemAllocNodeParams params;
+      static_cast<GraphMemAllocNode*>(topoOrder_[i])->GetParams(&params);
+      allocs[params.dptr] = i;
+    }
+  }
+  if (allocs.empty()) {
+    return hipSuccess;
+  }
+  const auto& dev_info = g_devices[0]->devices()[0]->info();
+  // Only the allocations with a free in the graph have a live range, the others outlive
+  // the launch and keep the pool allocation
+  std::vector<GraphMemBlock> blocks;
+  for (size_t i = 0; i < topoOrder_.size(); ++i) {
+    if (topoOrder_[i]->GetType() != hipGraphNodeTypeMemFree) {
+      continue;
+    }
+    void* dptr = nullptr;
+    static_cast<GraphMemFreeNode*>(topoOrder_[i])->GetParams(&dptr);
+    auto it = allocs.find(dptr);
+    if (it != allocs.end()) {
+      hipMemAllocNodeParams params;
+      static_cast<GraphMemAllocNode*>(topoOrder_[it->second])->GetParams(&params);
+      blocks.emplace_back(amd::alignUp(params.bytesize, dev_info.virtualMemAllocGranularity_),
+                          it->second, i);
+    }
+  }
+  if (blocks.empty()) {
+    return hipSuccess;
+  }
+
+  // Nodes, reachable from the free nodes over the edges
+  std::unordered_map<size_t, std::vector<bool>> reach;
+  for (const auto& block : blocks) {
+    std::vector<bool>& reachable = reach[block.freeIdx_];
+    reachable.resize(topoOrder_.size(), false);
+    std::vector<Node> stack(1, topoOrder_[block.freeIdx_]);
+    while (!stack.empty()) {
+      Node node = stack.back();
+      stack.pop_back();
+      for (auto edge : node->GetEdges()) {
+        auto it = index.find(edge);
+        if ((it != index.end()) && !reachable[it->second]) {
+          reachable[it->second] = true;
+          stack.push_back(edge);
+        }
+      }
+    }
+  }
+  GraphMemoryPlanner planner(dev_info.virtualMemAllocGranularity_);
+  size_t arenaSize = planner.Plan(blocks, [&reach](size_t from, size_t to) {
+    auto it = reach.find(from);
+    return (it != reach.end()) && it->second[to];
+  });
+
+  hip::Stream* stream = hip::getCurrentDevice()->NullStream();
+  memArena_ = clonedGraph_->AllocateMemory(arenaSize, stream, nullptr);
+  if (memArena_ == nullptr) {
+    // Keep the allocations on the launches
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM_POOL, "Graph arena allocation failed, size %zu",
+            arenaSize);
+    return hipSuccess;
+  }
+  size_t offset = 0;
+  amd::Memory* arena = getMemoryObject(memArena_, offset);
+  size_t sum = 0;
+  for (const auto& block : blocks) {
+    auto allocNode = static_cast<GraphMemAllocNode*>(topoOrder_[block.allocIdx_]);
+    hipMemAllocNodeParams params;
+    allocNode->GetParams(&params);
+    // Replace the dummy reference of the reserved address with the real mapping
+    if (amd::MemObjMap::FindMemObj(params.dptr) != nullptr) {
+      amd::MemObjMap::RemoveMemObj(params.dptr);
+    }
+    amd::Command* cmd = new amd::VirtualMapCommand(*stream, amd::Command::EventWaitList{},
+                                                   params.dptr, block.size_, arena,
+                                                   block.offset_);
+    cmd->enqueue();
+    cmd->awaitCompletion();
+    cmd->release();
+    stream->device().SetMemAccess(params.dptr, block.size_, amd::Device::VmmAccess::kReadWrite);
+    arenaMaps_.push_back(std::make_pair(params.dptr, block.size_));
+    allocNode->SetPlanned(true);
+    static_cast<GraphMemFreeNode*>(topoOrder_[block.freeIdx_])->SetPlanned(true);
+    sum += block.size_;
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM_POOL, "Graph arena map: %p, offset %zu, size %zu",
+            params.dptr, block.offset_, block.size_);
+  }
+  // A mapping links the arena to the last mapped address, the arena doesn't follow it
+  arena->getUserData().vaddr_mem_obj = nullptr;
+  ClPrint(amd::LOG_INFO, amd::LOG_MEM_POOL,
+          "Graph arena %p: %zu allocations, size %zu, unplanned size %zu", memArena_,
+          blocks.size(), arenaSize, sum);
+  return hipSuccess;
+}
+
+// ================================================================================================
+void GraphExec::ReleaseMemory() {
+  if (memArena_ == nullptr) {
+    return;
+  }
+  size_t offset = 0;
+  amd::Memory* arena = getMemoryObject(memArena_, offset);
+  hip::Stream* stream = g_devices[arena->getUserData().deviceId]->NullStream();
+  for (const auto& map : arenaMaps_) {
+    amd::Memory* va = amd::MemObjMap::FindVirtualMemObj(map.first);
+    amd::Command* cmd = new amd::VirtualMapCommand(*stream, amd::Command::EventWaitList{},
+                                                   map.first, map.second, nullptr);
+    cmd->enqueue();
+    cmd->awaitCompletion();
+    cmd->release();
+    // Restore the dummy reference for the validation of the captured pointers
+    if (va != nullptr) {
+      amd::MemObjMap::AddMemObj(map.first, va);
+    }
+  }
+  arenaMaps_.clear();
+  arena->getUserData().vaddr_mem_obj = nullptr;
+  clonedGraph_->FreeMemory(memArena_, stream);
+  memArena_ = nullptr;
+}
+
 //! Chunk size to add to kern arg pool
 constexpr uint32_t kKernArgChunkSize = 128 * Ki;
 // ================================================================================================
@@ -499,28 +699,88 @@ hipError_t GraphExec::CaptureAQLPackets() {
       return status;
     }
     kernArgManager_->ReadBackOrFlush();
+    DumpAQLPackets();
   }
   return status;
 }
 
+// ================================================================================================
+static void DumpNodePackets(GraphPacketDumper& dumper, const std::vector<Node>& topoOrder) {
+  for (auto node : topoOrder) {
+    const char* type = GetGraphNodeTypeString(node->GetType());
+    if (node->GraphCaptureEnabled()) {
+      dumper.DumpNode(node->GetID(), type, node->GetKernelName(), node->GetAqlPackets());
+    } else if ((node->GetType() == hipGraphNodeTypeGraph) &&
+               reinterpret_cast<ChildGraphNode*>(node)->GetGraphCaptureStatus()) {
+      DumpNodePackets(dumper, reinterpret_cast<ChildGraphNode*>(node)->GetChildGraphNodeOrder());
+    } else {
+      dumper.DumpCommandNode(node->GetID(), type);
+    }
+  }
+}
+
+// ================================================================================================
+void GraphExec::DumpAQLPackets() {
+  if (flagIsDefault(DEBUG_HIP_GRAPH_PACKET_DUMP) || (parallelLists_.size() != 1)) {
+    return;
+  }
+  std::ofstream out(DEBUG_HIP_GRAPH_PACKET_DUMP, std::ios::app);
+  if (!out.is_open()) {
+    LogPrintfError("Can't open the graph packet dump file %s", DEBUG_HIP_GRAPH_PACKET_DUMP);
+    return;
+  }
+  GraphPacketDumper dumper(out);
+  dumper.Begin(this, topoOrder_.size());
+  DumpNodePackets(dumper, topoOrder_);
+  dumper.End();
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE,
+          "[hipGraph] Packet stream of graph %p: packets %zu, command nodes %zu, errors %zu",
+          this, dumper.PacketCount(), dumper.CommandNodes(), dumper.Errors());
+}
+
 // ================================================================================================
 hipError_t GraphExec::UpdateAQLPacket(hip::GraphNode* node) {
   hipError_t status = hipSuccess;
   if (parallelLists_.size() == 1) {
-    node->CaptureAndFormPacket(capture_stream_, kernArgManager_);
+    // An idle graph gets its kernel arguments patched in place, otherwise the packets in flight
+    // keep the old arguments and the update takes new space from the pool
+    node->CaptureAndFormPacket(capture_stream_, kernArgManager_, IsLastLaunchComplete());
   }
   return hipSuccess;
 }
 
+// ================================================================================================
+bool GraphExec::IsLastLaunchComplete() {
+  if (lastEnqueuedCommand_ == nullptr) {
+    return true;
+  }
+  // Check HW status of the ROCcrl event. Note: not all ROCclr modes support HW status
+  bool ready = lastEnqueuedCommand_->queue()->device().IsHwEventReady(
+      lastEnqueuedCommand_->event());
+  if (!ready) {
+    ready = (lastEnqueuedCommand_->status() == CL_COMPLETE);
+  }
+  if (ready) {
+    lastEnqueuedCommand_->release();
+    lastEnqueuedCommand_ = nullptr;
+  }
+  return ready;
+}
+
 hipError_t FillCommands(std::vector<std::vector<Node>>& parallelLists,
                         std::unordered_map<Node, std::vector<Node>>& nodeWaitLists,
                         std::vector<Node>& topoOrder, Graph* clonedGraph,
-                        amd::Command*& graphStart, amd::Command*& graphEnd, hip::Stream* stream) {
+                        amd::Command*& graphStart, amd::Command*& graphEnd, hip::Stream* stream,
+                        GraphProfiler* profiler) {
   hipError_t status = hipSuccess;
   for (auto& node : topoOrder) {
+    uint64_t start = (profiler != nullptr) ? amd::Os::timeNanos() : 0;
     // TODO: clone commands from next launch
     status = node->CreateCommand(node->GetQueue());
     if (status != hipSuccess) return status;
+    if (profiler != nullptr) {
+      profiler->TagCommands(node, start);
+    }
     amd::Command::EventWaitList waitList;
     for (auto depNode : nodeWaitLists[node]) {
       for (auto command : depNode->GetCommands()) {
@@ -607,8 +867,15 @@ hipError_t EnqueueGraphWithSingleList(std::vector<hip::Node>& topoOrder, hip::St
   if (DEBUG_CLR_GRAPH_PACKET_CAPTURE) {
     accumulate = new amd::AccumulateCommand(*hip_stream, {}, nullptr);
   }
+  // The profiled graph runs with the commands, since the packets have no timestamps
+  GraphProfiler* profiler = (graphExec != nullptr) ? graphExec->GetProfiler() : nullptr;
   for (int i = 0; i < topoOrder.size(); i++) {
-    if (topoOrder[i]->GraphCaptureEnabled()) {
+    if (topoOrder[i]->GraphCaptureEnabled() && (profiler == nullptr)) {
+      // A split fold or an update of an inlined child graph invalidates the packets
+      if (topoOrder[i]->NeedsRecapture() && (graphExec != nullptr)) {
+        graphExec->UpdateAQLPacket(topoOrder[i]);
+        graphExec->FlushKernelArgs();
+      }
       if (topoOrder[i]->GetEnabled()) {
         std::vector<uint8_t*>& gpuPackets = topoOrder[i]->GetAqlPackets();
         for (auto& packet : gpuPackets) {
@@ -616,14 +883,21 @@ hipError_t EnqueueGraphWithSingleList(std::vector<hip::Node>& topoOrder, hip::St
         }
       }
     } else {
+      uint64_t start = (profiler != nullptr) ? amd::Os::timeNanos() : 0;
       topoOrder[i]->SetStream(hip_stream, graphExec);
       status = topoOrder[i]->CreateCommand(topoOrder[i]->GetQueue());
+      if (profiler != nullptr) {
+        profiler->TagCommands(topoOrder[i], start);
+      }
       topoOrder[i]->EnqueueCommands(hip_stream);
     }
   }
 
   if (DEBUG_CLR_GRAPH_PACKET_CAPTURE) {
     accumulate->enqueue();
+    if (graphExec != nullptr) {
+      graphExec->SetLastLaunch(accumulate);
+    }
     accumulate->release();
   }
   return status;
@@ -689,6 +963,7 @@ bool Graph::RunOneNode(Node node, bool wait) {
         child->RunNodes(node->stream_id_, &streams_, &waitList);
       }
     } else {
+      uint64_t start = (profiler_ != nullptr) ? amd::Os::timeNanos() : 0;
       // Assing a stream to the current node
       node->SetStream(streams_);
       // Create the execution commands on the assigned stream
@@ -697,6 +972,9 @@ bool Graph::RunOneNode(Node node, bool wait) {
         LogPrintfError("Command creation for node id(%d) failed!", current_id_ + 1);
         return false;
       }
+      if (profiler_ != nullptr) {
+        profiler_->TagCommands(node, start);
+      }
       // Retain all commands, since potentially the command can finish before a wait signal
       for (auto command : node->GetCommands()) {
         command->retain();
@@ -821,6 +1099,12 @@ hipError_t GraphExec::Run(hipStream_t graph_launch_stream) {
 
   hip::Stream* launch_stream = hip::getStream(graph_launch_stream);
 
+  if (profiler_ != nullptr) {
+    // Release the commands of the finished launches, so they don't pile up
+    profiler_->Collect(false);
+    profiler_->BeginLaunch();
+  }
+
   if (flags_ & hipGraphInstantiateFlagAutoFreeOnLaunch) {
     if (!topoOrder_.empty()) {
       topoOrder_[0]->GetParentGraph()->FreeAllMemory(launch_stream);
@@ -855,8 +1139,12 @@ hipError_t GraphExec::Run(hipStream_t graph_launch_stream) {
   } else if (parallelLists_.size() == 1 &&
              instantiateDeviceId_ != launch_stream->DeviceId()) {
     for (int i = 0; i < topoOrder_.size(); i++) {
+      uint64_t start = (profiler_ != nullptr) ? amd::Os::timeNanos() : 0;
       topoOrder_[i]->SetStream(launch_stream, this);
       status = topoOrder_[i]->CreateCommand(topoOrder_[i]->GetQueue());
+      if (profiler_ != nullptr) {
+        profiler_->TagCommands(topoOrder_[i], start);
+      }
       topoOrder_[i]->EnqueueCommands(launch_stream);
     }
   } else {
@@ -865,7 +1153,7 @@ hipError_t GraphExec::Run(hipStream_t graph_launch_stream) {
       amd::Command* rootCommand = nullptr;
       amd::Command* endCommand = nullptr;
       status = FillCommands(parallelLists_, nodeWaitLists_, topoOrder_, clonedGraph_, rootCommand,
-                            endCommand, launch_stream);
+                            endCommand, launch_stream, profiler_);
       if (status != hipSuccess) {
         return status;
       }
@@ -890,6 +1178,9 @@ hipError_t GraphExec::Run(hipStream_t graph_launch_stream) {
       }
     }
   }
+  if (profiler_ != nullptr) {
+    profiler_->EndLaunch();
+  }
   amd::ScopedLock lock(GraphExecStatusLock_);
   GraphExecStatus_[this] = std::make_pair(launch_stream, false);
   ResetQueueIndex();
@@ -29,7 +29,9 @@
 
 #include "hip/hip_runtime.h"
 #include "hip_internal.hpp"
+#include "hip_callback_executor.hpp"
 #include "hip_graph_helper.hpp"
+#include "hip_graph_pass_core.hpp"
 #include "hip_event.hpp"
 #include "hip_platform.hpp"
 #include "hip_mempool_impl.hpp"
@@ -45,33 +47,32 @@ struct Graph;
 struct GraphNode;
 struct GraphExec;
 struct UserObject;
+class GraphProfiler;
 typedef GraphNode* Node;
 hipError_t FillCommands(std::vector<std::vector<Node>>& parallelLists,
                         std::unordered_map<Node, std::vector<Node>>& nodeWaitLists,
                         std::vector<Node>& topoOrder, Graph* clonedGraph, amd::Command*& graphStart,
-                        amd::Command*& graphEnd, hip::Stream* stream);
+                        amd::Command*& graphEnd, hip::Stream* stream,
+                        GraphProfiler* profiler = nullptr);
 void UpdateStream(std::vector<std::vector<Node>>& parallelLists, hip::Stream* stream,
                   GraphExec* ptr);
 hipError_t EnqueueGraphWithSingleList(std::vector<hip::Node>& topoOrder, hip::Stream* hip_stream,
                                       hip::GraphExec* graphExec = nullptr);
 struct UserObject : public amd::ReferenceCountedObject {
   typedef void (*UserCallbackDestructor)(void* data);
-  static std::unordered_set<UserObject*> ObjectSet_;
-  static amd::Monitor UserObjectLock_;
+  static amd::ConcurrentHandleSet<UserObject> ObjectSet_;
 
  public:
   UserObject(UserCallbackDestructor callback, void* data, unsigned int flags)
       : ReferenceCountedObject(), callback_(callback), data_(data), flags_(flags) {
-    amd::ScopedLock lock(UserObjectLock_);
-    ObjectSet_.insert(this);
+    handle_ = ObjectSet_.insert(this);
   }
 
   virtual ~UserObject() {
-    amd::ScopedLock lock(UserObjectLock_);
     if (callback_ != nullptr) {
       callback_(data_);
     }
-    ObjectSet_.erase(this);
+    ObjectSet_.erase(this, handle_);
   }
 
   void increaseRefCount(const unsigned int refCount) {
@@ -88,26 +89,19 @@ struct UserObject : public amd::ReferenceCountedObject {
   }
 
   static bool isUserObjvalid(UserObject* pUsertObj) {
-    amd::ScopedLock lock(UserObjectLock_);
-    auto it = ObjectSet_.find(pUsertObj);
-    if (it == ObjectSet_.end()) {
-      return false;
-    }
-    return true;
+    return ObjectSet_.contains(pUsertObj);
   }
 
+  //! The caller guarantees the object is alive, the removal of an unlisted object is a nop
   static void removeUSerObj(UserObject* pUsertObj) {
-    amd::ScopedLock lock(UserObjectLock_);
-    auto it = ObjectSet_.find(pUsertObj);
-    if (it != ObjectSet_.end()) {
-      ObjectSet_.erase(it);
-    }
+    ObjectSet_.erase(pUsertObj, pUsertObj->handle_);
   }
 
  private:
   UserCallbackDestructor callback_;
   void* data_;
   unsigned int flags_;
+  amd::ConcurrentHandleSet<UserObject>::Token handle_;  //!< Slot of the object in ObjectSet_
   //! Disable default operator=
   UserObject& operator=(const UserObject&) = delete;
   //! Disable copy constructor
@@ -120,11 +114,8 @@ struct hipGraphNodeDOTAttribute {
   std::string shape_;
   std::string label_;
 
-  hipGraphNodeDOTAttribute(std::string style, std::string shape, std::string label) {
-    style_ = style;
-    shape_ = shape;
-    label_ = label;
-  }
+  hipGraphNodeDOTAttribute(std::string style, std::string shape, std::string label)
+      : style_(std::move(style)), shape_(std::move(shape)), label_(std::move(label)) {}
 
   hipGraphNodeDOTAttribute() {
     style_ = "solid";
@@ -186,11 +177,140 @@ class GraphKernelArgManager : public amd::ReferenceCountedObject, public amd::Gr
   using KernelArgImpl = device::Settings::KernelArgImpl;
 };
 
-struct GraphNode : public hipGraphNodeDOTAttribute {
+//! Kernel argument blocks of a graph node, reused when the node packets are captured again
+class GraphKernelArgCache : public amd::GraphKernelArgManager {
+ public:
+  //! Starts a capture. The blocks are reused in the allocation order, if reuse is allowed
+  void Begin(amd::GraphKernelArgManager* manager, bool reuse) {
+    manager_ = manager;
+    next_ = 0;
+    if (!reuse) {
+      blocks_.clear();
+    }
+  }
+
+  address AllocKernArg(size_t size, size_t alignment) override {
+    if (next_ < blocks_.size()) {
+      const Block& block = blocks_[next_];
+      if ((block.size_ >= size) && ((reinterpret_cast<uintptr_t>(block.addr_) % alignment) == 0)) {
+        next_++;
+        return block.addr_;
+      }
+      // The layout of the arguments changed, the remaining blocks don't match
+      blocks_.resize(next_);
+    }
+    address addr = manager_->AllocKernArg(size, alignment);
+    if (addr != nullptr) {
+      blocks_.push_back({addr, size});
+      next_++;
+    }
+    return addr;
+  }
+
+ private:
+  struct Block {
+    address addr_;  //!< Kernel arguments in the graph pool
+    size_t size_;   //!< Size of the block
+  };
+  amd::GraphKernelArgManager* manager_ = nullptr;  //!< Pool of the new blocks
+  std::vector<Block> blocks_;                       //!< Blocks in the allocation order
+  size_t next_ = 0;                                 //!< Next block to reuse
+};
+
+/*! \brief Kernel arguments of a kernel node in one allocation.
+ *
+ *  The clones of a node share the arguments, so the instantiation doesn't copy them. A node
+ *  takes a private copy, before it exposes the argument pointers to the application, which may
+ *  write through them, and replaces the block, when it gets new parameters.
+ */
+class GraphKernelParams : public amd::ReferenceCountedObject {
+ public:
+  //! Number of the entries in the 'extra' array
+  static constexpr size_t kNumExtra = 5;
+
+  //! Copies the arguments, passed as 'kernelParams', with the sizes of the kernel signature
+  GraphKernelParams(void* const* kernelParams, std::vector<size_t> sizes)
+      : ReferenceCountedObject(), sizes_(std::move(sizes)) {
+    size_t offset = sizes_.size() * sizeof(void*);
+    for (auto size : sizes_) {
+      offset = amd::alignUp(offset, kAlignment) + size;
+    }
+    storage_.resize(std::max(offset, sizeof(void*)));
+    kernelParams_ = reinterpret_cast<void**>(storage_.data());
+    offset = sizes_.size() * sizeof(void*);
+    for (size_t i = 0; i < sizes_.size(); ++i) {
+      offset = amd::alignUp(offset, kAlignment);
+      kernelParams_[i] = storage_.data() + offset;
+      ::memcpy(kernelParams_[i], kernelParams[i], sizes_[i]);
+      offset += sizes_[i];
+    }
+  }
+
+  //! Copies the argument buffer, passed as 'extra'
+  explicit GraphKernelParams(void* const* extra) : ReferenceCountedObject() {
+    const size_t size = *reinterpret_cast<size_t*>(extra[3]);
+    const size_t sizeOffset = kNumExtra * sizeof(void*);
+    const size_t bufferOffset = amd::alignUp(sizeOffset + sizeof(size_t), kAlignment);
+    storage_.resize(bufferOffset + size);
+    extra_ = reinterpret_cast<void**>(storage_.data());
+    extra_[0] = extra[0];
+    extra_[1] = storage_.data() + bufferOffset;
+    extra_[2] = extra[2];
+    extra_[3] = storage_.data() + sizeOffset;
+    extra_[4] = extra[4];
+    *reinterpret_cast<size_t*>(extra_[3]) = size;
+    ::memcpy(extra_[1], extra[1], size);
+  }
+
+  //! Returns a private copy of the arguments
+  GraphKernelParams* Clone() const {
+    return (kernelParams_ != nullptr) ? new GraphKernelParams(kernelParams_, sizes_)
+                                      : new GraphKernelParams(extra_);
+  }
+
+  void** KernelParams() const { return kernelParams_; }
+  void** Extra() const { return extra_; }
+  //! Returns the sizes of the arguments, passed as 'kernelParams'
+  const std::vector<size_t>& Sizes() const { return sizes_; }
+  //! Marks the arguments as visible to the application, which may write them at any time
+  void SetExposed() { exposed_ = true; }
+  //! Returns true if the arguments can't be shared with another node
+  bool IsExposed() const { return exposed_; }
+
+ private:
+  //! Alignment of the arguments, which matches the former allocations of each argument
+  static constexpr size_t kAlignment = alignof(std::max_align_t);
+
+  std::vector<uint8_t> storage_;    //!< Pointer table and arguments
+  std::vector<size_t> sizes_;       //!< Sizes of the arguments, passed as 'kernelParams'
+  void** kernelParams_ = nullptr;   //!< Pointers to the arguments in the storage
+  void** extra_ = nullptr;          //!< 'extra' array, which refers to the storage
+  bool exposed_ = false;            //!< The application received pointers to the storage
+};
+
+//! Accumulates the bytes into a FNV-1a hash
+inline uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+//! Accumulates the value into a FNV-1a hash
+template <typename T> inline uint64_t HashValue(uint64_t hash, const T& value) {
+  return HashBytes(hash, &value, sizeof(T));
+}
+
+//! Initial value of the parameter hashes
+constexpr uint64_t kHashSeed = 0xcbf29ce484222325ull;
+
+struct GraphNode : public hipGraphNodeDOTAttribute, public GraphFold<GraphNode> {
  protected:
   // Declare Graph and GraphExec as friends of node for simpler access to GraphNode fields
   friend class Graph;
   friend class GraphExec;
+  friend class GraphInstantiateCache;
   hip::Stream* stream_ = nullptr;
   unsigned int id_;
   hipGraphNodeType type_;
@@ -204,8 +324,8 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   int32_t launch_id_ = -1;  //! Launch ID of this node in the entire graph execution sequence
   static int nextID;
   struct Graph* parentGraph_;
-  static std::unordered_set<GraphNode*> nodeSet_;
-  static amd::Monitor nodeSetLock_;
+  static amd::ConcurrentHandleSet<GraphNode> nodeSet_;
+  amd::ConcurrentHandleSet<GraphNode>::Token handle_;  //!< Slot of the node in nodeSet_
   static amd::Monitor WorkerThreadLock_;
   unsigned int isEnabled_;
   bool signal_is_required_ = false; //!< This node requires a signal on the command
@@ -214,6 +334,10 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   size_t alignedKernArgSize_ = 256;       //!< Aligned size required for kernel args
   size_t kernargSegmentByteSize_ = 512;   //!< Kernel arg segment byte size
   size_t kernargSegmentAlignment_ = 256;  //!< Kernel arg segment alignment
+  uint64_t paramsHash_ = 0;               //!< Cached hash of the node parameters
+  bool paramsHashValid_ = false;          //!< The cached hash matches the parameters
+  GraphKernelArgCache kernArgCache_;      //!< Kernel arguments of the captured packets
+  size_t index_ = 0;                      //!< Position of the node in the parent graph
 
  public:
   GraphNode(hipGraphNodeType type, std::string style = "", std::string shape = "",
@@ -225,9 +349,8 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
         id_(nextID++),
         parentGraph_(nullptr),
         isEnabled_(1),
-        hipGraphNodeDOTAttribute(style, shape, label) {
-    amd::ScopedLock lock(nodeSetLock_);
-    nodeSet_.insert(this);
+        hipGraphNodeDOTAttribute(std::move(style), std::move(shape), std::move(label)) {
+    handle_ = nodeSet_.insert(this);
   }
   /// Copy Constructor
   GraphNode(const GraphNode& node) : hipGraphNodeDOTAttribute(node) {
@@ -237,8 +360,7 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
     visited_ = false;
     id_ = node.id_;
     parentGraph_ = nullptr;
-    amd::ScopedLock lock(nodeSetLock_);
-    nodeSet_.insert(this);
+    handle_ = nodeSet_.insert(this);
     isEnabled_ = node.isEnabled_;
   }
 
@@ -252,17 +374,12 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
     for (auto packet : gpuPackets_) {
       delete[] packet;
     }
-    amd::ScopedLock lock(nodeSetLock_);
-    nodeSet_.erase(this);
+    nodeSet_.erase(this, handle_);
   }
 
   // check node validity
   static bool isNodeValid(GraphNode* pGraphNode) {
-    amd::ScopedLock lock(nodeSetLock_);
-    if (pGraphNode == nullptr || nodeSet_.find(pGraphNode) == nodeSet_.end()) {
-      return false;
-    }
-    return true;
+    return nodeSet_.contains(pGraphNode);
   }
   // Return gpu packet address to update with actual packet under capture.
   std::vector<uint8_t *>& GetAqlPackets() { return gpuPackets_; }
@@ -271,11 +388,19 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   size_t GetKerArgSize() const { return alignedKernArgSize_; }
   size_t GetKernargSegmentByteSize() const { return kernargSegmentByteSize_; }
   size_t GetKernargSegmentAlignment() const { return kernargSegmentAlignment_; }
-  void CaptureAndFormPacket(hip::Stream* capture_stream, GraphKernelArgManager* kernArgMgr) {
+  /// Captures the packets of the node. The kernel arguments are written in place of the
+  /// previous capture, if reuse is allowed
+  void CaptureAndFormPacket(hip::Stream* capture_stream, GraphKernelArgManager* kernArgMgr,
+                            bool reuseKernArgs = false) {
     hipError_t status = CreateCommand(capture_stream);
+    for (auto packet : gpuPackets_) {
+      delete[] packet;
+    }
     gpuPackets_.clear();
+    recapture_ = false;
+    kernArgCache_.Begin(kernArgMgr, reuseKernArgs);
     for (auto& command : commands_) {
-      command->setPktCapturingState(true, &gpuPackets_, kernArgMgr, &capturedKernelName_);
+      command->setPktCapturingState(true, &gpuPackets_, &kernArgCache_, &capturedKernelName_);
       // Enqueue command to capture GPU Packet. The packet is not submitted to the device.
       // The packet is stored in gpuPacket_ and submitted during graph launch.
       command->submit(*(command->queue())->vdev());
@@ -306,8 +431,10 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   }
   /// Return node unique ID
   int GetID() const { return id_; }
-  /// Returns command for graph node
-  virtual std::vector<amd::Command*>& GetCommands() { return commands_; }
+  /// Returns command for graph node, a folded node returns the commands of its fold head
+  virtual std::vector<amd::Command*>& GetCommands() {
+    return (foldHead_ != nullptr) ? foldHead_->commands_ : commands_;
+  }
   /// Returns graph node type
   hipGraphNodeType GetType() const { return type_; }
   /// Clone graph node
@@ -324,6 +451,7 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   const std::vector<Node>& GetDependencies() const { return dependencies_; }
   /// Update graph node dependecies
   void SetDependencies(std::vector<Node>& dependencies) {
+    dependencies_.reserve(dependencies_.size() + dependencies.size());
     for (auto entry : dependencies) {
       dependencies_.push_back(entry);
     }
@@ -370,6 +498,7 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   const std::vector<Node>& GetEdges() const { return edges_; }
   /// Updates graph node children
   void SetEdges(std::vector<Node>& edges) {
+    edges_.reserve(edges_.size() + edges.size());
     for (auto entry : edges) {
       edges_.push_back(entry);
     }
@@ -410,6 +539,9 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   Graph* GetParentGraph() { return parentGraph_; }
   virtual Graph* GetChildGraph() { return nullptr; }
   void SetParentGraph(Graph* graph) { parentGraph_ = graph; }
+  /// Returns the position of the node in the vertices of the parent graph
+  size_t GetIndex() const { return index_; }
+  void SetIndex(size_t index) { index_ = index; }
   virtual hipError_t SetParams(GraphNode* node) { return hipSuccess; }
   virtual void GenerateDOT(std::ostream& fout, hipGraphDebugDotFlags flag) {}
   virtual void GenerateDOTNode(size_t graphId, std::ostream& fout, hipGraphDebugDotFlags flag) {
@@ -433,7 +565,49 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
     return (std::to_string(id_) + "\n" + label_);
   }
   unsigned int GetEnabled() const { return isEnabled_; }
-  void SetEnabled(unsigned int isEnabled) { isEnabled_ = isEnabled; }
+  void SetEnabled(unsigned int isEnabled) {
+    if (isEnabled_ != isEnabled) {
+      BreakFold();
+    }
+    isEnabled_ = isEnabled;
+  }
+  /// Extends this node with the work of the next node, which has to run right after this node
+  virtual bool Fold(GraphNode* next) { return false; }
+  /// Restores the own parameters of a fold head
+  virtual void Unfold() {}
+  /// Returns true if the node is a plain 1D buffer copy
+  virtual bool IsFoldableCopy() const { return false; }
+  /// Returns true if the node has no work
+  bool IsEmptyNode() const { return type_ == hipGraphNodeTypeEmpty; }
+  /// Returns true if the node can run in the parent graph of its child graph
+  bool IsInlinable() const {
+    switch (type_) {
+      case hipGraphNodeTypeKernel:
+      case hipGraphNodeTypeMemcpy:
+      case hipGraphNodeTypeMemset:
+      case hipGraphNodeTypeHost:
+      case hipGraphNodeTypeEmpty:
+        return true;
+      default:
+        return false;
+    }
+  }
+  /// Computes the hash of the parameters, which the exec update compares. Returns false if
+  /// the node doesn't support the hashing
+  virtual bool HashParams(uint64_t* hash) const { return false; }
+  /// Returns true if the parameters, covered by HashParams(), match a node of the same type.
+  /// Confirms a hash match, since equal hashes don't prove equal parameters
+  virtual bool EqualParams(const GraphNode* node) const { return false; }
+  /// Returns the hash of the parameters, computed once after every parameter change
+  bool GetParamsHash(uint64_t* hash) {
+    if (!paramsHashValid_) {
+      paramsHashValid_ = HashParams(&paramsHash_);
+    }
+    *hash = paramsHash_;
+    return paramsHashValid_;
+  }
+  /// Must be called on every change of the parameters, covered by HashParams()
+  void InvalidateParamsHash() { paramsHashValid_ = false; }
   // Returns true if capture is enabled for the current node.
   virtual bool GraphCaptureEnabled() {
     bool isGraphCapture = false;
@@ -476,8 +650,12 @@ struct Graph {
   friend class GraphExec;
   std::vector<Node> vertices_;
   const Graph* pOriginalGraph_ = nullptr;
-  static std::unordered_set<Graph*> graphSet_;
+  static amd::ConcurrentHandleSet<Graph> graphSet_;
+  //! Guards memAllocNodePtrs_, memAllocOwners_ and graphUserObj_
   static amd::Monitor graphSetLock_;
+  //! The graphs, which hold an allocation without a free node, looked up by the address
+  static std::unordered_multimap<void*, Graph*> memAllocOwners_;
+  amd::ConcurrentHandleSet<Graph>::Token handle_;  //!< Slot of the graph in graphSet_
   std::unordered_set<UserObject*> graphUserObj_;
   unsigned int id_;
   static int nextID;
@@ -494,36 +672,94 @@ struct Graph {
   std::unordered_set<GraphNode*> capturedNodes_;
   bool graphInstantiated_;
   std::unordered_set<void*> memAllocNodePtrs_;
+  //! Removes the graph from the owners of the allocation, called under graphSetLock_
+  static void EraseMemAllocOwner(void* ptr, const Graph* graph) {
+    auto range = memAllocOwners_.equal_range(ptr);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == graph) {
+        memAllocOwners_.erase(it);
+        return;
+      }
+    }
+  }
+  //! Nodes removed by the instantiate passes, kept for the updates of the executable graph
+  std::vector<Node> detached_;
+  GraphProfiler* profiler_ = nullptr;  //!< Profiler of the executable graph, run by this graph
  public:
   Graph(hip::Device* device, const Graph* original = nullptr)
       : pOriginalGraph_(original)
       , id_(nextID++)
       , device_(device) {
-    amd::ScopedLock lock(graphSetLock_);
-    graphSet_.insert(this);
     mem_pool_ = device->GetGraphMemoryPool();
     mem_pool_->retain();
     graphInstantiated_ = false;
     roots_.resize(DEBUG_HIP_FORCE_GRAPH_QUEUES);
     leafs_.resize(DEBUG_HIP_FORCE_GRAPH_QUEUES);
     wait_order_.resize(DEBUG_HIP_FORCE_GRAPH_QUEUES);
+    // Register the graph when it's complete, so the validation never sees a partial graph
+    handle_ = graphSet_.insert(this);
   }
 
   ~Graph() {
+    for (auto node : detached_) {
+      // The nodes of an inlined child graph are owned by this graph
+      Graph* child = node->GetChildGraph();
+      if (child != nullptr) {
+        child->vertices_.erase(std::remove_if(child->vertices_.begin(), child->vertices_.end(),
+                                              [child](Node n) {
+                                                return n->GetParentGraph() != child;
+                                              }),
+                               child->vertices_.end());
+      }
+    }
+    for (auto node : detached_) {
+      delete node;
+    }
     for (auto node : vertices_) {
       delete node;
     }
     amd::ScopedLock lock(graphSetLock_);
-    graphSet_.erase(this);
+    graphSet_.erase(this, handle_);
     for (auto userobj : graphUserObj_) {
       userobj->release();
     }
     if (mem_pool_ != nullptr) {
       mem_pool_->release();
     }
+    for (auto ptr : memAllocNodePtrs_) {
+      EraseMemAllocOwner(ptr, this);
+    }
     memAllocNodePtrs_.clear();
   }
 
+  /// Records an allocation of the graph, which doesn't have a free node yet
+  void AddMemAllocPtr(void* ptr) {
+    amd::ScopedLock lock(graphSetLock_);
+    if (memAllocNodePtrs_.insert(ptr).second) {
+      memAllocOwners_.emplace(ptr, this);
+    }
+  }
+  /// Copies the allocations without a free node from another graph
+  void CopyMemAllocPtrs(const Graph* graph) {
+    amd::ScopedLock lock(graphSetLock_);
+    for (auto ptr : graph->memAllocNodePtrs_) {
+      if (memAllocNodePtrs_.insert(ptr).second) {
+        memAllocOwners_.emplace(ptr, this);
+      }
+    }
+  }
+  /// Removes the allocation from a graph, which owns it. Returns false if no graph owns it
+  static bool ReleaseMemAllocPtr(void* ptr) {
+    amd::ScopedLock lock(graphSetLock_);
+    auto it = memAllocOwners_.find(ptr);
+    if (it == memAllocOwners_.end()) {
+      return false;
+    }
+    it->second->memAllocNodePtrs_.erase(ptr);
+    memAllocOwners_.erase(it);
+    return true;
+  }
+
   void AddManualNodeDuringCapture(GraphNode* node) { capturedNodes_.insert(node); }
 
   std::unordered_set<GraphNode*> GetManualNodesDuringCapture() { return capturedNodes_; }
@@ -541,6 +777,17 @@ struct Graph {
   /// add node to the graph
   void AddNode(const Node& node);
   void RemoveNode(const Node& node);
+  /// Removes the node with its edges from the graph, but keeps it alive. The optional
+  /// replacement takes the position of the node in the vertices
+  void DetachNode(const Node& node, const Node& replacement = nullptr);
+  /// Returns the position of the node in the vertices or the vertex count, if it's not there
+  size_t GetNodeIndex(const Node& node) const {
+    size_t index = node->GetIndex();
+    if ((index < vertices_.size()) && (vertices_[index] == node)) {
+      return index;
+    }
+    return std::find(vertices_.begin(), vertices_.end(), node) - vertices_.begin();
+  }
   /// Returns root nodes, all vertices with 0 in-degrees
   std::vector<Node> GetRootNodes() const;
   /// Returns leaf nodes, all vertices with 0 out-degrees
@@ -607,7 +854,8 @@ struct Graph {
 
   bool TopologicalOrder(std::vector<Node>& TopoOrder);
 
-  Graph* clone(std::unordered_map<Node, Node>& clonedNodes) const;
+  /// Clones the graph, the clones of the nodes are returned in the order of the vertices
+  Graph* clone(std::vector<Node>& clonedNodes) const;
   Graph* clone() const;
   void GenerateDOT(std::ostream& fout, hipGraphDebugDotFlags flag) {
     fout << "subgraph cluster_" << GetID() << " {" << std::endl;
@@ -700,42 +948,54 @@ struct GraphExec : public amd::ReferenceCountedObject {
   std::vector<hip::Stream*> parallel_streams_;
   hip::Stream* capture_stream_;
   uint currentQueueIndex_;
-  std::unordered_map<Node, Node> clonedNodes_;
+  //! Nodes of the application graph at the instantiation, in the order of its vertices
+  std::vector<Node> originalNodes_;
+  std::vector<Node> clonedNodes_;  //!< Clones of originalNodes_ at the same positions
   amd::Command* lastEnqueuedCommand_;
-  static std::unordered_set<GraphExec*> graphExecSet_;
-  static amd::Monitor graphExecSetLock_;
+  static amd::ConcurrentHandleSet<GraphExec> graphExecSet_;
+  amd::ConcurrentHandleSet<GraphExec>::Token handle_;  //!< Slot of the graph in graphExecSet_
   uint64_t flags_ = 0;
   GraphKernelArgManager* kernArgManager_ = nullptr; //!< Kernel Arg manager for graph.
   int instantiateDeviceId_ = -1;
   bool hasHiddenHeap_ = false;  //!< Hidden heap indicator for Kernel node
   bool repeatLaunch_ = false;
+  //! Topological order of the graph before the instantiate passes, used for the updates
+  std::vector<Node> updateOrder_;
+  //! Number of dependencies of the nodes in updateOrder_ before the instantiate passes
+  std::vector<size_t> updateDeps_;
+  void* memArena_ = nullptr;  //!< Memory, which backs the planned graph allocations
+  //! Virtual addresses and sizes of the graph allocations, mapped to the arena
+  std::vector<std::pair<void*, size_t>> arenaMaps_;
+  uint64_t cacheEntry_ = 0;   //!< Entry of the instantiate cache with the graph schedule
+  GraphProfiler* profiler_ = nullptr;  //!< Node timings of the launches, DEBUG_HIP_GRAPH_PROFILE
 
  public:
   GraphExec(std::vector<Node>& topoOrder, std::vector<std::vector<Node>>& lists,
             std::unordered_map<Node, std::vector<Node>>& nodeWaitLists, struct Graph*& clonedGraph,
-            std::unordered_map<Node, Node>& clonedNodes, uint64_t flags = 0)
+            std::vector<Node>& originalNodes, std::vector<Node>& clonedNodes,
+            uint64_t flags = 0)
       : ReferenceCountedObject(),
         parallelLists_(lists),
         topoOrder_(topoOrder),
         nodeWaitLists_(nodeWaitLists),
         clonedGraph_(clonedGraph),
+        originalNodes_(originalNodes),
         clonedNodes_(clonedNodes),
         lastEnqueuedCommand_(nullptr),
         currentQueueIndex_(0),
         flags_(flags) {
-    amd::ScopedLock lock(graphExecSetLock_);
-    graphExecSet_.insert(this);
+    handle_ = graphExecSet_.insert(this);
   }
 
   ~GraphExec() {
-    for (auto stream : parallel_streams_) {
-      if (stream != nullptr) {
-        stream->finish();
-        hip::Stream::Destroy(stream);
-      }
-    }
-    amd::ScopedLock lock(graphExecSetLock_);
-    graphExecSet_.erase(this);
+    // The report waits for the profiled commands, so the streams must still exist
+    ReportProfile();
+    ReleaseStreams();
+    if (lastEnqueuedCommand_ != nullptr) {
+      lastEnqueuedCommand_->release();
+    }
+    ReleaseMemory();
+    graphExecSet_.erase(this, handle_);
     delete clonedGraph_;
     if (DEBUG_CLR_GRAPH_PACKET_CAPTURE) {
       kernArgManager_->release();
@@ -743,15 +1003,26 @@ struct GraphExec : public amd::ReferenceCountedObject {
   }
 
   Node GetClonedNode(Node node) {
-    Node clonedNode;
-    if (clonedNodes_.find(node) == clonedNodes_.end()) {
+    if (!GraphNode::isNodeValid(node)) {
       return nullptr;
-    } else {
-      clonedNode = clonedNodes_[node];
     }
-    return clonedNode;
+    size_t index = node->GetIndex();
+    if ((index >= originalNodes_.size()) || (originalNodes_[index] != node)) {
+      // The application graph changed after the instantiation
+      index = std::find(originalNodes_.begin(), originalNodes_.end(), node) -
+              originalNodes_.begin();
+      if (index == originalNodes_.size()) {
+        return nullptr;
+      }
+    }
+    return clonedNodes_[index];
   }
 
+  //! Packs the graph allocations, freed in the graph, into one arena and maps them
+  hipError_t PlanMemory();
+  //! Unmaps the graph allocations and releases the arena
+  void ReleaseMemory();
+
   //! Check if kernel node has hidden heap
   bool HasHiddenHeap() const { return hasHiddenHeap_; }
   //! Graph has nodes that require hidden heap.
@@ -759,7 +1030,15 @@ struct GraphExec : public amd::ReferenceCountedObject {
 
   //! Check executable graphs validity
   static bool isGraphExecValid(GraphExec* pGraphExec);
-  std::vector<Node>& GetNodes() { return topoOrder_; }
+  //! Returns the nodes of the graph as instantiated by the application
+  std::vector<Node>& GetNodes() { return updateOrder_; }
+  //! Returns the number of dependencies of the node at index in GetNodes()
+  size_t GetNodeDependencyCount(size_t index) const { return updateDeps_[index]; }
+  //! Records the graph before the instantiate passes
+  void SetUpdateOrder(std::vector<Node>& order, std::vector<size_t>& dependencies) {
+    updateOrder_.swap(order);
+    updateDeps_.swap(dependencies);
+  }
 
   hip::Stream* GetAvailableStreams() {
     if (currentQueueIndex_ < parallel_streams_.size()) {
@@ -772,10 +1051,39 @@ struct GraphExec : public amd::ReferenceCountedObject {
   uint64_t GetFlags() const { return flags_; }
   hipError_t Init();
   hipError_t CreateStreams(uint32_t num_streams);
+  //! Returns the parallel streams to the instantiate cache or destroys them
+  void ReleaseStreams();
+  //! Binds the graph to the instantiate cache entry, which keeps its idle streams
+  void SetCacheEntry(uint64_t id) { cacheEntry_ = id; }
+  //! Returns the profiler of the launches or nullptr if the graph isn't profiled
+  GraphProfiler* GetProfiler() const { return profiler_; }
+  //! Writes the profile of the launches and destroys the profiler
+  void ReportProfile();
   hipError_t Run(hipStream_t stream);
-  // Capture GPU Packets from graph commands
+  // Capture GPU Packets from graph commands. Only single-list graphs are captured, their stream
+  // order encodes the edges, so no barrier-AND packets are formed between the streams. Event
+  // record and wait nodes stay command based, since the signal of a waited event is known only
+  // at launch.
   hipError_t CaptureAQLPackets();
   hipError_t UpdateAQLPacket(hip::GraphNode* node);
+  //! Appends the decoded packet stream of the graph to the DEBUG_HIP_GRAPH_PACKET_DUMP file
+  void DumpAQLPackets();
+  //! Makes the kernel arguments, written by the packet updates, visible to the device
+  void FlushKernelArgs() {
+    if (kernArgManager_ != nullptr) {
+      kernArgManager_->ReadBackOrFlush();
+    }
+  }
+  //! Tracks the last launch, which has to finish before the kernel arguments are rewritten
+  void SetLastLaunch(amd::Command* command) {
+    command->retain();
+    if (lastEnqueuedCommand_ != nullptr) {
+      lastEnqueuedCommand_->release();
+    }
+    lastEnqueuedCommand_ = command;
+  }
+  //! Returns true if no launch of the graph may read the captured kernel arguments
+  bool IsLastLaunchComplete();
   // Kenrel arg manger is for the entire graph.
   // Child graph also shares the same kernel arg manager object. some apps have 100's of
   // child graph nodes and each child graph has only one node.
@@ -916,6 +1224,10 @@ struct ChildGraphNode : public GraphNode {
       if (status != hipSuccess) {
         return status;
       }
+      // An inlined node is launched by the parent graph, which recaptures its packets
+      if (oldNodes[i]->GetParentGraph() != childGraph_) {
+        oldNodes[i]->SetRecapture();
+      }
     }
     return hipSuccess;
   }
@@ -941,6 +1253,8 @@ class GraphKernelNode : public GraphNode {
   unsigned int kernelAttrInUse_;       //!< Kernel attributes in use
   ihipExtKernelEvents kernelEvents_;   //!< Events for Ext launch kernel
   bool hasHiddenHeap_;                 //!< Kernel has hidden heap(device side allocation)
+  GraphKernelParams* args_ = nullptr;  //!< Kernel arguments, shared with the clones
+  int argsDevice_ = -1;                //!< Device of the kernel argument segment sizes
 
  public:
   bool HasHiddenHeap() const { return hasHiddenHeap_; }
@@ -1059,16 +1373,20 @@ class GraphKernelNode : public GraphNode {
     return func;
   }
 
-  hipError_t copyParams(const hipKernelNodeParams* pNodeParams) {
+  //! Copies the kernel arguments. The function may be passed, if the caller resolved it already
+  hipError_t copyParams(const hipKernelNodeParams* pNodeParams, hipFunction_t func = nullptr) {
     hasHiddenHeap_ = false;
-    hipFunction_t func = getFunc(*pNodeParams, ihipGetDevice());
+    if (func == nullptr) {
+      func = getFunc(*pNodeParams, ihipGetDevice());
+    }
     if (!func) {
       return hipErrorInvalidDeviceFunction;
     }
     hip::DeviceFunc* function = hip::DeviceFunc::asFunction(func);
     amd::Kernel* kernel = function->kernel();
+    argsDevice_ = ihipGetDevice();
     if (DEBUG_CLR_GRAPH_PACKET_CAPTURE) {
-      auto device = g_devices[ihipGetDevice()]->devices()[0];
+      auto device = g_devices[argsDevice_]->devices()[0];
       device::Kernel* devKernel = const_cast<device::Kernel*>(kernel->getDeviceKernel(*device));
       kernargSegmentByteSize_ = devKernel->KernargSegmentByteSize();
       kernargSegmentAlignment_ = devKernel->KernargSegmentAlignment();
@@ -1080,19 +1398,12 @@ class GraphKernelNode : public GraphNode {
 
     // Allocate/assign memory if params are passed part of 'kernelParams'
     if (pNodeParams->kernelParams != nullptr) {
-      kernelParams_.kernelParams = (void**)malloc(numParams_ * sizeof(void*));
-      if (kernelParams_.kernelParams == nullptr) {
-        return hipErrorOutOfMemory;
-      }
-
+      std::vector<size_t> sizes(numParams_);
       for (uint32_t i = 0; i < numParams_; ++i) {
-        const amd::KernelParameterDescriptor& desc = signature.at(i);
-        kernelParams_.kernelParams[i] = malloc(desc.size_);
-        if (kernelParams_.kernelParams[i] == nullptr) {
-          return hipErrorOutOfMemory;
-        }
-        ::memcpy(kernelParams_.kernelParams[i], (pNodeParams->kernelParams[i]), desc.size_);
+        sizes[i] = signature.at(i).size_;
       }
+      args_ = new GraphKernelParams(pNodeParams->kernelParams, std::move(sizes));
+      kernelParams_.kernelParams = args_->KernelParams();
       for (uint32_t i = signature.numParameters(); i < signature.numParametersAll(); ++i) {
         if (signature.at(i).info_.oclObject_ == amd::KernelParameterDescriptor::HiddenHeap) {
           hasHiddenHeap_ = true;
@@ -1106,72 +1417,77 @@ class GraphKernelNode : public GraphNode {
       // HIP_LAUNCH_PARAM_BUFFER_POINTER, kernargs,
       // HIP_LAUNCH_PARAM_BUFFER_SIZE, &kernargs_size,
       // HIP_LAUNCH_PARAM_END }
-      unsigned int numExtra = 5;
-      kernelParams_.extra = (void**)malloc(numExtra * sizeof(void*));
-      if (kernelParams_.extra == nullptr) {
-        return hipErrorOutOfMemory;
-      }
-      kernelParams_.extra[0] = pNodeParams->extra[0];
-      size_t kernargs_size = *((size_t*)pNodeParams->extra[3]);
-      kernelParams_.extra[1] = malloc(kernargs_size);
-      if (kernelParams_.extra[1] == nullptr) {
-        return hipErrorOutOfMemory;
-      }
-      kernelParams_.extra[2] = pNodeParams->extra[2];
-      kernelParams_.extra[3] = malloc(sizeof(void*));
-      if (kernelParams_.extra[3] == nullptr) {
-        return hipErrorOutOfMemory;
+      args_ = new GraphKernelParams(pNodeParams->extra);
+      kernelParams_.extra = args_->Extra();
+    }
+    return hipSuccess;
+  }
+
+  //! Shares the kernel arguments of another node, which is a clone or an update source
+  hipError_t shareParams(const GraphKernelNode& rhs) {
+    // The kernel argument segment sizes are per device, so they are queried again
+    if (DEBUG_CLR_GRAPH_PACKET_CAPTURE && (rhs.argsDevice_ != ihipGetDevice())) {
+      return copyParams(&rhs.kernelParams_);
+    }
+    argsDevice_ = rhs.argsDevice_;
+    kernargSegmentByteSize_ = rhs.kernargSegmentByteSize_;
+    kernargSegmentAlignment_ = rhs.kernargSegmentAlignment_;
+    alignedKernArgSize_ = rhs.alignedKernArgSize_;
+    numParams_ = rhs.numParams_;
+    hasHiddenHeap_ = rhs.hasHiddenHeap_;
+    args_ = rhs.args_;
+    if (args_ == nullptr) {
+      return hipSuccess;
+    }
+    if (args_->IsExposed()) {
+      // The application may still write the arguments through GetParams() pointers
+      args_ = args_->Clone();
+      if (kernelParams_.kernelParams != nullptr) {
+        kernelParams_.kernelParams = args_->KernelParams();
+      } else {
+        kernelParams_.extra = args_->Extra();
       }
-      *((size_t*)kernelParams_.extra[3]) = kernargs_size;
-      ::memcpy(kernelParams_.extra[1], (pNodeParams->extra[1]), kernargs_size);
-      kernelParams_.extra[4] = pNodeParams->extra[4];
+    } else {
+      args_->retain();
     }
     return hipSuccess;
   }
 
-  GraphKernelNode(const hipKernelNodeParams* pNodeParams, const ihipExtKernelEvents* pEvents)
+  GraphKernelNode(const hipKernelNodeParams* pNodeParams, const ihipExtKernelEvents* pEvents,
+                  hipFunction_t func = nullptr)
       : GraphNode(hipGraphNodeTypeKernel, "bold", "octagon", "KERNEL") {
     kernelParams_ = *pNodeParams;
     kernelEvents_ = { 0 };
     if (pEvents != nullptr) {
       kernelEvents_ = *pEvents;
     }
-    if (copyParams(pNodeParams) != hipSuccess) {
+    if (copyParams(pNodeParams, func) != hipSuccess) {
       ClPrint(amd::LOG_ERROR, amd::LOG_CODE, "[hipGraph] Failed to copy params");
     }
     memset(&kernelAttr_, 0, sizeof(kernelAttr_));
     kernelAttrInUse_ = 0;
-    hasHiddenHeap_ = false;
   }
 
   ~GraphKernelNode() { freeParams(); }
 
   void freeParams() {
-    // Deallocate memory allocated for kernargs passed via 'kernelParams'
+    if (args_ == nullptr) {
+      return;
+    }
+    // The arguments were passed via 'kernelParams' or via 'extra'
     if (kernelParams_.kernelParams != nullptr) {
-      for (size_t i = 0; i < numParams_; ++i) {
-        if (kernelParams_.kernelParams[i] != nullptr) {
-          free(kernelParams_.kernelParams[i]);
-        }
-        kernelParams_.kernelParams[i] = nullptr;
-      }
-      free(kernelParams_.kernelParams);
       kernelParams_.kernelParams = nullptr;
-    }
-    // Deallocate memory allocated for kernargs passed via 'extra'
-    else if (kernelParams_.extra != nullptr) {
-      free(kernelParams_.extra[1]);
-      free(kernelParams_.extra[3]);
-      memset(kernelParams_.extra, 0, 5 * sizeof(kernelParams_.extra[0]));  // 5 items
-      free(kernelParams_.extra);
+    } else {
       kernelParams_.extra = nullptr;
     }
+    args_->release();
+    args_ = nullptr;
   }
 
   GraphKernelNode(const GraphKernelNode& rhs) : GraphNode(rhs) {
     kernelParams_ = rhs.kernelParams_;
     kernelEvents_ = rhs.kernelEvents_;
-    hipError_t status = copyParams(&rhs.kernelParams_);
+    hipError_t status = shareParams(rhs);
     if (status != hipSuccess) {
       ClPrint(amd::LOG_ERROR, amd::LOG_CODE, "[hipGraph] Failed to allocate memory to copy params");
     }
@@ -1232,17 +1548,42 @@ class GraphKernelNode : public GraphNode {
     return status;
   }
 
-  void GetParams(hipKernelNodeParams* params) { *params = kernelParams_; }
+  //! The application may write the arguments through the returned pointers, so a shared
+  //! block is copied first and the block is never shared afterwards
+  void GetParams(hipKernelNodeParams* params) {
+    if (args_ != nullptr) {
+      if (args_->referenceCount() > 1) {
+        GraphKernelParams* args = args_->Clone();
+        args_->release();
+        args_ = args;
+        if (kernelParams_.kernelParams != nullptr) {
+          kernelParams_.kernelParams = args_->KernelParams();
+        } else {
+          kernelParams_.extra = args_->Extra();
+        }
+      }
+      args_->SetExposed();
+    }
+    *params = kernelParams_;
+  }
 
-  hipError_t SetParams(const hipKernelNodeParams* params) {
+  hipError_t ValidateParams(const hipKernelNodeParams* params) {
     hipFunction_t func = getFunc(kernelParams_, ihipGetDevice());
     if (!func) {
       return hipErrorInvalidDeviceFunction;
     }
-    // updates kernel params
     hipError_t status = validateKernelParams(params, func, ihipGetDevice());
     if (hipSuccess != status) {
       ClPrint(amd::LOG_ERROR, amd::LOG_CODE, "[hipGraph] Failed to validateKernelParams");
+    }
+    return status;
+  }
+
+  hipError_t SetParams(const hipKernelNodeParams* params) {
+    InvalidateParamsHash();
+    // updates kernel params
+    hipError_t status = ValidateParams(params);
+    if (hipSuccess != status) {
       return status;
     }
     if ((kernelParams_.kernelParams && kernelParams_.kernelParams == params->kernelParams) ||
@@ -1352,7 +1693,64 @@ class GraphKernelNode : public GraphNode {
 
   hipError_t SetParams(GraphNode* node) override {
     const GraphKernelNode* kernelNode = static_cast<GraphKernelNode const*>(node);
-    return SetParams(&kernelNode->kernelParams_);
+    if (kernelNode->args_ == args_) {
+      return SetParams(&kernelNode->kernelParams_);
+    }
+    InvalidateParamsHash();
+    hipError_t status = ValidateParams(&kernelNode->kernelParams_);
+    if (hipSuccess != status) {
+      return status;
+    }
+    freeParams();
+    kernelParams_ = kernelNode->kernelParams_;
+    return shareParams(*kernelNode);
+  }
+
+  bool HashParams(uint64_t* hash) const override {
+    uint64_t h = HashValue(kHashSeed, kernelParams_.func);
+    h = HashValue(h, kernelParams_.gridDim);
+    h = HashValue(h, kernelParams_.blockDim);
+    h = HashValue(h, kernelParams_.sharedMemBytes);
+    if ((kernelParams_.kernelParams != nullptr) && (args_ != nullptr)) {
+      const std::vector<size_t>& sizes = args_->Sizes();
+      for (size_t i = 0; i < sizes.size(); ++i) {
+        h = HashBytes(h, kernelParams_.kernelParams[i], sizes[i]);
+      }
+    } else if (kernelParams_.extra != nullptr) {
+      h = HashBytes(h, kernelParams_.extra[1], *reinterpret_cast<size_t*>(kernelParams_.extra[3]));
+    }
+    *hash = h;
+    return true;
+  }
+
+  bool EqualParams(const GraphNode* node) const override {
+    const GraphKernelNode* kernelNode = static_cast<GraphKernelNode const*>(node);
+    const hipKernelNodeParams& params = kernelNode->kernelParams_;
+    if ((params.func != kernelParams_.func) ||
+        (memcmp(&params.gridDim, &kernelParams_.gridDim, sizeof(dim3)) != 0) ||
+        (memcmp(&params.blockDim, &kernelParams_.blockDim, sizeof(dim3)) != 0) ||
+        (params.sharedMemBytes != kernelParams_.sharedMemBytes)) {
+      return false;
+    }
+    if ((kernelParams_.kernelParams != nullptr) && (args_ != nullptr)) {
+      if ((params.kernelParams == nullptr) || (kernelNode->args_ == nullptr) ||
+          (kernelNode->args_->Sizes() != args_->Sizes())) {
+        return false;
+      }
+      const std::vector<size_t>& sizes = args_->Sizes();
+      for (size_t i = 0; i < sizes.size(); ++i) {
+        if (memcmp(params.kernelParams[i], kernelParams_.kernelParams[i], sizes[i]) != 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+    if ((kernelParams_.extra != nullptr) && (params.extra != nullptr)) {
+      const size_t size = *reinterpret_cast<size_t*>(kernelParams_.extra[3]);
+      return (size == *reinterpret_cast<size_t*>(params.extra[3])) &&
+             (memcmp(params.extra[1], kernelParams_.extra[1], size) == 0);
+    }
+    return false;
   }
 
   static hipError_t validateKernelParams(const hipKernelNodeParams* pNodeParams,
@@ -1432,6 +1830,7 @@ class GraphMemcpyNode : public GraphNode {
     if (status != hipSuccess) {
       return status;
     }
+    InvalidateParamsHash();
     std::memcpy(&copyParams_, params, sizeof(hipMemcpy3DParms));
     return hipSuccess;
   }
@@ -1440,6 +1839,17 @@ class GraphMemcpyNode : public GraphNode {
     const GraphMemcpyNode* memcpyNode = static_cast<GraphMemcpyNode const*>(node);
     return SetParams(&memcpyNode->copyParams_);
   }
+
+  //! The padding of the parameters may differ, which costs only a redundant update
+  virtual bool HashParams(uint64_t* hash) const override {
+    *hash = HashValue(kHashSeed, copyParams_);
+    return true;
+  }
+
+  virtual bool EqualParams(const GraphNode* node) const override {
+    const GraphMemcpyNode* memcpyNode = static_cast<GraphMemcpyNode const*>(node);
+    return memcmp(&memcpyNode->copyParams_, &copyParams_, sizeof(copyParams_)) == 0;
+  }
   // ToDo: use this when commands are cloned and command params are to be updated
   hipError_t ValidateParams(const hipMemcpy3DParms* pNodeParams);
 
@@ -1532,6 +1942,13 @@ class GraphMemcpyNode : public GraphNode {
         case hipMemcpyDeviceToDevice:
           isGraphCapture = true;
           break;
+        case hipMemcpyDefault:
+          // The copy kind follows from the pointers, a copy between the buffers is a blit kernel
+          isGraphCapture = (copyParams_.srcArray == nullptr) &&
+                           (copyParams_.dstArray == nullptr) &&
+                           (ihipGetMemcpyType(copyParams_.srcPtr.ptr, copyParams_.dstPtr.ptr,
+                                              copyParams_.kind) == hipCopyBuffer);
+          break;
         default:
           break;
       }
@@ -1546,6 +1963,7 @@ class GraphMemcpyNode1D : public GraphMemcpyNode {
   const void* src_;
   size_t count_;
   hipMemcpyKind kind_;
+  size_t foldCount_ = 0;  //!< Own size of a fold head
 
  public:
   GraphMemcpyNode1D(void* dst, const void* src, size_t count, hipMemcpyKind kind,
@@ -1567,7 +1985,7 @@ class GraphMemcpyNode1D : public GraphMemcpyNode {
       return hipSuccess;
     }
     hipError_t status = GraphNode::CreateCommand(stream);
-    if (status != hipSuccess) {
+    if ((status != hipSuccess) || IsFolded()) {
       return status;
     }
     commands_.reserve(1);
@@ -1658,6 +2076,8 @@ class GraphMemcpyNode1D : public GraphMemcpyNode {
     if (status != hipSuccess) {
       return status;
     }
+    BreakFold();
+    InvalidateParamsHash();
     dst_ = dst;
     src_ = src;
     count_ = count;
@@ -1670,6 +2090,52 @@ class GraphMemcpyNode1D : public GraphMemcpyNode {
     return SetParams(memcpy1DNode->dst_, memcpy1DNode->src_, memcpy1DNode->count_,
                      memcpy1DNode->kind_);
   }
+
+  bool IsFoldableCopy() const override {
+    return ihipGetMemcpyType(src_, dst_, kind_) == hipCopyBuffer;
+  }
+
+  bool HashParams(uint64_t* hash) const override {
+    uint64_t h = HashValue(kHashSeed, dst_);
+    h = HashValue(h, src_);
+    h = HashValue(h, (foldMembers_.empty()) ? count_ : foldCount_);
+    *hash = HashValue(h, kind_);
+    return true;
+  }
+
+  bool EqualParams(const GraphNode* node) const override {
+    const GraphMemcpyNode1D* copy = static_cast<GraphMemcpyNode1D const*>(node);
+    const size_t count = (foldMembers_.empty()) ? count_ : foldCount_;
+    const size_t copyCount = (copy->foldMembers_.empty()) ? copy->count_ : copy->foldCount_;
+    return (copy->dst_ == dst_) && (copy->src_ == src_) && (copyCount == count) &&
+           (copy->kind_ == kind_);
+  }
+
+  //! Folds a buffer copy, which continues both ranges of this copy in the same allocations
+  bool Fold(GraphNode* next) override {
+    if (!IsFoldableCopy() || !next->IsFoldableCopy()) {
+      return false;
+    }
+    GraphMemcpyNode1D* copy = static_cast<GraphMemcpyNode1D*>(next);
+    if ((copy->kind_ != kind_) ||
+        !CanFoldCopies(dst_, src_, count_, copy->dst_, copy->src_, copy->count_)) {
+      return false;
+    }
+    size_t offset = 0;
+    amd::Memory* dstMemory = getMemoryObject(dst_, offset);
+    amd::Memory* srcMemory = getMemoryObject(src_, offset);
+    if ((dstMemory != getMemoryObject(copy->dst_, offset)) ||
+        (srcMemory != getMemoryObject(copy->src_, offset))) {
+      return false;
+    }
+    if (foldMembers_.empty()) {
+      foldCount_ = count_;
+    }
+    count_ += copy->count_;
+    return true;
+  }
+
+  void Unfold() override { count_ = foldCount_; }
   static hipError_t ValidateParams(void* dst, const void* src, size_t count, hipMemcpyKind kind);
   virtual std::string GetLabel(hipGraphDebugDotFlags flag) override {
     size_t sOffsetOrig = 0;
@@ -1758,6 +2224,25 @@ class GraphMemcpyNodeFromSymbol : public GraphMemcpyNode1D {
         static_cast<GraphMemcpyNodeFromSymbol const&>(*this));
   }
 
+  //! Symbol copies aren't folded
+  bool IsFoldableCopy() const override { return false; }
+
+  bool HashParams(uint64_t* hash) const override {
+    uint64_t h = HashValue(kHashSeed, symbol_);
+    h = HashValue(h, offset_);
+    h = HashValue(h, dst_);
+    h = HashValue(h, src_);
+    h = HashValue(h, count_);
+    *hash = HashValue(h, kind_);
+    return true;
+  }
+
+  bool EqualParams(const GraphNode* node) const override {
+    const GraphMemcpyNodeFromSymbol* copy = static_cast<GraphMemcpyNodeFromSymbol const*>(node);
+    return (copy->symbol_ == symbol_) && (copy->offset_ == offset_) && (copy->dst_ == dst_) &&
+           (copy->src_ == src_) && (copy->count_ == count_) && (copy->kind_ == kind_);
+  }
+
   virtual hipError_t CreateCommand(hip::Stream* stream) override {
     hipError_t status = GraphNode::CreateCommand(stream);
     if (status != hipSuccess) {
@@ -1818,6 +2303,7 @@ class GraphMemcpyNodeFromSymbol : public GraphMemcpyNode1D {
       return hipErrorInvalidMemcpyDirection;
     }
 
+    InvalidateParamsHash();
     dst_ = dst;
     symbol_ = symbol;
     count_ = count;
@@ -1850,6 +2336,25 @@ class GraphMemcpyNodeToSymbol : public GraphMemcpyNode1D {
     return new GraphMemcpyNodeToSymbol(static_cast<GraphMemcpyNodeToSymbol const&>(*this));
   }
 
+  //! Symbol copies aren't folded
+  bool IsFoldableCopy() const override { return false; }
+
+  bool HashParams(uint64_t* hash) const override {
+    uint64_t h = HashValue(kHashSeed, symbol_);
+    h = HashValue(h, offset_);
+    h = HashValue(h, dst_);
+    h = HashValue(h, src_);
+    h = HashValue(h, count_);
+    *hash = HashValue(h, kind_);
+    return true;
+  }
+
+  bool EqualParams(const GraphNode* node) const override {
+    const GraphMemcpyNodeToSymbol* copy = static_cast<GraphMemcpyNodeToSymbol const*>(node);
+    return (copy->symbol_ == symbol_) && (copy->offset_ == offset_) && (copy->dst_ == dst_) &&
+           (copy->src_ == src_) && (copy->count_ == count_) && (copy->kind_ == kind_);
+  }
+
   virtual hipError_t CreateCommand(hip::Stream* stream) override {
     hipError_t status = GraphNode::CreateCommand(stream);
     if (status != hipSuccess) {
@@ -1915,6 +2420,7 @@ class GraphMemcpyNodeToSymbol : public GraphMemcpyNode1D {
     } else if (kind == hipMemcpyHostToHost || kind == hipMemcpyDeviceToHost) {
       return hipErrorInvalidValue;
     }
+    InvalidateParamsHash();
     symbol_ = symbol;
     src_ = src;
     count_ = count;
@@ -1933,6 +2439,7 @@ class GraphMemcpyNodeToSymbol : public GraphMemcpyNode1D {
 class GraphMemsetNode : public GraphNode {
   hipMemsetParams memsetParams_;
   size_t depth_ = 1;
+  hipMemsetParams foldParams_;  //!< Own parameters of a fold head
  public:
   GraphMemsetNode(const hipMemsetParams* pMemsetParams, size_t depth = 1)
       : GraphNode(hipGraphNodeTypeMemset, "solid", "invtrapezium", "MEMSET") {
@@ -1991,7 +2498,7 @@ class GraphMemsetNode : public GraphNode {
 
   hipError_t CreateCommand(hip::Stream* stream) override {
     hipError_t status = GraphNode::CreateCommand(stream);
-    if (status != hipSuccess) {
+    if ((status != hipSuccess) || IsFolded()) {
       return status;
     }
     if (memsetParams_.height == 1) {
@@ -2014,6 +2521,43 @@ class GraphMemsetNode : public GraphNode {
     std::memcpy(params, &memsetParams_, sizeof(hipMemsetParams));
   }
 
+  //! Folds a 1D memset of the same pattern, which continues this range in the same allocation
+  bool Fold(GraphNode* next) override {
+    if (next->GetType() != hipGraphNodeTypeMemset) {
+      return false;
+    }
+    const hipMemsetParams& params = static_cast<GraphMemsetNode*>(next)->memsetParams_;
+    if (!CanFoldMemsets(memsetParams_, params)) {
+      return false;
+    }
+    size_t offset = 0;
+    amd::Memory* memory = getMemoryObject(memsetParams_.dst, offset);
+    if ((memory == nullptr) || (memory != getMemoryObject(params.dst, offset))) {
+      return false;
+    }
+    if (foldMembers_.empty()) {
+      foldParams_ = memsetParams_;
+    }
+    memsetParams_.width += params.width;
+    return true;
+  }
+
+  void Unfold() override { memsetParams_ = foldParams_; }
+
+  bool HashParams(uint64_t* hash) const override {
+    const hipMemsetParams& params = (foldMembers_.empty()) ? memsetParams_ : foldParams_;
+    *hash = HashValue(HashValue(kHashSeed, params), depth_);
+    return true;
+  }
+
+  bool EqualParams(const GraphNode* node) const override {
+    const GraphMemsetNode* memsetNode = static_cast<GraphMemsetNode const*>(node);
+    const hipMemsetParams& params = (foldMembers_.empty()) ? memsetParams_ : foldParams_;
+    const hipMemsetParams& nodeParams =
+        (memsetNode->foldMembers_.empty()) ? memsetNode->memsetParams_ : memsetNode->foldParams_;
+    return (memcmp(&nodeParams, &params, sizeof(params)) == 0) && (memsetNode->depth_ == depth_);
+  }
+
   void GetParams(HIP_MEMSET_NODE_PARAMS* params) {
     params->dst = memsetParams_.dst;
     params->elementSize = memsetParams_.elementSize;
@@ -2025,6 +2569,8 @@ class GraphMemsetNode : public GraphNode {
 
   hipError_t SetParamsInternal(const hipMemsetParams* params, bool isExec, size_t depth = 1) {
     hipError_t hip_error = hipSuccess;
+    BreakFold();
+    InvalidateParamsHash();
     hip_error = ihipGraphMemsetParams_validate(params);
     if (hip_error != hipSuccess) {
       return hip_error;
@@ -2250,7 +2796,9 @@ class GraphHostNode : public GraphNode {
 
   static void Callback(cl_event event, cl_int command_exec_status, void* user_data) {
     hipHostNodeParams* NodeParams = reinterpret_cast<hipHostNodeParams*>(user_data);
-    NodeParams->fn(NodeParams->userData);
+    if (!CallbackExecutor::Submit(event, NodeParams->fn, NodeParams->userData)) {
+      NodeParams->fn(NodeParams->userData);
+    }
   }
 
   void EnqueueCommands(hip::Stream* stream) override {
@@ -2297,6 +2845,10 @@ class GraphEmptyNode : public GraphNode {
     return new GraphEmptyNode(static_cast<GraphEmptyNode const&>(*this));
   }
 
+  //! The stream order of a single list satisfies the dependencies, so the captured marker
+  //! forms no packets and the node drops out of the replay
+  bool GraphCaptureEnabled() override { return DEBUG_CLR_GRAPH_PACKET_CAPTURE; }
+
   hipError_t CreateCommand(hip::Stream* stream) override {
     hipError_t status = GraphNode::CreateCommand(stream);
     if (status != hipSuccess) {
@@ -2317,6 +2869,7 @@ class GraphEmptyNode : public GraphNode {
 class GraphMemAllocNode final : public GraphNode {
   hipMemAllocNodeParams node_params_;  // Node parameters for memory allocation
   amd::Memory* va_ = nullptr;         // Memory object, which holds a virtual address
+  bool planned_ = false;              // The graph arena backs the allocation
 
   // Derive the new class for VirtualMapCommand,
   // so runtime can allocate memory during the execution of command
@@ -2401,6 +2954,10 @@ class GraphMemAllocNode final : public GraphNode {
 
   virtual hipError_t CreateCommand(hip::Stream* stream) final {
     auto error = GraphNode::CreateCommand(stream);
+    if (planned_) {
+      // The arena is mapped at instantiate, the launch has nothing to do
+      return error;
+    }
     if (!HIP_MEM_POOL_USE_VM) {
       auto ptr = Execute(stream_);
     } else {
@@ -2469,11 +3026,19 @@ class GraphMemAllocNode final : public GraphNode {
   void GetParams(hipMemAllocNodeParams* params) const {
     std::memcpy(params, &node_params_, sizeof(hipMemAllocNodeParams));
   }
+
+  //! Returns the memory object of the reserved virtual address
+  amd::Memory* GetVirtualMemory() const { return va_; }
+
+  //! Marks the allocation as backed by the graph arena
+  void SetPlanned(bool planned) { planned_ = planned; }
+  bool IsPlanned() const { return planned_; }
 };
 
 // ================================================================================================
 class GraphMemFreeNode : public GraphNode {
   void* device_ptr_;    // Device pointer of the freed memory
+  bool planned_ = false;  // The graph arena backs the freed allocation
 
   // Derive the new class for VirtualMap command, since runtime has to free
   // real allocation after unmap is complete
@@ -2525,6 +3090,10 @@ class GraphMemFreeNode : public GraphNode {
 
   virtual hipError_t CreateCommand(hip::Stream* stream) final {
     auto error = GraphNode::CreateCommand(stream);
+    if (planned_) {
+      // The arena stays mapped until the executable graph is destroyed
+      return error;
+    }
     if (!HIP_MEM_POOL_USE_VM) {
       Execute(stream_);
     } else {
@@ -2553,6 +3122,9 @@ class GraphMemFreeNode : public GraphNode {
   void GetParams(void** params) const {
     *params = device_ptr_;
   }
+
+  //! Marks the freed allocation as backed by the graph arena
+  void SetPlanned(bool planned) { planned_ = planned; }
 };
 
 class GraphDrvMemcpyNode : public GraphNode {
@@ -2614,6 +3186,7 @@ class GraphDrvMemcpyNode : public GraphNode {
     if (status != hipSuccess) {
       return status;
     }
+    InvalidateParamsHash();
     std::memcpy(&copyParams_, params, sizeof(HIP_MEMCPY3D));
     return hipSuccess;
   }
@@ -2621,6 +3194,22 @@ class GraphDrvMemcpyNode : public GraphNode {
     const GraphDrvMemcpyNode* memcpyNode = static_cast<GraphDrvMemcpyNode const*>(node);
     return SetParams(&memcpyNode->copyParams_);
   }
+  bool HashParams(uint64_t* hash) const override {
+    *hash = HashValue(kHashSeed, copyParams_);
+    return true;
+  }
+  bool EqualParams(const GraphNode* node) const override {
+    const GraphDrvMemcpyNode* memcpyNode = static_cast<GraphDrvMemcpyNode const*>(node);
+    return memcmp(&memcpyNode->copyParams_, &copyParams_, sizeof(copyParams_)) == 0;
+  }
+  //! A copy between the buffers of one device is a single blit kernel
+  bool GraphCaptureEnabled() override {
+    return DEBUG_CLR_GRAPH_PACKET_CAPTURE &&
+           (copyParams_.srcMemoryType == hipMemoryTypeDevice) &&
+           (copyParams_.dstMemoryType == hipMemoryTypeDevice) &&
+           (ihipGetMemcpyType(copyParams_.srcDevice, copyParams_.dstDevice,
+                              hipMemcpyDeviceToDevice) == hipCopyBuffer);
+  }
   // ToDo: use this when commands are cloned and command params are to be updated
   hipError_t ValidateParams(const HIP_MEMCPY3D* pNodeParams) {
     hipError_t status = ihipDrvMemcpy3D_validate(pNodeParams);
@@ -0,0 +1,70 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hip_graph_mem_planner.hpp"
+
+#include <algorithm>
+
+namespace hip {
+
+// ================================================================================================
+size_t GraphMemoryPlanner::Plan(std::vector<GraphMemBlock>& blocks,
+                                const HappensBefore& happensBefore) const {
+  std::vector<size_t> order(blocks.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  // The large blocks have the fewest placement options, so they go first
+  std::stable_sort(order.begin(), order.end(), [&blocks](size_t a, size_t b) {
+    return blocks[a].size_ > blocks[b].size_;
+  });
+
+  size_t arenaSize = 0;
+  std::vector<size_t> placed;
+  std::vector<size_t> conflicts;
+  placed.reserve(blocks.size());
+  for (auto i : order) {
+    GraphMemBlock& block = blocks[i];
+    const size_t size = AlignUp(block.size_);
+    conflicts.clear();
+    for (auto j : placed) {
+      if (Conflict(block, blocks[j], happensBefore)) {
+        conflicts.push_back(j);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(), [&blocks](size_t a, size_t b) {
+      return blocks[a].offset_ < blocks[b].offset_;
+    });
+    // Find the first gap between the conflicting blocks, which fits the block
+    size_t offset = 0;
+    for (auto j : conflicts) {
+      if (offset + size <= blocks[j].offset_) {
+        break;
+      }
+      offset = std::max(offset, blocks[j].offset_ + AlignUp(blocks[j].size_));
+    }
+    block.offset_ = offset;
+    arenaSize = std::max(arenaSize, offset + size);
+    placed.push_back(i);
+  }
+  return arenaSize;
+}
+
+}  // namespace hip
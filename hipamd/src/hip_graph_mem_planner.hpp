@@ -0,0 +1,73 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace hip {
+
+//! Allocation of a MemAlloc node, which is freed by a MemFree node of the same graph
+struct GraphMemBlock {
+  size_t size_;       //!< Size of the allocation
+  size_t allocIdx_;   //!< Index of the MemAlloc node in the topological order
+  size_t freeIdx_;    //!< Index of the MemFree node in the topological order
+  size_t offset_ = 0; //!< Offset of the allocation in the arena, assigned by the planner
+
+  GraphMemBlock(size_t size, size_t allocIdx, size_t freeIdx)
+      : size_(size), allocIdx_(allocIdx), freeIdx_(freeIdx) {}
+};
+
+/*! \brief Static memory planner of the graph allocations.
+ *
+ *  The live range of an allocation starts at its MemAlloc node and ends at its MemFree node.
+ *  Two allocations may share memory only if the free of one is ordered before the alloc of the
+ *  other by the graph edges, since the nodes of independent branches can run concurrently. The
+ *  planner packs the allocations into a single arena, placing the largest allocations first at
+ *  the lowest offset, which doesn't overlap the conflicting allocations already placed.
+ */
+class GraphMemoryPlanner {
+ public:
+  //! Returns true if the node at the first index is ordered before the node at the second one
+  typedef std::function<bool(size_t, size_t)> HappensBefore;
+
+  explicit GraphMemoryPlanner(size_t alignment) : alignment_((alignment != 0) ? alignment : 1) {}
+
+  //! Assigns the offsets of the blocks and returns the arena size
+  size_t Plan(std::vector<GraphMemBlock>& blocks, const HappensBefore& happensBefore) const;
+
+  //! Returns true if the live ranges of the blocks overlap
+  static bool Conflict(const GraphMemBlock& a, const GraphMemBlock& b,
+                       const HappensBefore& happensBefore) {
+    return !happensBefore(a.freeIdx_, b.allocIdx_) && !happensBefore(b.freeIdx_, a.allocIdx_);
+  }
+
+ private:
+  size_t AlignUp(size_t value) const {
+    return ((value + alignment_ - 1) / alignment_) * alignment_;
+  }
+
+  size_t alignment_;  //!< Alignment of the offsets and the sizes in the arena
+};
+
+}  // namespace hip
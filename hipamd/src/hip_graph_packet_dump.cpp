@@ -0,0 +1,155 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#include "hip_graph_packet_dump.hpp"
+
+#include <cstring>
+
+namespace hip {
+
+namespace {
+// Packet types and header fields of the HSA specification
+enum AqlPacketType : uint32_t {
+  kAqlVendorSpecific = 0,
+  kAqlInvalid = 1,
+  kAqlKernelDispatch = 2,
+  kAqlBarrierAnd = 3,
+  kAqlAgentDispatch = 4,
+  kAqlBarrierOr = 5
+};
+constexpr uint32_t kHeaderBarrierShift = 8;
+constexpr uint32_t kHeaderAcquireShift = 9;
+constexpr uint32_t kHeaderReleaseShift = 11;
+constexpr uint32_t kBarrierDepSignals = 5;
+
+template <typename T>
+T ReadField(const uint8_t* packet, size_t offset) {
+  T value;
+  std::memcpy(&value, packet + offset, sizeof(T));
+  return value;
+}
+
+const char* GetPacketTypeString(uint32_t type) {
+  switch (type) {
+    case kAqlVendorSpecific:
+      return "VENDOR_SPECIFIC";
+    case kAqlInvalid:
+      return "INVALID";
+    case kAqlKernelDispatch:
+      return "KERNEL_DISPATCH";
+    case kAqlBarrierAnd:
+      return "BARRIER_AND";
+    case kAqlAgentDispatch:
+      return "AGENT_DISPATCH";
+    case kAqlBarrierOr:
+      return "BARRIER_OR";
+    default:
+      return "UNKNOWN";
+  }
+}
+}  // namespace
+
+// ================================================================================================
+void GraphPacketDumper::Begin(const void* graphExec, size_t nodeCount) {
+  packets_ = 0;
+  commandNodes_ = 0;
+  errors_ = 0;
+  out_ << "graph " << graphExec << " nodes " << nodeCount << "\n";
+}
+
+// ================================================================================================
+void GraphPacketDumper::DumpNode(int id, const char* type, const std::string& name,
+                                 const std::vector<uint8_t*>& packets) {
+  out_ << "  node " << id << " " << type;
+  if (!name.empty()) {
+    out_ << " " << name;
+  }
+  out_ << " packets " << packets.size() << "\n";
+  for (auto packet : packets) {
+    if (!DumpPacket(packet)) {
+      errors_++;
+    }
+  }
+}
+
+// ================================================================================================
+void GraphPacketDumper::DumpCommandNode(int id, const char* type) {
+  out_ << "  node " << id << " " << type << " commands\n";
+  commandNodes_++;
+}
+
+// ================================================================================================
+void GraphPacketDumper::End() {
+  out_ << "total packets " << packets_ << ", command nodes " << commandNodes_ << ", errors "
+       << errors_ << "\n";
+  out_.flush();
+}
+
+// ================================================================================================
+bool GraphPacketDumper::DumpPacket(const uint8_t* packet) {
+  const uint16_t header = ReadField<uint16_t>(packet, 0);
+  const uint32_t type = header & 0xFF;
+  out_ << "    [" << packets_++ << "] " << GetPacketTypeString(type) << " barrier "
+       << ((header >> kHeaderBarrierShift) & 0x1) << " acquire "
+       << ((header >> kHeaderAcquireShift) & 0x3) << " release "
+       << ((header >> kHeaderReleaseShift) & 0x3);
+  bool valid = true;
+  out_ << std::hex;
+  switch (type) {
+    case kAqlKernelDispatch: {
+      const uint32_t dims = ReadField<uint16_t>(packet, 2) & 0x3;
+      const uint16_t wgX = ReadField<uint16_t>(packet, 4);
+      const uint16_t wgY = ReadField<uint16_t>(packet, 6);
+      const uint16_t wgZ = ReadField<uint16_t>(packet, 8);
+      const uint32_t gridX = ReadField<uint32_t>(packet, 12);
+      const uint32_t gridY = ReadField<uint32_t>(packet, 16);
+      const uint32_t gridZ = ReadField<uint32_t>(packet, 20);
+      const uint64_t kernelObject = ReadField<uint64_t>(packet, 32);
+      const uint64_t kernarg = ReadField<uint64_t>(packet, 40);
+      out_ << std::dec << " dims " << dims << " grid (" << gridX << "," << gridY << ","
+           << gridZ << ") workgroup (" << wgX << "," << wgY << "," << wgZ << ") private "
+           << ReadField<uint32_t>(packet, 24) << " group " << ReadField<uint32_t>(packet, 28)
+           << std::hex << " object 0x" << kernelObject << " kernarg 0x" << kernarg;
+      // A dispatch without the code, the arguments or with an empty grid can't run
+      valid = (dims != 0) && (wgX * wgY * wgZ != 0) && (gridX * gridY * gridZ != 0) &&
+              (kernelObject != 0) && (kernarg != 0);
+      break;
+    }
+    case kAqlBarrierAnd:
+    case kAqlBarrierOr:
+      out_ << " deps [";
+      for (uint32_t i = 0; i < kBarrierDepSignals; ++i) {
+        out_ << ((i != 0) ? " " : "") << "0x" << ReadField<uint64_t>(packet, 8 + i * 8);
+      }
+      out_ << "]";
+      break;
+    case kAqlVendorSpecific:
+      break;
+    default:
+      valid = false;
+      break;
+  }
+  out_ << " signal 0x" << ReadField<uint64_t>(packet, 56) << std::dec;
+  out_ << (valid ? "\n" : " INVALID\n");
+  return valid;
+}
+
+}  // namespace hip
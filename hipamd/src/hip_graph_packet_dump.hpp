@@ -0,0 +1,72 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace hip {
+
+/*! \brief Decodes the AQL packets, captured for an executable graph, into text.
+ *
+ *  The decoder reads the packet layout of the HSA specification from the raw bytes and doesn't
+ *  access the device, so the lowering of the graph nodes can be checked on a host without a GPU.
+ *  The nodes, which aren't lowered to packets, are listed as command nodes, since they break the
+ *  replay of the graph as one packet stream.
+ */
+class GraphPacketDumper {
+ public:
+  static constexpr size_t kPacketSize = 64;  //!< Size of one AQL packet
+
+  explicit GraphPacketDumper(std::ostream& out) : out_(out) {}
+
+  //! Starts the packet stream of an executable graph
+  void Begin(const void* graphExec, size_t nodeCount);
+
+  //! Dumps the packets, captured for a node
+  void DumpNode(int id, const char* type, const std::string& name,
+                const std::vector<uint8_t*>& packets);
+
+  //! Dumps a node, which is submitted as commands
+  void DumpCommandNode(int id, const char* type);
+
+  //! Ends the packet stream with the totals
+  void End();
+
+  //! Decodes one packet, returns false if the packet can't be dispatched
+  bool DumpPacket(const uint8_t* packet);
+
+  size_t PacketCount() const { return packets_; }     //!< Dumped packets
+  size_t CommandNodes() const { return commandNodes_; }  //!< Nodes, submitted as commands
+  size_t Errors() const { return errors_; }           //!< Malformed packets
+
+ private:
+  std::ostream& out_;         //!< Output stream of the dump
+  size_t packets_ = 0;        //!< Packets in the current stream
+  size_t commandNodes_ = 0;   //!< Nodes in the current stream, submitted as commands
+  size_t errors_ = 0;         //!< Malformed packets in the current stream
+};
+
+}  // namespace hip
@@ -0,0 +1,278 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/** \file Graph instantiate passes and fold state without the runtime.
+ *
+ *  The passes are templates over the graph, so the runtime runs them on hip::Graph and the
+ *  host tests on synthetic graphs. A graph provides GetNodes(), GetNodeCount(),
+ *  TopologicalOrder() and DetachNode(). Its nodes provide the edge API of hip::GraphNode,
+ *  GetChildGraph(), SetParentGraph(), GetEnabled(), IsEmptyNode(), IsInlinable() and Fold(),
+ *  and derive from GraphFold.
+ */
+
+namespace hip {
+
+//! Statistics of one instantiate pass
+struct GraphPassStats {
+  const char* name_;          //!< Pass name
+  size_t nodesRemoved_ = 0;   //!< Nodes detached from the graph
+  size_t nodesFolded_ = 0;    //!< Nodes, whose work is executed by another node
+  size_t edgesRemoved_ = 0;   //!< Removed edges
+  size_t edgesAdded_ = 0;     //!< Added edges
+  uint64_t timeNs_ = 0;       //!< Time spent in the pass
+
+  explicit GraphPassStats(const char* name) : name_(name) {}
+};
+
+/*! \brief Fold state of a graph node.
+ *
+ *  The head of a fold executes the work of its members, which run right after it. A change of
+ *  the parameters or of the enable state of any node in the fold splits it again, and all its
+ *  nodes have to recapture their packets. NodeT restores the own parameters of the head in
+ *  Unfold().
+ */
+template <typename NodeT> class GraphFold {
+ public:
+  /// Records the next node as executed by this node, Fold() must have succeeded
+  void AddFoldMember(NodeT* node) {
+    node->foldHead_ = static_cast<NodeT*>(this);
+    foldMembers_.push_back(node);
+  }
+  /// Returns true if the work of this node is executed by another node
+  bool IsFolded() const { return foldHead_ != nullptr; }
+  /// Splits the fold this node belongs to, every node executes its own work again
+  void BreakFold() {
+    NodeT* head = (foldHead_ != nullptr) ? foldHead_ : static_cast<NodeT*>(this);
+    if (head->foldMembers_.empty()) {
+      return;
+    }
+    head->Unfold();
+    head->recapture_ = true;
+    for (auto member : head->foldMembers_) {
+      member->foldHead_ = nullptr;
+      member->recapture_ = true;
+    }
+    head->foldMembers_.clear();
+  }
+  /// Returns true if the captured packets don't match the node parameters
+  bool NeedsRecapture() const { return recapture_; }
+  void SetRecapture() { recapture_ = true; }
+
+ protected:
+  NodeT* foldHead_ = nullptr;         //!< Node, which executes the work of this node
+  std::vector<NodeT*> foldMembers_;   //!< Nodes, whose work this node executes
+  bool recapture_ = false;            //!< The captured packets are stale
+};
+
+/*! \brief Returns true if a buffer copy can run as a part of the previous copy.
+ *
+ *  The next copy has to continue both ranges of the previous one. The merged copy mustn't read
+ *  what it writes, since the next copy could read the bytes the previous one writes and a single
+ *  copy wouldn't keep that order. The caller checks that the ranges stay in their allocations.
+ */
+inline bool CanFoldCopies(const void* dst, const void* src, size_t count, const void* nextDst,
+                          const void* nextSrc, size_t nextCount) {
+  if ((nextDst != static_cast<const char*>(dst) + count) ||
+      (nextSrc != static_cast<const char*>(src) + count)) {
+    return false;
+  }
+  const uintptr_t srcStart = reinterpret_cast<uintptr_t>(src);
+  const uintptr_t dstStart = reinterpret_cast<uintptr_t>(dst);
+  const size_t total = count + nextCount;
+  return (srcStart >= dstStart + total) || (dstStart >= srcStart + total);
+}
+
+/*! \brief Returns true if a memset can run as a part of the previous memset.
+ *
+ *  Both have to be 1D with the same pattern, and the next one has to continue the range of the
+ *  previous one. Params has the fields of hipMemsetParams. The caller checks that the range
+ *  stays in its allocation.
+ */
+template <typename Params> bool CanFoldMemsets(const Params& params, const Params& next) {
+  return (params.height == 1) && (next.height == 1) &&
+         (params.elementSize == next.elementSize) && (params.value == next.value) &&
+         (next.dst == static_cast<char*>(params.dst) + params.width * params.elementSize);
+}
+
+namespace graph_passes {
+
+//! Max graph size for the transitive reduction, which keeps a reachability bit matrix
+constexpr size_t kMaxReductionNodes = 8192;
+
+//! Replaces the child graph nodes, whose graph has a single inlinable node, with that node
+template <typename GraphT> void InlineChildGraphs(GraphT* graph, GraphPassStats& stats) {
+  // Copy the list, since the inlining replaces the vertices
+  const auto nodes = graph->GetNodes();
+  for (auto node : nodes) {
+    auto child = node->GetChildGraph();
+    if ((child == nullptr) || (child->GetNodeCount() != 1)) {
+      continue;
+    }
+    auto inner = child->GetNodes()[0];
+    if (!inner->IsInlinable()) {
+      continue;
+    }
+    const auto dependencies = node->GetDependencies();
+    const auto edges = node->GetEdges();
+    // The child graph keeps the node in its vertices, so the updates of the detached child
+    // graph node still reach it, but the node runs as a part of this graph
+    graph->DetachNode(node, inner);
+    inner->SetParentGraph(graph);
+    for (auto dep : dependencies) {
+      dep->AddEdgeDep(inner);
+    }
+    for (auto edge : edges) {
+      inner->AddEdgeDep(edge);
+    }
+    stats.nodesRemoved_++;
+  }
+}
+
+//! Removes the empty nodes, which don't join many dependencies into many edges
+template <typename GraphT> void EliminateEmptyNodes(GraphT* graph, GraphPassStats& stats) {
+  const auto nodes = graph->GetNodes();
+  for (auto node : nodes) {
+    // Keep one node at least, since the execution expects a non-empty graph
+    if (graph->GetNodeCount() == 1) {
+      break;
+    }
+    if (!node->IsEmptyNode()) {
+      continue;
+    }
+    const auto dependencies = node->GetDependencies();
+    const auto edges = node->GetEdges();
+    // A join of many dependencies into many edges is cheaper as one barrier
+    if ((dependencies.size() > 1) && (edges.size() > 1)) {
+      continue;
+    }
+    graph->DetachNode(node);
+    stats.nodesRemoved_++;
+    stats.edgesRemoved_ += dependencies.size() + edges.size();
+    for (auto dep : dependencies) {
+      const auto& depEdges = dep->GetEdges();
+      for (auto edge : edges) {
+        if (std::find(depEdges.begin(), depEdges.end(), edge) == depEdges.end()) {
+          dep->AddEdgeDep(edge);
+          stats.edgesAdded_++;
+        }
+      }
+    }
+  }
+}
+
+//! Removes the edges, which are implied by a longer path
+template <typename GraphT> void ReduceTransitiveEdges(GraphT* graph, GraphPassStats& stats) {
+  typedef typename std::decay<decltype(graph->GetNodes()[0])>::type NodePtr;
+  std::vector<NodePtr> order;
+  if (!graph->TopologicalOrder(order) || (order.size() > kMaxReductionNodes)) {
+    return;
+  }
+  const size_t count = order.size();
+  const size_t words = (count + 63) / 64;
+  std::unordered_map<NodePtr, size_t> index;
+  index.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    index[order[i]] = i;
+  }
+  // reach[i] holds all nodes, reachable from the node i over one edge or more
+  std::vector<uint64_t> reach(count * words, 0);
+  std::vector<uint64_t> cover(words);
+  for (size_t i = count; i-- > 0;) {
+    NodePtr node = order[i];
+    // The nodes reachable over two edges or more
+    std::fill(cover.begin(), cover.end(), 0);
+    for (auto edge : node->GetEdges()) {
+      const uint64_t* edgeReach = &reach[index[edge] * words];
+      for (size_t w = 0; w < words; ++w) {
+        cover[w] |= edgeReach[w];
+      }
+    }
+    // An edge to a node in the cover is implied by a longer path
+    const auto edges = node->GetEdges();
+    uint64_t* nodeReach = &reach[i * words];
+    std::copy(cover.begin(), cover.end(), nodeReach);
+    for (auto edge : edges) {
+      const size_t j = index[edge];
+      if ((cover[j / 64] & (1ull << (j % 64))) != 0) {
+        node->RemoveEdgeDep(edge);
+        stats.edgesRemoved_++;
+      } else {
+        nodeReach[j / 64] |= 1ull << (j % 64);
+      }
+    }
+  }
+}
+
+//! Folds the chains of memsets and copies, which the nodes can execute as one command
+template <typename GraphT> void MergeCopies(GraphT* graph, GraphPassStats& stats) {
+  typedef typename std::decay<decltype(graph->GetNodes()[0])>::type NodePtr;
+  std::vector<NodePtr> order;
+  if (!graph->TopologicalOrder(order)) {
+    return;
+  }
+  for (auto head : order) {
+    if (head->IsFolded() || !head->GetEnabled()) {
+      continue;
+    }
+    // Fold a chain, in which every node is the only edge of the previous one and depends on
+    // it only, so the dependencies of the folded nodes are satisfied by the head
+    NodePtr current = head;
+    while (current->GetEdges().size() == 1) {
+      NodePtr next = current->GetEdges()[0];
+      if ((next->GetDependencies().size() != 1) || !next->GetEnabled() || !head->Fold(next)) {
+        break;
+      }
+      head->AddFoldMember(next);
+      stats.nodesFolded_++;
+      current = next;
+    }
+  }
+}
+
+/*! \brief Records the graph before the passes for the updates of the executable graph.
+ *
+ *  hipGraphExecUpdate() matches the nodes of the new graph by their topological order and
+ *  compares their dependency counts with the graph, as the application created it.
+ */
+template <typename GraphT, typename NodePtr>
+bool RecordUpdateOrder(GraphT* graph, std::vector<NodePtr>& order,
+                       std::vector<size_t>& dependencies) {
+  if (!graph->TopologicalOrder(order)) {
+    return false;
+  }
+  dependencies.reserve(order.size());
+  for (auto node : order) {
+    dependencies.push_back(node->GetDependencies().size());
+  }
+  return true;
+}
+
+}  // namespace graph_passes
+}  // namespace hip
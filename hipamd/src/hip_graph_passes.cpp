@@ -0,0 +1,59 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hip_graph_passes.hpp"
+
+namespace hip {
+
+// ================================================================================================
+void GraphPassManager::Run(Graph* graph) {
+  struct PassEntry {
+    Pass pass_;
+    const char* name_;
+    void (*run_)(Graph*, GraphPassStats&);
+  };
+  // Inlining exposes the empty nodes and copies of the child graphs to the other passes and
+  // the reduction exposes more chains of copies to the merging
+  static constexpr PassEntry kPasses[] = {
+    {kInlineChildGraphs, "InlineChildGraphs", &graph_passes::InlineChildGraphs<Graph>},
+    {kEliminateEmptyNodes, "EliminateEmptyNodes", &graph_passes::EliminateEmptyNodes<Graph>},
+    {kReduceTransitiveEdges, "ReduceTransitiveEdges",
+     &graph_passes::ReduceTransitiveEdges<Graph>},
+    {kMergeCopies, "MergeCopies", &graph_passes::MergeCopies<Graph>},
+  };
+
+  for (const auto& entry : kPasses) {
+    if ((passes_ & entry.pass_) == 0) {
+      continue;
+    }
+    GraphPassStats stats(entry.name_);
+    uint64_t start = amd::Os::timeNanos();
+    entry.run_(graph, stats);
+    stats.timeNs_ = amd::Os::timeNanos() - start;
+    ClPrint(amd::LOG_INFO, amd::LOG_CODE,
+            "[hipGraph] Pass %s: removed nodes %zu, folded nodes %zu, removed edges %zu, "
+            "added edges %zu, time %llu ns", stats.name_, stats.nodesRemoved_,
+            stats.nodesFolded_, stats.edgesRemoved_, stats.edgesAdded_,
+            static_cast<unsigned long long>(stats.timeNs_));
+    stats_.push_back(stats);
+  }
+}
+
+}  // namespace hip
@@ -0,0 +1,57 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include "hip_graph_internal.hpp"
+#include "hip_graph_pass_core.hpp"
+
+namespace hip {
+
+/*! \brief Optimizes the executable graph before the scheduling.
+ *
+ *  The passes run on the graph clone of GraphExec, the application graph is never modified.
+ *  The removed nodes stay alive in Graph::detached_, so the updates of the executable graph
+ *  still see the nodes as the application created them, and the folded nodes split again when
+ *  their parameters change. The passes are in hip_graph_pass_core.hpp.
+ */
+class GraphPassManager {
+ public:
+  enum Pass : uint32_t {
+    kInlineChildGraphs = 0x1,      //!< Replaces single-node child graphs with the node
+    kEliminateEmptyNodes = 0x2,    //!< Removes empty nodes, which don't multiply the edges
+    kReduceTransitiveEdges = 0x4,  //!< Removes the edges implied by other paths
+    kMergeCopies = 0x8             //!< Folds chains of contiguous memsets and memcpys
+  };
+
+  explicit GraphPassManager(uint32_t passes = DEBUG_HIP_GRAPH_PASSES) : passes_(passes) {}
+
+  //! Runs the enabled passes on the graph
+  void Run(Graph* graph);
+
+  //! Returns the statistics of the executed passes
+  const std::vector<GraphPassStats>& Stats() const { return stats_; }
+
+ private:
+  uint32_t passes_;                     //!< Mask of the enabled passes
+  std::vector<GraphPassStats> stats_;   //!< Statistics of the executed passes
+};
+
+}  // namespace hip
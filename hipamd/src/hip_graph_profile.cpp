@@ -0,0 +1,246 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#include "hip_graph_profile.hpp"
+
+namespace hip {
+
+// ================================================================================================
+void GraphProfile::AddLaunch(const std::vector<GraphProfileSample>& samples, uint64_t hostNs) {
+  launches_++;
+  hostNs_ += hostNs;
+  uint64_t begin = std::numeric_limits<uint64_t>::max();
+  uint64_t end = 0;
+  uint32_t numStreams = 0;
+  for (const auto& sample : samples) {
+    if (sample.node_ >= nodes_.size()) {
+      continue;
+    }
+    NodeStats& stats = stats_[sample.node_];
+    stats.hostNs_ += sample.hostNs_;
+    // A command without the timestamps has zero start
+    if ((sample.startNs_ == 0) || (sample.endNs_ < sample.startNs_)) {
+      continue;
+    }
+    const uint64_t gpuNs = sample.endNs_ - sample.startNs_;
+    stats.count_++;
+    stats.gpuNs_ += gpuNs;
+    stats.minGpuNs_ = std::min(stats.minGpuNs_, gpuNs);
+    stats.maxGpuNs_ = std::max(stats.maxGpuNs_, gpuNs);
+    if (sample.startNs_ > sample.submitNs_) {
+      stats.latencyNs_ += sample.startNs_ - sample.submitNs_;
+    }
+    begin = std::min(begin, sample.startNs_);
+    end = std::max(end, sample.endNs_);
+    numStreams = std::max(numStreams, sample.stream_ + 1);
+  }
+  if (end <= begin) {
+    return;
+  }
+  const uint64_t spanNs = end - begin;
+  timedLaunches_++;
+  spanNs_ += spanNs;
+  if (streams_.size() < numStreams) {
+    streams_.resize(numStreams);
+  }
+
+  // Merge the overlapping nodes on every stream, the rest of the stream time is idle
+  std::vector<std::pair<uint64_t, uint64_t>> intervals;
+  for (uint32_t stream = 0; stream < numStreams; ++stream) {
+    intervals.clear();
+    for (const auto& sample : samples) {
+      if ((sample.stream_ == stream) && (sample.node_ < nodes_.size()) &&
+          (sample.startNs_ != 0) && (sample.endNs_ >= sample.startNs_)) {
+        intervals.emplace_back(sample.startNs_, sample.endNs_);
+      }
+    }
+    if (intervals.empty()) {
+      continue;
+    }
+    std::sort(intervals.begin(), intervals.end());
+    StreamStats& stats = streams_[stream];
+    stats.launches_++;
+    stats.spanNs_ += spanNs;
+    uint64_t busyStart = intervals[0].first;
+    uint64_t busyEnd = intervals[0].second;
+    for (size_t i = 1; i < intervals.size(); ++i) {
+      if (intervals[i].first > busyEnd) {
+        const uint64_t idleNs = intervals[i].first - busyEnd;
+        stats.idleNs_ += idleNs;
+        stats.maxIdleNs_ = std::max(stats.maxIdleNs_, idleNs);
+        stats.busyNs_ += busyEnd - busyStart;
+        busyStart = intervals[i].first;
+      }
+      busyEnd = std::max(busyEnd, intervals[i].second);
+    }
+    stats.busyNs_ += busyEnd - busyStart;
+  }
+}
+
+// ================================================================================================
+std::vector<size_t> GraphProfile::CriticalPath(uint64_t* lengthNs) const {
+  const size_t count = nodes_.size();
+  std::vector<size_t> inDegree(count, 0);
+  for (const auto& node : nodes_) {
+    for (auto edge : node.edges_) {
+      inDegree[edge]++;
+    }
+  }
+  // The longest path over the mean GPU durations, the nodes are visited in a topological order
+  std::vector<uint64_t> start(count, 0);
+  std::vector<uint64_t> finish(count, 0);
+  std::vector<size_t> pred(count, count);
+  std::vector<size_t> ready;
+  for (size_t i = 0; i < count; ++i) {
+    if (inDegree[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  size_t last = count;
+  while (!ready.empty()) {
+    const size_t node = ready.back();
+    ready.pop_back();
+    finish[node] = start[node] + MeanGpuNs(node);
+    if ((last == count) || (finish[node] > finish[last])) {
+      last = node;
+    }
+    for (auto edge : nodes_[node].edges_) {
+      if ((pred[edge] == count) || (finish[node] > start[edge])) {
+        start[edge] = finish[node];
+        pred[edge] = node;
+      }
+      if (--inDegree[edge] == 0) {
+        ready.push_back(edge);
+      }
+    }
+  }
+  std::vector<size_t> path;
+  for (size_t node = last; node != count; node = pred[node]) {
+    path.push_back(node);
+  }
+  std::reverse(path.begin(), path.end());
+  if (lengthNs != nullptr) {
+    *lengthNs = (last == count) ? 0 : finish[last];
+  }
+  return path;
+}
+
+// ================================================================================================
+//! Escapes the string for JSON and DOT, which use the same quoting
+static std::string Escape(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    if ((c == '"') || (c == '\\')) {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) >= 0x20) {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+// ================================================================================================
+void GraphProfile::WriteJson(std::ostream& out) const {
+  uint64_t pathNs = 0;
+  std::vector<size_t> path = CriticalPath(&pathNs);
+  std::vector<bool> critical(nodes_.size(), false);
+  for (auto node : path) {
+    critical[node] = true;
+  }
+  const uint64_t timed = std::max<uint64_t>(timedLaunches_, 1);
+  const uint64_t launches = std::max<uint64_t>(launches_, 1);
+  out << "{\"launches\":" << launches_ << ",\"meanSpanNs\":" << spanNs_ / timed
+      << ",\"meanHostNs\":" << hostNs_ / launches << ",\"nodes\":[";
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    const NodeStats& stats = stats_[i];
+    const uint64_t count = std::max<uint64_t>(stats.count_, 1);
+    out << ((i == 0) ? "" : ",") << "{\"id\":" << nodes_[i].id_ << ",\"type\":\""
+        << Escape(nodes_[i].type_) << "\",\"name\":\"" << Escape(nodes_[i].name_)
+        << "\",\"samples\":" << stats.count_ << ",\"meanGpuNs\":" << MeanGpuNs(i)
+        << ",\"minGpuNs\":" << ((stats.count_ == 0) ? 0 : stats.minGpuNs_)
+        << ",\"maxGpuNs\":" << stats.maxGpuNs_ << ",\"meanHostNs\":" << stats.hostNs_ / launches
+        << ",\"meanLatencyNs\":" << stats.latencyNs_ / count
+        << ",\"critical\":" << (critical[i] ? "true" : "false") << ",\"edges\":[";
+    for (size_t j = 0; j < nodes_[i].edges_.size(); ++j) {
+      out << ((j == 0) ? "" : ",") << nodes_[nodes_[i].edges_[j]].id_;
+    }
+    out << "]}";
+  }
+  out << "],\"streams\":[";
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    const StreamStats& stats = streams_[i];
+    const double utilization =
+        (stats.spanNs_ == 0) ? 0.0 : static_cast<double>(stats.busyNs_) / stats.spanNs_;
+    out << ((i == 0) ? "" : ",") << "{\"index\":" << i << ",\"launches\":" << stats.launches_
+        << ",\"utilization\":" << utilization
+        << ",\"meanIdleNs\":" << stats.idleNs_ / std::max<uint64_t>(stats.launches_, 1)
+        << ",\"maxIdleNs\":" << stats.maxIdleNs_ << "}";
+  }
+  out << "],\"criticalPath\":{\"lengthNs\":" << pathNs << ",\"nodes\":[";
+  for (size_t i = 0; i < path.size(); ++i) {
+    out << ((i == 0) ? "" : ",") << nodes_[path[i]].id_;
+  }
+  out << "]}}" << std::endl;
+}
+
+// ================================================================================================
+void GraphProfile::WriteDot(std::ostream& out) const {
+  std::vector<size_t> path = CriticalPath(nullptr);
+  std::vector<size_t> next(nodes_.size(), nodes_.size());
+  for (size_t i = 1; i < path.size(); ++i) {
+    next[path[i - 1]] = path[i];
+  }
+  std::vector<bool> critical(nodes_.size(), false);
+  for (auto node : path) {
+    critical[node] = true;
+  }
+  const uint64_t launches = std::max<uint64_t>(launches_, 1);
+  out << "digraph graph_profile {\n";
+  out << "label=\"launches " << launches_ << ", mean span "
+      << spanNs_ / std::max<uint64_t>(timedLaunches_, 1) / 1000.0 << " us\";\n";
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    out << "node_" << nodes_[i].id_ << " [shape=rectangle, label=\"" << Escape(nodes_[i].type_)
+        << " " << nodes_[i].id_;
+    if (!nodes_[i].name_.empty()) {
+      out << "\\n" << Escape(nodes_[i].name_);
+    }
+    out << "\\ngpu " << MeanGpuNs(i) / 1000.0 << " us, host "
+        << stats_[i].hostNs_ / launches / 1000.0 << " us\"";
+    if (critical[i]) {
+      out << ", color=red, penwidth=2";
+    }
+    out << "];\n";
+  }
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    for (auto edge : nodes_[i].edges_) {
+      out << "node_" << nodes_[i].id_ << " -> node_" << nodes_[edge].id_;
+      if (next[i] == edge) {
+        out << " [color=red, penwidth=2]";
+      }
+      out << ";\n";
+    }
+  }
+  out << "}" << std::endl;
+}
+
+}  // namespace hip
@@ -0,0 +1,104 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace hip {
+
+//! Timings of one node in one graph launch
+struct GraphProfileSample {
+  size_t node_;         //!< Index of the node in the profile
+  uint32_t stream_;     //!< Index of the stream in the launch
+  uint64_t submitNs_;   //!< Submission of the first command of the node
+  uint64_t startNs_;    //!< GPU start of the first command of the node
+  uint64_t endNs_;      //!< GPU end of the last command of the node
+  uint64_t hostNs_;     //!< Host time spent in the creation of the node commands
+};
+
+/*! \brief Aggregates the node timings of many launches of one graph.
+ *
+ *  The profile doesn't depend on the runtime objects. It keeps the nodes as indices with the
+ *  edges between them, and reports the critical path over the mean GPU durations of the nodes,
+ *  the utilization of the streams and the idle gaps between the nodes on a stream.
+ */
+class GraphProfile {
+ public:
+  struct NodeInfo {
+    int id_;                        //!< Node ID, as in the DOT dump
+    std::string type_;              //!< Node type
+    std::string name_;              //!< Kernel name, empty for other nodes
+    std::vector<size_t> edges_;     //!< Indices of the dependent nodes
+  };
+
+  explicit GraphProfile(std::vector<NodeInfo>&& nodes)
+      : nodes_(std::move(nodes)), stats_(nodes_.size()) {}
+
+  //! Adds the samples of one launch, which took hostNs on the host
+  void AddLaunch(const std::vector<GraphProfileSample>& samples, uint64_t hostNs);
+
+  //! Returns the node indices on the critical path and its length
+  std::vector<size_t> CriticalPath(uint64_t* lengthNs) const;
+
+  //! Writes the report as a JSON object
+  void WriteJson(std::ostream& out) const;
+  //! Writes the graph as DOT with the nodes annotated with the timings
+  void WriteDot(std::ostream& out) const;
+
+  size_t Launches() const { return launches_; }
+
+ private:
+  struct NodeStats {
+    uint64_t count_ = 0;        //!< Launches with the timings of the node
+    uint64_t gpuNs_ = 0;        //!< Sum of the GPU durations
+    uint64_t minGpuNs_ = std::numeric_limits<uint64_t>::max();
+    uint64_t maxGpuNs_ = 0;
+    uint64_t hostNs_ = 0;       //!< Sum of the command creation times
+    uint64_t latencyNs_ = 0;    //!< Sum of the delays from the submission to the GPU start
+  };
+  struct StreamStats {
+    uint64_t launches_ = 0;     //!< Launches, which used the stream
+    uint64_t busyNs_ = 0;       //!< Sum of the time with a node running on the stream
+    uint64_t spanNs_ = 0;       //!< Sum of the launch spans, while the stream was used
+    uint64_t idleNs_ = 0;       //!< Sum of the gaps between the nodes on the stream
+    uint64_t maxIdleNs_ = 0;    //!< The longest gap
+  };
+
+  uint64_t MeanGpuNs(size_t node) const {
+    return (stats_[node].count_ == 0) ? 0 : stats_[node].gpuNs_ / stats_[node].count_;
+  }
+
+  std::vector<NodeInfo> nodes_;         //!< Nodes of the graph
+  std::vector<NodeStats> stats_;        //!< Statistics of the nodes
+  std::vector<StreamStats> streams_;    //!< Statistics of the streams
+  uint64_t launches_ = 0;               //!< Number of launches
+  uint64_t timedLaunches_ = 0;          //!< Number of launches with the GPU timings
+  uint64_t spanNs_ = 0;                 //!< Sum of the GPU spans of the timed launches
+  uint64_t hostNs_ = 0;                 //!< Sum of the host times of the launches
+};
+
+}  // namespace hip
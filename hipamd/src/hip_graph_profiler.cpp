@@ -0,0 +1,168 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#include "hip_graph_profiler.hpp"
+#include <fstream>
+
+namespace hip {
+
+// ================================================================================================
+static std::vector<GraphProfile::NodeInfo> DescribeNodes(const Graph* graph) {
+  const std::vector<Node>& vertices = graph->GetNodes();
+  std::vector<GraphProfile::NodeInfo> nodes(vertices.size());
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    nodes[i].id_ = vertices[i]->GetID();
+    nodes[i].type_ = GetGraphNodeTypeString(vertices[i]->GetType());
+    nodes[i].name_ = vertices[i]->GetKernelName();
+    for (auto edge : vertices[i]->GetEdges()) {
+      nodes[i].edges_.push_back(graph->GetNodeIndex(edge));
+    }
+  }
+  return nodes;
+}
+
+// ================================================================================================
+GraphProfiler::GraphProfiler(const Graph* graph) : profile_(DescribeNodes(graph)) {
+  const std::vector<Node>& vertices = graph->GetNodes();
+  index_.reserve(vertices.size());
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    index_[vertices[i]] = i;
+  }
+}
+
+// ================================================================================================
+GraphProfiler::~GraphProfiler() {
+  pending_.push_back(std::move(current_));
+  for (auto& launch : pending_) {
+    for (auto& node : launch.nodes_) {
+      for (auto command : node.commands_) {
+        command->release();
+      }
+    }
+  }
+}
+
+// ================================================================================================
+void GraphProfiler::BeginLaunch() {
+  // A failed launch leaves its commands behind
+  for (auto& node : current_.nodes_) {
+    for (auto command : node.commands_) {
+      command->release();
+    }
+  }
+  current_.nodes_.clear();
+  launchStartNs_ = amd::Os::timeNanos();
+}
+
+// ================================================================================================
+void GraphProfiler::TagCommands(Node node, uint64_t hostStartNs) {
+  auto it = index_.find(node);
+  if (it == index_.end()) {
+    return;
+  }
+  NodeCommands entry = {it->second, node->GetQueue(), amd::Os::timeNanos() - hostStartNs, {}};
+  for (auto command : node->GetCommands()) {
+    // The timestamps have to be requested before the submission
+    command->SetProfiling();
+    command->retain();
+    entry.commands_.push_back(command);
+  }
+  current_.nodes_.push_back(std::move(entry));
+}
+
+// ================================================================================================
+void GraphProfiler::EndLaunch() {
+  current_.hostNs_ = amd::Os::timeNanos() - launchStartNs_;
+  pending_.push_back(std::move(current_));
+  current_ = Launch();
+}
+
+// ================================================================================================
+void GraphProfiler::Collect(bool wait) {
+  std::vector<GraphProfileSample> samples;
+  std::vector<hip::Stream*> streams;
+  while (!pending_.empty()) {
+    Launch& launch = pending_.front();
+    for (auto& node : launch.nodes_) {
+      for (auto command : node.commands_) {
+        if (wait) {
+          command->awaitCompletion();
+        } else if (command->status() > CL_COMPLETE) {
+          // The launches complete in order, so the later ones are still running too
+          return;
+        }
+      }
+    }
+    samples.clear();
+    streams.clear();
+    for (auto& node : launch.nodes_) {
+      GraphProfileSample sample = {node.node_, 0, 0, 0, 0, node.hostNs_};
+      auto stream = std::find(streams.begin(), streams.end(), node.stream_);
+      sample.stream_ = static_cast<uint32_t>(stream - streams.begin());
+      if (stream == streams.end()) {
+        streams.push_back(node.stream_);
+      }
+      for (auto command : node.commands_) {
+        const auto& info = command->profilingInfo();
+        if ((command->status() == CL_COMPLETE) && (info.start_ != 0) &&
+            (info.end_ >= info.start_)) {
+          if ((sample.startNs_ == 0) || (info.start_ < sample.startNs_)) {
+            sample.startNs_ = info.start_;
+            sample.submitNs_ = info.submitted_;
+          }
+          sample.endNs_ = std::max(sample.endNs_, info.end_);
+        }
+        command->release();
+      }
+      samples.push_back(sample);
+    }
+    profile_.AddLaunch(samples, launch.hostNs_);
+    pending_.pop_front();
+  }
+}
+
+// ================================================================================================
+void GraphProfiler::Report() {
+  Collect(true);
+  if (profile_.Launches() == 0) {
+    return;
+  }
+  const std::string path = DEBUG_HIP_GRAPH_PROFILE;
+  std::ofstream out(path, std::ios::app);
+  if (!out.is_open()) {
+    LogPrintfError("Can't open the graph profile file %s", path.c_str());
+    return;
+  }
+  uint64_t lengthNs = 0;
+  size_t pathNodes = profile_.CriticalPath(&lengthNs).size();
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE,
+          "[hipGraph] Profile of %zu launches, critical path %zu nodes, %llu ns",
+          profile_.Launches(), pathNodes, static_cast<unsigned long long>(lengthNs));
+  const std::string dot = ".dot";
+  if ((path.size() > dot.size()) &&
+      (path.compare(path.size() - dot.size(), dot.size(), dot) == 0)) {
+    profile_.WriteDot(out);
+  } else {
+    profile_.WriteJson(out);
+  }
+}
+
+}  // namespace hip
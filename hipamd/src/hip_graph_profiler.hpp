@@ -0,0 +1,74 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#pragma once
+
+#include "hip_graph_internal.hpp"
+#include "hip_graph_profile.hpp"
+#include <deque>
+
+namespace hip {
+
+/*! \brief Profiles the launches of an executable graph with DEBUG_HIP_GRAPH_PROFILE.
+ *
+ *  The graph runs with the commands instead of the captured packets, since the packets carry no
+ *  timestamps. The launch enables the profiling of every node command before the submission and
+ *  keeps the commands, until they complete and their timestamps go into the profile.
+ */
+class GraphProfiler {
+ public:
+  //! Profiles the nodes of the graph, the nodes of the child graphs aren't profiled
+  explicit GraphProfiler(const Graph* graph);
+  ~GraphProfiler();
+
+  //! Starts a launch of the graph
+  void BeginLaunch();
+  //! Enables the timestamps of the node commands, created since hostStartNs
+  void TagCommands(Node node, uint64_t hostStartNs);
+  //! Ends the launch of the graph
+  void EndLaunch();
+
+  //! Adds the completed launches to the profile, waits for all launches if wait is true
+  void Collect(bool wait);
+
+  //! Waits for all launches and appends the report to the DEBUG_HIP_GRAPH_PROFILE file
+  void Report();
+
+ private:
+  struct NodeCommands {
+    size_t node_;                           //!< Index of the node
+    hip::Stream* stream_;                   //!< Stream of the node
+    uint64_t hostNs_;                       //!< Host time spent in the creation
+    std::vector<amd::Command*> commands_;   //!< Retained commands of the node
+  };
+  struct Launch {
+    uint64_t hostNs_ = 0;                   //!< Host time of the launch
+    std::vector<NodeCommands> nodes_;       //!< Commands of the profiled nodes
+  };
+
+  std::unordered_map<Node, size_t> index_;  //!< Indices of the profiled nodes
+  GraphProfile profile_;                    //!< Aggregated timings
+  Launch current_;                          //!< The launch in progress
+  uint64_t launchStartNs_ = 0;              //!< Host time of the current launch start
+  std::deque<Launch> pending_;              //!< Submitted launches, which may still run
+};
+
+}  // namespace hip
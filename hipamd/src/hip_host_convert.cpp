@@ -0,0 +1,173 @@
+/*
+Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip/hip_runtime.h>
+#include "hip_internal.hpp"
+#include "hip_host_convert.hpp"
+
+namespace hip {
+namespace hostcvt {
+
+//! Maps a hipDataType to the matching conversion format, Format::Invalid if not supported
+inline Format GetFormat(hipDataType type) {
+  switch (type) {
+    case HIP_R_32F:
+      return Format::F32;
+    case HIP_R_16F:
+      return Format::F16;
+    case HIP_R_16BF:
+      return Format::BF16;
+    case HIP_R_8F_E4M3:
+      return Format::E4M3;
+    case HIP_R_8F_E5M2:
+      return Format::E5M2;
+    case HIP_R_8F_E4M3_FNUZ:
+      return Format::E4M3Fnuz;
+    case HIP_R_8F_E5M2_FNUZ:
+      return Format::E5M2Fnuz;
+    default:
+      return Format::Invalid;
+  }
+}
+
+// ================================================================================================
+bool Convert(void* dst, Format dstFormat, const void* src, Format srcFormat, size_t count,
+             bool saturate) {
+  static const Isa isa = DEBUG_HIP_HOST_CONVERT_SIMD ? BestIsa() : Isa::Scalar;
+  return Convert(isa, dst, dstFormat, src, srcFormat, count, saturate);
+}
+
+}  // namespace hostcvt
+
+// ================================================================================================
+hipError_t hipExtConvertHostArray(void* dst, hipDataType dstType, const void* src,
+                                  hipDataType srcType, size_t count, unsigned int flags) {
+  HIP_INIT_API_NO_RETURN(hipExtConvertHostArray, dst, dstType, src, srcType, count, flags);
+
+  if (count == 0) {
+    HIP_RETURN(hipSuccess);
+  }
+  if (dst == nullptr || src == nullptr || (flags & ~hipExtConvertSaturateFinite) != 0) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  hostcvt::Format dstFormat = hostcvt::GetFormat(dstType);
+  hostcvt::Format srcFormat = hostcvt::GetFormat(srcType);
+  if (dstFormat == hostcvt::Format::Invalid || srcFormat == hostcvt::Format::Invalid) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  if (!hostcvt::Convert(dst, dstFormat, src, srcFormat, count,
+                        (flags & hipExtConvertSaturateFinite) != 0)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
+  HIP_RETURN(hipSuccess);
+}
+
+namespace {
+// Runs inside the staged upload of the blit manager, count is in elements
+bool ConvertStagedChunk(void* dst, const void* src, size_t count,
+                        const amd::CopyConversion& conversion) {
+  return hostcvt::Convert(dst, static_cast<hostcvt::Format>(conversion.dstFormat_), src,
+                          static_cast<hostcvt::Format>(conversion.srcFormat_), count,
+                          (conversion.flags_ & hipExtConvertSaturateFinite) != 0);
+}
+}  // namespace
+
+// ================================================================================================
+hipError_t hipExtMemcpyHtoDConvert(void* dst, hipDataType dstType, const void* src,
+                                   hipDataType srcType, size_t count, unsigned int flags,
+                                   hipStream_t stream) {
+  HIP_INIT_API(hipExtMemcpyHtoDConvert, dst, dstType, src, srcType, count, flags, stream);
+
+  if (count == 0) {
+    HIP_RETURN(hipSuccess);
+  }
+  if (dst == nullptr || src == nullptr || (flags & ~hipExtConvertSaturateFinite) != 0) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  if (!hip::isValid(stream)) {
+    HIP_RETURN(hipErrorContextIsDestroyed);
+  }
+  if (hip::Stream::StreamCaptureOngoing(stream)) {
+    HIP_RETURN(hipErrorStreamCaptureUnsupported);
+  }
+  hostcvt::Format dstFormat = hostcvt::GetFormat(dstType);
+  hostcvt::Format srcFormat = hostcvt::GetFormat(srcType);
+  if (dstFormat == hostcvt::Format::Invalid || srcFormat == hostcvt::Format::Invalid) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  if (dstFormat != hostcvt::Format::F32 && srcFormat != hostcvt::Format::F32) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
+
+  // The host reads the source while it fills the staging buffers, so it must be host memory
+  size_t sOffset = 0;
+  amd::Memory* srcMemory = getMemoryObject(src, sOffset);
+  if (srcMemory != nullptr &&
+      ((CL_MEM_SVM_FINE_GRAIN_BUFFER | CL_MEM_USE_HOST_PTR) & srcMemory->getMemFlags()) == 0) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  size_t dOffset = 0;
+  amd::Memory* dstMemory = getMemoryObject(dst, dOffset);
+  const size_t dstBytes = count * hostcvt::FormatSize(dstFormat);
+  if (dstMemory == nullptr || (dOffset + dstBytes) > dstMemory->getSize()) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  amd::CopyConversion conversion;
+  conversion.convert_ = ConvertStagedChunk;
+  conversion.srcFormat_ = static_cast<uint32_t>(srcFormat);
+  conversion.dstFormat_ = static_cast<uint32_t>(dstFormat);
+  conversion.flags_ = flags;
+  conversion.srcElementSize_ = static_cast<uint32_t>(hostcvt::FormatSize(srcFormat));
+  conversion.dstElementSize_ = static_cast<uint32_t>(hostcvt::FormatSize(dstFormat));
+
+  hip::Stream* hip_stream = hip::getStream(stream);
+  if (hip_stream == nullptr) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  amd::Command::EventWaitList waitList;
+  hip::Stream* pStream = hip_stream;
+  if (&hip_stream->device() != dstMemory->GetDeviceById()) {
+    pStream = hip::getNullStream(dstMemory->GetDeviceById()->context());
+    amd::Command* cmd = hip_stream->getLastQueuedCommand(true);
+    if (cmd != nullptr) {
+      waitList.push_back(cmd);
+    }
+  }
+  amd::WriteMemoryCommand* command = new amd::WriteMemoryCommand(
+      *pStream, CL_COMMAND_WRITE_BUFFER, waitList, *dstMemory->asBuffer(), dOffset, dstBytes, src);
+  for (auto cmd : waitList) {
+    cmd->release();
+  }
+  if (command == nullptr) {
+    HIP_RETURN(hipErrorOutOfMemory);
+  }
+  command->setConversion(conversion);
+
+  // The source is read during the submission, wait for it like a synchronous memcpy
+  command->enqueue();
+  command->awaitCompletion();
+  command->release();
+
+  HIP_RETURN(hipSuccess);
+}
+}  // namespace hip
@@ -0,0 +1,314 @@
+/*
+Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Host side conversions between fp32 and the reduced precision formats used by the device
+// (fp16, bf16 and fp8). The scalar routines below are the reference implementation: they produce
+// bit-identical results to the host paths of amd_hip_fp16.h, amd_hip_bf16.h and amd_hip_fp8.h.
+// The bulk entry points dispatch to F16C/AVX2/AVX-512 variants when the CPU supports them and
+// must match the scalar routines for every input.
+namespace hip {
+namespace hostcvt {
+
+//! Element formats understood by the bulk host conversion routines
+enum class Format : uint32_t {
+  Invalid = 0,
+  F32,        //!< IEEE fp32
+  F16,        //!< IEEE fp16
+  BF16,       //!< bfloat16
+  E4M3,       //!< OCP fp8 e4m3
+  E5M2,       //!< OCP fp8 e5m2
+  E4M3Fnuz,   //!< fp8 e4m3 with FNUZ encoding
+  E5M2Fnuz    //!< fp8 e5m2 (bf8) with FNUZ encoding
+};
+
+inline size_t FormatSize(Format f) {
+  switch (f) {
+    case Format::F32:
+      return sizeof(float);
+    case Format::F16:
+    case Format::BF16:
+      return sizeof(uint16_t);
+    case Format::E4M3:
+    case Format::E5M2:
+    case Format::E4M3Fnuz:
+    case Format::E5M2Fnuz:
+      return sizeof(uint8_t);
+    default:
+      return 0;
+  }
+}
+
+inline bool IsFp8(Format f) {
+  return f == Format::E4M3 || f == Format::E5M2 || f == Format::E4M3Fnuz ||
+         f == Format::E5M2Fnuz;
+}
+
+inline uint32_t F32AsU32(float f) {
+  uint32_t u;
+  std::memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+inline float U32AsF32(uint32_t u) {
+  float f;
+  std::memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+// half float, the f16 is in the low 16 bits of the input argument
+inline float HalfToFloat(uint32_t a) noexcept {
+  uint32_t u = ((a << 13) + 0x70000000U) & 0x8fffe000U;
+
+  uint32_t v = F32AsU32(U32AsF32(u) * U32AsF32(0x77800000U) /*0x1.0p+112f*/) + 0x38000000U;
+
+  u = (a & 0x7fff) != 0 ? v : u;
+
+  return U32AsF32(u) * U32AsF32(0x07800000U) /*0x1.0p-112f*/;
+}
+
+// float half with nearest even rounding
+// The lower 16 bits of the result is the bit pattern for the f16
+inline uint32_t FloatToHalf(float a) noexcept {
+  uint32_t u = F32AsU32(a);
+  int e = static_cast<int>((u >> 23) & 0xff) - 127 + 15;
+  uint32_t m = ((u >> 11) & 0xffe) | ((u & 0xfff) != 0);
+  uint32_t i = 0x7c00 | (m != 0 ? 0x0200 : 0);
+  uint32_t n = (static_cast<uint32_t>(e) << 12) | m;
+  uint32_t s = (u >> 16) & 0x8000;
+  int b = std::min(std::max(1 - e, 0), 13);
+  uint32_t d = (0x1000 | m) >> b;
+  d |= (d << b) != (0x1000 | m);
+  uint32_t v = e < 1 ? d : n;
+  v = (v >> 2) + (((v & 0x7) == 3) | ((v & 0x7) > 5));
+  v = e > 30 ? 0x7c00 : v;
+  v = e == 143 ? i : v;
+  return s | v;
+}
+
+inline float Bf16ToFloat(uint16_t a) noexcept { return U32AsF32(static_cast<uint32_t>(a) << 16); }
+
+// Matches __hip_bfloat16::float_2_bfloatraw: round to nearest even, NaN payloads are kept
+// non-zero so a signaling NaN never turns into Inf
+inline uint16_t FloatToBf16(float f) noexcept {
+  uint32_t u = F32AsU32(f);
+  if (~u & 0x7f800000) {
+    u += 0x7fff + ((u >> 16) & 1);
+  } else if (u & 0xffff) {
+    u |= 0x10000;
+  }
+  return static_cast<uint16_t>(u >> 16);
+}
+
+//! Exponent/mantissa widths of an fp8 format
+inline void Fp8Layout(Format f, int* we, int* wm, bool* fnuz) {
+  *we = (f == Format::E4M3 || f == Format::E4M3Fnuz) ? 4 : 5;
+  *wm = (*we == 4) ? 3 : 2;
+  *fnuz = (f == Format::E4M3Fnuz || f == Format::E5M2Fnuz);
+}
+
+// fp32 to fp8 with round to nearest even, the float specialization of internal::cast_to_f8 in
+// amd_hip_fp8.h. clip selects __HIP_SATFINITE
+inline uint8_t FloatToFp8(float f, int wm, int we, bool fnuz, bool clip) noexcept {
+  constexpr int mfmt = 23;
+  const uint32_t x = F32AsU32(f);
+  uint32_t mantissa = x & 0x7fffff;
+  const int exponent = (x >> 23) & 0xff;
+  const uint32_t sign = x >> 31;
+  constexpr int bias = 127;
+
+  uint32_t signed_inf = 0;
+  uint32_t nan = 0;
+  if (fnuz) {
+    signed_inf = clip ? ((sign << 7) + 0x7f) : 0x80;
+    nan = 0x80;
+  } else {
+    if (we == 4) {
+      signed_inf = (sign << 7) + (clip ? 0x7e : 0x7f);
+    } else {
+      signed_inf = (sign << 7) + (clip ? 0x7b : 0x7c);
+    }
+    nan = (sign << 7) + 0x7f;
+  }
+  const uint32_t ifmax = (we == 5) ? 0x47600000 : (fnuz ? 0x43700000 : 0x43E00000);
+
+  if ((x & 0x7f800000) == 0x7f800000) {
+    if (fnuz) return signed_inf;
+    return mantissa != 0 ? nan : signed_inf;
+  }
+  if ((x & 0x7fffffff) > ifmax) {
+    return signed_inf;
+  }
+  if (x == 0) {
+    return 0;
+  }
+
+  const int f8_bias = (1 << (we - 1)) - 1 + (fnuz ? 1 : 0);
+  const int f8_denormal_act_exponent = 1 - f8_bias;
+  int act_exponent, f8_exponent, exponent_diff;
+  uint64_t m = mantissa;
+
+  if (exponent == 0) {
+    act_exponent = exponent - bias + 1;
+    exponent_diff = f8_denormal_act_exponent - act_exponent;
+  } else {
+    act_exponent = exponent - bias;
+    if (act_exponent <= f8_denormal_act_exponent) {
+      exponent_diff = f8_denormal_act_exponent - act_exponent;
+    } else {
+      exponent_diff = 0;
+    }
+    m += (1ull << mfmt);
+  }
+  // Far below the smallest fp8 denormal, avoid shifting the mantissa out of range
+  if (exponent_diff > 31) {
+    return fnuz ? 0 : (sign << 7);
+  }
+
+  bool midpoint = (m & ((1ull << (mfmt - wm + exponent_diff)) - 1)) ==
+      (1ull << (mfmt - wm + exponent_diff - 1));
+
+  if (exponent_diff > 0) {
+    m >>= exponent_diff;
+  } else if (exponent_diff == -1) {
+    m <<= -exponent_diff;
+  }
+  bool implicit_one = m & (1ull << mfmt);
+  f8_exponent = (act_exponent + exponent_diff) + f8_bias - (implicit_one ? 0 : 1);
+
+  uint64_t drop_mask = (1ull << (mfmt - wm)) - 1;
+  bool odd = m & (1ull << (mfmt - wm));
+  m += (midpoint ? (odd ? m : m - 1ull) : m) & drop_mask;
+
+  if (f8_exponent == 0) {
+    if ((1ull << mfmt) & m) {
+      f8_exponent = 1;
+    }
+  } else {
+    if ((1ull << (mfmt + 1)) & m) {
+      m >>= 1;
+      f8_exponent++;
+    }
+  }
+
+  m >>= (mfmt - wm);
+
+  const int max_exp = (1 << we) - 1;
+  if (f8_exponent > max_exp) {
+    if (clip) {
+      m = (1 << wm) - 1;
+      f8_exponent = max_exp;
+    } else {
+      return signed_inf;
+    }
+  }
+
+  if (f8_exponent == 0 && m == 0) return fnuz ? 0 : (sign << 7);
+  m &= (1 << wm) - 1;
+  return static_cast<uint8_t>((sign << 7) | (f8_exponent << wm) | m);
+}
+
+// fp8 to fp32, the float specialization of internal::cast_from_f8 in amd_hip_fp8.h
+inline float Fp8ToFloat(uint8_t x, int wm, int we, bool fnuz) noexcept {
+  constexpr int weo = 8;
+  constexpr int wmo = 23;
+  const float fInf = U32AsF32(0x7F800000);
+  const float fNegInf = U32AsF32(0xFF800000);
+  const float fNaN = U32AsF32(0x7F800001);
+  const float fNeg0 = U32AsF32(0x80000000);
+
+  if (x == 0) {
+    return 0;
+  }
+
+  uint32_t sign = x >> 7;
+  uint32_t mantissa = x & ((1 << wm) - 1);
+  int exponent = (x & 0x7F) >> wm;
+  if (fnuz) {
+    if (x == 0x80) {
+      return fNaN;
+    }
+  } else {
+    if (x == 0x80) {
+      return fNeg0;
+    }
+    if (we == 4) {
+      if ((x & 0x7F) == 0x7F) {
+        return fNaN;
+      }
+    } else if ((x & 0x7C) == 0x7C) {
+      if ((x & 0x3) == 0) {
+        return sign ? fNegInf : fInf;
+      }
+      return fNaN;
+    }
+  }
+
+  const int exp_low_cutoff = (1 << (weo - 1)) - (1 << (we - 1)) + 1 - (fnuz ? 1 : 0);
+
+  if (exponent == 0) {
+    int sh = 1;
+    while ((mantissa << sh) < (1u << wm)) {
+      ++sh;
+    }
+    mantissa <<= sh;
+    exponent += 1 - sh;
+    mantissa &= ((1u << wm) - 1);
+  }
+  exponent += exp_low_cutoff - 1;
+  mantissa <<= wmo - wm;
+
+  return U32AsF32((sign << 31) | (static_cast<uint32_t>(exponent) << 23) | mantissa);
+}
+
+//! Instruction sets of the bulk conversions
+enum class Isa : uint32_t {
+  Scalar = 0,   //!< Portable scalar routines above
+  Avx2,         //!< F16C and AVX2
+  Avx512        //!< AVX-512 F, BW and VL
+};
+
+//! Returns true if the host CPU runs the conversions of the instruction set
+bool IsaSupported(Isa isa);
+
+//! Returns the widest instruction set, which the host CPU supports
+Isa BestIsa();
+
+//! Converts count elements of srcFormat at src into dstFormat at dst with the routines of the
+//! instruction set, which must be supported. One side must be Format::F32.
+//! Returns false for unsupported format pairs.
+bool Convert(Isa isa, void* dst, Format dstFormat, const void* src, Format srcFormat,
+             size_t count, bool saturate);
+
+//! Converts with the widest supported instruction set, unless DEBUG_HIP_HOST_CONVERT_SIMD
+//! selects the scalar routines
+bool Convert(void* dst, Format dstFormat, const void* src, Format srcFormat, size_t count,
+             bool saturate);
+
+}  // namespace hostcvt
+}  // namespace hip
@@ -0,0 +1,363 @@
+/*
+Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "hip_host_convert.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define HIP_HOST_CONVERT_X86 1
+#else
+#define HIP_HOST_CONVERT_X86 0
+#endif
+
+namespace hip {
+namespace hostcvt {
+namespace {
+
+typedef void (*F32ToU16Fn)(uint16_t* dst, const float* src, size_t count);
+typedef void (*U16ToF32Fn)(float* dst, const uint16_t* src, size_t count);
+
+// ================================================================================================
+void F32ToF16Scalar(uint16_t* dst, const float* src, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = static_cast<uint16_t>(FloatToHalf(src[i]));
+  }
+}
+
+void F16ToF32Scalar(float* dst, const uint16_t* src, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = HalfToFloat(src[i]);
+  }
+}
+
+void F32ToBf16Scalar(uint16_t* dst, const float* src, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = FloatToBf16(src[i]);
+  }
+}
+
+void Bf16ToF32Scalar(float* dst, const uint16_t* src, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = Bf16ToFloat(src[i]);
+  }
+}
+
+#if HIP_HOST_CONVERT_X86
+// The hardware conversions keep the NaN payload, while the reference routines return the
+// canonical quiet NaN of the sign. The vector paths patch NaN lanes to match the scalar code.
+
+// ================================================================================================
+__attribute__((target("avx2,f16c")))
+void F32ToF16Avx2(uint16_t* dst, const float* src, size_t count) {
+  const __m128i qnan = _mm_set1_epi16(0x7e00);
+  const __m128i sign = _mm_set1_epi16(static_cast<short>(0x8000));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 v = _mm256_loadu_ps(src + i);
+    __m128i h = _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256i nan32 = _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+    __m128i nan16 = _mm_packs_epi32(_mm256_castsi256_si128(nan32),
+                                    _mm256_extracti128_si256(nan32, 1));
+    __m128i fixed = _mm_or_si128(_mm_and_si128(h, sign), qnan);
+    h = _mm_blendv_epi8(h, fixed, nan16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+  }
+  F32ToF16Scalar(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx2,f16c")))
+void F16ToF32Avx2(float* dst, const uint16_t* src, size_t count) {
+  const __m256i qnan = _mm256_set1_epi32(0x7fc00000);
+  const __m256i mant = _mm256_set1_epi32(0x3ff);
+  const __m256i sign = _mm256_set1_epi32(0x8000);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m256 f = _mm256_cvtph_ps(h);
+    __m256i w = _mm256_cvtepu16_epi32(h);
+    __m256i fixed = _mm256_or_si256(
+        _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(w, sign), 16), qnan),
+        _mm256_slli_epi32(_mm256_and_si256(w, mant), 13));
+    f = _mm256_blendv_ps(f, _mm256_castsi256_ps(fixed), _mm256_cmp_ps(f, f, _CMP_UNORD_Q));
+    _mm256_storeu_ps(dst + i, f);
+  }
+  F16ToF32Scalar(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void F32ToBf16Avx2(uint16_t* dst, const float* src, size_t count) {
+  const __m256i expMask = _mm256_set1_epi32(0x7f800000);
+  const __m256i lowMask = _mm256_set1_epi32(0xffff);
+  const __m256i bias = _mm256_set1_epi32(0x7fff);
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i nanBit = _mm256_set1_epi32(0x10000);
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m256i r[2];
+    for (int j = 0; j < 2; ++j) {
+      __m256i u = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 8 * j));
+      __m256i special = _mm256_cmpeq_epi32(_mm256_and_si256(u, expMask), expMask);
+      __m256i rounded = _mm256_add_epi32(
+          u, _mm256_add_epi32(bias, _mm256_and_si256(_mm256_srli_epi32(u, 16), one)));
+      __m256i payload = _mm256_andnot_si256(
+          _mm256_cmpeq_epi32(_mm256_and_si256(u, lowMask), zero), nanBit);
+      __m256i nan = _mm256_or_si256(u, payload);
+      r[j] = _mm256_srli_epi32(_mm256_blendv_epi8(rounded, nan, special), 16);
+    }
+    // packus interleaves the 128 bit lanes, restore element order afterwards
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(r[0], r[1]), 0xd8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+  }
+  F32ToBf16Scalar(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void Bf16ToF32Avx2(float* dst, const uint16_t* src, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m256i w = _mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), w);
+  }
+  Bf16ToF32Scalar(dst + i, src + i, count - i);
+}
+
+// ================================================================================================
+__attribute__((target("avx512f,avx512bw,avx512vl")))
+void F32ToF16Avx512(uint16_t* dst, const float* src, size_t count) {
+  const __m256i qnan = _mm256_set1_epi16(0x7e00);
+  const __m256i sign = _mm256_set1_epi16(static_cast<short>(0x8000));
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m512 v = _mm512_loadu_ps(src + i);
+    __m256i h = _mm512_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __mmask16 nan = _mm512_cmp_ps_mask(v, v, _CMP_UNORD_Q);
+    __m256i fixed = _mm256_or_si256(_mm256_and_si256(h, sign), qnan);
+    h = _mm256_mask_blend_epi16(nan, h, fixed);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), h);
+  }
+  F32ToF16Avx2(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vl")))
+void F16ToF32Avx512(float* dst, const uint16_t* src, size_t count) {
+  const __m512i qnan = _mm512_set1_epi32(0x7fc00000);
+  const __m512i mant = _mm512_set1_epi32(0x3ff);
+  const __m512i sign = _mm512_set1_epi32(0x8000);
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m512 f = _mm512_cvtph_ps(h);
+    __m512i w = _mm512_cvtepu16_epi32(h);
+    __m512i fixed = _mm512_or_si512(
+        _mm512_or_si512(_mm512_slli_epi32(_mm512_and_si512(w, sign), 16), qnan),
+        _mm512_slli_epi32(_mm512_and_si512(w, mant), 13));
+    f = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(f, f, _CMP_UNORD_Q), f,
+                             _mm512_castsi512_ps(fixed));
+    _mm512_storeu_ps(dst + i, f);
+  }
+  F16ToF32Avx2(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vl")))
+void F32ToBf16Avx512(uint16_t* dst, const float* src, size_t count) {
+  const __m512i expMask = _mm512_set1_epi32(0x7f800000);
+  const __m512i lowMask = _mm512_set1_epi32(0xffff);
+  const __m512i bias = _mm512_set1_epi32(0x7fff);
+  const __m512i one = _mm512_set1_epi32(1);
+  const __m512i nanBit = _mm512_set1_epi32(0x10000);
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m512i u = _mm512_loadu_si512(src + i);
+    __mmask16 special = _mm512_cmpeq_epi32_mask(_mm512_and_si512(u, expMask), expMask);
+    __mmask16 payload = _mm512_test_epi32_mask(u, lowMask);
+    __m512i r = _mm512_add_epi32(
+        u, _mm512_add_epi32(bias, _mm512_and_si512(_mm512_srli_epi32(u, 16), one)));
+    r = _mm512_mask_mov_epi32(r, special, u);
+    r = _mm512_mask_or_epi32(r, special & payload, r, nanBit);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm512_cvtepi32_epi16(_mm512_srli_epi32(r, 16)));
+  }
+  F32ToBf16Avx2(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vl")))
+void Bf16ToF32Avx512(float* dst, const uint16_t* src, size_t count) {
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm512_storeu_si512(dst + i, _mm512_slli_epi32(_mm512_cvtepu16_epi32(h), 16));
+  }
+  Bf16ToF32Avx2(dst + i, src + i, count - i);
+}
+#endif  // HIP_HOST_CONVERT_X86
+
+// ================================================================================================
+struct Kernels {
+  F32ToU16Fn f32ToF16_;
+  U16ToF32Fn f16ToF32_;
+  F32ToU16Fn f32ToBf16_;
+  U16ToF32Fn bf16ToF32_;
+};
+
+const Kernels& GetKernels(Isa isa) {
+  static const Kernels scalar = {F32ToF16Scalar, F16ToF32Scalar, F32ToBf16Scalar,
+                                 Bf16ToF32Scalar};
+#if HIP_HOST_CONVERT_X86
+  static const Kernels avx2 = {F32ToF16Avx2, F16ToF32Avx2, F32ToBf16Avx2, Bf16ToF32Avx2};
+  static const Kernels avx512 = {F32ToF16Avx512, F16ToF32Avx512, F32ToBf16Avx512,
+                                 Bf16ToF32Avx512};
+  switch (isa) {
+    case Isa::Avx2:
+      return avx2;
+    case Isa::Avx512:
+      return avx512;
+    default:
+      break;
+  }
+#endif  // HIP_HOST_CONVERT_X86
+  return scalar;
+}
+
+// fp8 has only 256 encodings, so decoding is a table lookup built from the scalar reference
+struct Fp8Table {
+  float value_[256];
+  explicit Fp8Table(Format f) {
+    int we, wm;
+    bool fnuz;
+    Fp8Layout(f, &we, &wm, &fnuz);
+    for (uint32_t i = 0; i < 256; ++i) {
+      value_[i] = Fp8ToFloat(static_cast<uint8_t>(i), wm, we, fnuz);
+    }
+  }
+};
+
+const Fp8Table& GetFp8Table(Format f) {
+  static const Fp8Table e4m3(Format::E4M3);
+  static const Fp8Table e5m2(Format::E5M2);
+  static const Fp8Table e4m3Fnuz(Format::E4M3Fnuz);
+  static const Fp8Table e5m2Fnuz(Format::E5M2Fnuz);
+  switch (f) {
+    case Format::E4M3:
+      return e4m3;
+    case Format::E5M2:
+      return e5m2;
+    case Format::E4M3Fnuz:
+      return e4m3Fnuz;
+    default:
+      return e5m2Fnuz;
+  }
+}
+
+void F32ToFp8(uint8_t* dst, const float* src, size_t count, Format f, bool saturate) {
+  int we, wm;
+  bool fnuz;
+  Fp8Layout(f, &we, &wm, &fnuz);
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = FloatToFp8(src[i], wm, we, fnuz, saturate);
+  }
+}
+
+void Fp8ToF32(float* dst, const uint8_t* src, size_t count, Format f) {
+  const float* table = GetFp8Table(f).value_;
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = table[src[i]];
+  }
+}
+}  // namespace
+
+// ================================================================================================
+bool IsaSupported(Isa isa) {
+  switch (isa) {
+    case Isa::Scalar:
+      return true;
+#if HIP_HOST_CONVERT_X86
+    case Isa::Avx2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+    case Isa::Avx512:
+      __builtin_cpu_init();
+      return IsaSupported(Isa::Avx2) && __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl");
+#endif  // HIP_HOST_CONVERT_X86
+    default:
+      return false;
+  }
+}
+
+// ================================================================================================
+Isa BestIsa() {
+  if (IsaSupported(Isa::Avx512)) {
+    return Isa::Avx512;
+  }
+  if (IsaSupported(Isa::Avx2)) {
+    return Isa::Avx2;
+  }
+  return Isa::Scalar;
+}
+
+// ================================================================================================
+bool Convert(Isa isa, void* dst, Format dstFormat, const void* src, Format srcFormat,
+             size_t count, bool saturate) {
+  const Kernels& kernels = GetKernels(isa);
+  if (srcFormat == Format::F32) {
+    const float* in = reinterpret_cast<const float*>(src);
+    switch (dstFormat) {
+      case Format::F32:
+        std::memmove(dst, src, count * sizeof(float));
+        return true;
+      case Format::F16:
+        kernels.f32ToF16_(reinterpret_cast<uint16_t*>(dst), in, count);
+        return true;
+      case Format::BF16:
+        kernels.f32ToBf16_(reinterpret_cast<uint16_t*>(dst), in, count);
+        return true;
+      default:
+        if (IsFp8(dstFormat)) {
+          F32ToFp8(reinterpret_cast<uint8_t*>(dst), in, count, dstFormat, saturate);
+          return true;
+        }
+        return false;
+    }
+  } else if (dstFormat == Format::F32) {
+    float* out = reinterpret_cast<float*>(dst);
+    switch (srcFormat) {
+      case Format::F16:
+        kernels.f16ToF32_(out, reinterpret_cast<const uint16_t*>(src), count);
+        return true;
+      case Format::BF16:
+        kernels.bf16ToF32_(out, reinterpret_cast<const uint16_t*>(src), count);
+        return true;
+      default:
+        if (IsFp8(srcFormat)) {
+          Fp8ToF32(out, reinterpret_cast<const uint8_t*>(src), count, srcFormat);
+          return true;
+        }
+        return false;
+    }
+  }
+  return false;
+}
+
+}  // namespace hostcvt
+}  // namespace hip
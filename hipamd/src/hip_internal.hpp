@@ -305,7 +305,9 @@ public:
     /// Stream capture related parameters
 
     /// Current capture status of the stream
-    hipStreamCaptureStatus captureStatus_;
+    std::atomic<hipStreamCaptureStatus> captureStatus_;
+    /// The stream is in the stream set of its device and counted in the device state counters
+    bool registered_ = false;
     /// Graph that is constructed with capture
     hip::Graph* pCaptureGraph_;
     /// Based on mode stream capture places restrictions on API calls that can be made within or
@@ -403,7 +405,7 @@ public:
     /// Set graph that is being captured
     void SetCaptureGraph(hip::Graph* pGraph) {
       pCaptureGraph_ = pGraph;
-      captureStatus_ = hipStreamCaptureStatusActive;
+      SetCaptureStatus(hipStreamCaptureStatusActive);
     }
     void SetCaptureId() {
       // ID is generated in Begin Capture i.e.. when capture status is active
@@ -415,8 +417,12 @@ public:
     }
     /// reset capture parameters
     hipError_t EndCapture();
-    /// Set capture status
-    void SetCaptureStatus(hipStreamCaptureStatus captureStatus) { captureStatus_ = captureStatus; }
+    /// Set capture status and update the capture counter of the device
+    void SetCaptureStatus(hipStreamCaptureStatus captureStatus);
+    /// Returns true if the stream captures and blocks the legacy null stream
+    bool IsBlockingCapture() const {
+      return (captureStatus_ == hipStreamCaptureStatusActive) && (flags_ != hipStreamNonBlocking);
+    }
     /// Set capture mode
     void SetCaptureMode(hipStreamCaptureMode captureMode) { captureMode_ = captureMode; }
     /// Set parent stream
@@ -461,9 +467,14 @@ public:
       }
     }
 
+    /// The first command was enqueued, count the stream as active on its device
+    void QueueActivated() override;
+
     /// The stream should be destroyed via release() rather than delete
     private:
       ~Stream() {};
+
+    friend class Device;
   };
 
   /// HIP Device class
@@ -473,6 +484,10 @@ public:
     // Guards device stream set
     amd::Monitor streamSetLock{};
     std::unordered_set<hip::Stream*> streamSet;
+    /// Number of streams in the set, which capture and block the legacy null stream
+    std::atomic<uint32_t> blockingCaptureStreams_{0};
+    /// Number of streams in the set, which have enqueued commands
+    std::atomic<uint32_t> activeStreams_{0};
     /// ROCclr context
     amd::Context* context_;
     /// Device's ID
@@ -597,9 +612,17 @@ public:
 
     void SyncAllStreams( bool cpu_wait = true);
 
-    bool StreamCaptureBlocking();
+    /// Returns true if a stream of the device captures and blocks the legacy null stream
+    bool StreamCaptureBlocking() const { return blockingCaptureStreams_.load() != 0; }
+
+    /// Returns true if any stream of the device has enqueued commands
+    bool existsActiveStreamForDevice() const { return activeStreams_.load() != 0; }
+
+    /// Changes the capture status of a stream and updates the capture counter
+    void SetStreamCaptureStatus(Stream* stream, hipStreamCaptureStatus captureStatus);
 
-    bool existsActiveStreamForDevice();
+    /// Counts a stream, which enqueued its first command
+    void AddActiveStream(Stream* stream);
   /// Wait all active streams on the blocking queue. The method enqueues a wait command and
   /// doesn't stall the current thread
     void WaitActiveStreams(hip::Stream* blocking_stream, bool wait_null_stream = false);
@@ -33,6 +33,9 @@ hipError_t ihipModuleLoadData(hipModule_t* module, const void* mmap_ptr, size_t
 extern hipError_t ihipLaunchKernel(const void* hostFunction, dim3 gridDim, dim3 blockDim,
                                    void** args, size_t sharedMemBytes, hipStream_t stream,
                                    hipEvent_t startEvent, hipEvent_t stopEvent, int flags);
+extern hipError_t ihipLaunchKernel_prepare(hipFunction_t* func, const void* hostFunction,
+                                           dim3 gridDim, dim3 blockDim, int deviceId,
+                                           uint32_t* globalWorkSize);
 
 const std::string& FunctionName(const hipFunction_t f) {
   return hip::DeviceFunc::asFunction(f)->kernel()->name();
@@ -326,6 +329,36 @@ hipError_t ihipLaunchKernel_validate(hipFunction_t f, uint32_t globalWorkSizeX,
   return hipSuccess;
 }
 
+// Validates a launch of a device function and clamps the workgroup size to the global size.
+// The caller holds the kernel argument lock of the function.
+static hipError_t ihipModuleLaunchKernel_validate(
+    hipFunction_t f, uint32_t globalWorkSizeX, uint32_t globalWorkSizeY, uint32_t globalWorkSizeZ,
+    uint32_t& blockDimX, uint32_t& blockDimY, uint32_t& blockDimZ, uint32_t sharedMemBytes,
+    void** kernelParams, void** extra, int deviceId, uint32_t params = 0) {
+  hipError_t status = ihipLaunchKernel_validate(
+      f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ, blockDimX, blockDimY, blockDimZ,
+      sharedMemBytes, kernelParams, extra, deviceId, params);
+  if (status != hipSuccess) {
+    return status;
+  }
+  // Make sure the app doesn't launch a workgroup bigger than the global size
+  if (globalWorkSizeX < blockDimX) blockDimX = globalWorkSizeX;
+  if (globalWorkSizeY < blockDimY) blockDimY = globalWorkSizeY;
+  if (globalWorkSizeZ < blockDimZ) blockDimZ = globalWorkSizeZ;
+
+  auto device = g_devices[deviceId]->devices()[0];
+  amd::Kernel* kernel = hip::DeviceFunc::asFunction(f)->kernel();
+  // Check if it's a uniform kernel and validate dimensions
+  if (kernel->getDeviceKernel(*device)->getUniformWorkGroupSize()) {
+    if (((globalWorkSizeX % blockDimX) != 0) ||
+        ((globalWorkSizeY % blockDimY) != 0) ||
+        ((globalWorkSizeZ % blockDimZ) != 0)) {
+      return hipErrorInvalidValue;
+    }
+  }
+  return hipSuccess;
+}
+
 hipError_t ihipLaunchKernelCommand(amd::Command*& command, hipFunction_t f,
                                    uint32_t globalWorkSizeX, uint32_t globalWorkSizeY,
                                    uint32_t globalWorkSizeZ, uint32_t blockDimX, uint32_t blockDimY,
@@ -419,30 +452,15 @@ hipError_t ihipModuleLaunchKernel(hipFunction_t f, uint32_t globalWorkSizeX,
     return hipErrorInvalidResourceHandle;
   }
   hip::DeviceFunc* function = hip::DeviceFunc::asFunction(f);
-  amd::Kernel* kernel = function->kernel();
 
   amd::ScopedLock lock (DEBUG_HIP_KERNARG_COPY_OPT ? &function->dflock_ : nullptr);
 
-  hipError_t status = ihipLaunchKernel_validate(
+  hipError_t status = ihipModuleLaunchKernel_validate(
       f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ, blockDimX, blockDimY, blockDimZ,
       sharedMemBytes, kernelParams, extra, deviceId, params);
   if (status != hipSuccess) {
     return status;
   }
-  // Make sure the app doesn't launch a workgroup bigger than the global size
-  if (globalWorkSizeX < blockDimX) blockDimX = globalWorkSizeX;
-  if (globalWorkSizeY < blockDimY) blockDimY = globalWorkSizeY;
-  if (globalWorkSizeZ < blockDimZ) blockDimZ = globalWorkSizeZ;
-
-  auto device = g_devices[deviceId]->devices()[0];
-  // Check if it's a uniform kernel and validate dimensions
-  if (kernel->getDeviceKernel(*device)->getUniformWorkGroupSize()) {
-    if (((globalWorkSizeX % blockDimX) != 0) ||
-        ((globalWorkSizeY % blockDimY) != 0) ||
-        ((globalWorkSizeZ % blockDimZ) != 0)) {
-      return hipErrorInvalidValue;
-    }
-  }
   amd::Command* command = nullptr;
   hip::Stream* hip_stream = hip::getStream(hStream);
   status = ihipLaunchKernelCommand(command, f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ,
@@ -880,6 +898,90 @@ hipError_t hipExtLaunchMultiKernelMultiDevice(hipLaunchParams* launchParamsList,
   HIP_RETURN(ihipLaunchCooperativeKernelMultiDevice(launchParamsList, numDevices, flags, 0));
 }
 
+hipError_t ihipExtLaunchKernelBatch(const hipLaunchParams* launchParamsList,
+                                    unsigned int numLaunches, hipStream_t stream) {
+  if ((launchParamsList == nullptr) && (numLaunches != 0)) {
+    return hipErrorInvalidValue;
+  }
+  if (!hip::isValid(stream)) {
+    return hipErrorInvalidValue;
+  }
+  if (numLaunches == 0) {
+    return hipSuccess;
+  }
+
+  hip::getStreamPerThread(stream);
+  hip::Stream* capture_stream = reinterpret_cast<hip::Stream*>(stream);
+  if ((stream != nullptr) && (stream != hipStreamLegacy) &&
+      (capture_stream->GetCaptureStatus() != hipStreamCaptureStatusNone)) {
+    // Captured launches become graph nodes one by one, there is nothing to batch
+    for (unsigned int i = 0; i < numLaunches; ++i) {
+      const hipLaunchParams& launch = launchParamsList[i];
+      IHIP_RETURN_ONFAIL(hipLaunchKernel_common(launch.func, launch.gridDim, launch.blockDim,
+                                                launch.args, launch.sharedMem, stream));
+    }
+    return hipSuccess;
+  }
+
+  int deviceId = hip::Stream::DeviceId(stream);
+  IHIP_RETURN_ONFAIL(PlatformState::instance().initStatManagedVarDevicePtr(deviceId));
+  hip::Stream* hip_stream = hip::getStream(stream);
+
+  // Validate all launches and capture their arguments before anything is submitted,
+  // so a bad descriptor doesn't leave a partially launched batch behind
+  std::vector<amd::Command*> commands;
+  commands.reserve(numLaunches);
+  hipError_t status = hipSuccess;
+  for (unsigned int i = 0; (i < numLaunches) && (status == hipSuccess); ++i) {
+    const hipLaunchParams& launch = launchParamsList[i];
+    hipFunction_t func = nullptr;
+    uint32_t globalWorkSize[3];
+    status = ihipLaunchKernel_prepare(&func, launch.func, launch.gridDim, launch.blockDim,
+                                      deviceId, globalWorkSize);
+    if (status != hipSuccess) {
+      break;
+    }
+    uint32_t blockDimX = launch.blockDim.x;
+    uint32_t blockDimY = launch.blockDim.y;
+    uint32_t blockDimZ = launch.blockDim.z;
+
+    hip::DeviceFunc* function = hip::DeviceFunc::asFunction(func);
+    amd::ScopedLock lock(DEBUG_HIP_KERNARG_COPY_OPT ? &function->dflock_ : nullptr);
+    status = ihipModuleLaunchKernel_validate(func, globalWorkSize[0], globalWorkSize[1],
+                                             globalWorkSize[2], blockDimX, blockDimY, blockDimZ,
+                                             launch.sharedMem, launch.args, nullptr, deviceId);
+    if (status != hipSuccess) {
+      break;
+    }
+    amd::Command* command = nullptr;
+    status = ihipLaunchKernelCommand(command, func, globalWorkSize[0], globalWorkSize[1],
+                                     globalWorkSize[2], blockDimX, blockDimY, blockDimZ,
+                                     launch.sharedMem, hip_stream, launch.args, nullptr);
+    if (status == hipSuccess) {
+      commands.push_back(command);
+    }
+  }
+
+  if (status == hipSuccess) {
+    amd::Command::enqueueBatch(commands.data(), commands.size());
+  }
+
+  for (auto command : commands) {
+    if ((status == hipSuccess) && (command->status() == CL_INVALID_OPERATION)) {
+      status = hipErrorIllegalState;
+    }
+    command->release();
+  }
+  return status;
+}
+
+hipError_t hipExtLaunchKernelBatch(const hipLaunchParams* launchParamsList,
+                                   unsigned int numLaunches, hipStream_t stream) {
+  HIP_INIT_API(hipExtLaunchKernelBatch, launchParamsList, numLaunches, stream);
+
+  HIP_RETURN(ihipExtLaunchKernelBatch(launchParamsList, numLaunches, stream));
+}
+
 hipError_t hipModuleGetTexRef(textureReference** texRef, hipModule_t hmod, const char* name) {
   HIP_INIT_API(hipModuleGetTexRef, texRef, hmod, name);
 
@@ -22,6 +22,7 @@
 #include <hip/texture_types.h>
 #include "hip_platform.hpp"
 #include "hip_internal.hpp"
+#include "hip_host_convert.hpp"
 #include "platform/program.hpp"
 #include "platform/runtime.hpp"
 
@@ -603,16 +604,10 @@ hipError_t hipOccupancyMaxActiveBlocksPerMultiprocessorWithFlags(int* numBlocks,
   HIP_RETURN(ret);
 }
 
-hipError_t ihipLaunchKernel(const void* hostFunction, dim3 gridDim, dim3 blockDim, void** args,
-                            size_t sharedMemBytes, hipStream_t stream, hipEvent_t startEvent,
-                            hipEvent_t stopEvent, int flags) {
-  if (!hip::isValid(stream)) {
-    return hipErrorInvalidValue;
-  }
-  hipFunction_t func = nullptr;
-  int deviceId = hip::Stream::DeviceId(stream);
-  hipError_t hip_error = PlatformState::instance().getStatFunc(&func, hostFunction, deviceId);
-  if ((hip_error != hipSuccess) || (func == nullptr)) {
+hipError_t ihipLaunchKernel_prepare(hipFunction_t* func, const void* hostFunction, dim3 gridDim,
+                                    dim3 blockDim, int deviceId, uint32_t* globalWorkSize) {
+  hipError_t hip_error = PlatformState::instance().getStatFunc(func, hostFunction, deviceId);
+  if ((hip_error != hipSuccess) || (*func == nullptr)) {
     if (hip_error == hipErrorNoBinaryForGpu) {
       return hip_error;
     } else {
@@ -634,66 +629,32 @@ hipError_t ihipLaunchKernel(const void* hostFunction, dim3 gridDim, dim3 blockDi
       globalWorkSizeZ > std::numeric_limits<uint32_t>::max()) {
     return hipErrorInvalidConfiguration;
   }
-  return ihipModuleLaunchKernel(
-      func, static_cast<uint32_t>(globalWorkSizeX), static_cast<uint32_t>(globalWorkSizeY),
-      static_cast<uint32_t>(globalWorkSizeZ), blockDim.x, blockDim.y, blockDim.z, sharedMemBytes,
-      stream, args, nullptr, startEvent, stopEvent, flags);
-}
-
-// conversion routines between float and half precision
-
-static inline std::uint32_t f32_as_u32(float f) {
-  union {
-    float f;
-    std::uint32_t u;
-  } v;
-  v.f = f;
-  return v.u;
-}
-
-static inline float u32_as_f32(std::uint32_t u) {
-  union {
-    float f;
-    std::uint32_t u;
-  } v;
-  v.u = u;
-  return v.f;
+  globalWorkSize[0] = static_cast<uint32_t>(globalWorkSizeX);
+  globalWorkSize[1] = static_cast<uint32_t>(globalWorkSizeY);
+  globalWorkSize[2] = static_cast<uint32_t>(globalWorkSizeZ);
+  return hipSuccess;
 }
 
-static inline int clamp_int(int i, int l, int h) { return std::min(std::max(i, l), h); }
-
-
-// half float, the f16 is in the low 16 bits of the input argument
-
-static inline float __convert_half_to_float(std::uint32_t a) noexcept {
-  std::uint32_t u = ((a << 13) + 0x70000000U) & 0x8fffe000U;
-
-  std::uint32_t v =
-      f32_as_u32(u32_as_f32(u) * u32_as_f32(0x77800000U) /*0x1.0p+112f*/) + 0x38000000U;
-
-  u = (a & 0x7fff) != 0 ? v : u;
-
-  return u32_as_f32(u) * u32_as_f32(0x07800000U) /*0x1.0p-112f*/;
+hipError_t ihipLaunchKernel(const void* hostFunction, dim3 gridDim, dim3 blockDim, void** args,
+                            size_t sharedMemBytes, hipStream_t stream, hipEvent_t startEvent,
+                            hipEvent_t stopEvent, int flags) {
+  if (!hip::isValid(stream)) {
+    return hipErrorInvalidValue;
+  }
+  hipFunction_t func = nullptr;
+  int deviceId = hip::Stream::DeviceId(stream);
+  uint32_t globalWorkSize[3];
+  hipError_t hip_error = ihipLaunchKernel_prepare(&func, hostFunction, gridDim, blockDim, deviceId,
+                                                  globalWorkSize);
+  if (hip_error != hipSuccess) {
+    return hip_error;
+  }
+  return ihipModuleLaunchKernel(
+      func, globalWorkSize[0], globalWorkSize[1], globalWorkSize[2], blockDim.x, blockDim.y,
+      blockDim.z, sharedMemBytes, stream, args, nullptr, startEvent, stopEvent, flags);
 }
 
-// float half with nearest even rounding
-// The lower 16 bits of the result is the bit pattern for the f16
-static inline std::uint32_t __convert_float_to_half(float a) noexcept {
-  std::uint32_t u = f32_as_u32(a);
-  int e = static_cast<int>((u >> 23) & 0xff) - 127 + 15;
-  std::uint32_t m = ((u >> 11) & 0xffe) | ((u & 0xfff) != 0);
-  std::uint32_t i = 0x7c00 | (m != 0 ? 0x0200 : 0);
-  std::uint32_t n = ((std::uint32_t)e << 12) | m;
-  std::uint32_t s = (u >> 16) & 0x8000;
-  int b = clamp_int(1 - e, 0, 13);
-  std::uint32_t d = (0x1000 | m) >> b;
-  d |= (d << b) != (0x1000 | m);
-  std::uint32_t v = e < 1 ? d : n;
-  v = (v >> 2) + (((v & 0x7) == 3) | ((v & 0x7) > 5));
-  v = e > 30 ? 0x7c00 : v;
-  v = e == 143 ? i : v;
-  return s | v;
-}
+// conversion routines between float and half precision, see hip_host_convert.hpp
 
 extern "C"
 #if !defined(_MSC_VER)
@@ -701,7 +662,7 @@ extern "C"
 #endif
     float
     __gnu_h2f_ieee(unsigned short h) {
-  return __convert_half_to_float((std::uint32_t)h);
+  return hostcvt::HalfToFloat((std::uint32_t)h);
 }
 
 extern "C"
@@ -710,7 +671,7 @@ extern "C"
 #endif
     unsigned short
     __gnu_f2h_ieee(float f) {
-  return (unsigned short)__convert_float_to_half(f);
+  return (unsigned short)hostcvt::FloatToHalf(f);
 }
 
 void PlatformState::init() {
@@ -21,6 +21,7 @@
 #include <hip/hip_runtime.h>
 #include "hip_internal.hpp"
 #include "hip_event.hpp"
+#include "hip_callback_executor.hpp"
 #include "thread/monitor.hpp"
 #include "hip_prof_api.h"
 
@@ -55,7 +56,7 @@ hipError_t Stream::EndCapture() {
     hipError_t err = s->EndCapture();
     assert(err == hipSuccess);
   }
-  captureStatus_ = hipStreamCaptureStatusNone;
+  SetCaptureStatus(hipStreamCaptureStatusNone);
   pCaptureGraph_ = nullptr;
   originStream_ = false;
   parentStream_ = nullptr;
@@ -66,6 +67,16 @@ hipError_t Stream::EndCapture() {
   return hipSuccess;
 }
 
+// ================================================================================================
+void Stream::SetCaptureStatus(hipStreamCaptureStatus captureStatus) {
+  device_->SetStreamCaptureStatus(this, captureStatus);
+}
+
+// ================================================================================================
+void Stream::QueueActivated() {
+  device_->AddActiveStream(this);
+}
+
 // ================================================================================================
 bool Stream::Create() {
   return create();
@@ -172,12 +183,43 @@ bool Stream::StreamCaptureOngoing(hipStream_t hStream) {
 }
 
 // ================================================================================================
-void CL_CALLBACK ihipStreamCallback(cl_event event, cl_int command_exec_status, void* user_data) {
-  StreamCallback* cbo = reinterpret_cast<StreamCallback*>(user_data);
+//! Unblocks the HW queue of the callback command, after the executor ran the host function
+static void ReleaseCallbackCommand(void* data) {
+  amd::Command* command = reinterpret_cast<amd::Command*>(data);
+  command->ReleaseCallbackBlock();
+  command->release();
+}
+
+// ================================================================================================
+bool CallbackExecutor::Submit(cl_event event, void (*run)(void* data), void* data) {
+  CallbackExecutor* executor = Get();
+  if (executor == nullptr) {
+    return false;
+  }
+  amd::Command& command = as_amd(event)->command();
+  // Without the blocked queue the dependent work could start before the function is done
+  if (!command.HoldCallbackBlock()) {
+    return false;
+  }
+  command.retain();
+  executor->Enqueue(command.queue(), Task{run, data, &ReleaseCallbackCommand, &command});
+  return true;
+}
+
+// ================================================================================================
+static void RunStreamCallback(void* data) {
+  StreamCallback* cbo = reinterpret_cast<StreamCallback*>(data);
   cbo->callback();
   delete cbo;
 }
 
+// ================================================================================================
+void CL_CALLBACK ihipStreamCallback(cl_event event, cl_int command_exec_status, void* user_data) {
+  if (!CallbackExecutor::Submit(event, &RunStreamCallback, user_data)) {
+    RunStreamCallback(user_data);
+  }
+}
+
 // ================================================================================================
 static hipError_t ihipStreamCreate(hipStream_t* stream,
                                   unsigned int flags, hip::Stream::Priority priority,
@@ -0,0 +1,48 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace hip {
+
+/*! \brief Finishes all queues and waits about as long as the slowest of them.
+ *
+ *  The markers of all queues are submitted before the first wait, so the queues drain in
+ *  parallel. Waiting on each queue in turn would submit the marker of a queue only after the
+ *  queues before it drained. Queue needs submitFinish(cpu_wait), which returns the marker or
+ *  nullptr without waiting, and completeFinish(marker, cpu_wait), which waits for it.
+ */
+template <typename Queue>
+void FinishQueues(const std::vector<Queue*>& queues, bool cpu_wait) {
+  std::vector<decltype(queues[0]->submitFinish(cpu_wait))> markers;
+  markers.reserve(queues.size());
+  for (auto queue : queues) {
+    markers.push_back(queue->submitFinish(cpu_wait));
+  }
+  for (size_t i = 0; i < queues.size(); ++i) {
+    queues[i]->completeFinish(markers[i], cpu_wait);
+  }
+}
+
+}  // namespace hip
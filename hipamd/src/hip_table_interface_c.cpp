@@ -51,3 +51,20 @@ DllExport hipError_t hipHccModuleLaunchKernel(hipFunction_t f, uint32_t globalWo
       f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ, localWorkSizeX, localWorkSizeY,
       localWorkSizeZ, sharedMemBytes, hStream, kernelParams, extra, startEvent, stopEvent);
 }
+DllExport hipError_t hipExtConvertHostArray(void* dst, hipDataType dstType, const void* src,
+                                            hipDataType srcType, size_t count,
+                                            unsigned int flags) {
+  return hip::GetHipDispatchTable()->hipExtConvertHostArray_fn(dst, dstType, src, srcType, count,
+                                                               flags);
+}
+DllExport hipError_t hipExtMemcpyHtoDConvert(void* dst, hipDataType dstType, const void* src,
+                                             hipDataType srcType, size_t count, unsigned int flags,
+                                             hipStream_t stream) {
+  return hip::GetHipDispatchTable()->hipExtMemcpyHtoDConvert_fn(dst, dstType, src, srcType, count,
+                                                                flags, stream);
+}
+DllExport hipError_t hipExtLaunchKernelBatch(const hipLaunchParams* launchParamsList,
+                                             unsigned int numLaunches, hipStream_t stream) {
+  return hip::GetHipDispatchTable()->hipExtLaunchKernelBatch_fn(launchParamsList, numLaunches,
+                                                                stream);
+}
@@ -0,0 +1,152 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Runs the host callback executor without a device. The functions of one key must run in the
+// order of their submission and never overlap, the done function of a task must follow its
+// host function, and a blocked key must not hold back the tasks of the other keys.
+
+#include "hip_callback_executor.hpp"
+#include "clr_test_common.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kNumWorkers = 4;
+constexpr size_t kNumKeys = 8;
+constexpr uint32_t kTasksPerKey = 500;
+
+//! Waits until the condition holds, a lost task would otherwise hang the test
+template <typename F> bool WaitFor(F condition) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+//! State of one key, the key of the tasks is the address of the lane
+struct Lane {
+  std::atomic<uint32_t> next_{0};     //!< Sequence number of the expected task
+  std::atomic<bool> running_{false};  //!< A host function of the key runs
+  std::atomic<bool> failed_{false};   //!< Ordering or overlap violation
+};
+
+struct OrderedTask {
+  Lane* lane_;
+  uint32_t sequence_;
+  std::atomic<bool> ran_{false};
+  std::atomic<bool> doneAfterRun_{false};
+};
+
+std::atomic<uint32_t> completed{0};
+
+void RunOrdered(void* data) {
+  OrderedTask* task = reinterpret_cast<OrderedTask*>(data);
+  Lane* lane = task->lane_;
+  if (lane->running_.exchange(true)) {
+    lane->failed_ = true;
+  }
+  if (lane->next_.load() != task->sequence_) {
+    lane->failed_ = true;
+  }
+  // Give the other workers a chance to pick up the same key
+  std::this_thread::yield();
+  lane->next_.store(task->sequence_ + 1);
+  task->ran_ = true;
+  lane->running_ = false;
+}
+
+void DoneOrdered(void* data) {
+  OrderedTask* task = reinterpret_cast<OrderedTask*>(data);
+  task->doneAfterRun_ = task->ran_.load();
+  completed++;
+}
+
+void TestLaneOrder(hip::CallbackExecutor& executor) {
+  std::vector<Lane> lanes(kNumKeys);
+  std::vector<OrderedTask> tasks(kNumKeys * kTasksPerKey);
+  completed = 0;
+  // Interleave the keys, so every worker sees tasks of every key
+  for (uint32_t i = 0; i < kTasksPerKey; ++i) {
+    for (size_t key = 0; key < kNumKeys; ++key) {
+      OrderedTask& task = tasks[i * kNumKeys + key];
+      task.lane_ = &lanes[key];
+      task.sequence_ = i;
+      executor.Enqueue(&lanes[key], {&RunOrdered, &task, &DoneOrdered, &task});
+    }
+  }
+  CLR_TEST_CHECK(WaitFor([&]() { return completed.load() == tasks.size(); }));
+  for (const auto& lane : lanes) {
+    CLR_TEST_CHECK(!lane.failed_.load());
+    CLR_TEST_CHECK(lane.next_.load() == kTasksPerKey);
+  }
+  for (const auto& task : tasks) {
+    CLR_TEST_CHECK(task.doneAfterRun_.load());
+  }
+}
+
+std::atomic<bool> release{false};
+std::atomic<uint32_t> blockedDone{0};
+std::atomic<uint32_t> freeDone{0};
+
+void RunBlocked(void* data) {
+  CLR_TEST_CHECK(WaitFor([]() { return release.load(); }));
+}
+
+void RunFree(void* data) {}
+
+void DoneCount(void* data) { (*reinterpret_cast<std::atomic<uint32_t>*>(data))++; }
+
+void TestBlockedLane(hip::CallbackExecutor& executor) {
+  int blockedKey = 0;
+  int freeKey = 0;
+  // The second task of the blocked key must wait for the first one
+  executor.Enqueue(&blockedKey, {&RunBlocked, nullptr, &DoneCount, &blockedDone});
+  executor.Enqueue(&blockedKey, {&RunFree, nullptr, &DoneCount, &blockedDone});
+  for (uint32_t i = 0; i < kTasksPerKey; ++i) {
+    executor.Enqueue(&freeKey, {&RunFree, nullptr, &DoneCount, &freeDone});
+  }
+  CLR_TEST_CHECK(WaitFor([]() { return freeDone.load() == kTasksPerKey; }));
+  CLR_TEST_CHECK(blockedDone.load() == 0);
+  release = true;
+  CLR_TEST_CHECK(WaitFor([]() { return blockedDone.load() == 2; }));
+}
+
+}  // namespace
+
+int main() {
+  // The workers wait for the tasks until the process exit, so the executor is never destroyed
+  hip::CallbackExecutor* executor = new hip::CallbackExecutor();
+  CLR_TEST_CHECK(executor->Create(kNumWorkers));
+
+  TestLaneOrder(*executor);
+  TestBlockedLane(*executor);
+
+  std::printf("callback executor: passed\n");
+  return 0;
+}
@@ -0,0 +1,217 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Measures the clone of synthetic graphs with 1k, 10k and 100k kernel nodes, the part of the
+// instantiation which grows with the graph. The legacy clone copied the arguments of every
+// kernel node with one allocation per argument and mapped the edges through an unordered_map
+// of the originals to the clones. The shared clone retains the reference-counted argument
+// block of GraphKernelParams and maps the edges by the position of the node in the graph, like
+// Graph::clone. The nodes are the parts of hip::GraphKernelNode the clone touches, since the
+// runtime needs a device. Each node has 6 arguments and edges to the next 2 nodes.
+//
+// Usage: hip_graph_clone_bench [clones per size]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr size_t kNumArgs = 6;
+constexpr size_t kArgSize = 8;
+constexpr size_t kNumEdges = 2;
+
+//! Kernel node with an allocation per argument, as before the shared argument blocks
+struct LegacyNode {
+  LegacyNode() = default;
+  LegacyNode(const LegacyNode& rhs) : params_(rhs.params_.size()) {
+    for (size_t i = 0; i < params_.size(); ++i) {
+      params_[i] = std::malloc(kArgSize);
+      std::memcpy(params_[i], rhs.params_[i], kArgSize);
+    }
+  }
+  ~LegacyNode() {
+    for (auto param : params_) {
+      std::free(param);
+    }
+  }
+  std::vector<void*> params_;
+  std::vector<LegacyNode*> edges_;
+  std::vector<LegacyNode*> dependencies_;
+};
+
+//! Arguments of a node in one allocation, shared by the clones
+struct SharedParams {
+  std::atomic<uint32_t> refCount_{1};
+  std::vector<uint8_t> storage_;
+
+  void Retain() { refCount_++; }
+  void Release() {
+    if (--refCount_ == 0) {
+      delete this;
+    }
+  }
+};
+
+//! Kernel node, which shares the arguments with its clones and knows its position
+struct SharedNode {
+  SharedNode() = default;
+  SharedNode(const SharedNode& rhs) : params_(rhs.params_), index_(rhs.index_) {
+    params_->Retain();
+  }
+  ~SharedNode() {
+    if (params_ != nullptr) {
+      params_->Release();
+    }
+  }
+  SharedParams* params_ = nullptr;
+  size_t index_ = 0;
+  std::vector<SharedNode*> edges_;
+  std::vector<SharedNode*> dependencies_;
+};
+
+template <typename Node>
+void Connect(std::vector<Node*>& nodes) {
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    for (size_t j = i + 1; j < std::min(nodes.size(), i + 1 + kNumEdges); ++j) {
+      nodes[i]->edges_.push_back(nodes[j]);
+      nodes[j]->dependencies_.push_back(nodes[i]);
+    }
+  }
+}
+
+std::vector<LegacyNode*> BuildLegacy(size_t count) {
+  std::vector<LegacyNode*> nodes(count);
+  for (auto& node : nodes) {
+    node = new LegacyNode();
+    for (size_t i = 0; i < kNumArgs; ++i) {
+      node->params_.push_back(std::calloc(1, kArgSize));
+    }
+  }
+  Connect(nodes);
+  return nodes;
+}
+
+std::vector<SharedNode*> BuildShared(size_t count) {
+  std::vector<SharedNode*> nodes(count);
+  for (size_t i = 0; i < count; ++i) {
+    nodes[i] = new SharedNode();
+    nodes[i]->index_ = i;
+    nodes[i]->params_ = new SharedParams();
+    nodes[i]->params_->storage_.resize(kNumArgs * (sizeof(void*) + kArgSize));
+  }
+  Connect(nodes);
+  return nodes;
+}
+
+//! The clone of Graph::clone before the index mapping
+std::vector<LegacyNode*> CloneLegacy(const std::vector<LegacyNode*>& nodes) {
+  std::unordered_map<LegacyNode*, LegacyNode*> clonedNodes;
+  std::vector<LegacyNode*> clones;
+  for (auto node : nodes) {
+    LegacyNode* clone = new LegacyNode(*node);
+    clones.push_back(clone);
+    clonedNodes[node] = clone;
+  }
+  for (auto node : nodes) {
+    for (auto edge : node->edges_) {
+      clonedNodes[node]->edges_.push_back(clonedNodes[edge]);
+    }
+  }
+  for (auto node : nodes) {
+    for (auto dep : node->dependencies_) {
+      clonedNodes[node]->dependencies_.push_back(clonedNodes[dep]);
+    }
+  }
+  return clones;
+}
+
+//! The clone of Graph::clone, the clones take the positions of the originals
+std::vector<SharedNode*> CloneShared(const std::vector<SharedNode*>& nodes) {
+  std::vector<SharedNode*> clones;
+  clones.reserve(nodes.size());
+  for (auto node : nodes) {
+    clones.push_back(new SharedNode(*node));
+  }
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    clones[i]->edges_.reserve(nodes[i]->edges_.size());
+    for (auto edge : nodes[i]->edges_) {
+      clones[i]->edges_.push_back(clones[edge->index_]);
+    }
+  }
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    clones[i]->dependencies_.reserve(nodes[i]->dependencies_.size());
+    for (auto dep : nodes[i]->dependencies_) {
+      clones[i]->dependencies_.push_back(clones[dep->index_]);
+    }
+  }
+  return clones;
+}
+
+//! Returns the average clone time in ms, the clones are destroyed outside of the timing
+template <typename Node, typename Clone>
+double Measure(const std::vector<Node*>& nodes, Clone clone, size_t clones) {
+  double total = 0;
+  for (size_t ii = 0; ii < clones; ++ii) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<Node*> cloned = clone(nodes);
+    const auto end = std::chrono::steady_clock::now();
+    total += std::chrono::duration<double, std::milli>(end - start).count();
+    if ((cloned.size() != nodes.size()) ||
+        (cloned.back()->dependencies_.size() != nodes.back()->dependencies_.size())) {
+      std::fprintf(stderr, "clone mismatch\n");
+      std::exit(1);
+    }
+    for (auto node : cloned) {
+      delete node;
+    }
+  }
+  return total / clones;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t clones = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 10;
+
+  std::printf("%zu clones per size, %zu arguments and %zu edges per node\n", clones, kNumArgs,
+              kNumEdges);
+  std::printf("%8s %12s %12s\n", "nodes", "legacy ms", "shared ms");
+  for (size_t count : {1000, 10000, 100000}) {
+    std::vector<LegacyNode*> legacy = BuildLegacy(count);
+    std::vector<SharedNode*> shared = BuildShared(count);
+    const double legacyMs = Measure(legacy, CloneLegacy, clones);
+    const double sharedMs = Measure(shared, CloneShared, clones);
+    std::printf("%8zu %12.3f %12.3f\n", count, legacyMs, sharedMs);
+    for (auto node : legacy) {
+      delete node;
+    }
+    for (auto node : shared) {
+      delete node;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,210 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+// Plans synthetic graph allocations. Two blocks, whose live ranges overlap, must never share
+// memory, blocks ordered by the graph edges should share it, and every offset and size in the
+// arena must keep the alignment. A block must take the first gap between the conflicting
+// blocks, which fits it.
+
+#include "hip_graph_mem_planner.hpp"
+#include "clr_test_common.hpp"
+
+#include <map>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using hip::GraphMemBlock;
+using hip::GraphMemoryPlanner;
+
+//! Returns true if the blocks overlap in the arena
+bool Overlap(const GraphMemBlock& a, const GraphMemBlock& b, size_t alignment) {
+  auto alignUp = [alignment](size_t value) {
+    return ((value + alignment - 1) / alignment) * alignment;
+  };
+  return (a.offset_ < b.offset_ + alignUp(b.size_)) && (b.offset_ < a.offset_ + alignUp(a.size_));
+}
+
+//! Happens-before relation over the blocks, block i allocates at 2 * i and frees at 2 * i + 1
+class BlockOrder {
+ public:
+  explicit BlockOrder(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      before_.insert({2 * i, 2 * i + 1});
+    }
+  }
+
+  //! The first block is freed before the second one is allocated, the relation isn't transitive
+  void Order(size_t first, size_t second) { before_.insert({2 * first + 1, 2 * second}); }
+
+  GraphMemBlock Block(size_t index, size_t size) const {
+    return GraphMemBlock(size, 2 * index, 2 * index + 1);
+  }
+
+  GraphMemoryPlanner::HappensBefore Relation() const {
+    return [this](size_t a, size_t b) { return before_.count({a, b}) != 0; };
+  }
+
+ private:
+  std::set<std::pair<size_t, size_t>> before_;
+};
+
+// ================================================================================================
+void TestConflicts() {
+  // Concurrent blocks are placed one after the other
+  BlockOrder order(3);
+  std::vector<GraphMemBlock> blocks = {order.Block(0, 1000), order.Block(1, 3000),
+                                       order.Block(2, 2000)};
+  GraphMemoryPlanner planner(1);
+  const size_t arena = planner.Plan(blocks, order.Relation());
+  CLR_TEST_CHECK(arena == 6000);
+  // The largest block goes first
+  CLR_TEST_CHECK(blocks[1].offset_ == 0);
+  CLR_TEST_CHECK(blocks[2].offset_ == 3000);
+  CLR_TEST_CHECK(blocks[0].offset_ == 5000);
+}
+
+// ================================================================================================
+void TestDisjointLiveRanges() {
+  // A chain of allocations, each freed before the next one, reuses one range
+  BlockOrder order(4);
+  for (size_t first = 0; first < 4; ++first) {
+    for (size_t second = first + 1; second < 4; ++second) {
+      order.Order(first, second);
+    }
+  }
+  std::vector<GraphMemBlock> blocks = {order.Block(0, 4096), order.Block(1, 1024),
+                                       order.Block(2, 8192), order.Block(3, 512)};
+  GraphMemoryPlanner planner(256);
+  CLR_TEST_CHECK(planner.Plan(blocks, order.Relation()) == 8192);
+  for (const auto& block : blocks) {
+    CLR_TEST_CHECK(block.offset_ == 0);
+  }
+  // The order of either direction makes the blocks disjoint
+  CLR_TEST_CHECK(!GraphMemoryPlanner::Conflict(blocks[2], blocks[1], order.Relation()));
+  CLR_TEST_CHECK(!GraphMemoryPlanner::Conflict(blocks[1], blocks[2], order.Relation()));
+}
+
+// ================================================================================================
+void TestAlignment() {
+  BlockOrder order(3);
+  std::vector<GraphMemBlock> blocks = {order.Block(0, 100), order.Block(1, 1),
+                                       order.Block(2, 300)};
+  GraphMemoryPlanner planner(256);
+  const size_t arena = planner.Plan(blocks, order.Relation());
+  CLR_TEST_CHECK(blocks[2].offset_ == 0);
+  CLR_TEST_CHECK(blocks[0].offset_ == 512);
+  CLR_TEST_CHECK(blocks[1].offset_ == 768);
+  CLR_TEST_CHECK(arena == 1024);
+  // A zero alignment falls back to bytes
+  GraphMemoryPlanner bytes(0);
+  CLR_TEST_CHECK(bytes.Plan(blocks, order.Relation()) == 401);
+}
+
+// ================================================================================================
+void TestGapReuse() {
+  // p and r conflict with everything else, q and s are ordered, so s fits exactly in the range
+  // of q between p and r
+  BlockOrder order(4);
+  order.Order(1, 3);
+  std::vector<GraphMemBlock> blocks = {order.Block(0, 400), order.Block(1, 300),
+                                       order.Block(2, 300), order.Block(3, 300)};
+  GraphMemoryPlanner planner(1);
+  const size_t arena = planner.Plan(blocks, order.Relation());
+  CLR_TEST_CHECK(blocks[0].offset_ == 0);
+  CLR_TEST_CHECK(blocks[1].offset_ == 400);
+  CLR_TEST_CHECK(blocks[2].offset_ == 700);
+  CLR_TEST_CHECK(blocks[3].offset_ == 400);
+  CLR_TEST_CHECK(arena == 1000);
+
+  // r fits in front of q, since it is ordered with p. The gap between r and q is too small
+  // for s, which goes behind q
+  BlockOrder tight(4);
+  tight.Order(0, 2);
+  tight.Order(0, 3);
+  blocks = {tight.Block(0, 400), tight.Block(1, 300), tight.Block(2, 220), tight.Block(3, 210)};
+  CLR_TEST_CHECK(planner.Plan(blocks, tight.Relation()) == 910);
+  CLR_TEST_CHECK(blocks[1].offset_ == 400);
+  CLR_TEST_CHECK(blocks[2].offset_ == 0);
+  CLR_TEST_CHECK(blocks[3].offset_ == 700);
+}
+
+// ================================================================================================
+void TestRandomGraphs() {
+  std::mt19937 rng(11);
+  for (int round = 0; round < 200; ++round) {
+    // Random DAG over the alloc and free nodes, in topological order
+    const size_t numNodes = 4 + rng() % 60;
+    std::vector<std::vector<bool>> reach(numNodes, std::vector<bool>(numNodes, false));
+    for (size_t i = numNodes; i-- > 0;) {
+      for (size_t j = i + 1; j < numNodes; ++j) {
+        if ((rng() % 6 == 0) && !reach[i][j]) {
+          reach[i][j] = true;
+          for (size_t k = j + 1; k < numNodes; ++k) {
+            if (reach[j][k]) {
+              reach[i][k] = true;
+            }
+          }
+        }
+      }
+    }
+    auto happensBefore = [&reach](size_t a, size_t b) { return reach[a][b]; };
+    std::vector<GraphMemBlock> blocks;
+    for (size_t i = 0; i < numNodes; ++i) {
+      for (size_t j = i + 1; j < numNodes; ++j) {
+        if (reach[i][j] && (rng() % 8 == 0)) {
+          blocks.emplace_back(1 + rng() % 5000, i, j);
+        }
+      }
+    }
+    const size_t alignment = size_t{1} << (rng() % 10);
+    GraphMemoryPlanner planner(alignment);
+    const size_t arena = planner.Plan(blocks, happensBefore);
+    size_t total = 0;
+    for (size_t a = 0; a < blocks.size(); ++a) {
+      const size_t aligned = ((blocks[a].size_ + alignment - 1) / alignment) * alignment;
+      total += aligned;
+      CLR_TEST_CHECK(blocks[a].offset_ % alignment == 0);
+      CLR_TEST_CHECK(blocks[a].offset_ + aligned <= arena);
+      for (size_t b = a + 1; b < blocks.size(); ++b) {
+        if (GraphMemoryPlanner::Conflict(blocks[a], blocks[b], happensBefore)) {
+          CLR_TEST_CHECK(!Overlap(blocks[a], blocks[b], alignment));
+        }
+      }
+    }
+    CLR_TEST_CHECK(arena <= total);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestConflicts();
+  TestDisjointLiveRanges();
+  TestAlignment();
+  TestGapReuse();
+  TestRandomGraphs();
+
+  std::printf("graph memory planner: passed\n");
+  return 0;
+}
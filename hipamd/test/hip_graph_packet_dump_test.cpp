@@ -0,0 +1,188 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Decodes synthetic AQL packets in the layout of the HSA specification. The dump must show the
+// header fields, the dispatch geometry and the barrier dependencies, flag the packets, which
+// can't be dispatched, and count the packets, the command nodes and the errors of a stream.
+
+#include "hip_graph_packet_dump.hpp"
+#include "clr_test_common.hpp"
+
+#include <array>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using hip::GraphPacketDumper;
+using Packet = std::array<uint8_t, GraphPacketDumper::kPacketSize>;
+
+constexpr uint16_t kTypeDispatch = 2;
+constexpr uint16_t kTypeBarrierAnd = 3;
+constexpr uint16_t kTypeBarrierOr = 5;
+
+template <typename T>
+void WriteField(Packet& packet, size_t offset, T value) {
+  std::memcpy(packet.data() + offset, &value, sizeof(T));
+}
+
+//! Header with the barrier bit, system scope acquire and release fences
+uint16_t Header(uint16_t type) { return type | (1 << 8) | (2 << 9) | (2 << 11); }
+
+Packet Dispatch(uint32_t gridX, uint64_t kernelObject, uint64_t kernarg) {
+  Packet packet{};
+  WriteField<uint16_t>(packet, 0, Header(kTypeDispatch));
+  WriteField<uint16_t>(packet, 2, 3);  // setup, dimensions
+  WriteField<uint16_t>(packet, 4, 256);
+  WriteField<uint16_t>(packet, 6, 1);
+  WriteField<uint16_t>(packet, 8, 1);
+  WriteField<uint32_t>(packet, 12, gridX);
+  WriteField<uint32_t>(packet, 16, 2);
+  WriteField<uint32_t>(packet, 20, 1);
+  WriteField<uint32_t>(packet, 24, 16);
+  WriteField<uint32_t>(packet, 28, 1024);
+  WriteField<uint64_t>(packet, 32, kernelObject);
+  WriteField<uint64_t>(packet, 40, kernarg);
+  WriteField<uint64_t>(packet, 56, 0xabc);
+  return packet;
+}
+
+Packet Barrier(uint16_t type, uint64_t dep0, uint64_t dep4) {
+  Packet packet{};
+  WriteField<uint16_t>(packet, 0, Header(type));
+  WriteField<uint64_t>(packet, 8, dep0);
+  WriteField<uint64_t>(packet, 40, dep4);
+  return packet;
+}
+
+bool Contains(const std::string& text, const std::string& part) {
+  return text.find(part) != std::string::npos;
+}
+
+// ================================================================================================
+void TestDispatch() {
+  std::ostringstream out;
+  GraphPacketDumper dumper(out);
+  Packet packet = Dispatch(1024, 0x1000, 0x2000);
+  CLR_TEST_CHECK(dumper.DumpPacket(packet.data()));
+  const std::string text = out.str();
+  CLR_TEST_CHECK(Contains(text, "[0] KERNEL_DISPATCH barrier 1 acquire 2 release 2"));
+  CLR_TEST_CHECK(Contains(text, " dims 3 grid (1024,2,1) workgroup (256,1,1)"));
+  CLR_TEST_CHECK(Contains(text, " private 16 group 1024"));
+  CLR_TEST_CHECK(Contains(text, " object 0x1000 kernarg 0x2000 signal 0xabc\n"));
+  CLR_TEST_CHECK(!Contains(text, "INVALID"));
+  CLR_TEST_CHECK(dumper.PacketCount() == 1);
+}
+
+// ================================================================================================
+void TestMalformedDispatch() {
+  std::vector<Packet> packets = {Dispatch(0, 0x1000, 0x2000), Dispatch(64, 0, 0x2000),
+                                 Dispatch(64, 0x1000, 0)};
+  Packet noDims = Dispatch(64, 0x1000, 0x2000);
+  WriteField<uint16_t>(noDims, 2, 0);
+  packets.push_back(noDims);
+  Packet noWorkgroup = Dispatch(64, 0x1000, 0x2000);
+  WriteField<uint16_t>(noWorkgroup, 6, 0);
+  packets.push_back(noWorkgroup);
+  for (auto& packet : packets) {
+    std::ostringstream out;
+    GraphPacketDumper dumper(out);
+    CLR_TEST_CHECK(!dumper.DumpPacket(packet.data()));
+    CLR_TEST_CHECK(Contains(out.str(), " INVALID\n"));
+  }
+}
+
+// ================================================================================================
+void TestBarriers() {
+  std::ostringstream out;
+  GraphPacketDumper dumper(out);
+  Packet barrierAnd = Barrier(kTypeBarrierAnd, 0x10, 0x50);
+  Packet barrierOr = Barrier(kTypeBarrierOr, 0x20, 0);
+  CLR_TEST_CHECK(dumper.DumpPacket(barrierAnd.data()));
+  CLR_TEST_CHECK(dumper.DumpPacket(barrierOr.data()));
+  const std::string text = out.str();
+  CLR_TEST_CHECK(Contains(text, "[0] BARRIER_AND barrier 1 acquire 2 release 2"
+                                " deps [0x10 0x0 0x0 0x0 0x50] signal 0x0\n"));
+  CLR_TEST_CHECK(Contains(text, "[1] BARRIER_OR barrier 1 acquire 2 release 2"
+                                " deps [0x20 0x0 0x0 0x0 0x0] signal 0x0\n"));
+}
+
+// ================================================================================================
+void TestUnknownTypes() {
+  for (uint16_t type : {1, 4, 7, 255}) {
+    std::ostringstream out;
+    GraphPacketDumper dumper(out);
+    Packet packet{};
+    WriteField<uint16_t>(packet, 0, type);
+    CLR_TEST_CHECK(!dumper.DumpPacket(packet.data()));
+    CLR_TEST_CHECK(Contains(out.str(), " INVALID\n"));
+  }
+  // Vendor packets are opaque to the decoder and pass
+  std::ostringstream out;
+  GraphPacketDumper dumper(out);
+  Packet vendor{};
+  CLR_TEST_CHECK(dumper.DumpPacket(vendor.data()));
+  CLR_TEST_CHECK(Contains(out.str(), "VENDOR_SPECIFIC"));
+}
+
+// ================================================================================================
+void TestStream() {
+  std::ostringstream out;
+  GraphPacketDumper dumper(out);
+  Packet kernel = Dispatch(64, 0x1000, 0x2000);
+  Packet broken = Dispatch(64, 0, 0x2000);
+  Packet barrier = Barrier(kTypeBarrierAnd, 0x10, 0);
+
+  // A second stream on the same dumper must start from zero
+  for (int pass = 0; pass < 2; ++pass) {
+    out.str("");
+    dumper.Begin(reinterpret_cast<const void*>(0x100), 4);
+    dumper.DumpNode(0, "KERNEL", "vadd", {kernel.data()});
+    dumper.DumpNode(1, "MEMCPY", "", {kernel.data(), barrier.data()});
+    dumper.DumpCommandNode(2, "HOST");
+    dumper.DumpNode(3, "KERNEL", "bad", {broken.data()});
+    dumper.End();
+    CLR_TEST_CHECK(dumper.PacketCount() == 4);
+    CLR_TEST_CHECK(dumper.CommandNodes() == 1);
+    CLR_TEST_CHECK(dumper.Errors() == 1);
+  }
+  const std::string text = out.str();
+  CLR_TEST_CHECK(Contains(text, "graph 0x100 nodes 4\n"));
+  CLR_TEST_CHECK(Contains(text, "  node 0 KERNEL vadd packets 1\n"));
+  CLR_TEST_CHECK(Contains(text, "  node 1 MEMCPY packets 2\n"));
+  CLR_TEST_CHECK(Contains(text, "  node 2 HOST commands\n"));
+  CLR_TEST_CHECK(Contains(text, "    [3] KERNEL_DISPATCH"));
+  CLR_TEST_CHECK(Contains(text, "total packets 4, command nodes 1, errors 1\n"));
+}
+
+}  // namespace
+
+int main() {
+  TestDispatch();
+  TestMalformedDispatch();
+  TestBarriers();
+  TestUnknownTypes();
+  TestStream();
+  std::printf("graph packet dump: passed\n");
+  return 0;
+}
@@ -0,0 +1,587 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+// Runs the graph instantiate passes on synthetic graphs. Every pass has to keep the ordering
+// of the remaining work: a node may only run after another one if the application graph
+// ordered them, and every ordered pair stays ordered. The folds have to join contiguous,
+// non-overlapping work only, and an update of a folded node has to split its fold, as
+// hipGraphExecUpdate() does after the passes.
+
+#include "hip_graph_pass_core.hpp"
+#include "clr_test_common.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <queue>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using hip::GraphPassStats;
+namespace graph_passes = hip::graph_passes;
+
+enum Kind { kKernel, kEmpty, kMemset, kCopy, kChild, kEvent };
+
+struct FakeGraph;
+
+//! 1D memset parameters, as in hipMemsetParams
+struct MemsetParams {
+  void* dst;
+  size_t elementSize;
+  size_t width;
+  size_t height;
+  unsigned int value;
+};
+
+//! Node with the edge API and the fold state of hip::GraphNode
+class FakeNode : public hip::GraphFold<FakeNode> {
+ public:
+  FakeNode(Kind kind, int id) : kind_(kind), id_(id) {}
+
+  void AddEdgeDep(FakeNode* node) {
+    edges_.push_back(node);
+    node->dependencies_.push_back(this);
+  }
+  bool RemoveEdgeDep(FakeNode* node) {
+    auto it = std::find(edges_.begin(), edges_.end(), node);
+    if (it == edges_.end()) {
+      return false;
+    }
+    edges_.erase(it);
+    auto dep = std::find(node->dependencies_.begin(), node->dependencies_.end(), this);
+    node->dependencies_.erase(dep);
+    return true;
+  }
+  const std::vector<FakeNode*>& GetEdges() const { return edges_; }
+  const std::vector<FakeNode*>& GetDependencies() const { return dependencies_; }
+
+  FakeGraph* GetChildGraph() { return child_; }
+  void SetParentGraph(FakeGraph* graph) { parent_ = graph; }
+  unsigned int GetEnabled() const { return enabled_; }
+  bool IsEmptyNode() const { return kind_ == kEmpty; }
+  bool IsInlinable() const { return kind_ != kChild && kind_ != kEvent; }
+
+  //! The fold of the memset and copy nodes, the allocation check of the runtime is omitted
+  bool Fold(FakeNode* next) {
+    if (kind_ != next->kind_) {
+      return false;
+    }
+    if (kind_ == kMemset) {
+      if (!hip::CanFoldMemsets(memset_, next->memset_)) {
+        return false;
+      }
+      if (foldMembers_.empty()) {
+        foldMemset_ = memset_;
+      }
+      memset_.width += next->memset_.width;
+      return true;
+    }
+    if (kind_ == kCopy) {
+      if (!hip::CanFoldCopies(dst_, src_, count_, next->dst_, next->src_, next->count_)) {
+        return false;
+      }
+      if (foldMembers_.empty()) {
+        foldCount_ = count_;
+      }
+      count_ += next->count_;
+      return true;
+    }
+    return false;
+  }
+  void Unfold() {
+    memset_ = foldMemset_;
+    count_ = foldCount_;
+  }
+
+  //! Changes the parameters like SetParams() of the runtime nodes
+  void SetCount(size_t count) {
+    BreakFold();
+    count_ = count;
+  }
+  void SetEnabled(unsigned int enabled) {
+    if (enabled != enabled_) {
+      BreakFold();
+    }
+    enabled_ = enabled;
+  }
+
+  FakeNode* FoldHead() const { return foldHead_; }
+
+  Kind kind_;
+  int id_;
+  FakeGraph* child_ = nullptr;
+  FakeGraph* parent_ = nullptr;
+  unsigned int enabled_ = 1;
+  MemsetParams memset_{};
+  MemsetParams foldMemset_{};
+  char* dst_ = nullptr;
+  const char* src_ = nullptr;
+  size_t count_ = 0;
+  size_t foldCount_ = 0;
+
+ private:
+  std::vector<FakeNode*> edges_;
+  std::vector<FakeNode*> dependencies_;
+};
+
+//! Graph with the API of hip::Graph, which the passes use
+struct FakeGraph {
+  std::vector<FakeNode*> vertices_;
+  std::vector<FakeNode*> detached_;
+  std::vector<std::unique_ptr<FakeNode>> storage_;
+  std::vector<std::unique_ptr<FakeGraph>> children_;
+
+  FakeNode* Add(Kind kind) {
+    storage_.emplace_back(new FakeNode(kind, static_cast<int>(storage_.size())));
+    FakeNode* node = storage_.back().get();
+    node->SetParentGraph(this);
+    vertices_.push_back(node);
+    return node;
+  }
+  FakeNode* AddMemset(char* dst, size_t width, unsigned int value) {
+    FakeNode* node = Add(kMemset);
+    node->memset_ = {dst, 1, width, 1, value};
+    return node;
+  }
+  FakeNode* AddCopy(char* dst, const char* src, size_t count) {
+    FakeNode* node = Add(kCopy);
+    node->dst_ = dst;
+    node->src_ = src;
+    node->count_ = count;
+    return node;
+  }
+  //! Adds a child graph node, whose graph holds a single node of the kind
+  FakeNode* AddChild(Kind innerKind, FakeNode** inner) {
+    children_.emplace_back(new FakeGraph);
+    FakeNode* node = Add(kChild);
+    node->child_ = children_.back().get();
+    *inner = node->child_->Add(innerKind);
+    return node;
+  }
+
+  const std::vector<FakeNode*>& GetNodes() const { return vertices_; }
+  size_t GetNodeCount() const { return vertices_.size(); }
+
+  void DetachNode(FakeNode* node, FakeNode* replacement = nullptr) {
+    const std::vector<FakeNode*> dependencies = node->GetDependencies();
+    for (auto dep : dependencies) {
+      dep->RemoveEdgeDep(node);
+    }
+    const std::vector<FakeNode*> edges = node->GetEdges();
+    for (auto edge : edges) {
+      node->RemoveEdgeDep(edge);
+    }
+    auto it = std::find(vertices_.begin(), vertices_.end(), node);
+    if (replacement != nullptr) {
+      *it = replacement;
+    } else {
+      vertices_.erase(it);
+    }
+    detached_.push_back(node);
+  }
+
+  bool TopologicalOrder(std::vector<FakeNode*>& order) const {
+    std::unordered_map<FakeNode*, size_t> inDegree;
+    std::queue<FakeNode*> ready;
+    for (auto node : vertices_) {
+      inDegree[node] = node->GetDependencies().size();
+      if (inDegree[node] == 0) {
+        ready.push(node);
+      }
+    }
+    while (!ready.empty()) {
+      FakeNode* node = ready.front();
+      ready.pop();
+      order.push_back(node);
+      for (auto edge : node->GetEdges()) {
+        if (--inDegree[edge] == 0) {
+          ready.push(edge);
+        }
+      }
+    }
+    return order.size() == vertices_.size();
+  }
+};
+
+typedef std::set<std::pair<int, int>> Pairs;
+
+//! Returns the pairs of the non-empty nodes, in which the first node runs before the second
+Pairs Ordering(const FakeGraph& graph) {
+  Pairs pairs;
+  for (auto from : graph.vertices_) {
+    std::vector<FakeNode*> stack(from->GetEdges().begin(), from->GetEdges().end());
+    std::set<FakeNode*> seen;
+    while (!stack.empty()) {
+      FakeNode* node = stack.back();
+      stack.pop_back();
+      if (!seen.insert(node).second) {
+        continue;
+      }
+      if (!from->IsEmptyNode() && !node->IsEmptyNode()) {
+        pairs.insert({from->id_, node->id_});
+      }
+      stack.insert(stack.end(), node->GetEdges().begin(), node->GetEdges().end());
+    }
+  }
+  return pairs;
+}
+
+bool HasEdge(FakeNode* from, FakeNode* to) {
+  const auto& edges = from->GetEdges();
+  return std::find(edges.begin(), edges.end(), to) != edges.end();
+}
+
+bool InGraph(const FakeGraph& graph, FakeNode* node) {
+  return std::find(graph.vertices_.begin(), graph.vertices_.end(), node) !=
+         graph.vertices_.end();
+}
+
+// ================================================================================================
+void TestFoldMemsets() {
+  char buffer[4096];
+  FakeGraph graph;
+  // Contiguous chain with one pattern, then a gap, then a different pattern
+  FakeNode* a = graph.AddMemset(buffer, 256, 7);
+  FakeNode* b = graph.AddMemset(buffer + 256, 128, 7);
+  FakeNode* c = graph.AddMemset(buffer + 384, 64, 7);
+  FakeNode* gap = graph.AddMemset(buffer + 512, 64, 7);
+  FakeNode* d = graph.AddMemset(buffer + 576, 64, 7);
+  FakeNode* other = graph.AddMemset(buffer + 640, 64, 9);
+  a->AddEdgeDep(b);
+  b->AddEdgeDep(c);
+  c->AddEdgeDep(gap);
+  gap->AddEdgeDep(d);
+  d->AddEdgeDep(other);
+
+  GraphPassStats stats("MergeCopies");
+  graph_passes::MergeCopies(&graph, stats);
+  CLR_TEST_CHECK(stats.nodesFolded_ == 3);
+  CLR_TEST_CHECK(!a->IsFolded() && (b->FoldHead() == a) && (c->FoldHead() == a));
+  CLR_TEST_CHECK(a->memset_.width == 448);
+  CLR_TEST_CHECK(!gap->IsFolded() && (d->FoldHead() == gap));
+  CLR_TEST_CHECK(gap->memset_.width == 128);
+  CLR_TEST_CHECK(!other->IsFolded() && (other->memset_.width == 64));
+
+  // 2D memsets and different element sizes stay apart
+  MemsetParams wide = {buffer, 1, 16, 2, 0};
+  MemsetParams next = {buffer + 16, 1, 16, 1, 0};
+  CLR_TEST_CHECK(!hip::CanFoldMemsets(wide, next));
+  MemsetParams words = {buffer, 4, 16, 1, 0};
+  MemsetParams bytes = {buffer + 64, 1, 16, 1, 0};
+  CLR_TEST_CHECK(!hip::CanFoldMemsets(words, bytes));
+  bytes.elementSize = 4;
+  CLR_TEST_CHECK(hip::CanFoldMemsets(words, bytes));
+}
+
+// ================================================================================================
+void TestFoldCopies() {
+  static char src[8192];
+  static char dst[8192];
+  // Contiguous in both ranges
+  CLR_TEST_CHECK(hip::CanFoldCopies(dst, src, 100, dst + 100, src + 100, 50));
+  // Only one range continues
+  CLR_TEST_CHECK(!hip::CanFoldCopies(dst, src, 100, dst + 100, src + 101, 50));
+  CLR_TEST_CHECK(!hip::CanFoldCopies(dst, src, 100, dst + 101, src + 100, 50));
+  // Backwards
+  CLR_TEST_CHECK(!hip::CanFoldCopies(dst + 100, src + 100, 100, dst, src, 100));
+  // The merged copy reads what it writes: the second copy reads the output of the first
+  CLR_TEST_CHECK(!hip::CanFoldCopies(src + 100, src, 100, src + 200, src + 100, 100));
+  // Overlap only in the merged range, the destination starts in the second source range
+  CLR_TEST_CHECK(!hip::CanFoldCopies(src + 150, src, 100, src + 250, src + 100, 100));
+  // Adjacent but disjoint ranges in one buffer
+  CLR_TEST_CHECK(hip::CanFoldCopies(src + 200, src, 100, src + 300, src + 100, 100));
+  CLR_TEST_CHECK(hip::CanFoldCopies(src, src + 200, 100, src + 100, src + 300, 100));
+
+  FakeGraph graph;
+  FakeNode* a = graph.AddCopy(dst, src, 1024);
+  FakeNode* b = graph.AddCopy(dst + 1024, src + 1024, 1024);
+  // Continues both ranges, but the merged ranges would overlap
+  FakeNode* c = graph.AddCopy(src + 2048, src + 1024, 1024);
+  FakeNode* d = graph.AddCopy(dst + 4096, src + 4096, 512);
+  FakeNode* e = graph.AddCopy(dst + 4608, src + 4608, 512);
+  a->AddEdgeDep(b);
+  b->AddEdgeDep(c);
+  c->AddEdgeDep(d);
+  d->AddEdgeDep(e);
+  GraphPassStats stats("MergeCopies");
+  graph_passes::MergeCopies(&graph, stats);
+  CLR_TEST_CHECK(stats.nodesFolded_ == 2);
+  CLR_TEST_CHECK((b->FoldHead() == a) && (a->count_ == 2048));
+  CLR_TEST_CHECK(!c->IsFolded() && (c->count_ == 1024));
+  CLR_TEST_CHECK((e->FoldHead() == d) && (d->count_ == 1024));
+}
+
+// ================================================================================================
+void TestFoldShape() {
+  char buffer[4096];
+  FakeGraph graph;
+  // The head fans out, so its first edge can't fold
+  FakeNode* head = graph.AddMemset(buffer, 64, 0);
+  FakeNode* left = graph.AddMemset(buffer + 64, 64, 0);
+  FakeNode* right = graph.AddMemset(buffer + 1024, 64, 0);
+  head->AddEdgeDep(left);
+  head->AddEdgeDep(right);
+  // The joined node has two dependencies
+  FakeNode* first = graph.AddMemset(buffer + 2048, 64, 0);
+  FakeNode* joined = graph.AddMemset(buffer + 2112, 64, 0);
+  FakeNode* kernel = graph.Add(kKernel);
+  first->AddEdgeDep(joined);
+  kernel->AddEdgeDep(joined);
+  // A disabled node neither heads nor joins a fold
+  FakeNode* enabled = graph.AddMemset(buffer + 3072, 64, 0);
+  FakeNode* disabled = graph.AddMemset(buffer + 3136, 64, 0);
+  FakeNode* after = graph.AddMemset(buffer + 3200, 64, 0);
+  disabled->SetEnabled(0);
+  enabled->AddEdgeDep(disabled);
+  disabled->AddEdgeDep(after);
+
+  GraphPassStats stats("MergeCopies");
+  graph_passes::MergeCopies(&graph, stats);
+  CLR_TEST_CHECK(stats.nodesFolded_ == 0);
+  for (auto node : graph.vertices_) {
+    CLR_TEST_CHECK(!node->IsFolded());
+  }
+}
+
+// ================================================================================================
+void TestTransitiveEdges() {
+  FakeGraph graph;
+  FakeNode* a = graph.Add(kKernel);
+  FakeNode* b = graph.Add(kKernel);
+  FakeNode* c = graph.Add(kKernel);
+  FakeNode* d = graph.Add(kKernel);
+  a->AddEdgeDep(b);
+  b->AddEdgeDep(c);
+  c->AddEdgeDep(d);
+  a->AddEdgeDep(c);
+  a->AddEdgeDep(d);
+  b->AddEdgeDep(d);
+  GraphPassStats stats("ReduceTransitiveEdges");
+  graph_passes::ReduceTransitiveEdges(&graph, stats);
+  CLR_TEST_CHECK(stats.edgesRemoved_ == 3);
+  CLR_TEST_CHECK(HasEdge(a, b) && HasEdge(b, c) && HasEdge(c, d));
+  CLR_TEST_CHECK(!HasEdge(a, c) && !HasEdge(a, d) && !HasEdge(b, d));
+
+  // Random DAGs: the ordering stays and no edge is implied by the others afterwards
+  std::mt19937 rng(3);
+  for (int round = 0; round < 20; ++round) {
+    FakeGraph random;
+    const size_t count = 10 + rng() % 150;
+    for (size_t i = 0; i < count; ++i) {
+      random.Add(kKernel);
+    }
+    for (size_t i = 0; i < count; ++i) {
+      for (size_t j = i + 1; j < count; ++j) {
+        if (rng() % 8 == 0) {
+          random.vertices_[i]->AddEdgeDep(random.vertices_[j]);
+        }
+      }
+    }
+    const Pairs before = Ordering(random);
+    GraphPassStats randomStats("ReduceTransitiveEdges");
+    graph_passes::ReduceTransitiveEdges(&random, randomStats);
+    CLR_TEST_CHECK(Ordering(random) == before);
+    for (auto node : random.vertices_) {
+      const std::vector<FakeNode*> edges = node->GetEdges();
+      for (auto edge : edges) {
+        node->RemoveEdgeDep(edge);
+        CLR_TEST_CHECK(Ordering(random) != before);
+        node->AddEdgeDep(edge);
+      }
+    }
+  }
+}
+
+// ================================================================================================
+void TestEmptyNodes() {
+  FakeGraph graph;
+  // Fan-out: one dependency into many edges
+  FakeNode* root = graph.Add(kKernel);
+  FakeNode* fanOut = graph.Add(kEmpty);
+  FakeNode* x = graph.Add(kKernel);
+  FakeNode* y = graph.Add(kKernel);
+  root->AddEdgeDep(fanOut);
+  fanOut->AddEdgeDep(x);
+  fanOut->AddEdgeDep(y);
+  // Fan-in: many dependencies into one edge
+  FakeNode* fanIn = graph.Add(kEmpty);
+  FakeNode* z = graph.Add(kKernel);
+  x->AddEdgeDep(fanIn);
+  y->AddEdgeDep(fanIn);
+  fanIn->AddEdgeDep(z);
+  // Join of many into many stays as one barrier
+  FakeNode* join = graph.Add(kEmpty);
+  FakeNode* u = graph.Add(kKernel);
+  FakeNode* v = graph.Add(kKernel);
+  x->AddEdgeDep(join);
+  y->AddEdgeDep(join);
+  join->AddEdgeDep(u);
+  join->AddEdgeDep(v);
+  // A dependency, which already has the edge, doesn't get a duplicate
+  FakeNode* direct = graph.Add(kEmpty);
+  root->AddEdgeDep(direct);
+  direct->AddEdgeDep(x);
+  // Isolated empty node
+  FakeNode* isolated = graph.Add(kEmpty);
+
+  const Pairs before = Ordering(graph);
+  GraphPassStats stats("EliminateEmptyNodes");
+  graph_passes::EliminateEmptyNodes(&graph, stats);
+  CLR_TEST_CHECK(Ordering(graph) == before);
+  CLR_TEST_CHECK(stats.nodesRemoved_ == 4);
+  CLR_TEST_CHECK(!InGraph(graph, fanOut) && !InGraph(graph, fanIn));
+  CLR_TEST_CHECK(!InGraph(graph, direct) && !InGraph(graph, isolated));
+  CLR_TEST_CHECK(InGraph(graph, join));
+  CLR_TEST_CHECK(graph.detached_.size() == 4);
+  CLR_TEST_CHECK(HasEdge(root, x) && HasEdge(root, y));
+  CLR_TEST_CHECK(std::count(root->GetEdges().begin(), root->GetEdges().end(), x) == 1);
+  CLR_TEST_CHECK(HasEdge(x, z) && HasEdge(y, z));
+  for (auto node : graph.detached_) {
+    CLR_TEST_CHECK(node->GetEdges().empty() && node->GetDependencies().empty());
+  }
+
+  // A graph of a single empty node keeps it
+  FakeGraph single;
+  single.Add(kEmpty);
+  GraphPassStats singleStats("EliminateEmptyNodes");
+  graph_passes::EliminateEmptyNodes(&single, singleStats);
+  CLR_TEST_CHECK(single.GetNodeCount() == 1);
+}
+
+// ================================================================================================
+void TestInlineChildGraphs() {
+  FakeGraph graph;
+  FakeNode* before = graph.Add(kKernel);
+  FakeNode* inner = nullptr;
+  FakeNode* child = graph.AddChild(kKernel, &inner);
+  FakeNode* after = graph.Add(kKernel);
+  before->AddEdgeDep(child);
+  child->AddEdgeDep(after);
+  // A child graph of an event node and a child graph of two nodes stay
+  FakeNode* eventInner = nullptr;
+  FakeNode* eventChild = graph.AddChild(kEvent, &eventInner);
+  FakeNode* pairInner = nullptr;
+  FakeNode* pairChild = graph.AddChild(kKernel, &pairInner);
+  pairChild->child_->Add(kKernel);
+
+  GraphPassStats stats("InlineChildGraphs");
+  graph_passes::InlineChildGraphs(&graph, stats);
+  CLR_TEST_CHECK(stats.nodesRemoved_ == 1);
+  CLR_TEST_CHECK(graph.vertices_[1] == inner);
+  CLR_TEST_CHECK(inner->parent_ == &graph);
+  CLR_TEST_CHECK(HasEdge(before, inner) && HasEdge(inner, after));
+  CLR_TEST_CHECK(!InGraph(graph, child) && InGraph(graph, eventChild) &&
+                 InGraph(graph, pairChild));
+  // The detached child graph node still reaches the node for the updates
+  CLR_TEST_CHECK(child->child_->vertices_[0] == inner);
+}
+
+// ================================================================================================
+//! Builds the same graph for the instantiation and the exec update
+FakeNode* BuildUpdateGraph(FakeGraph& graph, char* dst, const char* src) {
+  FakeNode* kernel = graph.Add(kKernel);
+  FakeNode* empty = graph.Add(kEmpty);
+  FakeNode* a = graph.AddCopy(dst, src, 256);
+  FakeNode* b = graph.AddCopy(dst + 256, src + 256, 256);
+  FakeNode* c = graph.AddCopy(dst + 512, src + 512, 256);
+  FakeNode* tail = graph.Add(kKernel);
+  kernel->AddEdgeDep(empty);
+  empty->AddEdgeDep(a);
+  a->AddEdgeDep(b);
+  b->AddEdgeDep(c);
+  c->AddEdgeDep(tail);
+  kernel->AddEdgeDep(tail);
+  return b;
+}
+
+void TestExecUpdate() {
+  static char src[1024];
+  static char dst[1024];
+  FakeGraph exec;
+  FakeNode* member = BuildUpdateGraph(exec, dst, src);
+  std::vector<FakeNode*> updateOrder;
+  std::vector<size_t> updateDeps;
+  CLR_TEST_CHECK(graph_passes::RecordUpdateOrder(&exec, updateOrder, updateDeps));
+  GraphPassStats inlineStats("InlineChildGraphs");
+  graph_passes::InlineChildGraphs(&exec, inlineStats);
+  GraphPassStats emptyStats("EliminateEmptyNodes");
+  graph_passes::EliminateEmptyNodes(&exec, emptyStats);
+  GraphPassStats reduceStats("ReduceTransitiveEdges");
+  graph_passes::ReduceTransitiveEdges(&exec, reduceStats);
+  GraphPassStats mergeStats("MergeCopies");
+  graph_passes::MergeCopies(&exec, mergeStats);
+  CLR_TEST_CHECK(emptyStats.nodesRemoved_ == 1);
+  CLR_TEST_CHECK(reduceStats.edgesRemoved_ == 1);
+  CLR_TEST_CHECK(mergeStats.nodesFolded_ == 2);
+  FakeNode* head = member->FoldHead();
+  CLR_TEST_CHECK((head != nullptr) && (head->count_ == 768));
+
+  // hipGraphExecUpdate() matches the new graph against the recorded order, which still
+  // holds the removed empty node and the pre-pass dependency counts
+  FakeGraph update;
+  BuildUpdateGraph(update, dst, src);
+  std::vector<FakeNode*> newOrder;
+  CLR_TEST_CHECK(update.TopologicalOrder(newOrder));
+  CLR_TEST_CHECK(newOrder.size() == updateOrder.size());
+  for (size_t i = 0; i < newOrder.size(); ++i) {
+    CLR_TEST_CHECK(newOrder[i]->kind_ == updateOrder[i]->kind_);
+    CLR_TEST_CHECK(newOrder[i]->GetDependencies().size() == updateDeps[i]);
+  }
+
+  // The update of a fold member splits the fold, the nodes recapture with their own sizes
+  const size_t index = std::find(updateOrder.begin(), updateOrder.end(), member) -
+                       updateOrder.begin();
+  CLR_TEST_CHECK(index < updateOrder.size());
+  updateOrder[index]->SetCount(128);
+  for (auto node : updateOrder) {
+    CLR_TEST_CHECK(!node->IsFolded());
+    if (node->kind_ == kCopy) {
+      CLR_TEST_CHECK(node->NeedsRecapture());
+    }
+  }
+  CLR_TEST_CHECK((head->count_ == 256) && (member->count_ == 128));
+  // The copy after the changed member doesn't continue it anymore
+  GraphPassStats again("MergeCopies");
+  graph_passes::MergeCopies(&exec, again);
+  CLR_TEST_CHECK((again.nodesFolded_ == 1) && (member->FoldHead() == head));
+
+  // Disabling the head splits the fold as well
+  head->SetEnabled(0);
+  CLR_TEST_CHECK(!member->IsFolded() && (head->count_ == 256));
+}
+
+}  // namespace
+
+int main() {
+  TestFoldMemsets();
+  TestFoldCopies();
+  TestFoldShape();
+  TestTransitiveEdges();
+  TestEmptyNodes();
+  TestInlineChildGraphs();
+  TestExecUpdate();
+
+  std::printf("graph passes: passed\n");
+  return 0;
+}
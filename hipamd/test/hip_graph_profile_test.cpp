@@ -0,0 +1,131 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Feeds synthetic launch timestamps of a diamond graph into the graph profile and checks the
+// aggregated node timings, the stream utilization and idle gaps, and the critical path.
+
+#include "hip_graph_profile.hpp"
+#include "clr_test_common.hpp"
+
+#include <sstream>
+
+using hip::GraphProfile;
+using hip::GraphProfileSample;
+
+namespace {
+
+//! Diamond graph 10 -> {11, 12} -> 13, the indices of the nodes are 0 to 3
+GraphProfile MakeDiamond() {
+  std::vector<GraphProfile::NodeInfo> nodes(4);
+  nodes[0] = {10, "KERNEL", "first", {1, 2}};
+  nodes[1] = {11, "KERNEL", "left", {3}};
+  nodes[2] = {12, "MEMCPY", "", {3}};
+  nodes[3] = {13, "KERNEL", "last", {}};
+  return GraphProfile(std::move(nodes));
+}
+
+bool Contains(const std::string& text, const std::string& pattern) {
+  return text.find(pattern) != std::string::npos;
+}
+
+void TestAggregation() {
+  GraphProfile profile = MakeDiamond();
+  // Node 11 takes 400 and 600 ns, the gap before node 13 on stream 0 is 100 ns in the first
+  // launch and none in the second
+  profile.AddLaunch({{0, 0, 900, 1000, 1100, 10},
+                     {1, 0, 1000, 1100, 1500, 20},
+                     {2, 1, 1000, 1150, 1350, 30},
+                     {3, 0, 1500, 1600, 1700, 40}},
+                    1000);
+  profile.AddLaunch({{0, 0, 1900, 2000, 2100, 10},
+                     {1, 0, 2000, 2100, 2700, 20},
+                     {2, 1, 2000, 2100, 2300, 30},
+                     {3, 0, 2600, 2700, 2800, 40}},
+                    2000);
+  // A launch without the timestamps counts for the host times only
+  profile.AddLaunch({{0, 0, 0, 0, 0, 10}, {1, 0, 0, 0, 0, 20}}, 3000);
+  CLR_TEST_CHECK(profile.Launches() == 3);
+
+  uint64_t lengthNs = 0;
+  std::vector<size_t> path = profile.CriticalPath(&lengthNs);
+  CLR_TEST_CHECK((path == std::vector<size_t>{0, 1, 3}));
+  CLR_TEST_CHECK(lengthNs == 100 + 500 + 100);
+
+  std::ostringstream json;
+  profile.WriteJson(json);
+  const std::string report = json.str();
+  CLR_TEST_CHECK(Contains(report, "{\"launches\":3,\"meanSpanNs\":750,\"meanHostNs\":2000,"));
+  CLR_TEST_CHECK(Contains(report, "{\"id\":11,\"type\":\"KERNEL\",\"name\":\"left\","
+                                  "\"samples\":2,\"meanGpuNs\":500,\"minGpuNs\":400,"
+                                  "\"maxGpuNs\":600,\"meanHostNs\":20,\"meanLatencyNs\":100,"
+                                  "\"critical\":true,\"edges\":[13]}"));
+  CLR_TEST_CHECK(Contains(report, "{\"id\":12,\"type\":\"MEMCPY\",\"name\":\"\","
+                                  "\"samples\":2,\"meanGpuNs\":200,\"minGpuNs\":200,"
+                                  "\"maxGpuNs\":200,\"meanHostNs\":20,\"meanLatencyNs\":125,"
+                                  "\"critical\":false,\"edges\":[13]}"));
+  // Stream 0 is busy 600 + 800 of 1500 ns, stream 1 is busy 400 ns
+  CLR_TEST_CHECK(Contains(report, "{\"index\":0,\"launches\":2,\"utilization\":0.933333,"
+                                  "\"meanIdleNs\":50,\"maxIdleNs\":100}"));
+  CLR_TEST_CHECK(Contains(report, "{\"index\":1,\"launches\":2,\"utilization\":0.266667,"
+                                  "\"meanIdleNs\":0,\"maxIdleNs\":0}"));
+  CLR_TEST_CHECK(Contains(report, "\"criticalPath\":{\"lengthNs\":700,\"nodes\":[10,11,13]}"));
+
+  std::ostringstream dot;
+  profile.WriteDot(dot);
+  CLR_TEST_CHECK(Contains(dot.str(), "node_10 -> node_11 [color=red, penwidth=2];"));
+  CLR_TEST_CHECK(Contains(dot.str(), "node_10 -> node_12;"));
+  CLR_TEST_CHECK(Contains(dot.str(), "node_11 -> node_13 [color=red, penwidth=2];"));
+}
+
+void TestCriticalPathMoves() {
+  GraphProfile profile = MakeDiamond();
+  // The memcpy branch overtakes the kernel branch
+  profile.AddLaunch({{0, 0, 0, 100, 200, 0},
+                     {1, 0, 0, 200, 300, 0},
+                     {2, 1, 0, 200, 1200, 0},
+                     {3, 0, 0, 1200, 1250, 0}},
+                    0);
+  uint64_t lengthNs = 0;
+  std::vector<size_t> path = profile.CriticalPath(&lengthNs);
+  CLR_TEST_CHECK((path == std::vector<size_t>{0, 2, 3}));
+  CLR_TEST_CHECK(lengthNs == 100 + 1000 + 50);
+}
+
+void TestEmptyProfile() {
+  GraphProfile profile = MakeDiamond();
+  uint64_t lengthNs = 1;
+  std::vector<size_t> path = profile.CriticalPath(&lengthNs);
+  // Without the timings every node has zero duration, the path still ends in a node
+  CLR_TEST_CHECK(!path.empty());
+  CLR_TEST_CHECK(lengthNs == 0);
+  CLR_TEST_CHECK(profile.Launches() == 0);
+}
+
+}  // namespace
+
+int main() {
+  TestAggregation();
+  TestCriticalPathMoves();
+  TestEmptyProfile();
+
+  std::printf("graph profile: passed\n");
+  return 0;
+}
@@ -0,0 +1,174 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Compares the bulk host conversions of every instruction set, which the CPU supports, with the
+// scalar reference routines. All fp16, bf16 and fp8 encodings are decoded, the fp32 encodes run
+// over the rounding boundaries of every 16 bit pattern and a strided sweep of all fp32 values.
+
+#include "hip_host_convert.hpp"
+#include "clr_test_common.hpp"
+
+#include <vector>
+
+using namespace hip::hostcvt;
+
+namespace {
+
+const char* IsaName(Isa isa) {
+  switch (isa) {
+    case Isa::Avx2:
+      return "avx2";
+    case Isa::Avx512:
+      return "avx512";
+    default:
+      return "scalar";
+  }
+}
+
+//! Fp32 encodings around the rounding boundaries of fp16 and bf16: every high half with the low
+//! halves of the ties, their neighbours and the NaN payloads, then a strided sweep of all values
+std::vector<uint32_t> Fp32Inputs() {
+  static const uint32_t kLow[] = {0x0000, 0x0001, 0x0fff, 0x1000, 0x1001, 0x2000, 0x3000,
+                                  0x7fff, 0x8000, 0x8001, 0xefff, 0xf000, 0xffff};
+  std::vector<uint32_t> inputs;
+  for (uint32_t high = 0; high <= 0xffff; ++high) {
+    for (uint32_t low : kLow) {
+      inputs.push_back((high << 16) | low);
+    }
+  }
+  for (uint64_t bits = 0; bits <= 0xffffffffull; bits += 509) {
+    inputs.push_back(static_cast<uint32_t>(bits));
+  }
+  return inputs;
+}
+
+//! Decodes all 16 bit patterns, starting at an odd element to cover the unaligned tails
+void TestDecode16(Isa isa, Format format, float (*reference)(uint16_t)) {
+  std::vector<uint16_t> src(0x10000 + 1);
+  for (uint32_t i = 0; i <= 0xffff; ++i) {
+    src[i + 1] = static_cast<uint16_t>(i);
+  }
+  std::vector<float> dst(src.size());
+  CLR_TEST_CHECK(Convert(isa, dst.data() + 1, Format::F32, src.data() + 1, format, 0x10000,
+                         false));
+  for (uint32_t i = 0; i <= 0xffff; ++i) {
+    const uint32_t expected = F32AsU32(reference(static_cast<uint16_t>(i)));
+    if (F32AsU32(dst[i + 1]) != expected) {
+      std::fprintf(stderr, "%s: decode of 0x%04x gives 0x%08x, expected 0x%08x\n",
+                   IsaName(isa), i, F32AsU32(dst[i + 1]), expected);
+      CLR_TEST_CHECK(false);
+    }
+  }
+}
+
+void TestEncode16(Isa isa, Format format, const std::vector<uint32_t>& inputs,
+                  uint16_t (*reference)(float)) {
+  std::vector<float> src(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    src[i] = U32AsF32(inputs[i]);
+  }
+  // Convert in uneven pieces, so every vector path also runs its scalar tail
+  std::vector<uint16_t> dst(src.size());
+  size_t offset = 0;
+  for (size_t piece = 1; offset < src.size(); piece = (piece * 7 + 3) % 97 + 1) {
+    const size_t count = std::min(piece, src.size() - offset);
+    CLR_TEST_CHECK(Convert(isa, dst.data() + offset, format, src.data() + offset, Format::F32,
+                           count, false));
+    offset += count;
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const uint16_t expected = reference(src[i]);
+    if (dst[i] != expected) {
+      std::fprintf(stderr, "%s: encode of 0x%08x gives 0x%04x, expected 0x%04x\n",
+                   IsaName(isa), inputs[i], dst[i], expected);
+      CLR_TEST_CHECK(false);
+    }
+  }
+}
+
+float HalfReference(uint16_t h) { return HalfToFloat(h); }
+uint16_t HalfEncodeReference(float f) { return static_cast<uint16_t>(FloatToHalf(f)); }
+
+void TestFp8(Isa isa, Format format, const std::vector<uint32_t>& inputs) {
+  int we, wm;
+  bool fnuz;
+  Fp8Layout(format, &we, &wm, &fnuz);
+
+  uint8_t codes[256];
+  float values[256];
+  for (uint32_t i = 0; i < 256; ++i) {
+    codes[i] = static_cast<uint8_t>(i);
+  }
+  CLR_TEST_CHECK(Convert(isa, values, Format::F32, codes, format, 256, false));
+  for (uint32_t i = 0; i < 256; ++i) {
+    const float expected = Fp8ToFloat(codes[i], wm, we, fnuz);
+    CLR_TEST_CHECK(F32AsU32(values[i]) == F32AsU32(expected));
+  }
+
+  for (bool saturate : {false, true}) {
+    // Every finite encoding survives the round trip
+    uint8_t encoded[256];
+    CLR_TEST_CHECK(Convert(isa, encoded, format, values, Format::F32, 256, saturate));
+    for (uint32_t i = 0; i < 256; ++i) {
+      if (values[i] == values[i] && F32AsU32(values[i]) != 0x7f800000 &&
+          F32AsU32(values[i]) != 0xff800000) {
+        CLR_TEST_CHECK(encoded[i] == FloatToFp8(values[i], wm, we, fnuz, saturate));
+        CLR_TEST_CHECK((encoded[i] == codes[i]) || (values[i] == 0));
+      }
+    }
+    std::vector<float> src(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      src[i] = U32AsF32(inputs[i]);
+    }
+    std::vector<uint8_t> dst(src.size());
+    CLR_TEST_CHECK(Convert(isa, dst.data(), format, src.data(), Format::F32, src.size(),
+                           saturate));
+    for (size_t i = 0; i < src.size(); ++i) {
+      CLR_TEST_CHECK(dst[i] == FloatToFp8(src[i], wm, we, fnuz, saturate));
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  const std::vector<uint32_t> inputs = Fp32Inputs();
+  for (Isa isa : {Isa::Scalar, Isa::Avx2, Isa::Avx512}) {
+    if (!IsaSupported(isa)) {
+      std::printf("%s: not supported, skipped\n", IsaName(isa));
+      continue;
+    }
+    TestDecode16(isa, Format::F16, HalfReference);
+    TestDecode16(isa, Format::BF16, Bf16ToFloat);
+    TestEncode16(isa, Format::F16, inputs, HalfEncodeReference);
+    TestEncode16(isa, Format::BF16, inputs, FloatToBf16);
+    for (Format format : {Format::E4M3, Format::E5M2, Format::E4M3Fnuz, Format::E5M2Fnuz}) {
+      TestFp8(isa, format, inputs);
+    }
+    std::printf("%s: passed\n", IsaName(isa));
+  }
+  // The unsupported pairs are rejected
+  float f = 0;
+  uint16_t h = 0;
+  CLR_TEST_CHECK(!Convert(Isa::Scalar, &h, Format::BF16, &h, Format::F16, 1, false));
+  CLR_TEST_CHECK(!Convert(Isa::Scalar, &f, Format::F32, &f, Format::Invalid, 1, false));
+  return 0;
+}
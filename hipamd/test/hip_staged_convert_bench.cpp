@@ -0,0 +1,124 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Measures the host side of hipExtMemcpyHtoDConvert. The fused path converts while it fills
+// the staging buffer, the two-step path converts into a temporary buffer first and uploads it
+// like hipMemcpy. The copy engine is a memcpy into the simulated device memory, so the numbers
+// are the host bandwidth in source bytes per second, without the DMA of a real device.
+//
+// Usage: hip_staged_convert_bench [source MiB] [staging KiB] [iterations]
+
+#include "device/devstaging.hpp"
+#include "hip_host_convert.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace hip::hostcvt;
+
+namespace {
+
+//! Copy engine, which copies the staged chunk right away
+class MemcpyEngine {
+ public:
+  explicit MemcpyEngine(uint8_t* device) : device_(device) {}
+  void Begin() {}
+  void Abort() {}
+  bool Copy(size_t offset, const void* src, size_t size) {
+    std::memcpy(device_ + offset, src, size);
+    return true;
+  }
+  void Wait() {}
+
+ private:
+  uint8_t* device_;   //!< Simulated device memory
+};
+
+bool ConvertChunk(void* dst, const void* src, size_t count,
+                  const amd::CopyConversion& conversion) {
+  return Convert(BestIsa(), dst, static_cast<Format>(conversion.dstFormat_), src,
+                 static_cast<Format>(conversion.srcFormat_), count, conversion.flags_ != 0);
+}
+
+template <typename F> double BestSeconds(uint32_t iterations, F run) {
+  double best = 1e30;
+  for (uint32_t i = 0; i < iterations; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+void Run(const char* name, Format dstFormat, size_t srcBytes, size_t stagingSize,
+         uint32_t iterations) {
+  const size_t count = srcBytes / FormatSize(Format::F32);
+  const size_t dstBytes = count * FormatSize(dstFormat);
+  std::vector<float> src(count);
+  for (size_t i = 0; i < count; ++i) {
+    src[i] = static_cast<float>(i % 4093) * 0.37f - 700.0f;
+  }
+  std::vector<uint8_t> device(dstBytes);
+  std::vector<uint8_t> staging(stagingSize);
+  std::vector<uint8_t> temporary(dstBytes);
+
+  amd::CopyConversion conversion;
+  conversion.convert_ = ConvertChunk;
+  conversion.srcFormat_ = static_cast<uint32_t>(Format::F32);
+  conversion.dstFormat_ = static_cast<uint32_t>(dstFormat);
+  conversion.srcElementSize_ = static_cast<uint32_t>(FormatSize(Format::F32));
+  conversion.dstElementSize_ = static_cast<uint32_t>(FormatSize(dstFormat));
+
+  MemcpyEngine engine(device.data());
+  const double twoStep = BestSeconds(iterations, [&]() {
+    Convert(BestIsa(), temporary.data(), dstFormat, src.data(), Format::F32, count, false);
+    amd::device::StagedUpload(engine, temporary.data(), dstBytes, staging.data(), stagingSize,
+                              nullptr);
+  });
+  const double fused = BestSeconds(iterations, [&]() {
+    amd::device::StagedUpload(engine, src.data(), dstBytes, staging.data(), stagingSize,
+                              &conversion);
+  });
+  const double gb = static_cast<double>(count * sizeof(float)) / 1e9;
+  std::printf("%-6s two-step %7.2f GB/s   fused %7.2f GB/s   speedup %.2fx\n", name,
+              gb / twoStep, gb / fused, twoStep / fused);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t srcMiB = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 256;
+  const size_t stagingKiB = (argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 1024;
+  const uint32_t iterations = (argc > 3) ? std::strtoul(argv[3], nullptr, 0) : 5;
+  const size_t srcBytes = srcMiB << 20;
+  const size_t stagingSize = stagingKiB << 10;
+
+  std::printf("fp32 source %zu MiB, staging %zu KiB, best of %u\n", srcMiB, stagingKiB,
+              iterations);
+  Run("fp16", Format::F16, srcBytes, stagingSize, iterations);
+  Run("bf16", Format::BF16, srcBytes, stagingSize, iterations);
+  Run("e4m3", Format::E4M3, srcBytes, stagingSize, iterations);
+  Run("e5m2", Format::E5M2, srcBytes, stagingSize, iterations);
+  return 0;
+}
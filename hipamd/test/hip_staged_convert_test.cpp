@@ -0,0 +1,204 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Runs the staged host to device upload with the host conversions over a simulated copy engine.
+// The engine copies a chunk out of the staging buffer only when the upload waits for it, so a
+// refill of the staging buffer before the wait shows up as corrupted device data.
+
+#include "device/devstaging.hpp"
+#include "hip_host_convert.hpp"
+#include "clr_test_common.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace hip::hostcvt;
+
+namespace {
+
+//! Copy engine, which defers every chunk copy until the upload waits for it
+class DeferredCopyEngine {
+ public:
+  explicit DeferredCopyEngine(size_t size) : device_(size, 0xcd) {}
+
+  void Begin() {
+    // The staging buffer is refilled after Begin(), so the previous copy must be done
+    CLR_TEST_CHECK(!pending_);
+    CLR_TEST_CHECK(!begun_);
+    begun_ = true;
+  }
+  void Abort() {
+    CLR_TEST_CHECK(begun_);
+    begun_ = false;
+    ++aborts_;
+  }
+  bool Copy(size_t offset, const void* src, size_t size) {
+    CLR_TEST_CHECK(begun_);
+    CLR_TEST_CHECK(offset + size <= device_.size());
+    begun_ = false;
+    pending_ = true;
+    offset_ = offset;
+    src_ = static_cast<const uint8_t*>(src);
+    size_ = size;
+    ++copies_;
+    return true;
+  }
+  void Wait() {
+    if (pending_) {
+      std::copy(src_, src_ + size_, device_.begin() + offset_);
+      pending_ = false;
+    }
+  }
+
+  const std::vector<uint8_t>& device() const { return device_; }
+  size_t copies() const { return copies_; }
+  size_t aborts() const { return aborts_; }
+
+ private:
+  std::vector<uint8_t> device_;   //!< Simulated device memory
+  bool begun_ = false;            //!< Begin() was called for the next chunk
+  bool pending_ = false;          //!< A chunk copy is queued
+  size_t offset_ = 0;             //!< Device offset of the queued copy
+  const uint8_t* src_ = nullptr;  //!< Staging memory of the queued copy
+  size_t size_ = 0;               //!< Size of the queued copy
+  size_t copies_ = 0;             //!< Number of queued copies
+  size_t aborts_ = 0;             //!< Number of aborted chunks
+};
+
+bool ConvertChunk(void* dst, const void* src, size_t count,
+                  const amd::CopyConversion& conversion) {
+  return Convert(BestIsa(), dst, static_cast<Format>(conversion.dstFormat_), src,
+                 static_cast<Format>(conversion.srcFormat_), count, conversion.flags_ != 0);
+}
+
+//! Fails the conversion of the third chunk
+size_t convertCalls = 0;
+bool FailingChunk(void* dst, const void* src, size_t count,
+                  const amd::CopyConversion& conversion) {
+  return (++convertCalls != 3) && ConvertChunk(dst, src, count, conversion);
+}
+
+amd::CopyConversion MakeConversion(Format dstFormat, Format srcFormat, bool saturate) {
+  amd::CopyConversion conversion;
+  conversion.convert_ = ConvertChunk;
+  conversion.srcFormat_ = static_cast<uint32_t>(srcFormat);
+  conversion.dstFormat_ = static_cast<uint32_t>(dstFormat);
+  conversion.flags_ = saturate ? 1 : 0;
+  conversion.srcElementSize_ = static_cast<uint32_t>(FormatSize(srcFormat));
+  conversion.dstElementSize_ = static_cast<uint32_t>(FormatSize(dstFormat));
+  return conversion;
+}
+
+//! Host data with a mix of normal, tiny, huge and special values of the source format
+std::vector<uint8_t> SourceData(Format format, size_t count) {
+  std::vector<uint8_t> data(count * FormatSize(format));
+  uint32_t state = 0x12345678;
+  for (size_t i = 0; i < count; ++i) {
+    state = state * 1664525u + 1013904223u;
+    if (format == Format::F32) {
+      const float value = U32AsF32(state);
+      std::memcpy(&data[i * sizeof(float)], &value, sizeof(float));
+    } else if (FormatSize(format) == sizeof(uint16_t)) {
+      const uint16_t value = static_cast<uint16_t>(state >> 16);
+      std::memcpy(&data[i * sizeof(uint16_t)], &value, sizeof(uint16_t));
+    } else {
+      data[i] = static_cast<uint8_t>(state >> 24);
+    }
+  }
+  return data;
+}
+
+void TestUpload(Format dstFormat, Format srcFormat, bool saturate, size_t count,
+                size_t stagingSize) {
+  const amd::CopyConversion conversion = MakeConversion(dstFormat, srcFormat, saturate);
+  const std::vector<uint8_t> src = SourceData(srcFormat, count);
+  const size_t size = count * FormatSize(dstFormat);
+
+  std::vector<uint8_t> expected(size);
+  CLR_TEST_CHECK(Convert(Isa::Scalar, expected.data(), dstFormat, src.data(), srcFormat, count,
+                         saturate));
+
+  std::vector<uint8_t> staging(stagingSize);
+  DeferredCopyEngine engine(size);
+  CLR_TEST_CHECK(amd::device::StagedUpload(engine, src.data(), size, staging.data(),
+                                           stagingSize, &conversion));
+  engine.Wait();
+  // The chunks hold whole elements
+  const size_t chunk = stagingSize - stagingSize % FormatSize(dstFormat);
+  CLR_TEST_CHECK(engine.copies() == (size + chunk - 1) / chunk);
+  CLR_TEST_CHECK(engine.device() == expected);
+}
+
+void TestPlainUpload(size_t size, size_t stagingSize) {
+  const std::vector<uint8_t> src = SourceData(Format::E4M3, size);
+  std::vector<uint8_t> staging(stagingSize);
+  DeferredCopyEngine engine(size);
+  CLR_TEST_CHECK(amd::device::StagedUpload(engine, src.data(), size, staging.data(),
+                                           stagingSize, nullptr));
+  engine.Wait();
+  CLR_TEST_CHECK(engine.device() == src);
+}
+
+void TestFailedConversion() {
+  const size_t count = 1000;
+  const size_t stagingSize = 256;
+  amd::CopyConversion conversion = MakeConversion(Format::F16, Format::F32, false);
+  conversion.convert_ = FailingChunk;
+  const std::vector<uint8_t> src = SourceData(Format::F32, count);
+
+  std::vector<uint8_t> staging(stagingSize);
+  DeferredCopyEngine engine(count * sizeof(uint16_t));
+  CLR_TEST_CHECK(!amd::device::StagedUpload(engine, src.data(), count * sizeof(uint16_t),
+                                            staging.data(), stagingSize, &conversion));
+  CLR_TEST_CHECK(engine.copies() == 2);
+  CLR_TEST_CHECK(engine.aborts() == 1);
+}
+
+}  // namespace
+
+int main() {
+  // The odd sizes aren't multiples of the converted element sizes
+  static const size_t kStagingSizes[] = {64, 256, 1001, 4096, 4098, 1 << 20};
+  static const size_t kCounts[] = {1, 17, 1000, 100003};
+  static const struct {
+    Format dst_;
+    Format src_;
+    bool saturate_;
+  } kFormats[] = {
+      {Format::F16, Format::F32, false},  {Format::BF16, Format::F32, false},
+      {Format::E4M3, Format::F32, true},  {Format::E4M3, Format::F32, false},
+      {Format::E5M2Fnuz, Format::F32, true}, {Format::F32, Format::F16, false},
+      {Format::F32, Format::BF16, false}, {Format::F32, Format::E5M2, false},
+  };
+
+  for (size_t stagingSize : kStagingSizes) {
+    for (size_t count : kCounts) {
+      for (const auto& format : kFormats) {
+        TestUpload(format.dst_, format.src_, format.saturate_, count, stagingSize);
+      }
+      TestPlainUpload(count * 3, stagingSize);
+    }
+  }
+  TestFailedConversion();
+
+  std::printf("staged upload: passed\n");
+  return 0;
+}
@@ -0,0 +1,247 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+// Measures the stream state queries of hip::Device with 1, 100 and 1000 streams. The legacy
+// device locked streamSetLock and scanned the stream set on every StreamCaptureBlocking() and
+// existsActiveStreamForDevice() call, the counter device keeps the two counters of
+// hip::Device, which AddStream(), RemoveStream() and the capture transitions update under the
+// lock. The streams are the parts of hip::Stream the queries read, since the runtime needs a
+// device. The query workload has no capturing stream and only the last stream active, which
+// is the common case of the legacy null stream and the worst case of the scan. The stream
+// churn and capture workloads report the cost the counters add on the state transitions.
+//
+// Usage: hip_stream_state_bench [iterations]
+
+#include "thread/monitor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+enum CaptureStatus { kCaptureNone, kCaptureActive, kCaptureInvalidated };
+constexpr unsigned int kNonBlocking = 1;
+
+struct Stream {
+  std::atomic<CaptureStatus> captureStatus_{kCaptureNone};
+  unsigned int flags_ = 0;
+  std::atomic<bool> isActive_{false};
+  bool registered_ = false;
+
+  bool IsBlockingCapture() const {
+    return (captureStatus_ == kCaptureActive) && (flags_ != kNonBlocking);
+  }
+};
+
+//! The stream set of the old device, the queries scan it under the lock
+class LegacyDevice {
+ public:
+  void AddStream(Stream* stream) {
+    amd::ScopedLock lock(streamSetLock_);
+    streamSet_.insert(stream);
+  }
+
+  void RemoveStream(Stream* stream) {
+    amd::ScopedLock lock(streamSetLock_);
+    streamSet_.erase(stream);
+  }
+
+  void SetStreamCaptureStatus(Stream* stream, CaptureStatus captureStatus) {
+    stream->captureStatus_ = captureStatus;
+  }
+
+  bool StreamCaptureBlocking() {
+    amd::ScopedLock lock(streamSetLock_);
+    for (auto& it : streamSet_) {
+      if (it->captureStatus_ == kCaptureActive && it->flags_ != kNonBlocking) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool existsActiveStreamForDevice() {
+    amd::ScopedLock lock(streamSetLock_);
+    for (const auto& active_stream : streamSet_) {
+      if (active_stream->isActive_) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  amd::Monitor streamSetLock_{};
+  std::unordered_set<Stream*> streamSet_;
+};
+
+//! The stream set and the state counters of hip::Device
+class CounterDevice {
+ public:
+  void AddStream(Stream* stream) {
+    amd::ScopedLock lock(streamSetLock_);
+    if (streamSet_.insert(stream).second) {
+      stream->registered_ = true;
+      if (stream->IsBlockingCapture()) {
+        ++blockingCaptureStreams_;
+      }
+      if (stream->isActive_) {
+        ++activeStreams_;
+      }
+    }
+  }
+
+  void RemoveStream(Stream* stream) {
+    amd::ScopedLock lock(streamSetLock_);
+    if (streamSet_.erase(stream) != 0) {
+      stream->registered_ = false;
+      if (stream->IsBlockingCapture()) {
+        --blockingCaptureStreams_;
+      }
+      if (stream->isActive_) {
+        --activeStreams_;
+      }
+    }
+  }
+
+  void SetStreamCaptureStatus(Stream* stream, CaptureStatus captureStatus) {
+    amd::ScopedLock lock(streamSetLock_);
+    const bool blocking = stream->IsBlockingCapture();
+    stream->captureStatus_ = captureStatus;
+    if (stream->registered_ && (blocking != stream->IsBlockingCapture())) {
+      if (blocking) {
+        --blockingCaptureStreams_;
+      } else {
+        ++blockingCaptureStreams_;
+      }
+    }
+  }
+
+  bool StreamCaptureBlocking() const { return blockingCaptureStreams_.load() != 0; }
+
+  bool existsActiveStreamForDevice() const { return activeStreams_.load() != 0; }
+
+ private:
+  amd::Monitor streamSetLock_{};
+  std::unordered_set<Stream*> streamSet_;
+  std::atomic<uint32_t> blockingCaptureStreams_{0};
+  std::atomic<uint32_t> activeStreams_{0};
+};
+
+typedef std::vector<std::unique_ptr<Stream>> Streams;
+
+Streams MakeStreams(size_t count) {
+  Streams streams;
+  for (size_t ii = 0; ii < count; ++ii) {
+    streams.emplace_back(new Stream);
+  }
+  streams.back()->isActive_ = true;
+  return streams;
+}
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+//! Returns ns per pair of queries, the pair a legacy null stream operation makes
+template <typename Device>
+double Query(size_t numStreams, size_t iterations, size_t* hits) {
+  Device device;
+  Streams streams = MakeStreams(numStreams);
+  for (auto& stream : streams) {
+    device.AddStream(stream.get());
+  }
+  size_t count = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < iterations; ++ii) {
+    count += device.StreamCaptureBlocking() ? 1 : 0;
+    count += device.existsActiveStreamForDevice() ? 1 : 0;
+  }
+  const double seconds = Seconds(start);
+  *hits = count;
+  return seconds * 1e9 / iterations;
+}
+
+//! Returns ns per stream creation and destruction next to the other streams
+template <typename Device>
+double Churn(size_t numStreams, size_t iterations) {
+  Device device;
+  Streams streams = MakeStreams(numStreams);
+  for (auto& stream : streams) {
+    device.AddStream(stream.get());
+  }
+  Stream extra;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < iterations; ++ii) {
+    device.AddStream(&extra);
+    device.RemoveStream(&extra);
+  }
+  return Seconds(start) * 1e9 / iterations;
+}
+
+//! Returns ns per capture begin and end on one of the streams
+template <typename Device>
+double Capture(size_t numStreams, size_t iterations) {
+  Device device;
+  Streams streams = MakeStreams(numStreams);
+  for (auto& stream : streams) {
+    device.AddStream(stream.get());
+  }
+  Stream* stream = streams.front().get();
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < iterations; ++ii) {
+    device.SetStreamCaptureStatus(stream, kCaptureActive);
+    device.SetStreamCaptureStatus(stream, kCaptureNone);
+  }
+  return Seconds(start) * 1e9 / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t iterations = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 100000;
+
+  std::printf("%zu iterations, ns per operation\n", iterations);
+  std::printf("%-8s %10s %10s %10s %10s %10s %10s\n", "streams", "query", "query", "churn",
+              "churn", "capture", "capture");
+  std::printf("%-8s %10s %10s %10s %10s %10s %10s\n", "", "legacy", "counter", "legacy",
+              "counter", "legacy", "counter");
+  for (size_t numStreams : {1, 100, 1000}) {
+    size_t legacyHits, counterHits;
+    const double legacyQuery = Query<LegacyDevice>(numStreams, iterations, &legacyHits);
+    const double counterQuery = Query<CounterDevice>(numStreams, iterations, &counterHits);
+    if (legacyHits != counterHits) {
+      std::fprintf(stderr, "The queries disagree with %zu streams\n", numStreams);
+      return 1;
+    }
+    std::printf("%-8zu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", numStreams, legacyQuery,
+                counterQuery, Churn<LegacyDevice>(numStreams, iterations),
+                Churn<CounterDevice>(numStreams, iterations),
+                Capture<LegacyDevice>(numStreams, iterations),
+                Capture<CounterDevice>(numStreams, iterations));
+  }
+  return 0;
+}
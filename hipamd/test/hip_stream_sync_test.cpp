@@ -0,0 +1,141 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+// Finishes fake queues the way hip::Device::SyncAllStreams() finishes the streams. Every
+// marker must be submitted before the first wait, the waits must follow the queue order, and
+// the queues must drain in parallel, so the sync takes about as long as the slowest queue.
+
+#include "hip_stream_sync.hpp"
+#include "clr_test_common.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+enum Step { kSubmit, kWait };
+
+struct LogEntry {
+  Step step_;
+  size_t queue_;
+};
+
+//! Completion marker of a fake queue, the queue drains by the end time
+struct Marker {
+  Clock::time_point end_;
+  bool waited_ = false;
+};
+
+//! Queue, which starts to drain when the finish marker is submitted
+class FakeQueue {
+ public:
+  FakeQueue(size_t index, std::chrono::milliseconds busy, std::vector<LogEntry>* log)
+      : index_(index), busy_(busy), log_(log) {}
+
+  Marker* submitFinish(bool cpu_wait) {
+    CLR_TEST_CHECK(cpu_wait);
+    if (busy_.count() == 0) {
+      return nullptr;
+    }
+    log_->push_back({kSubmit, index_});
+    marker_.end_ = Clock::now() + busy_;
+    return &marker_;
+  }
+
+  void completeFinish(Marker* marker, bool cpu_wait) {
+    CLR_TEST_CHECK(cpu_wait);
+    if (marker == nullptr) {
+      return;
+    }
+    CLR_TEST_CHECK(marker == &marker_);
+    std::this_thread::sleep_until(marker->end_);
+    marker->waited_ = true;
+    log_->push_back({kWait, index_});
+  }
+
+  bool Idle() const { return busy_.count() == 0; }
+  bool Finished() const { return marker_.waited_; }
+
+ private:
+  size_t index_;
+  std::chrono::milliseconds busy_;
+  std::vector<LogEntry>* log_;
+  Marker marker_;
+};
+
+void TestOrderAndTiming() {
+  constexpr size_t kNumQueues = 8;
+  constexpr std::chrono::milliseconds kBusy(50);
+  std::vector<LogEntry> log;
+  std::vector<FakeQueue> storage;
+  storage.reserve(kNumQueues);
+  for (size_t ii = 0; ii < kNumQueues; ++ii) {
+    // Every third queue is idle and has no marker to wait for
+    storage.emplace_back(ii, (ii % 3 == 1) ? std::chrono::milliseconds(0) : kBusy, &log);
+  }
+  std::vector<FakeQueue*> queues;
+  for (auto& queue : storage) {
+    queues.push_back(&queue);
+  }
+
+  const auto start = Clock::now();
+  hip::FinishQueues(queues, true);
+  const auto elapsed = Clock::now() - start;
+
+  size_t busyQueues = 0;
+  for (const auto& queue : storage) {
+    CLR_TEST_CHECK(queue.Idle() || queue.Finished());
+    busyQueues += queue.Idle() ? 0 : 1;
+  }
+  CLR_TEST_CHECK(log.size() == 2 * busyQueues);
+  // All submissions first, then the waits, both in the queue order
+  for (size_t ii = 0; ii < log.size(); ++ii) {
+    CLR_TEST_CHECK(log[ii].step_ == ((ii < busyQueues) ? kSubmit : kWait));
+    if (ii % busyQueues != 0) {
+      CLR_TEST_CHECK(log[ii].queue_ > log[ii - 1].queue_);
+    }
+  }
+  // One drain of the slowest queue, sequential finishes would take one per busy queue
+  CLR_TEST_CHECK(elapsed >= kBusy);
+  CLR_TEST_CHECK(elapsed < kBusy * busyQueues / 2);
+}
+
+void TestIdle() {
+  std::vector<LogEntry> log;
+  FakeQueue idle(0, std::chrono::milliseconds(0), &log);
+  std::vector<FakeQueue*> queues = {&idle, &idle};
+  hip::FinishQueues(queues, true);
+  CLR_TEST_CHECK(log.empty());
+  queues.clear();
+  hip::FinishQueues(queues, true);
+}
+
+}  // namespace
+
+int main() {
+  TestOrderAndTiming();
+  TestIdle();
+
+  std::printf("stream sync: passed\n");
+  return 0;
+}
@@ -30,6 +30,7 @@ option(ROCCLR_ENABLE_HSAIL "Enable support for HSAIL compiler" OFF)
 option(ROCCLR_ENABLE_LC    "Enable support for LC compiler"    ON)
 option(ROCCLR_ENABLE_HSA   "Enable support for HSA runtime"    ON)
 option(ROCCLR_ENABLE_PAL   "Enable support for PAL runtime"    OFF)
+option(ROCCLR_FUTEX_MONITOR "Use the inline futex monitor for amd::Monitor on Linux" OFF)
 
 if((NOT ROCCLR_ENABLE_HSAIL) AND (NOT ROCCLR_ENABLE_LC))
   message(FATAL "Support for at least one compiler needs to be enabled!")
@@ -115,6 +116,10 @@ target_compile_definitions(rocclr PUBLIC
   LITTLEENDIAN_CPU
   ${AMD_OPENCL_DEFS})
 
+if(ROCCLR_FUTEX_MONITOR)
+  target_compile_definitions(rocclr PUBLIC ROCCLR_FUTEX_MONITOR)
+endif()
+
 target_include_directories(rocclr PUBLIC
   ${ROCCLR_SRC_DIR}
   ${ROCCLR_SRC_DIR}/compiler/lib
@@ -171,6 +171,31 @@ bool HostBlitManager::writeBuffer(const void* srcHost, device::Memory& dstMemory
   return true;
 }
 
+bool HostBlitManager::writeBufferConvert(const void* srcHost, device::Memory& dstMemory,
+                                         const amd::Coord3D& origin, const amd::Coord3D& size,
+                                         const amd::CopyConversion& conversion,
+                                         bool entire) const {
+  uint flags = 0;
+  if (entire) {
+    flags = Memory::CpuWriteOnly;
+  }
+
+  // Map the device memory to CPU visible
+  void* dst = dstMemory.cpuMap(vDev_, flags);
+  if (NULL == dst) {
+    LogError("Couldn't map GPU memory for host write");
+    return false;
+  }
+
+  // Convert directly into the mapped memory
+  bool result = conversion(reinterpret_cast<address>(dst) + origin[0], srcHost, size[0]);
+
+  // Unmap the device memory
+  dstMemory.cpuUnmap(vDev_);
+
+  return result;
+}
+
 bool HostBlitManager::writeBufferRect(const void* srcHost, device::Memory& dstMemory,
                                       const amd::BufferRect& hostRect,
                                       const amd::BufferRect& bufRect, const amd::Coord3D& size,
@@ -114,6 +114,15 @@ class BlitManager : public amd::HeapObject {
                                      amd::CopyMetadata() //!< Memory copy MetaData
                            ) const = 0;
 
+  //! Copies system memory to a buffer object, converting the elements on the way
+  virtual bool writeBufferConvert(const void* srcHost,         //!< Source host memory
+                                  Memory& dstMemory,           //!< Destination memory object
+                                  const amd::Coord3D& origin,  //!< Destination origin
+                                  const amd::Coord3D& size,    //!< Destination size in bytes
+                                  const amd::CopyConversion& conversion,  //!< Conversion
+                                  bool entire = false          //!< Entire buffer will be updated
+                                  ) const = 0;
+
   //! Copies system memory to a buffer object
   virtual bool writeBufferRect(const void* srcHost,              //!< Source host memory
                                Memory& dstMemory,                //!< Destination memory object
@@ -314,6 +323,15 @@ class HostBlitManager : public device::BlitManager {
                                     amd::CopyMetadata() //!< Memory copy MetaData
                            ) const;
 
+  //! Copies system memory to a buffer object, converting the elements on the way
+  virtual bool writeBufferConvert(const void* srcHost,         //!< Source host memory
+                                  device::Memory& dstMemory,   //!< Destination memory object
+                                  const amd::Coord3D& origin,  //!< Destination origin
+                                  const amd::Coord3D& size,    //!< Destination size in bytes
+                                  const amd::CopyConversion& conversion,  //!< Conversion
+                                  bool entire = false          //!< Entire buffer will be updated
+                                  ) const;
+
   //! Copies system memory to a buffer object
   virtual bool writeBufferRect(const void* srcHost,              //!< Source host memory
                                device::Memory& dstMemory,        //!< Destination memory object
@@ -0,0 +1,137 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace amd::device {
+
+/*! \brief Coalesces the doorbell writes of a hardware queue.
+ *
+ *  Packets are written to the queue right away, only the doorbell, which tells the packet
+ *  processor about them, is deferred. A deferred doorbell is rung when:
+ *  - the packet processor consumed all published packets, so it would starve otherwise;
+ *  - the number of deferred packets reached the packet limit;
+ *  - the oldest deferred packet waited longer than the time window.
+ *  The owner rings the rest with Flush() before any wait on the queue progress, and Expire()
+ *  lets a background thread bound the latency if no more packets arrive. A held publication,
+ *  i.e. an explicit batch, is always deferred until Flush().
+ *
+ *  Backend must provide:
+ *    void Ring(uint64_t index);  //!< Writes the doorbell with the last packet index
+ *  and the time is passed in by the caller, so the policy can be replayed on the host.
+ *  The class isn't thread safe, except for Pending().
+ */
+template <typename Backend>
+class DoorbellBatcher {
+ public:
+  explicit DoorbellBatcher(Backend backend, uint32_t maxPackets = 0, uint64_t windowNs = 0)
+      : backend_(backend),
+        maxPackets_(maxPackets),
+        windowNs_(windowNs),
+        pending_(false),
+        index_(0),
+        published_(0),
+        count_(0),
+        firstNs_(0),
+        packets_(0),
+        rings_(0) {}
+
+  //! Sets the coalescing limits, a packet limit below 2 disables the coalescing
+  void SetLimits(uint32_t maxPackets, uint64_t windowNs) {
+    maxPackets_ = maxPackets;
+    windowNs_ = windowNs;
+  }
+
+  //! Returns true if the doorbells are coalesced outside of the explicit batches
+  bool Enabled() const { return maxPackets_ > 1; }
+
+  /*! \brief Records the packet at the given queue index
+   *  \param index     Queue index of the packet
+   *  \param readIndex Current read index of the queue
+   *  \param hold      Defer the doorbell until Flush()
+   *  \param now       Current time in ns, only used if the coalescing is enabled
+   *  \return True if the doorbell was rung
+   */
+  bool Publish(uint64_t index, uint64_t readIndex, bool hold, uint64_t now) {
+    ++packets_;
+    if (!pending_.load(std::memory_order_relaxed)) {
+      firstNs_ = now;
+      pending_.store(true, std::memory_order_relaxed);
+    }
+    index_ = index;
+    ++count_;
+    if (hold) {
+      return false;
+    }
+    if (!Enabled() || (readIndex >= published_) || (count_ >= maxPackets_) ||
+        ((now - firstNs_) >= windowNs_)) {
+      return Flush();
+    }
+    return false;
+  }
+
+  //! Rings the deferred doorbell, returns false if nothing was deferred
+  bool Flush() {
+    if (!pending_.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    backend_.Ring(index_);
+    published_ = index_ + 1;
+    count_ = 0;
+    ++rings_;
+    pending_.store(false, std::memory_order_relaxed);
+    return true;
+  }
+
+  //! Rings the deferred doorbell if the oldest deferred packet waited for the whole window
+  bool Expire(uint64_t now) {
+    if (pending_.load(std::memory_order_relaxed) && ((now - firstNs_) >= windowNs_)) {
+      return Flush();
+    }
+    return false;
+  }
+
+  //! Returns true if a doorbell is deferred, can be polled without the owner's lock
+  bool Pending() const { return pending_.load(std::memory_order_relaxed); }
+
+  //! Returns the number of recorded packets
+  uint64_t packets() const { return packets_; }
+  //! Returns the number of doorbell writes
+  uint64_t rings() const { return rings_; }
+
+  Backend& backend() { return backend_; }
+
+ private:
+  Backend backend_;                //!< Writes the doorbell
+  uint32_t maxPackets_;            //!< Max packets behind one doorbell
+  uint64_t windowNs_;              //!< Max time a packet waits for its doorbell
+  std::atomic<bool> pending_;      //!< A doorbell is deferred
+  uint64_t index_;                 //!< Index of the last deferred packet
+  uint64_t published_;             //!< Index after the last published packet
+  uint32_t count_;                 //!< Number of deferred packets
+  uint64_t firstNs_;               //!< Time of the oldest deferred packet
+  uint64_t packets_;               //!< Recorded packets
+  uint64_t rings_;                 //!< Doorbell writes
+};
+
+}  // namespace amd::device
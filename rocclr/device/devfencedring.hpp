@@ -0,0 +1,136 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <deque>
+
+namespace amd::device {
+
+/*! \brief Variable size ring allocator, which retires its space with fences.
+ *
+ *  The ring works on virtual offsets which only grow, the physical offset is the virtual one
+ *  modulo the ring size. An allocation never wraps, the rest of the ring is skipped instead.
+ *
+ *  The life cycle of an allocation:
+ *  - Allocate() hands out the space.
+ *  - Commit() marks all allocations so far as referenced by submitted packets.
+ *  - Fence() covers the committed allocations with a fence value, the caller submits
+ *    a packet which completes after the packets that use the memory.
+ *  - Retire() releases the space of all fences up to the completed value.
+ *  Fence values must be increasing and complete in order. Uncommitted allocations are never
+ *  covered by a fence, so a fence issued between two allocations of the same packet can't
+ *  release the first one too early.
+ *
+ *  The class has no runtime dependencies, so it can be replayed against a fake completion
+ *  clock on the host.
+ */
+class FencedRing {
+ public:
+  explicit FencedRing(uint64_t size = 0) { Reset(size); }
+
+  //! Drops all allocations and sets a new ring size
+  void Reset(uint64_t size) {
+    size_ = size;
+    Reset();
+  }
+
+  //! Drops all allocations, i.e. after the queue went idle
+  void Reset() {
+    head_ = 0;
+    tail_ = 0;
+    committed_ = 0;
+    fenced_ = 0;
+    fences_.clear();
+  }
+
+  //! Allocates size bytes with the given alignment. Returns false if there is not enough
+  //! retired space. The alignment must divide the ring size.
+  bool Allocate(uint64_t size, uint64_t alignment, uint64_t* offset) {
+    assert((alignment != 0) && (size_ % alignment == 0) && "Invalid ring alignment");
+    uint64_t start = ((head_ + alignment - 1) / alignment) * alignment;
+    uint64_t phys = start % size_;
+    if (phys + size > size_) {
+      // Skip the end of the ring, the allocation has to be contiguous
+      start += size_ - phys;
+      phys = 0;
+    }
+    if ((size > size_) || ((start + size - tail_) > size_)) {
+      return false;
+    }
+    head_ = start + size;
+    *offset = phys;
+    return true;
+  }
+
+  //! All allocations so far are referenced by submitted packets
+  void Commit() { committed_ = head_; }
+
+  //! Returns the number of committed bytes which aren't covered by a fence
+  uint64_t Unfenced() const { return committed_ - fenced_; }
+
+  //! Covers the committed allocations with a fence. Returns false if there was nothing
+  //! to cover and the fence isn't needed.
+  bool Fence(uint64_t fence) {
+    if (committed_ == fenced_) {
+      return false;
+    }
+    assert((fences_.empty() || (fences_.back().fence_ < fence)) && "Fences must increase");
+    fences_.push_back({fence, committed_});
+    fenced_ = committed_;
+    return true;
+  }
+
+  //! Releases the space of all fences up to the completed value
+  void Retire(uint64_t completed) {
+    while (!fences_.empty() && (fences_.front().fence_ <= completed)) {
+      tail_ = fences_.front().end_;
+      fences_.pop_front();
+    }
+  }
+
+  //! Returns true if a fence holds space in the ring
+  bool HasFences() const { return !fences_.empty(); }
+
+  //! Returns the oldest fence, which holds space in the ring
+  uint64_t OldestFence() const { return fences_.front().fence_; }
+
+  //! Returns the number of bytes between the retired and the allocated space
+  uint64_t Used() const { return head_ - tail_; }
+
+  uint64_t size() const { return size_; }
+
+ private:
+  struct PendingFence {
+    uint64_t fence_;  //!< Fence value
+    uint64_t end_;    //!< End of the space covered by the fence
+  };
+
+  uint64_t size_;                    //!< Ring size
+  uint64_t head_;                    //!< End of the allocated space
+  uint64_t tail_;                    //!< End of the retired space
+  uint64_t committed_;               //!< End of the committed space
+  uint64_t fenced_;                  //!< End of the space covered by fences
+  std::deque<PendingFence> fences_;  //!< Fences in flight, oldest first
+};
+
+}  // namespace amd::device
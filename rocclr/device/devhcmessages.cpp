@@ -133,11 +133,6 @@ void MessageHandler::discardMessage(Message* message) {
   // some busy-ness heuristic.
 }
 
-// Defined in devhcprintf.cpp
-
-void handlePrintf(uint64_t* output, const uint64_t* input, uint64_t len);
-
-
 bool MessageHandler::handlePayload(uint32_t service, uint64_t* payload) {
   Message* message = nullptr;
 
@@ -169,7 +164,7 @@ bool MessageHandler::handlePayload(uint32_t service, uint64_t* payload) {
 
   switch (service) {
     case SERVICE_PRINTF:
-      amd::handlePrintf(payload, message->data_.data(), message->data_.size());
+      amd::handlePrintf(payload, message->data_.data(), message->data_.size(), printf_);
       break;
     default:
       ClPrint(amd::LOG_ERROR, amd::LOG_ALWAYS, "Hostcall: Messages not supported for service %d",
@@ -64,6 +64,8 @@
 
 #pragma once
 
+#include "device/devhcprintf.hpp"
+
 #include <vector>
 
 namespace amd {
@@ -85,6 +87,7 @@ struct Message;
 class MessageHandler {
   std::vector<uint64_t> freeSlots_;
   std::vector<Message*> messageSlots_;
+  PrintfOutput printf_;  //!< Batched output of the printf service
 
   Message* newMessage();
   Message* getMessage(uint64_t messageId);
@@ -93,5 +96,7 @@ class MessageHandler {
  public:
   ~MessageHandler();
   bool handlePayload(uint32_t service, uint64_t* payload);
+  //! Write out the output accumulated by the services
+  void flush() { printf_.flush(); }
 };
 }// namespace amd
\ No newline at end of file
@@ -22,128 +22,245 @@
  */
 
 #include "device/devkernel.hpp"
+#include "device/devhcprintf.hpp"
 #include <assert.h>
-#include <cstdarg>
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include <unordered_set>
 
 namespace amd {
-static void checkPrintf(FILE* stream, int* outCount, const char* fmt, ...) {
-  va_list args;
-  va_start(args, fmt);
-  int retval = vfprintf(stream, fmt, args);
-  *outCount = retval < 0 ? retval : *outCount + retval;
-  va_end(args);
-}
-
-static int countStars(const std::string& spec) {
-  int stars = 0;
-  for (auto c : spec) {
-    if (c == '*') {
-      ++stars;
+// ================================================================================================
+void PrintfFormat::addSegment(PrintfSegment::Kind kind, size_t pos, size_t len) {
+  PrintfSegment segment = {kind, PrintfSegment::None, 0, 0, static_cast<uint32_t>(text_.size()),
+                           static_cast<uint32_t>(len)};
+  if (kind == PrintfSegment::Spec) {
+    segment.conv_ = fmt_[pos + len - 1];
+    for (size_t ii = pos; ii < pos + len; ++ii) {
+      if (fmt_[ii] == '*') {
+        ++segment.stars_;
+      }
+    }
+    switch (segment.conv_) {
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        segment.arg_ = PrintfSegment::Double;
+        break;
+      case 's':
+        segment.arg_ = PrintfSegment::String;
+        break;
+      case 'p':
+        segment.arg_ = PrintfSegment::Pointer;
+        break;
+      case 'n':
+        segment.arg_ = PrintfSegment::Skip;
+        break;
+      default:
+        segment.arg_ = PrintfSegment::Integer;
+        break;
     }
   }
-  return stars;
+  text_.append(fmt_, pos, len);
+  text_.push_back('\0');
+  segments_.push_back(segment);
 }
 
-template <typename... Args>
-static const uint64_t* consumeInteger(FILE* stream, int* outCount, const std::string& spec,
-                                      const uint64_t* ptr, Args... args) {
-  checkPrintf(stream, outCount, spec.c_str(), args..., ptr[0]);
-  return ptr + 1;
-}
+// ================================================================================================
+PrintfFormat::PrintfFormat(std::string fmt) : fmt_(std::move(fmt)) {
+  const char convSpecifiers[] = "diouxXfFeEgGaAcspn";
+  size_t point = 0;
+  while (true) {
+    // Each segment of the format string delineated by [mark,
+    // point) is handled seprately.
+    auto mark = point;
+    point = fmt_.find('%', point);
 
-template <typename... Args>
-static const uint64_t* consumeFloatingPoint(FILE* stream, int* outCount, const std::string& spec,
-                                            const uint64_t* ptr, Args... args) {
-  double d;
-  memcpy(&d, ptr, 8);
-  checkPrintf(stream, outCount, spec.c_str(), args..., d);
-  return ptr + 1;
-}
+    // Two different cases where a literal segment is printed out.
+    // 1. When the point reaches the end of the format string.
+    // 2. When the point is at the start of a format specifier.
+    if (point == std::string::npos) {
+      if (mark < fmt_.size()) {
+        addSegment(PrintfSegment::Literal, mark, fmt_.size() - mark);
+      }
+      return;
+    }
+    if (point > mark) {
+      addSegment(PrintfSegment::Literal, mark, point - mark);
+    }
 
-template <typename... Args>
-static const uint64_t* consumeCstring(FILE* stream, int* outCount, const std::string& spec,
-                                      const uint64_t* ptr, Args... args) {
-  auto str = reinterpret_cast<const char*>(ptr);
-  auto old = *outCount;
-  checkPrintf(stream, outCount, spec.c_str(), args..., str);
-  auto stringMemSize = *outCount - old + 1;
-  return ptr + (stringMemSize + 7) / 8;
+    mark = point;
+    ++point;
+
+    // Handle the simplest specifier, '%%'.
+    if (fmt_[point] == '%') {
+      addSegment(PrintfSegment::Percent, point, 1);
+      ++point;
+      continue;
+    }
+
+    // Undefined behaviour if we don't see a conversion specifier.
+    point = fmt_.find_first_of(convSpecifiers, point);
+    if (point == std::string::npos) {
+      addSegment(PrintfSegment::Stop, mark, 0);
+      return;
+    }
+    ++point;
+
+    // [mark,point) now contains a complete specifier.
+    addSegment(PrintfSegment::Spec, mark, point - mark);
+  }
 }
 
+// ================================================================================================
 template <typename... Args>
-static const uint64_t* consumePointer(FILE* stream, int* outCount, const std::string& spec,
-                                      const uint64_t* ptr, Args... args) {
-  auto vptr = reinterpret_cast<void*>(*ptr);
-  checkPrintf(stream, outCount, spec.c_str(), args..., vptr);
-  return ptr + 1;
+void PrintfOutput::append(int* outCount, const char* spec, Args... args) {
+  // Format straight into the batch, most conversions fit the first guess
+  constexpr size_t kGuess = 64;
+  const size_t old = buf_.size();
+  buf_.resize(old + kGuess);
+  int retval = snprintf(&buf_[old], kGuess, spec, args...);
+  if (retval >= static_cast<int>(kGuess)) {
+    buf_.resize(old + retval + 1);
+    snprintf(&buf_[old], retval + 1, spec, args...);
+  }
+  buf_.resize(old + std::max(retval, 0));
+  *outCount = retval < 0 ? retval : *outCount + retval;
 }
 
-template <typename... Args>
-static const uint64_t* consumeArgument(FILE* stream, int* outCount, const std::string& spec,
-                                       const uint64_t* ptr, const uint64_t* end, Args... args) {
-  switch (spec.back()) {
-    case 'd':
-    case 'i':
-    case 'o':
-    case 'u':
-    case 'x':
-    case 'X':
-    case 'c':
-      return consumeInteger(stream, outCount, spec, ptr, args...);
-    case 'f':
-    case 'F':
-    case 'e':
-    case 'E':
-    case 'g':
-    case 'G':
-    case 'a':
-    case 'A':
-      return consumeFloatingPoint(stream, outCount, spec, ptr, args...);
-    case 's':
-      return consumeCstring(stream, outCount, spec, ptr, args...);
-    case 'p':
-      return consumePointer(stream, outCount, spec, ptr, args...);
-    case 'n':
-      return ptr + 1;
+// ================================================================================================
+const uint64_t* PrintfOutput::processSpec(int* outCount, const PrintfFormat& fmt,
+                                          const PrintfSegment& spec, const uint64_t* ptr,
+                                          const uint64_t* end) {
+  assert(spec.stars_ < 3 && "cannot have more than two placeholders");
+  // Undefined behaviour if there are not enough arguments, or more than two stars.
+  if (spec.stars_ > 2 || (end - ptr) < (spec.stars_ + 1)) {
+    return end;
+  }
+  const uint64_t* arg = ptr + spec.stars_;
+  const char* text = fmt.text(spec);
+  auto emit = [&](auto value) {
+    switch (spec.stars_) {
+      case 0:
+        append(outCount, text, value);
+        break;
+      case 1:
+        append(outCount, text, ptr[0], value);
+        break;
+      default:
+        append(outCount, text, ptr[0], ptr[1], value);
+        break;
+    }
+  };
+
+  switch (spec.arg_) {
+    case PrintfSegment::Integer:
+      emit(arg[0]);
+      return arg + 1;
+    case PrintfSegment::Double: {
+      double d;
+      memcpy(&d, arg, 8);
+      emit(d);
+      return arg + 1;
+    }
+    case PrintfSegment::String: {
+      auto old = *outCount;
+      emit(reinterpret_cast<const char*>(arg));
+      auto stringMemSize = *outCount - old + 1;
+      return arg + (stringMemSize + 7) / 8;
+    }
+    case PrintfSegment::Pointer:
+      emit(reinterpret_cast<void*>(*arg));
+      return arg + 1;
+    case PrintfSegment::Skip:
+      return arg + 1;
+    default:
+      break;
   }
 
   // Undefined behaviour with an unknown flag
   return end;
 }
 
-static const uint64_t* processSpec(FILE* stream, int* outCount, const std::string& spec,
-                                   const uint64_t* ptr, const uint64_t* end) {
-  auto stars = countStars(spec);
-  assert(stars < 3 && "cannot have more than two placeholders");
-  switch (stars) {
-    case 0:
-      return consumeArgument(stream, outCount, spec, ptr, end);
-    case 1:
-      // Undefined behaviour if there are not enough arguments.
-      if (end - ptr < 2) {
-        return end;
-      }
-      return consumeArgument(stream, outCount, spec, ptr + 1, end, ptr[0]);
-    case 2:
-      // Undefined behaviour if there are not enough arguments.
-      if (end - ptr < 3) {
-        return end;
-      }
-      return consumeArgument(stream, outCount, spec, ptr + 2, end, ptr[0], ptr[1]);
+// ================================================================================================
+int PrintfOutput::format(FILE* stream, const PrintfFormat& fmt, const uint64_t* ptr,
+                         const uint64_t* end) {
+  setStream(stream);
+  if (buf_.size() >= kFlushSize) {
+    flush();
   }
 
-  // Undefined behaviour if three are more than two stars.
-  return end;
+  int outCount = 0;
+  for (const auto& segment : fmt.segments()) {
+    switch (segment.kind_) {
+      case PrintfSegment::Literal:
+        buf_.append(fmt.text(segment), segment.length_);
+        outCount += static_cast<int>(segment.length_);
+        break;
+      case PrintfSegment::Percent:
+        buf_.push_back('%');
+        ++outCount;
+        break;
+      case PrintfSegment::Spec:
+        // Before processing the specifier, check if we have run out
+        // of arguments.
+        if (ptr == end) {
+          return outCount;
+        }
+        ptr = processSpec(&outCount, fmt, segment, ptr, end);
+        if (outCount < 0) {
+          return outCount;
+        }
+        break;
+      case PrintfSegment::Stop:
+        return outCount;
+    }
+  }
+  return outCount;
+}
+
+// ================================================================================================
+const PrintfFormat& PrintfOutput::lookup(std::string_view fmt) {
+  auto it = cache_.find(fmt);
+  if (it != cache_.end()) {
+    return *it->second;
+  }
+  // Format strings built at runtime could grow the cache without bound
+  if (cache_.size() >= kMaxCachedFormats) {
+    cache_.clear();
+  }
+  auto format = std::make_unique<PrintfFormat>(std::string(fmt));
+  std::string_view key = format->str();
+  return *cache_.emplace(key, std::move(format)).first->second;
+}
+
+// ================================================================================================
+void PrintfOutput::setStream(FILE* stream) {
+  // Keep the order of the output across stdout and stderr
+  if (stream != stream_) {
+    flush();
+    stream_ = stream;
+  }
+}
+
+// ================================================================================================
+void PrintfOutput::flush() {
+  if (buf_.empty()) {
+    return;
+  }
+  fwrite(buf_.data(), 1, buf_.size(), stream_);
+  fflush(stream_);
+  buf_.clear();
 }
 
 /** \brief Process a printf message using the system printf function.
- * \param begin Start of the uint64_t array containing the message.
- * \param end   One past the last element in the array.
- * \return An integer that satisfies the POSIX return value for printf.
  *
  * The message has the following format:
  *  - uint64_t version, required to be zero.
@@ -152,82 +269,25 @@ static const uint64_t* processSpec(FILE* stream, int* outCount, const std::strin
  *    - Each int/float/pointer argument occupies one uint64_t location.
  *    - Each string argument is padded to an 8 byte boundary.
  *
- * The format() function extracts the format string, and then
- * extracts further arguments based on the format string. It breaks
- * up the format string at the format specifiers and invokes the
- * system printf() function multiple times:
- * - A format specifier and its corresponding arguments are passed to
- *   a separate printf() call.
- * - Slices between the format specifiers are passed to additional
- *   printf() calls interleaved with the specifiers.
+ * The format string is split at the format specifiers once and the
+ * parse is cached. Each specifier and its corresponding arguments are
+ * passed to a separate snprintf() call that formats into the output
+ * batch, the slices between the specifiers are copied verbatim.
  *
  * Limitations:
  * - Behaviour is undefined with wide characters and strings.
  * - %n specifier is ignored and the corresponding argument is skipped.
  */
-static int format(FILE* stream, const uint64_t* begin, const uint64_t* end) {
-  const char convSpecifiers[] = "diouxXfFeEgGaAcspn";
-  auto ptr = begin;
-
-  const std::string fmt(reinterpret_cast<const char*>(ptr));
-  ptr += (fmt.length() + 7 + 1) / 8;  // the extra '1' is for the null
-
-  int outCount = 0;
-  size_t point = 0;
-  while (true) {
-    // Each segment of the format string delineated by [mark,
-    // point) is handled seprately.
-    auto mark = point;
-    point = fmt.find('%', point);
-
-    // Two different cases where a literal segment is printed out.
-    // 1. When the point reaches the end of the format string.
-    // 2. When the point is at the start of a format specifier.
-    if (point == std::string::npos) {
-      checkPrintf(stream, &outCount, "%s", &fmt[mark]);
-      return outCount;
-    }
-    checkPrintf(stream, &outCount, "%.*s", (int)(point - mark), &fmt[mark]);
-    if (outCount < 0) {
-      return outCount;
-    }
-
-    mark = point;
-    ++point;
-
-    // Handle the simplest specifier, '%%'.
-    if (fmt[point] == '%') {
-      checkPrintf(stream, &outCount, "%%");
-      if (outCount < 0) {
-        return outCount;
-      }
-      ++point;
-      continue;
-    }
-
-    // Before processing the specifier, check if we have run out
-    // of arguments.
-    if (ptr == end) {
-      return outCount;
-    }
+static int format(PrintfOutput& out, FILE* stream, const uint64_t* begin, const uint64_t* end) {
+  auto str = reinterpret_cast<const char*>(begin);
+  std::string_view fmt(str, strnlen(str, (end - begin) * sizeof(uint64_t)));
+  const PrintfFormat& parsed = out.lookup(fmt);
 
-    // Undefined behaviour if we don't see a conversion specifier.
-    point = fmt.find_first_of(convSpecifiers, point);
-    if (point == std::string::npos) {
-      return outCount;
-    }
-    ++point;
-
-    // [mark,point) now contains a complete specifier.
-    const std::string spec(fmt, mark, point - mark);
-    ptr = processSpec(stream, &outCount, spec, ptr, end);
-    if (outCount < 0) {
-      return outCount;
-    }
-  }
+  auto ptr = begin + (fmt.length() + 7 + 1) / 8;  // the extra '1' is for the null
+  return out.format(stream, parsed, std::min(ptr, end), end);
 }
 
-void handlePrintf(uint64_t* output, const uint64_t* input, uint64_t len) {
+void handlePrintf(uint64_t* output, const uint64_t* input, uint64_t len, PrintfOutput& out) {
   auto end = input + len;
   auto control = *input++;
   FILE* stream = stdout;
@@ -245,7 +305,7 @@ void handlePrintf(uint64_t* output, const uint64_t* input, uint64_t len) {
     stream = stderr;
   }
 
-  *output = format(stream, input, end);
+  *output = format(out, stream, input, end);
 }
 
 // Extract the format string hash and the format string.
@@ -254,40 +314,80 @@ void handlePrintf(uint64_t* output, const uint64_t* input, uint64_t len) {
 //    "0:0:<format_string_hash>,<actual_format_string>"
 // i.e the hash is part of the format string itself
 // delimited by character ','.
-bool populateFormatStringHashMap(
-    const std::vector<device::PrintfInfo> &printfInfo,
-    std::map<uint64_t, std::string> &strMap) {
-  for (auto it : printfInfo) {
+bool populateFormatStringHashMap(const std::vector<device::PrintfInfo>& printfInfo,
+                                 PrintfFormatMap& formats) {
+  // Hashes shared by different format strings, the records can't tell them apart
+  std::unordered_set<uint64_t> collisions;
+  for (const auto& it : printfInfo) {
     auto Delim = it.fmtString_.find_first_of(',');
     auto HashStr = it.fmtString_.substr(0, Delim);
 
     static_assert(sizeof(long long) == sizeof(uint64_t), "unexpected long long type width");
     auto HashVal = std::strtoull(HashStr.c_str(), NULL, 16);
-    if (strMap.find(HashVal) != strMap.end()) {
-      LogError("Hash value collision detected, printf buffer ill formed");
-      return false;
+    auto fmt = it.fmtString_.substr(Delim + 1);
+    auto found = formats.find(HashVal);
+    if (found != formats.end()) {
+      // The same format string can be listed more than once
+      if (found->second.str() != fmt) {
+        collisions.insert(HashVal);
+      }
+      continue;
     }
-    strMap[HashVal] = it.fmtString_.substr(Delim + 1, it.fmtString_.size());
+    formats.emplace(HashVal, PrintfFormat(std::move(fmt)));
   }
 
-  return true;
+  // Drop only the ambiguous formats, the records of all other format strings stay valid
+  for (auto hash : collisions) {
+    LogPrintfError("Hash value collision detected for 0x%llx, its printf records are skipped",
+                   static_cast<unsigned long long>(hash));
+    formats.erase(hash);
+  }
+  return collisions.empty();
 }
 
-void handlePrintfDelayed(const uint64_t* input, uint64_t len, uint64_t control)
-{
-  auto end = input + len;
-  FILE* stream = stdout;
+uint64_t handlePrintfBuffer(const uint32_t* buffer, uint64_t size, const PrintfFormatMap& formats,
+                            PrintfOutput& out) {
+  // Records are only dword aligned, the arguments are copied to an aligned scratch
+  std::vector<uint64_t> scratch;
+  uint64_t sbt = 0;
+
+  while (sbt < size) {
+    auto controlDword = buffer[0];
+    uint64_t nextOffset = controlDword >> 2;
+    if ((nextOffset < sizeof(uint32_t)) || (sbt + nextOffset > size)) {
+      break;  // Need new portion of data in staging buffer
+    }
 
-  // The LSB in the control word is used to decide stream.
-  uint64_t CTRL_MASK = 1;
+    // The LSB in the control word is used to decide stream.
+    FILE* stream = (controlDword & 1) ? stderr : stdout;
+    if (controlDword & 2U) {
+      // Process the contsant format string case.
+      // The first value is the 64 bit format string hash
+      // and remaining values are printf arguments.
+      uint64_t hash;
+      memcpy(&hash, buffer + 1, sizeof(hash));
+      auto numArgs = (nextOffset - 12) / sizeof(uint64_t);
+      scratch.resize(numArgs);
+      memcpy(scratch.data(), buffer + 3, numArgs * sizeof(uint64_t));
+      auto it = formats.find(hash);
+      if (it != formats.end()) {
+        out.format(stream, it->second, scratch.data(), scratch.data() + numArgs);
+      }
+    } else {
+      // Process Non constant format string case.
+      // Here, The buffer itself contains the actual
+      // format string followed by the arguments.
+      auto numArgs = (nextOffset - /*ControlDWord*/4) / sizeof(uint64_t);
+      scratch.resize(numArgs);
+      memcpy(scratch.data(), buffer + 1, numArgs * sizeof(uint64_t));
+      format(out, stream, scratch.data(), scratch.data() + numArgs);
+    }
 
-  // Output goes to stderr if LSB is set.
-  if (control & CTRL_MASK) {
-    stream = stderr;
+    buffer += nextOffset / sizeof(uint32_t);
+    sbt += nextOffset;
   }
 
-  format(stream, input, end);
-
+  return sbt;
 }
 
 } // namespace amd
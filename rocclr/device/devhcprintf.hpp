@@ -0,0 +1,157 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/** \file Host side formatting of device printf.
+ *
+ *  Format strings are split once into literal and conversion segments, and
+ *  the formatted text is accumulated in a PrintfOutput that writes it to the
+ *  stream in large batches instead of one stdio call per conversion.
+ */
+
+namespace amd {
+
+namespace device {
+struct PrintfInfo;
+}
+
+//! One piece of a parsed printf format string
+struct PrintfSegment {
+  enum Kind : uint8_t {
+    Literal = 0,  //!< Text copied to the output verbatim
+    Percent,      //!< The "%%" escape
+    Spec,         //!< A conversion spec consuming arguments
+    Stop          //!< A '%' without conversion specifier, ends the output
+  };
+  //! How the argument of a spec is decoded
+  enum Arg : uint8_t {
+    None = 0,  //!< No argument
+    Integer,   //!< One 64-bit slot passed as an integer
+    Double,    //!< One 64-bit slot holding a double
+    String,    //!< A NUL terminated string padded to 8 bytes
+    Pointer,   //!< One 64-bit slot passed as a pointer
+    Skip       //!< One 64-bit slot that is consumed but not printed (%n)
+  };
+  Kind kind_;
+  Arg arg_;
+  uint8_t stars_;    //!< Width/precision taken from the arguments, at most two
+  char conv_;        //!< Conversion specifier character
+  uint32_t offset_;  //!< Offset of the NUL terminated text in PrintfFormat::text_
+  uint32_t length_;  //!< Length of the text
+};
+
+//! A printf format string split at its conversion specs. Literal slices and specs are
+//! stored NUL terminated in one string, so decoding a record needs no string operations.
+class PrintfFormat {
+ public:
+  explicit PrintfFormat(std::string fmt);
+
+  //! Returns the format string
+  const std::string& str() const { return fmt_; }
+  //! Returns the parsed segments
+  const std::vector<PrintfSegment>& segments() const { return segments_; }
+  //! Returns the literal text or the spec of a segment
+  const char* text(const PrintfSegment& segment) const { return text_.data() + segment.offset_; }
+
+ private:
+  std::string fmt_;                      //!< The format string
+  std::string text_;                     //!< Segment texts, each NUL terminated
+  std::vector<PrintfSegment> segments_;  //!< Segments in output order
+
+  void addSegment(PrintfSegment::Kind kind, size_t pos, size_t len);
+};
+
+//! Parsed format strings of the HIP non-hostcall printf, keyed by the format string hash
+typedef std::unordered_map<uint64_t, PrintfFormat> PrintfFormatMap;
+
+//! Accumulates the formatted device printf output and writes it out in batches
+class PrintfOutput {
+ public:
+  PrintfOutput() : stream_(stdout) {}
+  ~PrintfOutput() { flush(); }
+
+  /** \brief Format one printf record
+   *  \param stream Destination stream, stdout or stderr
+   *  \param fmt    Parsed format string
+   *  \param ptr    First argument
+   *  \param end    One past the last argument
+   *  \return An integer that satisfies the POSIX return value for printf.
+   */
+  int format(FILE* stream, const PrintfFormat& fmt, const uint64_t* ptr, const uint64_t* end);
+
+  //! Parses a format string embedded in a hostcall message, reusing earlier parses
+  const PrintfFormat& lookup(std::string_view fmt);
+
+  //! Writes the accumulated output to its stream
+  void flush();
+
+ private:
+  //! Output beyond this size is written out without waiting for the end of the batch
+  static constexpr size_t kFlushSize = 1024 * 1024;
+  //! Bound on the number of cached hostcall format strings
+  static constexpr size_t kMaxCachedFormats = 4096;
+
+  FILE* stream_;     //!< Stream of the accumulated output
+  std::string buf_;  //!< Accumulated output
+  //! Parsed hostcall format strings, the keys point into the owned PrintfFormat
+  std::unordered_map<std::string_view, std::unique_ptr<PrintfFormat>> cache_;
+
+  void setStream(FILE* stream);
+  template <typename... Args>
+  void append(int* outCount, const char* spec, Args... args);
+  const uint64_t* processSpec(int* outCount, const PrintfFormat& fmt,
+                              const PrintfSegment& spec, const uint64_t* ptr,
+                              const uint64_t* end);
+};
+
+/** \brief Handle a printf message received through hostcall
+ *  \param output Return value for the device
+ *  \param input  Start of the message
+ *  \param len    Number of uint64_t elements in the message
+ *  \param out    Output accumulator of the listener
+ */
+void handlePrintf(uint64_t* output, const uint64_t* input, uint64_t len, PrintfOutput& out);
+
+//! Parse the format strings of the HIP non-hostcall printf and key them by their hash.
+//! Called once when the kernel is loaded. Format strings, which share a hash with a different
+//! string, are left out of the map, and false is returned.
+bool populateFormatStringHashMap(const std::vector<device::PrintfInfo>& printfInfo,
+                                 PrintfFormatMap& formats);
+
+/** \brief Decode the records of a HIP non-hostcall printf buffer
+ *  \param buffer  First record
+ *  \param size    Size of the records in bytes
+ *  \param formats Parsed format strings of the kernel
+ *  \param out     Output accumulator
+ *  \return Number of bytes consumed, a record crossing \p size is left for the next call
+ */
+uint64_t handlePrintfBuffer(const uint32_t* buffer, uint64_t size, const PrintfFormatMap& formats,
+                            PrintfOutput& out);
+
+}  // namespace amd
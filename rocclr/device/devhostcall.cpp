@@ -24,6 +24,7 @@
 
 #include "device/devhcmessages.hpp"
 #include "device/devhostcall.hpp"
+#include "device/devhostcallshards.hpp"
 #include "device/devsignal.hpp"
 
 #include "os/os.hpp"
@@ -34,7 +35,10 @@
 
 #include <assert.h>
 #include <string.h>
+#include <algorithm>
+#include <memory>
 #include <set>
+#include <vector>
 
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
@@ -123,14 +127,19 @@ static void handlePayload(MessageHandler& messages, uint32_t service, uint64_t*
   }
 }
 
-void HostcallBuffer::processPackets(MessageHandler& messages) {
+bool HostcallBuffer::processPackets(MessageHandler& messages) {
+  // Every worker sweep visits idle buffers too, skip them without a write to the line
+  if (ready_stack_.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+
   // Grab the entire ready stack and set the top to 0. New requests from the
   // device will continue pushing on the stack while we process the packets that
   // we have grabbed.
 
   uint64_t ready_stack = std::atomic_exchange_explicit(&ready_stack_, static_cast<uint64_t>(0), std::memory_order_acquire);
   if (!ready_stack) {
-    return;
+    return false;
   }
 
   // Each wave can submit at most one packet at a time. The ready stack cannot
@@ -164,6 +173,7 @@ void HostcallBuffer::processPackets(MessageHandler& messages) {
 
     header->control_.store(resetReadyFlag(header->control_), std::memory_order_release);
   }
+  return true;
 }
 
 static uintptr_t getHeaderStart() {
@@ -217,12 +227,18 @@ void HostcallBuffer::initialize(uint32_t num_packets) {
   ready_stack_ = 0;
 }
 
-/** \brief Manage a unique listener thread and its associated buffers.
+/** \brief Manage the hostcall listener threads and their associated buffers.
+ *
+ *  The listener runs DEBUG_CLR_HOSTCALL_WORKERS threads. Every worker owns a
+ *  doorbell signal, a shard of the buffers and a private MessageHandler. A new
+ *  buffer goes to the worker with the fewest buffers and rings only that
+ *  worker's doorbell, so buffers are sharded by queue. Workers walk their
+ *  shard without taking listenerLock; removeBuffer() waits for any walk in
+ *  flight to finish before the buffer can be freed.
  */
 class HostcallListener {
-  std::set<HostcallBuffer*> buffers_;
-  device::Signal* doorbell_;
-  MessageHandler messages_;
+  //! Buffer tables of the workers, the index of a shard is the index of its worker
+  std::unique_ptr<HostcallShards<HostcallBuffer>> shards_;
   // Keep track of devices for which signal creation have already been done
   std::set<const amd::Device*> devices_;
 #if defined(__clang__)
@@ -230,20 +246,37 @@ class HostcallListener {
    device::UriLocator* urilocator = nullptr;
 #endif
 #endif
-  class Thread : public amd::Thread {
+  class Worker : public amd::Thread {
    public:
-    Thread() : amd::Thread("Hostcall Listener Thread", CQ_THREAD_STACK_SIZE) {}
+    Worker(HostcallListener* listener, device::Signal* doorbell, uint32_t shard)
+        : amd::Thread("Hostcall Listener Thread", CQ_THREAD_STACK_SIZE),
+          listener_(listener),
+          doorbell_(doorbell),
+          shard_(shard) {}
 
     //! The hostcall listener thread entry point.
-    void run(void* data) {
-      auto listener = reinterpret_cast<HostcallListener*>(data);
-      listener->consumePackets();
-    }
-  } thread_;  //!< The hostcall listener thread.
+    void run(void* data) { listener_->consumePackets(*this); }
+
+    HostcallListener* listener_;      //!< Owner of the worker
+    device::Signal* doorbell_;        //!< Doorbell rung by the worker's buffers
+    uint32_t shard_;                  //!< Shard of the buffers, processed by the worker
+    MessageHandler messages_;         //!< Messages assembled from the worker's buffers
+  };
+  std::vector<Worker*> workers_;  //!< The hostcall listener threads.
 
-  void consumePackets();
+  void consumePackets(Worker& worker);
+  //! Process the ready packets of all buffers in the shard of a worker
+  void processShard(Worker& worker);
 
  public:
+  HostcallListener() {}
+
+  ~HostcallListener() {
+    for (auto worker : workers_) {
+      delete worker;
+    }
+  }
+
   /** \brief Add a buffer to the listener.
    *
    *  Behaviour is undefined if:
@@ -264,7 +297,7 @@ class HostcallListener {
   /* \brief Return true if no buffers are registered.
   */
   bool idle() const {
-    return buffers_.empty();
+    return (shards_ == nullptr) || (shards_->Size() == 0);
   }
 
   void terminate();
@@ -274,8 +307,10 @@ class HostcallListener {
 
 HostcallListener* hostcallListener = nullptr;
 extern amd::Monitor listenerLock;
-constexpr static uint64_t kTimeoutFloor = K * K * 4;
+//! Timeout of a blocking doorbell wait, bounds the latency of the exit handshake
 constexpr static uint64_t kTimeoutCeil = K * K * 16;
+//! Smallest spin window used once the workload shows back to back doorbells
+constexpr static uint64_t kSpinFloorNs = 2 * K;
 static struct Init {
   enum class State {
     kDefault = 0,
@@ -284,65 +319,107 @@ static struct Init {
     kExit
   };
   volatile State state = State::kDefault;
+  std::atomic<uint32_t> active{0};  //!< Number of running listener workers
   ~Init() {
     if (state == State::kInit) {
       state = State::kDestroy;
       // @note: Under Linux thread destruction can be delayed and
       // ROCR may crash in a wait for event occasionally. Hence, runtime needs
       // an early exit. The logic isn't required for Windows.
-      while (IS_LINUX && (state == State::kDestroy)) {}
+      while (IS_LINUX && (active.load() != 0)) {}
+      state = State::kExit;
     }
   }
 } kHostThreadActive;
-void HostcallListener::consumePackets() {
-  uint64_t timeout = kTimeoutFloor;
+
+void HostcallListener::processShard(Worker& worker) {
+  shards_->Walk(worker.shard_, [&worker](HostcallBuffer* buffer) {
+    buffer->processPackets(worker.messages_);
+  });
+
+  // One write for all printf output of the sweep
+  worker.messages_.flush();
+}
+
+void HostcallListener::consumePackets(Worker& worker) {
+  device::Signal* doorbell = worker.doorbell_;
+  const uint64_t spinCeil = static_cast<uint64_t>(DEBUG_CLR_HOSTCALL_SPIN_US) * K;
+  uint64_t spin = spinCeil;
   uint64_t signal_value = SIGNAL_INIT;
+  kHostThreadActive.active++;
   kHostThreadActive.state = Init::State::kInit;
   while (true) {
-    while (true) {
-      if (kHostThreadActive.state == Init::State::kDestroy) {
-        kHostThreadActive.state = Init::State::kExit;
-        return;
+    // Optionally spin on the doorbell first, since device printf and sanitizer reports
+    // arrive in bursts
+    uint64_t new_value = signal_value;
+    bool spun = false;
+    const uint64_t idleStart = amd::Os::timeNanos();
+    if (spin > 0) {
+      const uint64_t deadline = idleStart + spin;
+      do {
+        new_value = doorbell->Wait(signal_value, device::Signal::Condition::Ne, 0);
+        if (new_value != signal_value) {
+          spun = true;
+          break;
+        }
+        amd::Os::spinPause();
+      } while (amd::Os::timeNanos() < deadline);
+    }
+    if (spun) {
+      // Work arrived inside the spin window, keep spinning longer next time
+      spin = std::min(spinCeil, std::max(kSpinFloorNs, spin << 1));
+    } else {
+      // Nothing arrived while spinning, shrink the window and block on the doorbell
+      spin = spin >> 1;
+      while (true) {
+        if (kHostThreadActive.state == Init::State::kDestroy) {
+          kHostThreadActive.active--;
+          return;
+        }
+        new_value = doorbell->Wait(signal_value, device::Signal::Condition::Ne, kTimeoutCeil);
+        if (new_value != signal_value) {
+          break;
+        }
       }
-      uint64_t new_value = doorbell_->Wait(signal_value, device::Signal::Condition::Ne, timeout);
-      if (new_value != signal_value) {
-        signal_value = new_value;
-        // Reduce the timeout for quicker processing
-        timeout = timeout >> 0x1;
-        timeout = std::max(kTimeoutFloor, timeout);
-        break;
+      // The doorbell rang right after the window closed, widen it again
+      if ((spinCeil > 0) && ((amd::Os::timeNanos() - idleStart) < 2 * spinCeil)) {
+        spin = std::min(spinCeil, std::max(kSpinFloorNs, spin << 1));
       }
-      // Increase the timeout since we dont need to check as frequently
-      timeout = timeout << 0x1;
-      timeout = std::min(kTimeoutCeil, timeout);
     }
+    signal_value = new_value;
 
     if (signal_value == SIGNAL_DONE) {
+      kHostThreadActive.active--;
       return;
     }
 
     if (!idle()) {
-      amd::ScopedLock lock{listenerLock};
-
-      for (auto ii : buffers_) {
-        ii->processPackets(messages_);
-      }
+      processShard(worker);
     }
   }
-
-  return;
 }
 
 void HostcallListener::terminate() {
-  if (!amd::Os::isThreadAlive(thread_)) {
+  bool alive = false;
+  for (auto worker : workers_) {
+    alive |= amd::Os::isThreadAlive(*worker);
+  }
+  if (!alive) {
     return;
   }
   kHostThreadActive.state = Init::State::kExit;
-  doorbell_->Reset(SIGNAL_DONE);
+  for (auto worker : workers_) {
+    worker->doorbell_->Reset(SIGNAL_DONE);
+  }
 
   // FIXME_lmoriche: fix termination handshake
-  while (thread_.state() < Thread::FINISHED) {
-    amd::Os::yield();
+  for (auto worker : workers_) {
+    if (!amd::Os::isThreadAlive(*worker)) {
+      continue;
+    }
+    while (worker->state() < Thread::FINISHED) {
+      amd::Os::yield();
+    }
   }
 
 #if defined(__clang__)
@@ -350,38 +427,52 @@ void HostcallListener::terminate() {
   delete urilocator;
 #endif
 #endif
-  delete doorbell_;
+  for (auto worker : workers_) {
+    delete worker->doorbell_;
+    worker->doorbell_ = nullptr;
+  }
   devices_.clear();
 }
 
 void HostcallListener::addBuffer(HostcallBuffer* buffer) {
-  assert(buffers_.count(buffer) == 0 && "buffer already present");
-  buffer->setDoorbell(doorbell_->getHandle());
+  // Registration is serialized by listenerLock, the workers only read their shards
+  buffer->setDoorbell(workers_[shards_->NextShard()]->doorbell_->getHandle());
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
   buffer->setUriLocator(urilocator);
 #endif
 #endif
-  buffers_.insert(buffer);
+  shards_->Add(buffer);
 }
 
 void HostcallListener::removeBuffer(HostcallBuffer* buffer) {
-  assert(buffers_.count(buffer) != 0 && "unknown buffer");
-  buffers_.erase(buffer);
+  if (!shards_->Remove(buffer)) {
+    assert(false && "unknown buffer");
+  }
 }
 
 bool HostcallListener::initSignal(const amd::Device &dev) {
-  doorbell_ = dev.createSignal();
+  const uint32_t numWorkers = std::max(1u, static_cast<uint32_t>(DEBUG_CLR_HOSTCALL_WORKERS));
+  shards_.reset(new HostcallShards<HostcallBuffer>(numWorkers));
+  bool initialized = true;
+  for (uint32_t ii = 0; ii < numWorkers; ++ii) {
+    Worker* worker = new Worker(this, dev.createSignal(), ii);
+    workers_.push_back(worker);
+    initialized &= (worker->state() >= Thread::INITIALIZED);
+  }
   initDevice(dev);
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
   urilocator = dev.createUriLocator();
 #endif
 #endif
-  // If the listener thread was not successfully initialized, clean
+  // If the listener threads were not successfully initialized, clean
   // everything up and bail out.
-  if (thread_.state() < Thread::INITIALIZED) {
-    delete doorbell_;
+  if (!initialized) {
+    for (auto worker : workers_) {
+      delete worker->doorbell_;
+      worker->doorbell_ = nullptr;
+    }
     devices_.clear();
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
@@ -390,12 +481,14 @@ bool HostcallListener::initSignal(const amd::Device &dev) {
 #endif
     return false;
   }
-  thread_.start(this);
+  for (auto worker : workers_) {
+    worker->start(this);
+  }
   return true;
 }
 
 bool HostcallListener::initDevice(const amd::Device &dev) {
-  // Create only one signal per device
+  // Create only one signal per device and worker
   // This is to avoid conflicts when n signals are created for n HIP streams per device
   if (devices_.count(&dev) == 0) {
 #if defined(WITH_PAL_DEVICE) && !defined(_WIN32)
@@ -403,8 +496,10 @@ bool HostcallListener::initDevice(const amd::Device &dev) {
 #else
     auto ws = device::Signal::WaitState::Blocked;
 #endif
-    if ((doorbell_ == nullptr) || !doorbell_->Init(dev, SIGNAL_INIT, ws)) {
-      return false;
+    for (auto worker : workers_) {
+      if ((worker->doorbell_ == nullptr) || !worker->doorbell_->Init(dev, SIGNAL_INIT, ws)) {
+        return false;
+      }
     }
     devices_.insert(&dev);
   }
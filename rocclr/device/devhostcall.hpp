@@ -161,7 +161,8 @@ class HostcallBuffer {
   Payload* getPayload(uint64_t ptr) const;
 
  public:
-  void processPackets(MessageHandler& messages);
+  //! Handle all ready packets, returns false if there were none
+  bool processPackets(MessageHandler& messages);
   void initialize(uint32_t num_packets);
   void setDoorbell(void* doorbell) { doorbell_ = doorbell; };
   void setDevice(const amd::Device* dptr) { device_ = dptr; };
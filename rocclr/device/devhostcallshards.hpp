@@ -0,0 +1,171 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace amd {
+
+/** \brief Tables of the hostcall buffers, one per listener worker.
+ *
+ *  A new buffer goes to the shard with the fewest buffers. Registration is
+ *  serialized by the caller, while every worker walks its own shard without a
+ *  lock. A table grows by chunks, which are released only with the shards, so
+ *  a walk never reaches freed memory. Remove() waits for a walk in flight, so
+ *  the buffer can be freed when it returns.
+ */
+template <typename Buffer> class HostcallShards {
+ public:
+  explicit HostcallShards(uint32_t numShards)
+      : numShards_(numShards), shards_(new Shard[numShards]) {}
+
+  ~HostcallShards() {
+    for (uint32_t i = 0; i < numShards_; ++i) {
+      Chunk* chunk = shards_[i].first_.next_.load();
+      while (chunk != nullptr) {
+        Chunk* next = chunk->next_.load();
+        delete chunk;
+        chunk = next;
+      }
+    }
+  }
+
+  //! Returns the number of shards
+  uint32_t NumShards() const { return numShards_; }
+
+  //! Returns the number of buffers in all shards
+  uint32_t Size() const { return size_.load(std::memory_order_acquire); }
+
+  //! Returns the number of buffers in the shard
+  uint32_t Size(uint32_t shard) const { return shards_[shard].size_; }
+
+  //! Returns the shard with the fewest buffers, which Add() will use
+  uint32_t NextShard() const {
+    uint32_t best = 0;
+    for (uint32_t i = 1; i < numShards_; ++i) {
+      if (shards_[i].size_ < shards_[best].size_) {
+        best = i;
+      }
+    }
+    return best;
+  }
+
+  //! Adds the buffer to the shard NextShard() returned and returns the shard
+  uint32_t Add(Buffer* buffer) {
+    const uint32_t index = NextShard();
+    Shard& shard = shards_[index];
+    std::atomic<Buffer*>* freeSlot = nullptr;
+    Chunk* last = nullptr;
+    for (Chunk* chunk = &shard.first_; chunk != nullptr; chunk = chunk->next_.load()) {
+      for (auto& slot : chunk->slots_) {
+        assert(slot.load() != buffer && "buffer already present");
+        if ((freeSlot == nullptr) && (slot.load() == nullptr)) {
+          freeSlot = &slot;
+        }
+      }
+      last = chunk;
+    }
+    if (freeSlot != nullptr) {
+      freeSlot->store(buffer);
+    } else {
+      // Fill the new chunk before the worker can reach it
+      Chunk* chunk = new Chunk();
+      chunk->slots_[0].store(buffer, std::memory_order_relaxed);
+      last->next_.store(chunk);
+    }
+    shard.size_++;
+    size_++;
+    return index;
+  }
+
+  //! Removes the buffer and waits until no walk can use it. Returns false for an unknown buffer
+  bool Remove(Buffer* buffer) {
+    for (uint32_t i = 0; i < numShards_; ++i) {
+      Shard& shard = shards_[i];
+      for (Chunk* chunk = &shard.first_; chunk != nullptr; chunk = chunk->next_.load()) {
+        for (auto& slot : chunk->slots_) {
+          if (slot.load() != buffer) {
+            continue;
+          }
+          slot.store(nullptr);
+          shard.size_--;
+          size_--;
+          // The worker may still hold the buffer in the middle of a walk. Later
+          // walks can't see it anymore, so waiting for the current one is sufficient.
+          const uint64_t walk = shard.walk_.load();
+          if (walk & 1) {
+            while (shard.walk_.load() == walk) {
+              std::this_thread::yield();
+            }
+          }
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  //! Calls the functor for every buffer of the shard, runs on the worker of the shard
+  template <typename F> void Walk(uint32_t index, F functor) {
+    Shard& shard = shards_[index];
+    // Odd walk count tells Remove() that the table is being walked
+    shard.walk_.fetch_add(1);
+    for (Chunk* chunk = &shard.first_; chunk != nullptr; chunk = chunk->next_.load()) {
+      for (auto& slot : chunk->slots_) {
+        Buffer* buffer = slot.load();
+        if (buffer != nullptr) {
+          functor(buffer);
+        }
+      }
+    }
+    shard.walk_.fetch_add(1);
+  }
+
+ private:
+  //! Chunk of the buffer table of a shard
+  struct Chunk {
+    static constexpr uint32_t kNumSlots = 64;
+    std::atomic<Buffer*> slots_[kNumSlots];   //!< Registered buffers
+    std::atomic<Chunk*> next_;                //!< Next chunk of the table
+
+    Chunk() : next_(nullptr) {
+      for (auto& slot : slots_) {
+        slot.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+  };
+  struct Shard {
+    Chunk first_;                       //!< First chunk of the buffer table
+    uint32_t size_ = 0;                 //!< Buffers of the shard, guarded by the caller
+    std::atomic<uint64_t> walk_{0};     //!< Odd while the worker walks the table
+  };
+
+  const uint32_t numShards_;            //!< Number of shards
+  std::unique_ptr<Shard[]> shards_;     //!< Buffer tables of the workers
+  std::atomic<uint32_t> size_{0};       //!< Number of registered buffers
+};
+
+}  // namespace amd
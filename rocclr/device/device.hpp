@@ -38,6 +38,7 @@
 #include "hsailctx.hpp"
 #endif
 #include "devsignal.hpp"
+#include "devwaitpolicy.hpp"
 
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
@@ -1268,7 +1269,8 @@ class VirtualDevice : public amd::HeapObject {
     : device_(device)
     , blitMgr_(NULL)
     , execution_(true) /* Virtual device execution lock */
-    , index_(0) {}
+    , index_(0)
+    , waitPolicy_(DEBUG_CLR_WAIT_POLICY, static_cast<uint64_t>(DEBUG_CLR_WAIT_SPIN_US) * 1000) {}
 
   //! Destroy this virtual device.
   virtual ~VirtualDevice() {}
@@ -1311,6 +1313,12 @@ class VirtualDevice : public amd::HeapObject {
 
   virtual address allocKernelArguments(size_t size, size_t alignment) { return nullptr; }
 
+  //! Starts a batch of submissions, the device may defer publishing the packets to the
+  //! hardware until EndPacketBatch(). Must be called under the execution lock
+  virtual void BeginPacketBatch() {}
+  //! Publishes the packets submitted since BeginPacketBatch()
+  virtual void EndPacketBatch() {}
+
   //! Get the blit manager object
   device::BlitManager& blitMgr() const { return *blitMgr_; }
 
@@ -1323,6 +1331,9 @@ class VirtualDevice : public amd::HeapObject {
   //! Returns true if device has active wait setting
   bool ActiveWait() const;
 
+  //! Returns the host wait policy of this virtual device
+  WaitPolicy& waitPolicy() { return waitPolicy_; }
+
   //! Returns the status of queue handler callback
   virtual bool isHandlerPending() const = 0;
 
@@ -1350,6 +1361,7 @@ class VirtualDevice : public amd::HeapObject {
 
   amd::Monitor execution_;  //!< Lock to serialise access to all device objects
   uint index_;              //!< The virtual device unique index
+  WaitPolicy waitPolicy_;   //!< Host wait policy, learns the wait times of the queue
 };
 
 }  // namespace amd::device
@@ -1581,6 +1581,7 @@ void Kernel::InitPrintf(const std::vector<std::string>& printfInfoStrings) {
     }
     // ]
   }
+  InitPrintfFormats();
 }
 #endif  // defined(USE_COMGR_LIBRARY)
 
@@ -1653,6 +1654,18 @@ void Kernel::InitPrintf(const aclPrintfFmt* aclPrintf) {
       info.arguments_.push_back(*tmp_ptr);
     }
   }
+  InitPrintfFormats();
 }
 #endif // defined(WITH_COMPILER_LIB)
+
+// ================================================================================================
+void Kernel::InitPrintfFormats() {
+  // Only the HIP non-hostcall printf keys its format strings by hash
+  if (!amd::IS_HIP || printf_.empty()) {
+    return;
+  }
+  printfFormats_.clear();
+  // A hash collision drops only the ambiguous format strings
+  amd::populateFormatStringHashMap(printf_, printfFormats_);
+}
 } // namespace amd::device
@@ -26,6 +26,7 @@
 #include "platform/context.hpp"
 #include "platform/object.hpp"
 #include "platform/memory.hpp"
+#include "device/devhcprintf.hpp"
 
 namespace amd {
 class Device;
@@ -322,6 +323,9 @@ class Kernel : public amd::HeapObject {
   //! Return printf info array
   const std::vector<PrintfInfo>& printfInfo() const { return printf_; }
 
+  //! Return the parsed HIP printf format strings, keyed by their hash
+  const amd::PrintfFormatMap& printfFormats() const { return printfFormats_; }
+
   //! Finds local workgroup size
   void FindLocalWorkSize(
     size_t workDim,                   //!< Work dimension
@@ -388,6 +392,9 @@ class Kernel : public amd::HeapObject {
   //! Initializes HSAIL Printf metadata and info
   void InitPrintf(const aclPrintfFmt* aclPrintf);
 #endif
+  //! Parses the HIP printf format strings once, so the printf buffer decoder doesn't
+  void InitPrintfFormats();
+
   //! Returns program associated with this kernel
   const Program& prog() const { return prog_; }
 
@@ -399,6 +406,7 @@ class Kernel : public amd::HeapObject {
   amd::KernelSignature* signature_; //!< kernel signature
   std::string buildLog_;            //!< build log
   std::vector<PrintfInfo> printf_;  //!< Format strings for GPU printf support
+  amd::PrintfFormatMap printfFormats_;  //!< Parsed HIP printf format strings
   std::string runtimeHandle_;       //!< Runtime handle for context loader
 
   uint64_t kernelCodeHandle_ = 0;   //!< Kernel code handle (aka amd_kernel_code_t)
@@ -0,0 +1,148 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace amd::device {
+
+//! Set of busy address ranges with their access state, used for the memory dependency
+//! tracking between kernel dispatches. The ranges are kept sorted and non-overlapping, touching
+//! ranges with the same state are merged, so an overlap query is a binary search followed by
+//! a short walk. The class has no runtime dependencies and can be exercised on the host.
+class AddressRangeSet {
+ public:
+  struct Range {
+    uint64_t start_;  //!< Busy memory start address
+    uint64_t end_;    //!< Busy memory end address, exclusive
+    bool readOnly_;   //!< True if the range was only read
+  };
+
+  //! Returns true if an access to [start, end) depends on a range in the set,
+  //! i.e. it overlaps a written range or it writes and overlaps any range
+  bool conflicts(uint64_t start, uint64_t end, bool readOnly) const {
+    if (start >= end) {
+      return false;
+    }
+    auto it = std::partition_point(ranges_.begin(), ranges_.end(),
+                                   [start](const Range& r) { return r.end_ <= start; });
+    for (; it != ranges_.end() && it->start_ < end; ++it) {
+      if (!readOnly || !it->readOnly_) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //! Adds an access to [start, end). A write takes over the overlapped part of the existing
+  //! ranges, a read only fills the addresses which aren't tracked yet.
+  void insert(uint64_t start, uint64_t end, bool readOnly) {
+    if (start >= end) {
+      return;
+    }
+    // Ranges which overlap or touch the new one, they are replaced with the merged pieces
+    size_t first = std::partition_point(ranges_.begin(), ranges_.end(),
+                                        [start](const Range& r) { return r.end_ < start; }) -
+        ranges_.begin();
+    size_t last = std::partition_point(ranges_.begin() + first, ranges_.end(),
+                                       [end](const Range& r) { return r.start_ <= end; }) -
+        ranges_.begin();
+
+    // Fast path for a new isolated range
+    if (first == last) {
+      ranges_.insert(ranges_.begin() + first, Range{start, end, readOnly});
+      return;
+    }
+
+    merged_.clear();
+    if (readOnly) {
+      uint64_t cursor = start;
+      for (size_t i = first; i < last; ++i) {
+        const Range& r = ranges_[i];
+        if (r.start_ > cursor) {
+          append(cursor, r.start_, true);
+        }
+        append(r.start_, r.end_, r.readOnly_);
+        cursor = std::max(cursor, r.end_);
+      }
+      append(cursor, end, true);
+    } else {
+      // Only the first range can start before the new one and only the last can end after it
+      append(ranges_[first].start_, std::min(ranges_[first].end_, start),
+             ranges_[first].readOnly_);
+      append(start, end, false);
+      append(std::max(ranges_[last - 1].start_, end), ranges_[last - 1].end_,
+             ranges_[last - 1].readOnly_);
+    }
+
+    if (merged_.size() == last - first) {
+      std::copy(merged_.begin(), merged_.end(), ranges_.begin() + first);
+    } else {
+      ranges_.erase(ranges_.begin() + first, ranges_.begin() + last);
+      ranges_.insert(ranges_.begin() + first, merged_.begin(), merged_.end());
+    }
+  }
+
+  //! Adds all ranges of another set
+  void insert(const AddressRangeSet& other) {
+    if (ranges_.empty()) {
+      ranges_ = other.ranges_;
+      return;
+    }
+    for (const auto& r : other.ranges_) {
+      insert(r.start_, r.end_, r.readOnly_);
+    }
+  }
+
+  //! Removes all ranges, the allocated storage is kept for reuse
+  void clear() { ranges_.clear(); }
+
+  //! Preallocates storage for the given number of ranges
+  void reserve(size_t count) {
+    ranges_.reserve(count);
+    merged_.reserve(count);
+  }
+
+  bool empty() const { return ranges_.empty(); }
+  size_t size() const { return ranges_.size(); }
+  const std::vector<Range>& ranges() const { return ranges_; }
+
+ private:
+  std::vector<Range> ranges_;  //!< Sorted, non-overlapping ranges
+  std::vector<Range> merged_;  //!< Scratch storage for the pieces of an insert
+
+  //! Appends a piece to the merged list, extending the previous piece if it's contiguous
+  void append(uint64_t start, uint64_t end, bool readOnly) {
+    if (start >= end) {
+      return;
+    }
+    if (!merged_.empty() && merged_.back().end_ == start && merged_.back().readOnly_ == readOnly) {
+      merged_.back().end_ = end;
+    } else {
+      merged_.push_back(Range{start, end, readOnly});
+    }
+  }
+};
+
+}  // namespace amd::device
@@ -0,0 +1,229 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace amd::device {
+
+//! Bounded lock-free multi-producer/multi-consumer queue of pointers. Every cell carries
+//! a sequence number, which tells producers and consumers whose turn it is, so neither side
+//! needs a lock and a recycled pointer can't cause an ABA problem.
+template <typename T>
+class PointerQueue {
+ public:
+  //! The capacity is rounded up to a power of two
+  explicit PointerQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    cells_.reset(new Cell[size]);
+    mask_ = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+      cells_[i].seq_.store(i, std::memory_order_relaxed);
+    }
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+  }
+
+  //! Returns false if the queue is full
+  bool push(T* data) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = cells_[pos & mask_];
+      size_t seq = cell.seq_.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          cell.data_ = data;
+          cell.seq_.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  //! Returns nullptr if the queue is empty
+  T* pop() {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = cells_[pos & mask_];
+      size_t seq = cell.seq_.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          T* data = cell.data_;
+          cell.seq_.store(pos + mask_ + 1, std::memory_order_release);
+          return data;
+        }
+      } else if (diff < 0) {
+        return nullptr;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  //! Approximate number of queued pointers
+  size_t size() const {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_relaxed);
+    return (tail > head) ? (tail - head) : 0;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> seq_;  //!< Position this cell is ready for
+    T* data_;                  //!< Queued pointer
+  };
+
+  std::unique_ptr<Cell[]> cells_;          //!< Ring of cells
+  size_t mask_;                            //!< Ring size - 1
+  alignas(64) std::atomic<size_t> head_;   //!< Next position to pop
+  alignas(64) std::atomic<size_t> tail_;   //!< Next position to push
+};
+
+/*! \brief Pool of pre-created completion signals shared by the queues of a device.
+ *
+ *  The pool keeps between the low and the high watermark of idle signals. Acquire() takes
+ *  a signal from the pool and only falls back to the backend if the pool ran dry. Recycle()
+ *  returns an idle signal, it fails above the high watermark and the caller destroys the
+ *  signal. Refill() tops the pool up and is meant to run outside of the dispatch path.
+ *
+ *  Backend must provide:
+ *    T* Create();          //!< Creates a signal, nullptr on failure
+ *    void Destroy(T*);     //!< Destroys a signal
+ *  so the pool logic can be exercised with a mocked backend on a machine without a GPU.
+ */
+template <typename T, typename Backend>
+class SignalPool {
+ public:
+  struct Stats {
+    uint64_t hits_;       //!< Acquires served from the pool
+    uint64_t created_;    //!< Signals created on demand in Acquire()
+    uint64_t refilled_;   //!< Signals created by Refill()
+    uint64_t recycled_;   //!< Signals returned into the pool
+    uint64_t destroyed_;  //!< Returned signals destroyed above the high watermark
+  };
+
+  SignalPool(Backend backend, size_t lowWatermark, size_t highWatermark)
+      : backend_(backend),
+        free_(std::max<size_t>(highWatermark, 1)),
+        high_(std::max<size_t>(highWatermark, 1)),
+        low_(std::min(lowWatermark, high_)),
+        hits_(0),
+        created_(0),
+        refilled_(0),
+        recycled_(0),
+        destroyed_(0) {}
+
+  ~SignalPool() { Drain(); }
+
+  //! Takes an idle signal from the pool or creates a new one if the pool is empty
+  T* Acquire() {
+    T* signal = free_.pop();
+    if (signal != nullptr) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return signal;
+    }
+    signal = backend_.Create();
+    if (signal != nullptr) {
+      created_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return signal;
+  }
+
+  //! Returns an idle signal into the pool. False means the pool is full and the signal
+  //! must be destroyed by the caller
+  bool Recycle(T* signal) {
+    // The queue capacity is a power of two, the watermark bounds the idle signals exactly
+    if ((free_.size() < high_) && free_.push(signal)) {
+      recycled_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    destroyed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  //! Returns true if the pool dropped below the low watermark
+  bool NeedsRefill() const { return free_.size() < low_; }
+
+  //! Creates signals until the pool holds twice the low watermark, bounded by the high one.
+  //! Returns false if the backend failed to create a signal
+  bool Refill() {
+    const size_t target = std::min(2 * low_, high_);
+    while (free_.size() < target) {
+      T* signal = backend_.Create();
+      if (signal == nullptr) {
+        return false;
+      }
+      if (!free_.push(signal)) {
+        backend_.Destroy(signal);
+        break;
+      }
+      refilled_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  //! Destroys all idle signals
+  void Drain() {
+    while (T* signal = free_.pop()) {
+      backend_.Destroy(signal);
+    }
+  }
+
+  //! Approximate number of idle signals
+  size_t size() const { return free_.size(); }
+
+  Stats GetStats() const {
+    return Stats{hits_.load(std::memory_order_relaxed), created_.load(std::memory_order_relaxed),
+                 refilled_.load(std::memory_order_relaxed),
+                 recycled_.load(std::memory_order_relaxed),
+                 destroyed_.load(std::memory_order_relaxed)};
+  }
+
+  Backend& backend() { return backend_; }
+
+ private:
+  Backend backend_;                  //!< Creates and destroys the signals
+  PointerQueue<T> free_;             //!< Idle signals
+  const size_t high_;                //!< Maximum number of idle signals
+  const size_t low_;                 //!< Refill threshold
+  std::atomic<uint64_t> hits_;       //!< Acquires served from the pool
+  std::atomic<uint64_t> created_;    //!< On demand creations
+  std::atomic<uint64_t> refilled_;   //!< Refill creations
+  std::atomic<uint64_t> recycled_;   //!< Returns into the pool
+  std::atomic<uint64_t> destroyed_;  //!< Returns above the high watermark
+};
+
+}  // namespace amd::device
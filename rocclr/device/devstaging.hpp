@@ -0,0 +1,109 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace amd {
+
+//! Element conversion applied by the host while it fills the staging buffers of a write.
+//! The callback converts count elements from src into dst; the runtime layer owning the
+//! formats provides it, so the copy path only needs the element sizes.
+struct CopyConversion {
+  typedef bool (*ConvertFn)(void* dst, const void* src, size_t count,
+                            const CopyConversion& conversion);
+
+  ConvertFn convert_;         //!< Conversion callback, nullptr for a plain copy
+  uint32_t srcFormat_;        //!< Source element format, opaque to the copy path
+  uint32_t dstFormat_;        //!< Destination element format, opaque to the copy path
+  uint32_t flags_;            //!< Conversion flags passed through to the callback
+  uint32_t srcElementSize_;   //!< Size in bytes of a source element
+  uint32_t dstElementSize_;   //!< Size in bytes of a destination element
+
+  CopyConversion()
+      : convert_(nullptr),
+        srcFormat_(0),
+        dstFormat_(0),
+        flags_(0),
+        srcElementSize_(1),
+        dstElementSize_(1) {}
+
+  //! Returns true if the write needs a conversion
+  bool enabled() const { return convert_ != nullptr; }
+  //! Returns the number of host bytes consumed for dstBytes of device data
+  size_t srcBytes(size_t dstBytes) const {
+    return (dstBytes / dstElementSize_) * srcElementSize_;
+  }
+  //! Converts the elements of dstBytes of device data from src into dst
+  bool operator()(void* dst, const void* src, size_t dstBytes) const {
+    return convert_(dst, src, dstBytes / dstElementSize_, *this);
+  }
+};
+
+namespace device {
+
+//! Uploads size bytes of device data through a single staging buffer of stagingSize bytes.
+//! Each chunk is filled on the host, with a plain copy or the optional conversion, and then
+//! handed to the copy engine. The engine provides:
+//!   Begin()                      - prepares the dependencies of the next chunk copy
+//!   Abort()                      - drops the chunk prepared by Begin() after a failure
+//!   Copy(dstOffset, src, bytes)  - queues the asynchronous copy of a staged chunk
+//!   Wait()                       - waits for the last queued copy, so staging can be reused
+//! A converted chunk holds whole destination elements, so the usable staging size is rounded
+//! down to a multiple of the element size.
+template <typename Engine>
+bool StagedUpload(Engine& engine, const void* hostSrc, size_t size, void* staging,
+                  size_t stagingSize, const CopyConversion* conversion) {
+  const char* src = reinterpret_cast<const char*>(hostSrc);
+  if (conversion != nullptr) {
+    stagingSize -= stagingSize % conversion->dstElementSize_;
+    if (stagingSize == 0) {
+      return false;
+    }
+  }
+  size_t offset = 0;
+  while (offset < size) {
+    const size_t chunk = std::min(size - offset, stagingSize);
+    engine.Begin();
+    if (conversion == nullptr) {
+      std::memcpy(staging, src + offset, chunk);
+    } else if (!(*conversion)(staging, src + conversion->srcBytes(offset), chunk)) {
+      engine.Abort();
+      return false;
+    }
+    if (!engine.Copy(offset, staging, chunk)) {
+      return false;
+    }
+    offset += chunk;
+    if (offset < size) {
+      // Wait if there are extra copies, which don't fit in a single staging buffer
+      engine.Wait();
+    }
+  }
+  return true;
+}
+
+}  // namespace device
+}  // namespace amd
@@ -0,0 +1,124 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace amd::device {
+
+/*! \brief Host wait policy of a queue.
+ *
+ *  A wait runs in three phases: it spins, then yields the core between the polls and finally
+ *  blocks until the completion interrupt. The adaptive mode learns the typical wait time of the
+ *  queue as an exponentially weighted moving average and sizes the phases with it: short waits
+ *  spin a bit longer than the average, medium waits yield and long waits block almost right
+ *  away. The pinned modes always use a single phase.
+ *
+ *  The class has no runtime dependencies, the caller measures the waits, so the policy can be
+ *  replayed against a fake completion source on the host.
+ */
+class WaitPolicy {
+ public:
+  enum Mode : uint32_t {
+    Legacy = 0,  //!< Runtime keeps its static active/blocked wait selection
+    Adaptive,    //!< Phases follow the average wait time
+    Spin,        //!< Always spin
+    Yield,       //!< Always poll with a yield
+    Block        //!< Always block
+  };
+
+  //! Phase budgets of one wait
+  struct Plan {
+    uint64_t spinNs_;   //!< Time to spin
+    uint64_t yieldNs_;  //!< Time to poll with a yield after the spin, then block
+  };
+
+  static constexpr uint64_t kUnlimited = std::numeric_limits<uint64_t>::max();
+  static constexpr uint64_t kMinSpinNs = 1000;  //!< Spin of the waits which will block
+
+  explicit WaitPolicy(uint32_t mode = Legacy, uint64_t maxSpinNs = 50000)
+      : mode_((mode <= Block) ? static_cast<Mode>(mode) : Legacy),
+        maxSpinNs_(std::max(maxSpinNs, kMinSpinNs)),
+        maxYieldNs_(4 * maxSpinNs_),
+        average_(0),
+        samples_(0) {}
+
+  //! Returns true if the runtime should use the policy instead of its static selection
+  bool Enabled() const { return mode_ != Legacy; }
+
+  Mode mode() const { return mode_; }
+
+  //! Returns the phase budgets for the next wait
+  Plan GetPlan() const {
+    switch (mode_) {
+      case Spin:
+        return Plan{kUnlimited, 0};
+      case Yield:
+        return Plan{0, kUnlimited};
+      case Block:
+        return Plan{0, 0};
+      default:
+        break;
+    }
+    if (samples_.load(std::memory_order_relaxed) == 0) {
+      // Nothing is known about the queue yet, spin shortly and poll for a while
+      return Plan{maxSpinNs_, maxYieldNs_};
+    }
+    const uint64_t average = average_.load(std::memory_order_relaxed);
+    if (average < maxSpinNs_) {
+      // Short waits, spin past the typical completion time
+      return Plan{std::min(maxSpinNs_, 2 * average + kMinSpinNs), maxYieldNs_};
+    }
+    if (average < maxYieldNs_) {
+      // Medium waits, keep the core available to other threads
+      return Plan{kMinSpinNs, std::min(maxYieldNs_, 2 * average)};
+    }
+    // Long waits, the interrupt latency is small compared to the wait
+    return Plan{kMinSpinNs, 0};
+  }
+
+  //! Adds the duration of a completed wait to the average
+  void Record(uint64_t waitNs) {
+    // Concurrent waiters may lose an update, which doesn't matter for an estimate
+    const uint64_t average = average_.load(std::memory_order_relaxed);
+    if (samples_.fetch_add(1, std::memory_order_relaxed) == 0) {
+      average_.store(waitNs, std::memory_order_relaxed);
+    } else {
+      // average += (sample - average) / 8
+      average_.store(average - (average >> 3) + (waitNs >> 3), std::memory_order_relaxed);
+    }
+  }
+
+  //! Returns the average wait time in ns
+  uint64_t Average() const { return average_.load(std::memory_order_relaxed); }
+
+ private:
+  const Mode mode_;                 //!< Selected mode
+  const uint64_t maxSpinNs_;        //!< Spin limit of the adaptive mode
+  const uint64_t maxYieldNs_;       //!< Yield limit of the adaptive mode
+  std::atomic<uint64_t> average_;   //!< Moving average of the wait time
+  std::atomic<uint64_t> samples_;   //!< Number of recorded waits
+};
+
+}  // namespace amd::device
@@ -26,18 +26,11 @@
 #include "device/pal/palkernel.hpp"
 #include "device/pal/palprogram.hpp"
 #include "device/pal/palprintf.hpp"
+#include "device/devhcprintf.hpp"
 #include <cstdio>
 #include <algorithm>
 #include <cmath>
 
-// Functions defined in devhcprintf.cpp
-namespace amd {
-void handlePrintfDelayed(const uint64_t* input, uint64_t len, uint64_t control);
-bool populateFormatStringHashMap(
-    const std::vector<device::PrintfInfo> &printfInfo,
-    std::map<uint64_t, std::string> &strMap);
-} // namespace amd
-
 namespace amd::pal {
 
 PrintfDbg::PrintfDbg(Device& device, FILE* file)
@@ -586,7 +579,8 @@ bool PrintfDbgHSA::init(VirtualGPU& gpu, bool printfEnabled) {
 }
 
 bool PrintfDbgHSA::output(VirtualGPU& gpu, bool printfEnabled,
-                          const std::vector<device::PrintfInfo>& printfInfo) {
+                          const std::vector<device::PrintfInfo>& printfInfo,
+                          const amd::PrintfFormatMap& printfFormats) {
   if (printfEnabled) {
     uint32_t offsetSize = 0;
     xferBufRead_ = &(dev().xferRead().acquire());
@@ -615,9 +609,7 @@ bool PrintfDbgHSA::output(VirtualGPU& gpu, bool printfEnabled,
     size_t bufSize = dev().xferRead().bufSize();
     size_t copySize = offsetSize;
 
-    // Map between 64 bit MD5 format string hash and
-    // actual format string
-    std::map<uint64_t, std::string> StrMap;
+    amd::PrintfOutput out;
 
     while (copySize != 0) {
       // Copy the buffer data (i.e., the printfID followed by the
@@ -639,59 +631,9 @@ bool PrintfDbgHSA::output(VirtualGPU& gpu, bool printfEnabled,
 
       // Handle HIP nonhostcall printf here,
       if (amd::IS_HIP) {
-        auto BufferForHIP = reinterpret_cast<uint32_t*>(dbgBufferPtr);
-
-        // Populate string map with hashes and actual
-        // format strings.
-        if(!amd::populateFormatStringHashMap(printfInfo, StrMap))
-          return false;
-
-        while (sbt < copySize) {
-          auto controlDword = *BufferForHIP++;
-          uint64_t nextOffset  = controlDword >> 2;
-
-          if (sbt + nextOffset > bufSize) {
-            break;  // Need new portion of data in staging buffer
-          }
-
-          auto PB = (uint64_t*)BufferForHIP;
-          std::vector<uint8_t> PBuffer;
-          uint64_t BufferLen = 0;
-          if (controlDword & 2U) {
-            // Process the contsant format string case.
-            // The first value is the 64 bit format string hash
-            // and remaining values are printf arguments.
-            // Construct a temporary buffer with actual format
-            // string followed by arguments. The format string is
-            // obtained by querying StrMap populated before.
-            auto ArgsLen = nextOffset - 12;
-            auto Str = StrMap[*PB++];
-            auto StrLenWithNull = Str.size() + 1;
-            BufferLen = ArgsLen + amd::alignUp(StrLenWithNull, sizeof(uint64_t));
-            PBuffer.resize(BufferLen);
-            memcpy(PBuffer.data(), Str.c_str(), StrLenWithNull);
-            memset(PBuffer.data() + Str.size(), 0, 8 - (StrLenWithNull % 8 ));
-            memcpy(PBuffer.data() + amd::alignUp(StrLenWithNull, sizeof(uint64_t)),
-                   PB, ArgsLen);
-          }
-          else {
-            // Process Non constant format string case.
-            // Here, The buffer itself contains the actual
-            // format string and hence just copy the contents
-            // of format string and arguments into a temporary
-            // buffer
-            BufferLen = nextOffset - /*ControlDWord*/4;
-            PBuffer.resize(BufferLen);
-            memcpy(PBuffer.data(), BufferForHIP, nextOffset);
-          }
-
-          // Handle printing
-          amd::handlePrintfDelayed((uint64_t*)PBuffer.data(), BufferLen / 8,
-                              controlDword);
-          BufferForHIP += (nextOffset / 4) - /*ControlDWord*/1;
-          sbt += nextOffset;
-        }
-
+        // The format strings were parsed and keyed by their hash at kernel load
+        sbt = amd::handlePrintfBuffer(dbgBufferPtr, std::min(copySize, bufSize), printfFormats,
+                                      out);
         copySize -= sbt;
         xferBufRead_->unmap(&gpu);
         continue;
@@ -167,7 +167,8 @@ class PrintfDbgHSA : public PrintfDbg {
   //! Prints the kernel's debug informaiton from the buffer
   bool output(VirtualGPU& gpu,                                   //!< Virtual GPU object
               bool printfEnabled,                                //!< checks for printf
-              const std::vector<device::PrintfInfo>& printfInfo  //!< printf info
+              const std::vector<device::PrintfInfo>& printfInfo, //!< printf info
+              const amd::PrintfFormatMap& printfFormats          //!< parsed HIP formats
   );
 
  private:
@@ -1332,7 +1332,12 @@ void VirtualGPU::submitWriteMemory(amd::WriteMemoryCommand& vcmd) {
         origin.c[0] *= elemSize;
         size.c[0] *= elemSize;
       }
-      if ((hostMemory != nullptr) && (vcmd.size()[0] > dev().settings().prepinnedMinSize_)){
+      if (vcmd.conversion().enabled()) {
+        // Converting writes go through the host path of the blit manager
+        result = blitMgr().writeBufferConvert(vcmd.source(), *memory, origin, size,
+                                              vcmd.conversion(), vcmd.isEntireMemory());
+      } else if ((hostMemory != nullptr) &&
+                 (vcmd.size()[0] > dev().settings().prepinnedMinSize_)) {
         // Accelerated transfer without pinning
         amd::Coord3D srcOrigin(offset);
         result = blitMgr().copyBuffer(*hostMemory, *memory, srcOrigin, origin, size,
@@ -2228,7 +2233,7 @@ void VirtualGPU::submitVirtualMap(amd::VirtualMapCommand& vcmd) {
     vaddr_pal_mem->iMem(),
     vaddr_offset,
     phymem_igpu_mem,
-    0,
+    vcmd.offset(),
     vcmd.size(),
     Pal::VirtualGpuMemAccessMode::NoAccess
   };
@@ -2734,7 +2739,8 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
     constexpr bool kNeedFLush = false;
     setGpuEvent(gpuEvent, kNeedFLush);
 
-    if (printfEnabled && !printfDbgHSA().output(*this, printfEnabled, hsaKernel.printfInfo())) {
+    if (printfEnabled && !printfDbgHSA().output(*this, printfEnabled, hsaKernel.printfInfo(),
+                                                             hsaKernel.printfFormats())) {
       LogError("Couldn't read printf data from the buffer!\n");
       return false;
     }
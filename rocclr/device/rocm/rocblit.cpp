@@ -219,13 +219,15 @@ bool DmaBlitManager::readImage(device::Memory& srcMemory, void* dstHost,
 // ================================================================================================
 bool DmaBlitManager::writeMemoryStaged(const void* srcHost, Memory& dstMemory, address staging,
                                        size_t origin, size_t& offset, size_t& totalSize,
-                                       size_t xferSize) const {
+                                       size_t xferSize,
+                                       const amd::CopyConversion* conversion) const {
   address dst = dstMemory.getDeviceMemory();
 
-  // Copy data from host to device
+  // Copy data from host to device, offset is in destination bytes
   dst += origin + offset;
-  const_address src = reinterpret_cast<const_address>(srcHost) + offset;
-  bool retval = hsaCopyStaged(src, dst, totalSize, staging, true);
+  const_address src = reinterpret_cast<const_address>(srcHost) +
+      ((conversion != nullptr) ? conversion->srcBytes(offset) : offset);
+  bool retval = hsaCopyStaged(src, dst, totalSize, staging, true, conversion);
 
   return retval;
 }
@@ -322,6 +324,38 @@ bool DmaBlitManager::writeBuffer(const void* srcHost, device::Memory& dstMemory,
   return true;
 }
 
+// ================================================================================================
+bool DmaBlitManager::writeBufferConvert(const void* srcHost, device::Memory& dstMemory,
+                                        const amd::Coord3D& origin, const amd::Coord3D& size,
+                                        const amd::CopyConversion& conversion,
+                                        bool entire) const {
+  // Use host conversion if memory has direct access
+  if (setup_.disableWriteBuffer_ || dstMemory.isHostMemDirectAccess() ||
+      gpuMem(dstMemory).IsPersistentDirectMap()) {
+    // Stall GPU before CPU access
+    gpu().releaseGpuMemoryFence();
+    return HostBlitManager::writeBufferConvert(srcHost, dstMemory, origin, size, conversion,
+                                               entire);
+  }
+
+  // Pinned transfers can't convert, so the host fills the staging buffers with
+  // the converted data and the copy engine uploads them
+  gpu().releaseGpuMemoryFence(kSkipCpuWait);
+
+  size_t dstSize = size[0];
+  size_t offset = 0;
+  address staging = gpu().Staging().Acquire(
+      std::min(dstSize, dev().settings().stagedXferSize_));
+
+  if (!writeMemoryStaged(srcHost, gpuMem(dstMemory), staging, origin[0], offset, dstSize,
+                         dstSize, &conversion)) {
+    LogError("DmaBlitManager::writeBufferConvert failed!");
+    return false;
+  }
+
+  return true;
+}
+
 // ================================================================================================
 bool DmaBlitManager::writeBufferRect(const void* srcHost, device::Memory& dstMemory,
                                      const amd::BufferRect& hostRect,
@@ -775,13 +809,18 @@ bool DmaBlitManager::hsaCopy(const Memory& srcMemory, const Memory& dstMemory,
 
 // ================================================================================================
 bool DmaBlitManager::hsaCopyStaged(const_address hostSrc, address hostDst, size_t size,
-                                   address staging, bool hostToDev) const {
+                                   address staging, bool hostToDev,
+                                   const amd::CopyConversion* conversion) const {
   // Stall GPU, sicne CPU copy is possible
   gpu().releaseGpuMemoryFence(hostToDev);
 
   // No allocation is necessary for Full Profile
   hsa_status_t status;
   if (dev().agent_profile() == HSA_PROFILE_FULL) {
+    if (conversion != nullptr) {
+      // The device memory is host accessible, so convert straight into it
+      return (*conversion)(hostDst, hostSrc, size);
+    }
     status = hsa_memory_copy(hostDst, hostSrc, size);
     if (status != HSA_STATUS_SUCCESS) {
       LogPrintfError("Hsa copy of data failed with code %d", status);
@@ -789,6 +828,56 @@ bool DmaBlitManager::hsaCopyStaged(const_address hostSrc, address hostDst, size_
     return (status == HSA_STATUS_SUCCESS);
   }
 
+  if (hostToDev) {
+    // Copy data from Host to Device through the staging buffer
+    struct UploadEngine {
+      VirtualGPU& gpu_;
+      const Device& dev_;
+      address dst_;
+      hsa_agent_t srcAgent_;
+      HwQueueEngine engine_;
+      hsa_signal_t active_;
+      std::vector<hsa_signal_t> waitEvents_;
+
+      void Begin() {
+        gpu_.Barriers().SetActiveEngine(engine_);
+        waitEvents_ = gpu_.Barriers().WaitingSignal(engine_);
+        active_ = gpu_.Barriers().ActiveSignal(kInitSignalValueOne, gpu_.timestamp());
+      }
+      void Abort() {
+        gpu_.Barriers().ResetCurrentSignal();
+        LogError("Host conversion into the staging buffer failed");
+      }
+      bool Copy(size_t offset, const void* src, size_t size) {
+        hsa_status_t status = hsa_amd_memory_async_copy(
+            dst_ + offset, dev_.getBackendDevice(), src, srcAgent_, size,
+            waitEvents_.size(), waitEvents_.data(), active_);
+        ClPrint(amd::LOG_DEBUG, amd::LOG_COPY,
+            "HSA Async Copy staged H2D dst=0x%zx, src=0x%zx, size=%ld, completion_signal=0x%zx",
+            dst_ + offset, src, size, active_.handle);
+        if (status != HSA_STATUS_SUCCESS) {
+          gpu_.Barriers().ResetCurrentSignal();
+          LogPrintfError("Hsa copy from host to device failed with code %d", status);
+          return false;
+        }
+        return true;
+      }
+      void Wait() { gpu_.Barriers().WaitCurrent(); }
+    };
+
+    const hsa_agent_t srcAgent = dev().getCpuAgent();
+    UploadEngine upload = {gpu(), dev(), hostDst, srcAgent, HwQueueEngine::Unknown, {}, {}};
+    if (srcAgent.handle == dev().getBackendDevice().handle) {
+      upload.engine_ = HwQueueEngine::SdmaWrite;
+    }
+    if (!amd::device::StagedUpload(upload, hostSrc, size, staging,
+                                   dev().settings().stagedXferSize_, conversion)) {
+      return false;
+    }
+    gpu().addSystemScope();
+    return true;
+  }
+
   size_t totalSize = size;
   size_t offset = 0;
 
@@ -798,40 +887,6 @@ bool DmaBlitManager::hsaCopyStaged(const_address hostSrc, address hostDst, size_
   while (totalSize > 0) {
     size = std::min(totalSize, dev().settings().stagedXferSize_);
 
-    // Copy data from Host to Device
-    if (hostToDev) {
-      const hsa_agent_t srcAgent = dev().getCpuAgent();
-
-      HwQueueEngine engine = HwQueueEngine::Unknown;
-      if (srcAgent.handle == dev().getBackendDevice().handle) {
-        engine = HwQueueEngine::SdmaWrite;
-      }
-      gpu().Barriers().SetActiveEngine(engine);
-      auto wait_events = gpu().Barriers().WaitingSignal(engine);
-      hsa_signal_t active = gpu().Barriers().ActiveSignal(kInitSignalValueOne, gpu().timestamp());
-
-      memcpy(hsaBuffer, hostSrc + offset, size);
-      status = hsa_amd_memory_async_copy(
-          hostDst + offset, dev().getBackendDevice(), hsaBuffer, srcAgent, size,
-          wait_events.size(), wait_events.data(), active);
-      ClPrint(amd::LOG_DEBUG, amd::LOG_COPY,
-          "HSA Async Copy staged H2D dst=0x%zx, src=0x%zx, size=%ld, completion_signal=0x%zx",
-          hostDst + offset, hsaBuffer, size, active.handle);
-
-      if (status != HSA_STATUS_SUCCESS) {
-        gpu().Barriers().ResetCurrentSignal();
-        LogPrintfError("Hsa copy from host to device failed with code %d", status);
-        return false;
-      }
-      totalSize -= size;
-      if (totalSize > 0) {
-        // Wait if there are extra copies, which don't fit in a single staging buffer
-        gpu().Barriers().WaitCurrent();
-      }
-      offset += size;
-      continue;
-    }
-
     const hsa_agent_t dstAgent = dev().getCpuAgent();
 
     HwQueueEngine engine = HwQueueEngine::Unknown;
@@ -1974,6 +2029,20 @@ bool KernelBlitManager::writeBuffer(const void* srcHost, device::Memory& dstMemo
   return result;
 }
 
+// ================================================================================================
+bool KernelBlitManager::writeBufferConvert(const void* srcHost, device::Memory& dstMemory,
+                                           const amd::Coord3D& origin, const amd::Coord3D& size,
+                                           const amd::CopyConversion& conversion,
+                                           bool entire) const {
+  amd::ScopedLock k(lockXferOps_);
+
+  bool result = DmaBlitManager::writeBufferConvert(srcHost, dstMemory, origin, size, conversion,
+                                                   entire);
+  synchronize();
+
+  return result;
+}
+
 // ================================================================================================
 bool KernelBlitManager::writeBufferRect(const void* srcHost, device::Memory& dstMemory,
                                         const amd::BufferRect& hostRect,
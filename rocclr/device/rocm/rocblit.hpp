@@ -97,6 +97,15 @@ class DmaBlitManager : public device::HostBlitManager {
                                      amd::CopyMetadata()//!< Memory copy MetaData
                            ) const;
 
+  //! Copies system memory to a buffer object, converting the elements on the way
+  virtual bool writeBufferConvert(const void* srcHost,         //!< Source host memory
+                                  device::Memory& dstMemory,   //!< Destination memory object
+                                  const amd::Coord3D& origin,  //!< Destination origin
+                                  const amd::Coord3D& size,    //!< Destination size in bytes
+                                  const amd::CopyConversion& conversion,  //!< Conversion
+                                  bool entire = false          //!< Entire buffer will be updated
+                                  ) const;
+
   //! Copies system memory to a buffer object
   virtual bool writeBufferRect(const void* srcHost,              //!< Source host memory
                                device::Memory& dstMemory,        //!< Destination memory object
@@ -265,7 +274,8 @@ class DmaBlitManager : public device::HostBlitManager {
                          size_t origin,        //!< Original offset in the destination memory
                          size_t& offset,       //!< Offset for the current copy pointer
                          size_t& totalSize,    //!< Total size for the copy region
-                         size_t xferSize       //!< Transfer size
+                         size_t xferSize,      //!< Transfer size
+                         const amd::CopyConversion* conversion = nullptr  //!< Host conversion
                          ) const;
 
   //! Assits in transferring data from Host to Local or vice versa
@@ -274,7 +284,9 @@ class DmaBlitManager : public device::HostBlitManager {
                      address hostDst,        //!< Destination buffer address for copying
                      size_t size,            //!< Size of data to copy in bytes
                      address staging,        //!< Staging resource
-                     bool hostToDev          //!< True if data is copied from Host To Device
+                     bool hostToDev,         //!< True if data is copied from Host To Device
+                     const amd::CopyConversion* conversion = nullptr  //!< Conversion applied
+                                                                      //!< while filling staging
                      ) const;
 
   bool forceHostWaitFunc(size_t copy_size) const;
@@ -357,6 +369,15 @@ class KernelBlitManager : public DmaBlitManager {
                                      amd::CopyMetadata()//!< Memory copy MetaData
                            ) const;
 
+  //! Copies system memory to a buffer object, converting the elements on the way
+  virtual bool writeBufferConvert(const void* srcHost,         //!< Source host memory
+                                  device::Memory& dstMemory,   //!< Destination memory object
+                                  const amd::Coord3D& origin,  //!< Destination origin
+                                  const amd::Coord3D& size,    //!< Destination size in bytes
+                                  const amd::CopyConversion& conversion,  //!< Conversion
+                                  bool entire = false          //!< Entire buffer will be updated
+                                  ) const;
+
   //! Copies system memory to a buffer object
   virtual bool writeBufferRect(const void* srcHost,              //!< Source host memory
                                device::Memory& dstMemory,        //!< Destination memory object
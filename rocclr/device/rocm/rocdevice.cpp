@@ -49,6 +49,7 @@
 #endif
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -58,6 +59,7 @@
 #include <numaif.h>
 #endif // ROCCLR_SUPPORT_NUMA_POLICY
 #include <sstream>
+#include <thread>
 #include <vector>
 #endif // WITHOUT_HSA_BaCKEND
 
@@ -178,6 +180,8 @@ Device::Device(hsa_agent_t bkendDevice)
     , gpuvm_segment_max_alloc_(0)
     , alloc_granularity_(0)
     , xferQueue_(nullptr)
+    , signalPool_(nullptr)
+    , doorbellFlusher_(nullptr)
     , xferRead_(nullptr)
     , freeMem_(0)
     , vgpusAccess_(true) /* Virtual GPU List Ops Lock */
@@ -242,6 +246,12 @@ void Device::checkAtomicSupport() {
 }
 
 Device::~Device() {
+  // Stop the doorbell thread before the queues go away
+  if (doorbellFlusher_ != nullptr) {
+    doorbellFlusher_->Stop();
+    delete doorbellFlusher_;
+    doorbellFlusher_ = nullptr;
+  }
   if (coopHostcallBuffer_) {
     amd::disableHostcalls(coopHostcallBuffer_);
     context().svmFree(coopHostcallBuffer_);
@@ -293,6 +303,10 @@ Device::~Device() {
   // Destroy transfer queue
   delete xferQueue_;
 
+  // Signals still held by events or timestamps are detached from the pool and destroyed on
+  // their last release
+  delete signalPool_;
+
   delete blitProgram_;
 
   if (context_ != nullptr) {
@@ -836,6 +850,25 @@ bool Device::create() {
     return false;
   }
 
+  // Create the pool of completion signals shared by the queues of the device
+  signalPool_ = new SignalPool(*this);
+  if (!signalPool_->Create()) {
+    LogError("Couldn't create the signal pool");
+    return false;
+  }
+
+  if (AMD_DIRECT_DISPATCH && (DEBUG_CLR_DOORBELL_COALESCE_PACKETS > 1)) {
+    doorbellFlusher_ = new DoorbellFlusher(*this);
+    if ((doorbellFlusher_ == nullptr) ||
+        (doorbellFlusher_->state() < amd::Thread::INITIALIZED) ||
+        !doorbellFlusher_->start(this)) {
+      // The queues ring every doorbell without the thread
+      LogWarning("Couldn't start the doorbell flush thread");
+      delete doorbellFlusher_;
+      doorbellFlusher_ = nullptr;
+    }
+  }
+
   return true;
 }
 
@@ -2948,8 +2981,14 @@ bool Device::IsHwEventReady(const amd::Event& event, bool wait, uint32_t hip_eve
     // when set the CPU gives up host thread for other work
     // when not set the CPU enters a busy-wait on the event to occur
     constexpr int kHipEventBlockingSync = 0x1;
+    hsa_signal_t signal = reinterpret_cast<ProfilingSignal*>(hw_event)->signal_;
+    amd::HostQueue* queue = event.command().queue();
+    if (!(hip_event_flags & kHipEventBlockingSync) && (queue != nullptr) &&
+        queue->vdev()->waitPolicy().Enabled()) {
+      return WaitForSignal(signal, queue->vdev()->waitPolicy());
+    }
     bool active_wait = !(hip_event_flags & kHipEventBlockingSync) && ActiveWait();
-    return WaitForSignal(reinterpret_cast<ProfilingSignal*>(hw_event)->signal_, active_wait);
+    return WaitForSignal(signal, active_wait);
   }
   return (hsa_signal_load_relaxed(reinterpret_cast<ProfilingSignal*>(hw_event)->signal_) == 0);
 }
@@ -3616,6 +3655,199 @@ ProfilingSignal::~ProfilingSignal() {
   }
 }
 
+// ================================================================================================
+bool ProfilingSignal::terminate() {
+  // Recycle the signal if the GPU is done with it and nobody waits for its timestamps
+  if ((pool_ != nullptr) && (ts_ == nullptr) && (hsa_signal_load_relaxed(signal_) <= 0)) {
+    // Restore the reference for the next owner
+    retain();
+    if (pool_->Recycle(this)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ================================================================================================
+bool SignalPoolLink::Recycle(ProfilingSignal* signal) {
+  // Announce the recycle before the pool is read, Detach() checks both in the opposite order
+  users_.fetch_add(1);
+  SignalPool* pool = pool_.load();
+  bool recycled = (pool != nullptr) && pool->Recycle(signal);
+  users_.fetch_sub(1);
+  return recycled;
+}
+
+// ================================================================================================
+void SignalPoolLink::Detach() {
+  pool_.store(nullptr);
+  while (users_.load() != 0) {
+    amd::Os::yield();
+  }
+}
+
+// ================================================================================================
+ProfilingSignal* SignalBackend::Create() {
+  std::unique_ptr<ProfilingSignal> signal(new ProfilingSignal());
+  if (signal == nullptr) {
+    return nullptr;
+  }
+  hsa_agent_t agent = dev_.getBackendDevice();
+  const Settings& settings = dev_.settings();
+  hsa_agent_t* agents = (settings.system_scope_signal_) ? nullptr : &agent;
+  uint32_t num_agents = (settings.system_scope_signal_) ? 0 : 1;
+
+  if (HSA_STATUS_SUCCESS != hsa_signal_create(0, num_agents, agents, &signal->signal_)) {
+    return nullptr;
+  }
+  signal->pool_ = pool_;
+  return signal.release();
+}
+
+// ================================================================================================
+void SignalBackend::Destroy(ProfilingSignal* signal) {
+  signal->pool_ = nullptr;
+  signal->release();
+}
+
+// ================================================================================================
+SignalPool::SignalPool(const Device& dev)
+    : device::SignalPool<ProfilingSignal, SignalBackend>(
+          SignalBackend(dev, std::make_shared<SignalPoolLink>(this)), DEBUG_CLR_SIGNAL_POOL_LOW,
+          std::max(DEBUG_CLR_SIGNAL_POOL_HIGH, DEBUG_CLR_SIGNAL_POOL_LOW)),
+      lock_(true) /* Signal pool lock */,
+      exit_(false),
+      refillRequested_(false),
+      thread_(nullptr) {}
+
+// ================================================================================================
+SignalPool::~SignalPool() {
+  if (thread_ != nullptr) {
+    {
+      amd::ScopedLock lock(lock_);
+      exit_ = true;
+      lock_.notify();
+    }
+    if (amd::Os::isThreadAlive(*thread_)) {
+      while (thread_->state() < amd::Thread::FINISHED) {
+        amd::Os::yield();
+      }
+    }
+    delete thread_;
+  }
+  // Signals released after this point are destroyed instead of recycled
+  backend().link().Detach();
+  Stats stats = GetStats();
+  ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Signal pool: hits %lu, created on demand %lu, refilled "
+          "%lu, recycled %lu, destroyed %lu", stats.hits_, stats.created_, stats.refilled_,
+          stats.recycled_, stats.destroyed_);
+}
+
+// ================================================================================================
+bool SignalPool::Create() {
+  if (DEBUG_CLR_SIGNAL_POOL_LOW != 0) {
+    // The thread fills the pool right after the start, so device creation doesn't wait for it
+    refillRequested_ = true;
+    thread_ = new Replenisher(*this);
+    if ((thread_ == nullptr) || (thread_->state() < amd::Thread::INITIALIZED) ||
+        !thread_->start(this)) {
+      // The pool still works without the thread, signals are created on demand
+      LogWarning("Couldn't start the signal pool thread");
+      delete thread_;
+      thread_ = nullptr;
+    }
+  }
+  return true;
+}
+
+// ================================================================================================
+ProfilingSignal* SignalPool::Acquire() {
+  ProfilingSignal* signal = device::SignalPool<ProfilingSignal, SignalBackend>::Acquire();
+  if ((thread_ != nullptr) && NeedsRefill() && !refillRequested_.exchange(true)) {
+    amd::ScopedLock lock(lock_);
+    lock_.notify();
+  }
+  return signal;
+}
+
+// ================================================================================================
+void SignalPool::Replenish() {
+  for (;;) {
+    {
+      amd::ScopedLock lock(lock_);
+      while (!exit_ && !refillRequested_.load()) {
+        lock_.wait();
+      }
+      if (exit_) {
+        break;
+      }
+    }
+    if (!Refill()) {
+      LogWarning("Signal pool refill failed");
+    }
+    refillRequested_.store(false);
+  }
+}
+
+// ================================================================================================
+DoorbellFlusher::DoorbellFlusher(const Device& dev)
+    : amd::Thread("Doorbell Flush Thread", CQ_THREAD_STACK_SIZE),
+      dev_(dev),
+      lock_(true) /* Doorbell flusher lock */,
+      exit_(false),
+      armed_(false) {}
+
+// ================================================================================================
+void DoorbellFlusher::Stop() {
+  {
+    amd::ScopedLock lock(lock_);
+    exit_ = true;
+    lock_.notify();
+  }
+  if (amd::Os::isThreadAlive(*this)) {
+    while (state() < amd::Thread::FINISHED) {
+      amd::Os::yield();
+    }
+  }
+}
+
+// ================================================================================================
+void DoorbellFlusher::run(void* data) {
+  const auto window = std::chrono::microseconds(std::max(1u, DEBUG_CLR_DOORBELL_COALESCE_US));
+  for (;;) {
+    {
+      amd::ScopedLock lock(lock_);
+      while (!exit_ && !armed_.load()) {
+        lock_.wait();
+      }
+      if (exit_) {
+        break;
+      }
+    }
+    std::this_thread::sleep_for(window);
+    // Clear the state before the sweep, so a doorbell deferred during the sweep re-arms it
+    armed_.store(false);
+    bool pending = false;
+    {
+      amd::ScopedLock lock(dev_.vgpusAccess());
+      for (auto vgpu : dev_.vgpus()) {
+        if ((vgpu == nullptr) || !vgpu->isDoorbellPending()) {
+          continue;
+        }
+        // A busy queue publishes its packets on its own, skip it instead of blocking
+        if (vgpu->execution().tryLock()) {
+          vgpu->expireDoorbell();
+          vgpu->execution().unlock();
+        }
+        pending |= vgpu->isDoorbellPending();
+      }
+    }
+    if (pending) {
+      armed_.store(true);
+    }
+  }
+}
+
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
 device::UriLocator* Device::createUriLocator() const {
@@ -32,6 +32,7 @@
 #include "utils/concurrent.hpp"
 #include "thread/thread.hpp"
 #include "thread/monitor.hpp"
+#include "device/devsignalpool.hpp"
 #include "utils/versions.hpp"
 
 #include "device/rocm/rocsettings.hpp"
@@ -75,6 +76,26 @@ class Memory;
 class Resource;
 class VirtualDevice;
 class PrintfDbg;
+class Device;
+class SignalPool;
+class ProfilingSignal;
+
+//! Connects the pooled signals with their device pool. The pool is detached before it's
+//! destroyed, so signals still held by events or timestamps don't return into freed memory.
+class SignalPoolLink {
+ public:
+  explicit SignalPoolLink(SignalPool* pool) : pool_(pool), users_(0) {}
+
+  //! Returns an idle signal into the pool. False means the pool is full or already gone
+  bool Recycle(ProfilingSignal* signal);
+
+  //! Detaches the pool and waits for the recycles in flight
+  void Detach();
+
+ private:
+  std::atomic<SignalPool*> pool_;  //!< Device pool, nullptr once detached
+  std::atomic<uint32_t> users_;    //!< Number of recycles in flight
+};
 
 class ProfilingSignal : public amd::ReferenceCountedObject {
 public:
@@ -95,6 +116,8 @@ public:
 
   Flags flags_;
 
+  std::shared_ptr<SignalPoolLink> pool_;  //!< Device pool the signal returns to, if pooled
+
   ProfilingSignal()
     : ts_(nullptr)
     , engine_(HwQueueEngine::Compute)
@@ -108,6 +131,93 @@ public:
 
   virtual ~ProfilingSignal();
   amd::Monitor& LockSignalOps() { return lock_; }
+
+ protected:
+  //! Returns an idle signal into the device pool instead of destroying it
+  bool terminate() override;
+};
+
+//! Creates and destroys the HSA signals of the device signal pool
+class SignalBackend {
+ public:
+  SignalBackend(const Device& dev, std::shared_ptr<SignalPoolLink> pool)
+      : dev_(dev), pool_(std::move(pool)) {}
+
+  //! Creates a new signal, which returns to the pool on the last release
+  ProfilingSignal* Create();
+
+  //! Destroys a signal without returning it to the pool
+  void Destroy(ProfilingSignal* signal);
+
+  //! Returns the link of the created signals to the pool
+  SignalPoolLink& link() const { return *pool_; }
+
+ private:
+  const Device& dev_;  //!< Device the signals are created for
+  std::shared_ptr<SignalPoolLink> pool_;  //!< Link to the pool of the created signals
+};
+
+//! Device-wide pool of completion signals, shared by all queues of the device. Queues take
+//! signals from the pool instead of creating them in the dispatch path, and a background
+//! thread keeps the pool above the low watermark.
+class SignalPool : public device::SignalPool<ProfilingSignal, SignalBackend> {
+ public:
+  explicit SignalPool(const Device& dev);
+  ~SignalPool();
+
+  //! Starts the replenish thread and fills the pool up to the low watermark
+  bool Create();
+
+  //! Takes a signal from the pool and wakes up the replenish thread if the pool runs low
+  ProfilingSignal* Acquire();
+
+ private:
+  class Replenisher : public amd::Thread {
+   public:
+    Replenisher(SignalPool& pool)
+        : amd::Thread("Signal Pool Thread", CQ_THREAD_STACK_SIZE), pool_(pool) {}
+
+    //! The replenish thread entry point
+    void run(void* data) { pool_.Replenish(); }
+
+   private:
+    SignalPool& pool_;  //!< Pool to refill
+  };
+
+  //! Refills the pool whenever Acquire() requests it, until the pool is destroyed
+  void Replenish();
+
+  amd::Monitor lock_;                    //!< Lock for the replenish thread wake up
+  bool exit_;                            //!< The replenish thread has to exit
+  std::atomic<bool> refillRequested_;    //!< A refill was requested and is not done yet
+  Replenisher* thread_;                  //!< Replenish thread, nullptr if not running
+};
+
+//! Publishes the coalesced doorbells of the device queues, which didn't reach a flush point
+//! within the coalescing window. The thread sleeps until a queue defers a doorbell.
+class DoorbellFlusher : public amd::Thread {
+ public:
+  explicit DoorbellFlusher(const Device& dev);
+
+  //! Wakes up the thread, called after a queue deferred a doorbell
+  void Arm() {
+    if (!armed_.load(std::memory_order_relaxed) && !armed_.exchange(true)) {
+      amd::ScopedLock lock(lock_);
+      lock_.notify();
+    }
+  }
+
+  //! Stops the thread and waits for its exit
+  void Stop();
+
+  //! The flush thread entry point
+  void run(void* data);
+
+ private:
+  const Device& dev_;         //!< Device with the queues to flush
+  amd::Monitor lock_;         //!< Lock for the thread wake up
+  bool exit_;                 //!< The thread has to exit
+  std::atomic<bool> armed_;   //!< A queue may have a deferred doorbell
 };
 
 class Sampler : public device::Sampler {
@@ -555,6 +665,12 @@ class Device : public NullDevice {
 
   VirtualGPU* xferQueue() const;
 
+  //! Returns the pool of completion signals shared by the queues of the device
+  SignalPool& signalPool() const { return *signalPool_; }
+
+  //! Returns the doorbell flush thread, nullptr if the doorbell coalescing is disabled
+  DoorbellFlusher* doorbellFlusher() const { return doorbellFlusher_; }
+
   hsa_amd_memory_pool_t SystemSegment() const { return system_segment_; }
 
   hsa_amd_memory_pool_t SystemCoarseSegment() const { return system_coarse_segment_; }
@@ -648,6 +764,8 @@ class Device : public NullDevice {
   size_t alloc_granularity_;
   static constexpr bool offlineDevice_ = false;
   VirtualGPU* xferQueue_;  //!< Transfer queue, created on demand
+  SignalPool* signalPool_; //!< Completion signals shared by the queues
+  DoorbellFlusher* doorbellFlusher_; //!< Publishes the coalesced doorbells of the queues
 
   XferBuffers* xferRead_;   //!< Transfer buffers read
   std::atomic<size_t> freeMem_;   //!< Total of free memory available
@@ -66,7 +66,8 @@ class PrintfDbg : public amd::HeapObject {
   //! Prints the kernel's debug informaiton from the buffer
   bool output(VirtualGPU& gpu,
               bool printfEnabled,                        //!< checks for printf
-              const std::vector<device::PrintfInfo>& printfInfo  //!< printf info
+              const std::vector<device::PrintfInfo>& printfInfo, //!< printf info
+              const amd::PrintfFormatMap& printfFormats  //!< parsed HIP printf formats
               );
 
   //! Returns debug buffer object
@@ -182,6 +182,13 @@ void Timestamp::checkGpuTime() {
   }
 }
 
+// ================================================================================================
+//! Releases the AQL queue, blocked by the signal of a command with an API callback
+static void ReleaseCallbackSignal(void* data) {
+  hsa_signal_t signal = {reinterpret_cast<uint64_t>(data)};
+  hsa_signal_subtract_relaxed(signal, 1);
+}
+
 // ================================================================================================
 bool HsaAmdSignalHandler(hsa_signal_value_t value, void* arg) {
   Timestamp* ts = reinterpret_cast<Timestamp*>(arg);
@@ -234,12 +241,22 @@ bool HsaAmdSignalHandler(hsa_signal_value_t value, void* arg) {
   // Reset last used SDMA engine mask
   ts->gpu()->setLastUsedSdmaEngine(0);
 
+  // The callbacks may keep the AQL queue blocked after they return, so the command with the
+  // callback stays alive until the last hold of the callback signal is dropped
+  amd::Command& command = ts->command();
+  if (callback_signal.handle != 0) {
+    command.retain();
+    command.SetCallbackBlock(&ReleaseCallbackSignal,
+                             reinterpret_cast<void*>(callback_signal.handle));
+  }
+
   // Update the batch, since signal is complete
-  ts->gpu()->updateCommandsState(ts->command().GetBatchHead());
+  ts->gpu()->updateCommandsState(command.GetBatchHead());
 
   // Reset API callback signal. It will release AQL queue and start commands processing
   if (callback_signal.handle != 0) {
-    hsa_signal_subtract_relaxed(callback_signal, 1);
+    command.ReleaseCallbackBlock();
+    command.release();
   }
 
   // Return false, so the callback will not be called again for this signal
@@ -249,13 +266,10 @@ bool HsaAmdSignalHandler(hsa_signal_value_t value, void* arg) {
 // ================================================================================================
 bool VirtualGPU::MemoryDependency::create(size_t numMemObj) {
   if (numMemObj > 0) {
-    // Allocate the array of memory objects for dependency tracking
-    memObjectsInQueue_ = new MemoryState[numMemObj];
-    if (nullptr == memObjectsInQueue_) {
-      return false;
-    }
-    memset(memObjectsInQueue_, 0, sizeof(MemoryState) * numMemObj);
-    maxMemObjectsInQueue_ = numMemObj;
+    // The sets grow on demand, the reservation only avoids reallocations in the common case
+    busy_.reserve(numMemObj);
+    current_.reserve(numMemObj);
+    enabled_ = true;
   }
 
   return true;
@@ -263,9 +277,7 @@ bool VirtualGPU::MemoryDependency::create(size_t numMemObj) {
 
 // ================================================================================================
 void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memory, bool readOnly) {
-  bool flushL1Cache = false;
-
-  if (maxMemObjectsInQueue_ == 0) {
+  if (!enabled_) {
     // Sync AQL packets
     gpu.setAqlHeader(gpu.dispatchPacketHeader_);
     return;
@@ -274,33 +286,9 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
   uint64_t curStart = reinterpret_cast<uint64_t>(memory->getDeviceMemory());
   uint64_t curEnd = curStart + memory->size();
 
-  // Loop through all memory objects in the queue and find dependency
+  // Find a dependency on the memory used by the kernels in the queue
   // @note don't include objects from the current kernel
-  for (size_t j = 0; j < endMemObjectsInQueue_; ++j) {
-    // Check if the queue already contains this mem object and
-    // GPU operations aren't readonly
-    uint64_t busyStart = memObjectsInQueue_[j].start_;
-    uint64_t busyEnd = memObjectsInQueue_[j].end_;
-
-    // Check if the start inside the busy region
-    if ((((curStart >= busyStart) && (curStart < busyEnd)) ||
-         // Check if the end inside the busy region
-         ((curEnd > busyStart) && (curEnd <= busyEnd)) ||
-         // Check if the start/end cover the busy region
-         ((curStart <= busyStart) && (curEnd >= busyEnd))) &&
-        // If the buys region was written or the current one is for write
-        (!memObjectsInQueue_[j].readOnly_ || !readOnly)) {
-      flushL1Cache = true;
-      break;
-    }
-  }
-
-  // Did we reach the limit?
-  if (maxMemObjectsInQueue_ <= numMemObjectsInQueue_) {
-    flushL1Cache = true;
-  }
-
-  if (flushL1Cache) {
+  if (busy_.conflicts(curStart, curEnd, readOnly)) {
     // Sync AQL packets
     gpu.setAqlHeader(gpu.dispatchPacketHeader_);
 
@@ -309,48 +297,17 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
     clear(!All);
   }
 
-  // Insert current memory object into the queue always,
+  // Insert current memory object into the tracker always,
   // since runtime calls flush before kernel execution and it has to keep
   // current kernel in tracking
-  memObjectsInQueue_[numMemObjectsInQueue_].start_ = curStart;
-  memObjectsInQueue_[numMemObjectsInQueue_].end_ = curEnd;
-  memObjectsInQueue_[numMemObjectsInQueue_].readOnly_ = readOnly;
-  numMemObjectsInQueue_++;
+  current_.insert(curStart, curEnd, readOnly);
 }
 
 // ================================================================================================
 void VirtualGPU::MemoryDependency::clear(bool all) {
-  if (numMemObjectsInQueue_ > 0) {
-    if (all) {
-      endMemObjectsInQueue_ = numMemObjectsInQueue_;
-    }
-
-    // If the current launch didn't start from the beginning, then move the data
-    if (0 != endMemObjectsInQueue_) {
-      // Preserve all objects from the current kernel
-      size_t i, j;
-      for (i = 0, j = endMemObjectsInQueue_; j < numMemObjectsInQueue_; i++, j++) {
-        memObjectsInQueue_[i].start_ = memObjectsInQueue_[j].start_;
-        memObjectsInQueue_[i].end_ = memObjectsInQueue_[j].end_;
-        memObjectsInQueue_[i].readOnly_ = memObjectsInQueue_[j].readOnly_;
-      }
-    } else if (numMemObjectsInQueue_ >= maxMemObjectsInQueue_) {
-      // note: The array growth shouldn't occur under the normal conditions,
-      // but in a case when SVM path sends the amount of SVM ptrs over
-      // the max size of kernel arguments
-      MemoryState* ptr  = new MemoryState[maxMemObjectsInQueue_ << 1];
-      if (nullptr == ptr) {
-        numMemObjectsInQueue_ = 0;
-        return;
-      }
-      maxMemObjectsInQueue_ <<= 1;
-      memcpy(ptr, memObjectsInQueue_, sizeof(MemoryState) * numMemObjectsInQueue_);
-      delete[] memObjectsInQueue_;
-      memObjectsInQueue_= ptr;
-    }
-
-    numMemObjectsInQueue_ -= endMemObjectsInQueue_;
-    endMemObjectsInQueue_ = 0;
+  busy_.clear();
+  if (all) {
+    current_.clear();
   }
 }
 
@@ -368,18 +325,12 @@ bool VirtualGPU::HwQueueTracker::Create() {
 
   signal_list_.resize(kSignalListSize);
 
-  hsa_agent_t agent = gpu_.gpu_device();
-  const Settings& settings = gpu_.dev().settings();
-  hsa_agent_t* agents = (settings.system_scope_signal_) ? nullptr : &agent;
-  uint32_t num_agents = (settings.system_scope_signal_) ? 0 : 1;
-
   for (uint i = 0; i < kSignalListSize; ++i) {
-    std::unique_ptr<ProfilingSignal> signal(new ProfilingSignal());
-    if ((signal == nullptr) ||
-        (HSA_STATUS_SUCCESS != hsa_signal_create(0, num_agents, agents, &signal->signal_))) {
+    ProfilingSignal* signal = gpu_.dev().signalPool().Acquire();
+    if (signal == nullptr) {
       return false;
     }
-    signal_list_[i] = signal.release();
+    signal_list_[i] = signal;
   }
   return true;
 }
@@ -393,20 +344,13 @@ hsa_signal_t VirtualGPU::HwQueueTracker::ActiveSignal(
   auto temp_id = (current_id_ + 2) % signal_list_.size();
   // If GPU is still busy with processing, then add more signals to avoid more frequent stalls
   if (hsa_signal_load_relaxed(signal_list_[temp_id]->signal_) > 0) {
-    std::unique_ptr<ProfilingSignal> signal(new ProfilingSignal());
+    ProfilingSignal* signal = gpu_.dev().signalPool().Acquire();
     if (signal != nullptr) {
-      hsa_agent_t agent = gpu_.gpu_device();
-      const Settings& settings = gpu_.dev().settings();
-      hsa_agent_t* agents = (settings.system_scope_signal_) ? nullptr : &agent;
-      uint32_t num_agents = (settings.system_scope_signal_) ? 0 : 1;
-
-      if (HSA_STATUS_SUCCESS == hsa_signal_create(0, num_agents, agents, &signal->signal_)) {
-        // Find valid new index
-        ++current_id_ %= signal_list_.size();
-        // Insert the new signal into the current slot and ignore any wait
-        signal_list_.insert(signal_list_.begin() + current_id_, signal.release());
-        new_signal = true;
-      }
+      // Find valid new index
+      ++current_id_ %= signal_list_.size();
+      // Insert the new signal into the current slot and ignore any wait
+      signal_list_.insert(signal_list_.begin() + current_id_, signal);
+      new_signal = true;
     }
   }
 
@@ -426,20 +370,11 @@ hsa_signal_t VirtualGPU::HwQueueTracker::ActiveSignal(
 
   if (signal_list_[current_id_]->referenceCount() > 1) {
     // The signal was assigned to the global marker's event, hence runtime can't reuse it
-    // and needs a new signal
-    std::unique_ptr<ProfilingSignal> signal(new ProfilingSignal());
+    // and needs a new signal. The event returns the old one into the pool on its release.
+    ProfilingSignal* signal = gpu_.dev().signalPool().Acquire();
     if (signal != nullptr) {
-      hsa_agent_t agent = gpu_.gpu_device();
-      const Settings& settings = gpu_.dev().settings();
-      hsa_agent_t* agents = (settings.system_scope_signal_) ? nullptr : &agent;
-      uint32_t num_agents = (settings.system_scope_signal_) ? 0 : 1;
-
-      if (HSA_STATUS_SUCCESS == hsa_signal_create(0, num_agents, agents, &signal->signal_)) {
-        signal_list_[current_id_]->release();
-        signal_list_[current_id_] = signal.release();
-      } else {
-        assert(!"ProfilingSignal reallocation failed! Marker has a conflict with signal reuse!");
-      }
+      signal_list_[current_id_]->release();
+      signal_list_[current_id_] = signal;
     } else {
       assert(!"ProfilingSignal reallocation failed! Marker has a conflict with signal reuse!");
     }
@@ -565,6 +500,8 @@ std::vector<hsa_signal_t>& VirtualGPU::HwQueueTracker::WaitingSignal(HwQueueEngi
 
 // ================================================================================================
 bool VirtualGPU::HwQueueTracker::CpuWaitForSignal(ProfilingSignal* signal) {
+  // The signal may belong to a packet of the current batch
+  gpu_.flushDoorbell();
   // Wait for the current signal
   if (signal->ts_ != nullptr) {
     // Update timestamp values if requested
@@ -576,7 +513,10 @@ bool VirtualGPU::HwQueueTracker::CpuWaitForSignal(ProfilingSignal* signal) {
     amd::ScopedLock lock(signal->LockSignalOps());
     ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "Host wait on completion_signal=0x%zx",
             signal->signal_.handle);
-    if (!WaitForSignal(signal->signal_, gpu_.ActiveWait())) {
+    bool result = gpu_.waitPolicy().Enabled() ?
+        WaitForSignal(signal->signal_, gpu_.waitPolicy()) :
+        WaitForSignal(signal->signal_, gpu_.ActiveWait());
+    if (!result) {
       LogPrintfError("Failed signal [0x%lx] wait", signal->signal_);
       return false;
     }
@@ -601,7 +541,7 @@ bool VirtualGPU::processMemObjects(const amd::Kernel& kernel, const_address para
   const amd::KernelSignature& signature = kernel.signature();
   const amd::KernelParameters& kernelParams = kernel.parameters();
 
-  if (!cooperativeGroups && memoryDependency().maxMemObjectsInQueue() != 0) {
+  if (!cooperativeGroups && memoryDependency().enabled()) {
     // AQL packets
     setAqlHeader(dispatchPacketHeaderNoSync_);
   }
@@ -886,6 +826,8 @@ bool VirtualGPU::dispatchGenericAqlPacket(
 
   // Make sure the slot is free for usage
   while ((index - hsa_queue_load_read_index_scacquire(gpu_queue_)) >= sw_queue_size) {
+    // The packet processor must see the deferred packets to free the slot
+    flushDoorbell();
     amd::Os::yield();
   }
 
@@ -904,6 +846,11 @@ bool VirtualGPU::dispatchGenericAqlPacket(
   if (header != 0) {
     packet_store_release(reinterpret_cast<uint32_t*>(aql_loc), header, rest);
   }
+  if (std::is_same<decltype(packet), hsa_kernel_dispatch_packet_t*>::value) {
+    // The kernel args allocated so far are referenced by submitted packets,
+    // so the next kernel arg fence can cover them
+    kernarg_ring_.Commit();
+  }
   ClPrint(amd::LOG_DEBUG, amd::LOG_AQL,
           "SWq=0x%zx, HWq=0x%zx, id=%d, Dispatch Header = "
           "0x%x (type=%d, barrier=%d, acquire=%d, release=%d), "
@@ -931,7 +878,7 @@ bool VirtualGPU::dispatchGenericAqlPacket(
           reinterpret_cast<hsa_kernel_dispatch_packet_t*>(packet)->reserved2, read,
           index);
 
-  hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index);
+  ringDoorbell(index);
 
   // Mark the flag indicating if a dispatch is outstanding.
   // We are not waiting after every dispatch.
@@ -950,6 +897,20 @@ bool VirtualGPU::dispatchGenericAqlPacket(
   return true;
 }
 
+// ================================================================================================
+void VirtualGPU::ringDoorbell(uint64_t index) {
+  if (!doorbell_.Enabled() && (packetBatchDepth_ == 0)) {
+    doorbell_.backend().Ring(index);
+    return;
+  }
+  const uint64_t now = doorbell_.Enabled() ? amd::Os::timeNanos() : 0;
+  if (!doorbell_.Publish(index, hsa_queue_load_read_index_relaxed(gpu_queue_),
+                         packetBatchDepth_ > 0, now) && doorbell_.Enabled()) {
+    // Make sure the deferred packets get published, if the app stops submitting
+    roc_device_.doorbellFlusher()->Arm();
+  }
+}
+
 // ================================================================================================
 void VirtualGPU::dispatchBlockingWait() {
   auto wait_signals = Barriers().WaitingSignal();
@@ -1080,13 +1041,15 @@ void VirtualGPU::dispatchBarrierPacket(uint16_t packetHeader, bool skipSignal,
     addSystemScope_ = false;
   }
 
-  while ((index - hsa_queue_load_read_index_scacquire(gpu_queue_)) >= queueMask);
+  while ((index - hsa_queue_load_read_index_scacquire(gpu_queue_)) >= queueMask) {
+    flushDoorbell();
+  }
   hsa_barrier_and_packet_t* aql_loc =
     &(reinterpret_cast<hsa_barrier_and_packet_t*>(gpu_queue_->base_address))[index & queueMask];
   *aql_loc = barrier_packet_;
   __atomic_store_n(reinterpret_cast<uint32_t*>(aql_loc), packetHeader, __ATOMIC_RELEASE);
 
-  hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index);
+  ringDoorbell(index);
   ClPrint(amd::LOG_DEBUG, amd::LOG_AQL,
           "SWq=0x%zx, HWq=0x%zx, id=%d, BarrierAND Header = 0x%x (type=%d, barrier=%d, acquire=%d,"
           " release=%d), "
@@ -1158,13 +1121,15 @@ void VirtualGPU::dispatchBarrierValuePacket(uint16_t packetHeader, bool resolveD
   }
 
   uint64_t index = hsa_queue_add_write_index_screlease(gpu_queue_, 1);
-  while ((index - hsa_queue_load_read_index_scacquire(gpu_queue_)) >= queueMask);
+  while ((index - hsa_queue_load_read_index_scacquire(gpu_queue_)) >= queueMask) {
+    flushDoorbell();
+  }
   hsa_amd_barrier_value_packet_t* aql_loc = &(reinterpret_cast<hsa_amd_barrier_value_packet_t*>(
       gpu_queue_->base_address))[index & queueMask];
   *aql_loc = barrier_value_packet_;
   packet_store_release(reinterpret_cast<uint32_t*>(aql_loc), packetHeader, rest);
 
-  hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index);
+  ringDoorbell(index);
 
   ClPrint(amd::LOG_DEBUG, amd::LOG_AQL,
           "SWq=0x%zx, HWq=0x%zx, id=%d, BarrierValue Header = 0x%x AmdFormat = 0x%x "
@@ -1204,6 +1169,8 @@ bool VirtualGPU::releaseGpuMemoryFence(bool skip_cpu_wait) {
     hasPendingDispatch_ = false;
     retainExternalSignals_ = false;
   }
+  // Publish all packets on a synchronization, even if runtime skips the wait
+  flushDoorbell();
 
   // Check if runtime could skip CPU wait
   if (!skip_cpu_wait) {
@@ -1230,8 +1197,8 @@ VirtualGPU::VirtualGPU(Device& device, bool profiling, bool cooperative,
       schedulerQueue_(nullptr),
       schedulerSignal_({0}),
       barriers_(*this),
-      kernarg_pool_signal_(KernelArgPoolNumSignal),
       managed_buffer_(*this, ManagedBuffer::kPoolNumSignals * device.settings().stagedXferSize_),
+      doorbell_(DoorbellSignal{{0}}),
       cuMask_(cuMask),
       priority_(priority),
       copy_command_type_(0),
@@ -1251,6 +1218,11 @@ VirtualGPU::VirtualGPU(Device& device, bool profiling, bool cooperative,
 
   kernarg_pool_base_ = nullptr;
   kernarg_pool_size_ = 0;
+  kernarg_fence_interval_ = 0;
+  kernarg_fences_ = 0;
+  kernarg_fence_signal_.handle = 0;
+  kernarg_pool_chunk_end_ = 0;
+  active_chunk_ = 0;
   kernarg_pool_cur_offset_ = 0;
 
   if (device.settings().fenceScopeAgent_) {
@@ -1341,6 +1313,13 @@ bool VirtualGPU::create() {
   gpu_queue_ = roc_device_.acquireQueue(queue_size, cooperative_, cuMask_, priority_);
   if (!gpu_queue_) return false;
 
+  doorbell_.backend().signal_ = gpu_queue_->doorbell_signal;
+  if (roc_device_.doorbellFlusher() != nullptr) {
+    // Coalesce the doorbells, the device thread bounds the latency of the deferred packets
+    doorbell_.SetLimits(DEBUG_CLR_DOORBELL_COALESCE_PACKETS,
+                        static_cast<uint64_t>(DEBUG_CLR_DOORBELL_COALESCE_US) * 1000);
+  }
+
   if (!initPool(dev().settings().kernargPoolSize_)) {
     LogError("Couldn't allocate arguments/signals for the queue");
     return false;
@@ -1457,75 +1436,190 @@ address VirtualGPU::ManagedBuffer::Acquire(uint32_t size) {
 // ================================================================================================
 bool VirtualGPU::initPool(size_t kernarg_pool_size) {
   kernarg_pool_size_ = kernarg_pool_size;
-  kernarg_pool_chunk_end_ = kernarg_pool_size_ / KernelArgPoolNumSignal;
-  active_chunk_ = 0;
-  if ((dev().settings().kernel_arg_impl_ != KernelArgImpl::HostKernelArgs) &&
-      roc_device_.info().largeBar_) {
-    kernarg_pool_base_ =
-      reinterpret_cast<address>(roc_device_.deviceLocalAlloc(kernarg_pool_size_));
-    // @note Workaround first access penalty.
-    // KFD may update CPU page tables on the first CPU access
-    *kernarg_pool_base_ = 0;
-  } else {
-    kernarg_pool_base_ = reinterpret_cast<address>(roc_device_.hostAlloc(kernarg_pool_size_, 0,
-                                                   Device::MemorySegment::kKernArg));
-  }
+  kernarg_pool_base_ = allocKernArgPool(kernarg_pool_size_);
   if (kernarg_pool_base_ == nullptr) {
     return false;
   }
   hsa_agent_t agent = gpu_device();
-  for (auto& it : kernarg_pool_signal_) {
-    if (HSA_STATUS_SUCCESS != hsa_signal_create(0, 1, &agent, &it)) {
-      return false;
+  if (!DEBUG_CLR_KERNARG_RING) {
+    kernarg_pool_chunk_end_ = kernarg_pool_size_ / KernelArgPoolNumSignal;
+    kernarg_pool_signal_.resize(KernelArgPoolNumSignal, hsa_signal_t{0});
+    for (auto& it : kernarg_pool_signal_) {
+      if (HSA_STATUS_SUCCESS != hsa_signal_create(0, 1, &agent, &it)) {
+        return false;
+      }
     }
+    return true;
+  }
+
+  kernarg_ring_.Reset(kernarg_pool_size_);
+  kernarg_fence_interval_ = kernarg_pool_size_ / std::max(1u, DEBUG_CLR_KERNARG_POOL_FENCES);
+  if (HSA_STATUS_SUCCESS != hsa_signal_create(kKernArgFenceInit, 1, &agent,
+                                              &kernarg_fence_signal_)) {
+    return false;
   }
   return true;
 }
 
+// ================================================================================================
+address VirtualGPU::allocKernArgPool(size_t size) {
+  address pool = nullptr;
+  if ((dev().settings().kernel_arg_impl_ != KernelArgImpl::HostKernelArgs) &&
+      roc_device_.info().largeBar_) {
+    pool = reinterpret_cast<address>(roc_device_.deviceLocalAlloc(size));
+    if (pool != nullptr) {
+      // @note Workaround first access penalty.
+      // KFD may update CPU page tables on the first CPU access
+      *pool = 0;
+    }
+  } else {
+    pool = reinterpret_cast<address>(roc_device_.hostAlloc(size, 0,
+                                     Device::MemorySegment::kKernArg));
+  }
+  return pool;
+}
+
 // ================================================================================================
 void VirtualGPU::destroyPool() {
-  for (auto& it : kernarg_pool_signal_) {
+  if (kernarg_fence_signal_.handle != 0) {
+    hsa_signal_destroy(kernarg_fence_signal_);
+  }
+  for (const auto& it : kernarg_pool_signal_) {
     if (it.handle != 0) {
       hsa_signal_destroy(it);
     }
   }
+  for (const auto& it : kernarg_retired_pools_) {
+    roc_device_.hostFree(it.first, it.second);
+  }
+  kernarg_retired_pools_.clear();
   if (kernarg_pool_base_ != nullptr) {
     roc_device_.hostFree(kernarg_pool_base_, kernarg_pool_size_);
   }
 }
 
 // ================================================================================================
-void* VirtualGPU::allocKernArg(size_t size, size_t alignment) {
-  assert(alignment != 0);
-  address result = nullptr;
-  result = amd::alignUp(kernarg_pool_base_ + kernarg_pool_cur_offset_, alignment);
+void VirtualGPU::resetKernArgPool() {
+  kernarg_pool_cur_offset_ = 0;
+  kernarg_pool_chunk_end_ = kernarg_pool_size_ / KernelArgPoolNumSignal;
+  active_chunk_ = 0;
+  kernarg_ring_.Reset();
+  // The queue is idle, so the arguments in the replaced pools aren't in use anymore
+  for (const auto& it : kernarg_retired_pools_) {
+    roc_device_.hostFree(it.first, it.second);
+  }
+  kernarg_retired_pools_.clear();
+}
+
+// ================================================================================================
+bool VirtualGPU::growKernArgPool(size_t minSize) {
+  const uint64_t maxSize =
+      static_cast<uint64_t>(dev().settings().kernargPoolSize_) * DEBUG_CLR_KERNARG_POOL_GROWTH;
+  uint64_t newSize = static_cast<uint64_t>(kernarg_pool_size_) * 2;
+  while (newSize < minSize) {
+    newSize *= 2;
+  }
+  if ((newSize > maxSize) || (newSize > std::numeric_limits<uint32_t>::max())) {
+    return false;
+  }
+  address pool = allocKernArgPool(newSize);
+  if (pool == nullptr) {
+    return false;
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_KERN, "Grow kernel arg pool from %u to %lu bytes",
+          kernarg_pool_size_, newSize);
+  // The in-flight dispatches may still read their arguments from the old pool
+  kernarg_retired_pools_.push_back({kernarg_pool_base_, kernarg_pool_size_});
+  kernarg_pool_base_ = pool;
+  kernarg_pool_size_ = static_cast<uint32_t>(newSize);
+  kernarg_ring_.Reset(kernarg_pool_size_);
+  kernarg_fence_interval_ = kernarg_pool_size_ / std::max(1u, DEBUG_CLR_KERNARG_POOL_FENCES);
+  return true;
+}
+
+// ================================================================================================
+void VirtualGPU::issueKernArgFence() {
+  if (kernarg_ring_.Fence(kernarg_fences_ + 1)) {
+    ++kernarg_fences_;
+    ClPrint(amd::LOG_DEBUG, amd::LOG_KERN, "Issue kernel arg fence %lu", kernarg_fences_);
+    // The barrier packet decrements the fence signal once all previous dispatches are done
+    dispatchBarrierPacket(kBarrierPacketHeader, true, kernarg_fence_signal_);
+  }
+}
+
+// ================================================================================================
+void* VirtualGPU::allocKernArgChunk(size_t size, size_t alignment) {
+  address result = amd::alignUp(kernarg_pool_base_ + kernarg_pool_cur_offset_, alignment);
   const size_t pool_new_usage = (result + size) - kernarg_pool_base_;
   if (pool_new_usage <= kernarg_pool_chunk_end_) {
     kernarg_pool_cur_offset_ = pool_new_usage;
     return result;
-  } else {
+  }
+  //! That means the app didn't call clFlush/clFinish for very long time.
+  // Reset the signal for the barrier packet
+  hsa_signal_silent_store_relaxed(kernarg_pool_signal_[active_chunk_], kInitSignalValueOne);
+  ClPrint(amd::LOG_INFO, amd::LOG_KERN, "Issue barrier to flush kernel arg chunk %d",
+          active_chunk_);
+  // Dispatch a barrier packet into the queue
+  dispatchBarrierPacket(kBarrierPacketHeader, true, kernarg_pool_signal_[active_chunk_]);
+  // Get the next chunk
+  active_chunk_ = (active_chunk_ + 1) % KernelArgPoolNumSignal;
+  // Make sure the new active chunk is free
+  bool test = WaitForSignal(kernarg_pool_signal_[active_chunk_], ActiveWait());
+  assert(test && "Runtime can't fail a wait for chunk!");
+  // Make sure the current offset matches the new chunk to avoid possible overlaps
+  // between chunks and issues during recycle
+  kernarg_pool_cur_offset_ = (active_chunk_ == 0) ? 0 : kernarg_pool_chunk_end_;
+  kernarg_pool_chunk_end_ = kernarg_pool_cur_offset_ +
+                            kernarg_pool_size_ / KernelArgPoolNumSignal;
+  result = amd::alignUp(kernarg_pool_base_ + kernarg_pool_cur_offset_, alignment);
+  kernarg_pool_cur_offset_ = (result + size) - kernarg_pool_base_;
+  return result;
+}
+
+// ================================================================================================
+void* VirtualGPU::allocKernArg(size_t size, size_t alignment) {
+  assert(alignment != 0);
+  if (!DEBUG_CLR_KERNARG_RING) {
+    return allocKernArgChunk(size, alignment);
+  }
+  // Cover the arguments of the submitted dispatches, so their space retires incrementally
+  if (kernarg_ring_.Unfenced() >= kernarg_fence_interval_) {
+    issueKernArgFence();
+  }
+
+  uint64_t offset = 0;
+  while (!kernarg_ring_.Allocate(size, alignment, &offset)) {
+    // Release the space of the dispatches which are done
+    kernarg_ring_.Retire(completedKernArgFences());
+    if (kernarg_ring_.Allocate(size, alignment, &offset)) {
+      break;
+    }
+    // Grow the pool instead of waiting for the GPU
+    if (growKernArgPool(size + alignment)) {
+      continue;
+    }
     //! That means the app didn't call clFlush/clFinish for very long time.
-    // Reset the signal for the barrier packet
-    hsa_signal_silent_store_relaxed(kernarg_pool_signal_[active_chunk_], kInitSignalValueOne);
-    ClPrint(amd::LOG_INFO, amd::LOG_KERN, "Issue barrier to flush kernel arg chunk %d",
-            active_chunk_);
-    // Dispatch a barrier packet into the queue
-    dispatchBarrierPacket(kBarrierPacketHeader, true, kernarg_pool_signal_[active_chunk_]);
-    // Get the next chunk
-    active_chunk_ = ++active_chunk_ % KernelArgPoolNumSignal;
-    // Make sure the new active chunk is free
-    bool test = WaitForSignal(kernarg_pool_signal_[active_chunk_], ActiveWait());
-    assert(test && "Runtime can't fail a wait for chunk!");
-    // Make sure the current offset matches the new chunk to avoid possible overlaps
-    // between chunks and issues during recycle
-    kernarg_pool_cur_offset_ = (active_chunk_ == 0) ? 0 : kernarg_pool_chunk_end_;
-    kernarg_pool_chunk_end_ = kernarg_pool_cur_offset_ +
-                              kernarg_pool_size_ / KernelArgPoolNumSignal;
-    result = amd::alignUp(kernarg_pool_base_ + kernarg_pool_cur_offset_, alignment);
-    kernarg_pool_cur_offset_ = (result + size) - kernarg_pool_base_;
+    issueKernArgFence();
+    if (!kernarg_ring_.HasFences()) {
+      // Only the arguments of the current dispatch are in the pool
+      LogPrintfError("Kernel arguments of %zu bytes don't fit into the pool", size);
+      return nullptr;
+    }
+    // Wait for the oldest fence, the signal counts down from kKernArgFenceInit
+    const hsa_signal_value_t value = kKernArgFenceInit - kernarg_ring_.OldestFence();
+    ClPrint(amd::LOG_INFO, amd::LOG_KERN, "Wait for kernel arg fence %lu",
+            kernarg_ring_.OldestFence());
+    flushDoorbell();
+    if (hsa_signal_wait_scacquire(kernarg_fence_signal_, HSA_SIGNAL_CONDITION_LT, value + 1,
+                                  kUnlimitedWait, ActiveWait() ? HSA_WAIT_STATE_ACTIVE :
+                                  HSA_WAIT_STATE_BLOCKED) > value) {
+      assert(!"Runtime can't fail a wait for kernel arg fence!");
+      return nullptr;
+    }
   }
 
-  return result;
+  return kernarg_pool_base_ + offset;
 }
 
 // ================================================================================================
@@ -1831,7 +1925,11 @@ void VirtualGPU::submitWriteMemory(amd::WriteMemoryCommand& cmd) {
         origin.c[0] *= elemSize;
         size.c[0] *= elemSize;
       }
-      if (hostMemory != nullptr) {
+      if (cmd.conversion().enabled()) {
+        // The host converts the source elements while it fills the staging buffers
+        result = blitMgr().writeBufferConvert(src, *devMem, origin, size, cmd.conversion(),
+                                              cmd.isEntireMemory());
+      } else if (hostMemory != nullptr) {
         // Accelerated transfer without pinning
         amd::Coord3D srcOrigin(offset);
         result = blitMgr().copyBuffer(*hostMemory, *devMem, srcOrigin, origin, size,
@@ -2706,7 +2804,7 @@ void VirtualGPU::submitVirtualMap(amd::VirtualMapCommand& vcmd) {
     hsa_amd_vmem_alloc_handle_t opaque_hsa_handle;
     opaque_hsa_handle.handle = phys_mem_obj->getUserData().hsa_handle;
     if ((hsa_status = hsa_amd_vmem_map(vaddr_sub_obj->getSvmPtr(), vcmd.size(),
-                        vaddr_sub_obj->getOffset(), opaque_hsa_handle, 0)) == HSA_STATUS_SUCCESS) {
+                        vaddr_sub_obj->getOffset() + vcmd.offset(), opaque_hsa_handle, 0)) == HSA_STATUS_SUCCESS) {
       assert(amd::MemObjMap::FindMemObj(vcmd.ptr()) == nullptr);
       amd::MemObjMap::AddMemObj(vcmd.ptr(), vaddr_sub_obj);
       vaddr_sub_obj->getUserData().phys_mem_obj = phys_mem_obj;
@@ -3441,7 +3539,8 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
   }
 
   // Output printf buffer
-  if (!printfDbg()->output(*this, printfEnabled, gpuKernel.printfInfo())) {
+  if (!printfDbg()->output(*this, printfEnabled, gpuKernel.printfInfo(),
+                                               gpuKernel.printfFormats())) {
     LogError("\nCould not print data from the printf buffer!");
     return false;
   }
@@ -30,6 +30,9 @@
 #include "rocprintf.hpp"
 #include "hsa/hsa_ven_amd_aqlprofile.h"
 #include "rocsched.hpp"
+#include "device/devmemdep.hpp"
+#include "device/devfencedring.hpp"
+#include "device/devdoorbell.hpp"
 
 namespace amd::roc {
 class Device;
@@ -86,6 +89,40 @@ inline bool WaitForSignal(hsa_signal_t signal, bool active_wait = false, bool fo
   return true;
 }
 
+//! Waits for the signal in the phases of the wait policy and records the wait time
+inline bool WaitForSignal(hsa_signal_t signal, device::WaitPolicy& policy) {
+  if (hsa_signal_load_relaxed(signal) > 0) {
+    const device::WaitPolicy::Plan plan = policy.GetPlan();
+    const uint64_t start = amd::Os::timeNanos();
+    bool done = false;
+
+    if (plan.spinNs_ > 0) {
+      ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Host active wait for Signal = (0x%lx) for %lu ns",
+              signal.handle, plan.spinNs_);
+      done = (hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
+                                        plan.spinNs_, HSA_WAIT_STATE_ACTIVE) == 0);
+    }
+    if (!done && (plan.yieldNs_ > 0)) {
+      const uint64_t yieldStart = amd::Os::timeNanos();
+      do {
+        amd::Os::yield();
+        done = (hsa_signal_load_scacquire(signal) < kInitSignalValueOne);
+      } while (!done && ((amd::Os::timeNanos() - yieldStart) < plan.yieldNs_));
+    }
+    if (!done) {
+      ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Host blocked wait for Signal = (0x%lx)",
+              signal.handle);
+      if (hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
+                                    kUnlimitedWait, HSA_WAIT_STATE_BLOCKED) != 0) {
+        return false;
+      }
+    }
+    policy.Record(amd::Os::timeNanos() - start);
+  }
+
+  return true;
+}
+
 inline void fetchSignalTime(hsa_signal_t signal, hsa_agent_t gpu_device,
                             uint64_t* start, uint64_t* end) {
   if (start != nullptr && end != nullptr) {
@@ -213,16 +250,16 @@ class VirtualGPU : public device::VirtualDevice {
   class MemoryDependency : public amd::EmbeddedObject {
    public:
     //! Default constructor
-    MemoryDependency()
-        : memObjectsInQueue_(nullptr), numMemObjectsInQueue_(0), maxMemObjectsInQueue_(0) {}
-
-    ~MemoryDependency() { delete[] memObjectsInQueue_; }
+    MemoryDependency() : enabled_(false) {}
 
     //! Creates memory dependecy structure
     bool create(size_t numMemObj);
 
     //! Notify the tracker about new kernel
-    void newKernel() { endMemObjectsInQueue_ = numMemObjectsInQueue_; }
+    void newKernel() {
+      busy_.insert(current_);
+      current_.clear();
+    }
 
     //! Validates memory object on dependency
     void validate(VirtualGPU& gpu, const Memory* memory, bool readOnly);
@@ -230,20 +267,13 @@ class VirtualGPU : public device::VirtualDevice {
     //! Clear memory dependency
     void clear(bool all = true);
 
-    //! Max number of mem objects in the queue
-    size_t maxMemObjectsInQueue() const { return maxMemObjectsInQueue_; }
+    //! Returns true if the memory dependency tracking is enabled
+    bool enabled() const { return enabled_; }
 
    private:
-    struct MemoryState {
-      uint64_t start_;  //! Busy memory start address
-      uint64_t end_;    //! Busy memory end address
-      bool readOnly_;   //! Current GPU state in the queue
-    };
-
-    MemoryState* memObjectsInQueue_;  //!< Memory object state in the queue
-    size_t endMemObjectsInQueue_;     //!< End of mem objects in the queue
-    size_t numMemObjectsInQueue_;     //!< Number of mem objects in the queue
-    size_t maxMemObjectsInQueue_;     //!< Maximum number of mem objects in the queue
+    amd::device::AddressRangeSet busy_;     //!< Memory accessed by the kernels in the queue
+    amd::device::AddressRangeSet current_;  //!< Memory accessed by the current kernel
+    bool enabled_;                          //!< Dependency tracking is enabled
   };
 
   class HwQueueTracker : public amd::EmbeddedObject {
@@ -385,6 +415,26 @@ class VirtualGPU : public device::VirtualDevice {
 
   virtual address allocKernelArguments(size_t size, size_t alignment) final;
 
+  //! Defers the doorbell of the dispatched packets until the end of the batch
+  virtual void BeginPacketBatch() final { ++packetBatchDepth_; }
+  //! Rings the doorbell once for all packets of the batch
+  virtual void EndPacketBatch() final {
+    assert(packetBatchDepth_ > 0 && "Unbalanced packet batch");
+    if (--packetBatchDepth_ == 0) {
+      flushDoorbell();
+    }
+  }
+
+  //! Rings the deferred doorbell, must be called before any wait on the queue progress
+  void flushDoorbell() { doorbell_.Flush(); }
+
+  //! Returns true if the doorbell of some dispatched packets is deferred
+  bool isDoorbellPending() const { return doorbell_.Pending(); }
+
+  //! Rings the deferred doorbell if its packets waited for the whole coalescing window,
+  //! the caller must hold the execution lock
+  void expireDoorbell() { doorbell_.Expire(amd::Os::timeNanos()); }
+
   /**
    * @brief Waits on an outstanding kernel without regard to how
    * it was dispatched - with or without a signal
@@ -478,10 +528,24 @@ class VirtualGPU : public device::VirtualDevice {
   bool initPool(size_t kernarg_pool_size);
   void destroyPool();
 
-  void resetKernArgPool() {
-    kernarg_pool_cur_offset_ = 0;
-    kernarg_pool_chunk_end_ = kernarg_pool_size_ / KernelArgPoolNumSignal;
-    active_chunk_ = 0;
+  //! Releases the whole kernel arg pool, the queue must be idle
+  void resetKernArgPool();
+
+  //! Allocates memory for a kernel arg pool of the given size
+  address allocKernArgPool(size_t size);
+
+  //! Replaces the kernel arg pool with a larger one, returns false if it reached the limit
+  bool growKernArgPool(size_t minSize);
+
+  //! Covers the kernel args of the submitted dispatches with a fence
+  void issueKernArgFence();
+
+  //! Allocates kernel args from four fixed chunks of the pool, each guarded by a barrier
+  void* allocKernArgChunk(size_t size, size_t alignment);
+
+  //! Returns the number of completed kernel arg fences
+  uint64_t completedKernArgFences() const {
+    return kKernArgFenceInit - hsa_signal_load_scacquire(kernarg_fence_signal_);
   }
 
   uint64_t getVQVirtualAddress();
@@ -522,6 +586,10 @@ class VirtualGPU : public device::VirtualDevice {
   //! Resets the current queue state. Note: should be called after AQL queue becomes idle
   void ResetQueueStates();
 
+  //! Notifies the packet processor about the packets up to index. The doorbell is deferred
+  //! inside a batch, or coalesced with the next packets if the queue is busy
+  void ringDoorbell(uint64_t index);
+
   std::vector<amd::Memory*> pinnedMems_;   //!< Pinned memory list
 
   //! Queue state flags
@@ -561,18 +629,33 @@ class VirtualGPU : public device::VirtualDevice {
 
   HwQueueTracker  barriers_;      //!< Tracks active barriers in ROCr
 
-  //!< The number of chunks the kernel arg pool will be divided
-  static constexpr uint32_t KernelArgPoolNumSignal = 4;
+  //! Initial value of the kernel arg fence signal, every completed fence decrements it
+  static constexpr hsa_signal_value_t kKernArgFenceInit = (1ll << 62);
   address   kernarg_pool_base_;
   uint32_t  kernarg_pool_size_;
-  uint32_t  kernarg_pool_chunk_end_;    //!< The end offset of the current chunck
+  uint32_t  kernarg_fence_interval_;    //!< Committed bytes between kernel arg fences
+  uint64_t  kernarg_fences_;            //!< The number of issued kernel arg fences
+  hsa_signal_t kernarg_fence_signal_;   //!< Completion signal of the kernel arg fences
+  amd::device::FencedRing kernarg_ring_;  //!< Allocator of the kernel arg pool
+  //! The number of chunks the kernel arg pool is divided into without the ring
+  static constexpr uint32_t KernelArgPoolNumSignal = 4;
+  uint32_t  kernarg_pool_chunk_end_;    //!< The end offset of the current chunk
   uint32_t  active_chunk_;              //!< The index of the current active chunk
-  uint32_t  kernarg_pool_cur_offset_;
-  std::vector<hsa_signal_t> kernarg_pool_signal_; //!< Pool of HSA signals to manage
-                                                  //!< multiple chunks
+  uint32_t  kernarg_pool_cur_offset_;   //!< The current offset in the active chunk
+  std::vector<hsa_signal_t> kernarg_pool_signal_;  //!< Barrier signals of the chunks
+  //! Pools replaced by a larger one, released once the queue is idle
+  std::vector<std::pair<address, uint32_t>> kernarg_retired_pools_;
 
   ManagedBuffer managed_buffer_;  //!< Memory manager for staging copies
 
+  //! Writes the doorbell signal of the hardware queue
+  struct DoorbellSignal {
+    hsa_signal_t signal_;
+    void Ring(uint64_t index) { hsa_signal_store_screlease(signal_, index); }
+  };
+  uint32_t  packetBatchDepth_ = 0;    //!< Nesting depth of the packet batches
+  amd::device::DoorbellBatcher<DoorbellSignal> doorbell_;  //!< Doorbell coalescing
+
   friend class Timestamp;
 
   //  PM4 packet for gfx8 performance counter
@@ -39,6 +39,9 @@ namespace amd {
 Event::Event(HostQueue& queue, bool profilingEnabled)
     : callbacks_(NULL),
       status_(CL_INT_MAX),
+      callbackHolds_(0),
+      callbackRelease_(nullptr),
+      callbackReleaseData_(nullptr),
       hw_event_(nullptr),
       notify_event_(nullptr),
       device_(&queue.device()),
@@ -51,6 +54,9 @@ Event::Event(HostQueue& queue, bool profilingEnabled)
 Event::Event()
     : callbacks_(NULL),
       status_(CL_SUBMITTED),
+      callbackHolds_(0),
+      callbackRelease_(nullptr),
+      callbackReleaseData_(nullptr),
       hw_event_(nullptr),
       notify_event_(nullptr),
       device_(nullptr),
@@ -243,7 +249,30 @@ bool Event::awaitCompletion() {
     ClPrint(LOG_DEBUG, LOG_WAIT, "Waiting for event %p to complete, current status %d",
       this, status());
     auto* queue = command().queue();
-    if ((queue != nullptr) && queue->vdev()->ActiveWait()) {
+    if ((queue != nullptr) && queue->vdev()->waitPolicy().Enabled()) {
+      device::WaitPolicy& policy = queue->vdev()->waitPolicy();
+      const device::WaitPolicy::Plan plan = policy.GetPlan();
+      const uint64_t start = amd::Os::timeNanos();
+      // The queue notification may have completed the wait already, which isn't recorded
+      const bool pending = (status() > CL_COMPLETE);
+      // Spin, then poll with a yield, then block on the event monitor
+      while ((status() > CL_COMPLETE) && ((amd::Os::timeNanos() - start) < plan.spinNs_)) {
+        amd::Os::spinPause();
+      }
+      const uint64_t yieldStart = amd::Os::timeNanos();
+      while ((status() > CL_COMPLETE) && ((amd::Os::timeNanos() - yieldStart) < plan.yieldNs_)) {
+        amd::Os::yield();
+      }
+      if (status() > CL_COMPLETE) {
+        ScopedLock lock(lock_);
+        while (status() > CL_COMPLETE) {
+          lock_.wait();
+        }
+      }
+      if (pending) {
+        policy.Record(amd::Os::timeNanos() - start);
+      }
+    } else if ((queue != nullptr) && queue->vdev()->ActiveWait()) {
       while (status() > CL_COMPLETE) {
         amd::Os::yield();
       }
@@ -343,6 +372,57 @@ void Command::releaseResources() {
 void Command::enqueue() {
   assert(queue_ != NULL && "Cannot be enqueued");
 
+  prepareEnqueue();
+
+  if (AMD_DIRECT_DISPATCH) {
+    // The batch update must be lock protected to avoid a race condition
+    // when multiple threads submit/flush/update the batch at the same time
+    ScopedLock sl(queue_->vdev()->execution());
+    submitDirect();
+  } else {
+    queue_->append(*this);
+    queue_->flush();
+  }
+
+  finishEnqueue();
+}
+
+// ================================================================================================
+void Command::enqueueBatch(Command* const* commands, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  HostQueue* queue = commands[0]->queue_;
+  assert(queue != NULL && "Cannot be enqueued");
+
+  for (size_t i = 0; i < count; ++i) {
+    assert(commands[i]->queue_ == queue && "Batch must target a single queue");
+    commands[i]->prepareEnqueue();
+  }
+
+  if (AMD_DIRECT_DISPATCH) {
+    // Submit the whole batch under one lock and let the device publish the packets together
+    ScopedLock sl(queue->vdev()->execution());
+    queue->vdev()->BeginPacketBatch();
+    for (size_t i = 0; i < count; ++i) {
+      commands[i]->submitDirect();
+    }
+    queue->vdev()->EndPacketBatch();
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      queue->append(*commands[i]);
+    }
+    // Wake up the queue thread once for the whole batch
+    queue->flush();
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    commands[i]->finishEnqueue();
+  }
+}
+
+// ================================================================================================
+void Command::prepareEnqueue() {
   if (Agent::shouldPostEventEvents() && type_ != 0) {
     Agent::postEventCreate(as_cl(static_cast<Event*>(this)), type_);
   }
@@ -350,7 +430,7 @@ void Command::enqueue() {
   ClPrint(LOG_DEBUG, LOG_CMD, "Command (%s) enqueued: %p",
           amd::activity_prof::getOclCommandKindString(this->type()), this);
 
-  // Direct dispatch logic below will submit the command immediately, but the command status
+  // Direct dispatch logic will submit the command immediately, but the command status
   // update will occur later after flush() with a wait
   if (AMD_DIRECT_DISPATCH) {
     setStatus(CL_QUEUED);
@@ -360,31 +440,31 @@ void Command::enqueue() {
     for (const auto& event : eventWaitList()) {
       event->notifyCmdQueue(!kCpuWait);
     }
+  }
+}
 
-    // The batch update must be lock protected to avoid a race condition
-    // when multiple threads submit/flush/update the batch at the same time
-    ScopedLock sl(queue_->vdev()->execution());
-    queue_->FormSubmissionBatch(this);
+// ================================================================================================
+void Command::submitDirect() {
+  queue_->FormSubmissionBatch(this);
 
-    if (type() == CL_COMMAND_MARKER || type() == 0 || type() == CL_COMMAND_TASK) {
-      // The current HSA signal tracking logic requires profiling enabled for the markers
-      EnableProfiling();
-      // Update batch head for the current marker. Hence the status of all commands can be
-      // updated upon the marker completion
-      SetBatchHead(queue_->GetSubmittionBatch());
+  if (type() == CL_COMMAND_MARKER || type() == 0 || type() == CL_COMMAND_TASK) {
+    // The current HSA signal tracking logic requires profiling enabled for the markers
+    EnableProfiling();
+    // Update batch head for the current marker. Hence the status of all commands can be
+    // updated upon the marker completion
+    SetBatchHead(queue_->GetSubmittionBatch());
 
-      submit(*queue_->vdev());
+    submit(*queue_->vdev());
 
-      // The batch will be tracked with the marker now
-      queue_->ResetSubmissionBatch();
-    } else {
-      submit(*queue_->vdev());
-    }
+    // The batch will be tracked with the marker now
+    queue_->ResetSubmissionBatch();
   } else {
-    queue_->append(*this);
-    queue_->flush();
+    submit(*queue_->vdev());
   }
+}
 
+// ================================================================================================
+void Command::finishEnqueue() {
   if ((queue_->device().settings().waitCommand_ && (type_ != 0)) ||
       ((commandWaitBits_ & 0x2) != 0)) {
     queue_->finish();
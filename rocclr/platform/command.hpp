@@ -30,6 +30,7 @@
 #include "platform/ndrange.hpp"
 #include "platform/kernel.hpp"
 #include "device/device.hpp"
+#include "device/devstaging.hpp"
 #include "utils/concurrent.hpp"
 #include "platform/memory.hpp"
 #include "platform/perfctr.hpp"
@@ -88,6 +89,9 @@ class Event : public RuntimeObject {
   std::atomic<CallBackEntry*> callbacks_;  //!< linked list of callback entries.
   std::atomic<int32_t> status_;            //!< current execution status.
   std::atomic_flag notified_;              //!< Command queue was notified
+  std::atomic<uint32_t> callbackHolds_;    //!< Holds of the HW queue, blocked by the callbacks
+  void (*callbackRelease_)(void* data);    //!< Releases the HW queue, blocked by the callbacks
+  void* callbackReleaseData_;              //!< Argument of callbackRelease_
   void*  hw_event_;                        //!< HW event ID associated with SW event
   Event* notify_event_;                    //!< Notify event, which should contain HW signal
   const Device* device_;                   //!< Device, this event associated with
@@ -209,6 +213,40 @@ class Event : public RuntimeObject {
   //! Returns the callback for this event
   const CallBackEntry* Callback() const { return callbacks_; }
 
+  /*! \brief Marks the HW queue as blocked until the callbacks are done.
+   *
+   *  \details The device calls it before the callbacks with the function, which unblocks the
+   *  queue, and ReleaseCallbackBlock() after them.
+   */
+  void SetCallbackBlock(void (*release)(void* data), void* data) {
+    callbackRelease_ = release;
+    callbackReleaseData_ = data;
+    callbackHolds_.store(1, std::memory_order_release);
+  }
+
+  /*! \brief Keeps the HW queue blocked after the callback returns.
+   *
+   *  \details A callback, which passes its work to another thread, calls it and the thread
+   *  calls ReleaseCallbackBlock() when the work is done. Returns false if the device doesn't
+   *  block the queue, then the work has to be done in the callback.
+   */
+  bool HoldCallbackBlock() {
+    uint32_t holds = callbackHolds_.load(std::memory_order_acquire);
+    while (holds != 0) {
+      if (callbackHolds_.compare_exchange_weak(holds, holds + 1, std::memory_order_acq_rel)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //! Drops a hold of the blocked HW queue, the last one unblocks the queue
+  void ReleaseCallbackBlock() {
+    if (callbackHolds_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      callbackRelease_(callbackReleaseData_);
+    }
+  }
+
   // Saves HW event, associated with the current command
   void SetHwEvent(void* hw_event) { hw_event_ = hw_event; }
 
@@ -273,6 +311,14 @@ class Command : public Event {
   GraphKernelArgManager* graphKernArgMgr_ = nullptr;  //!< KernelMgr for graph
   address kernArgOffset_ = nullptr;  //!< KernelArg buffer to used when graph capturing is enabled
   std::string* capturedKernelName_ = nullptr;  //!< Kenrnel under capture
+
+  //! Posts the enqueue events and prepares the command for the submission
+  void prepareEnqueue();
+  //! Submits the command in direct dispatch mode, the caller holds the execution lock
+  void submitDirect();
+  //! Applies the post enqueue waits and marks the queue as active
+  void finishEnqueue();
+
  protected:
   bool cpu_wait_ = false;         //!< If true, then the command was issued for CPU/GPU sync
 
@@ -356,6 +402,10 @@ class Command : public Event {
   //! Enqueue this command into the associated command queue.
   void enqueue();
 
+  //! Enqueue a batch of commands into their common command queue. The batch is submitted
+  //! under a single execution lock and the device may publish its packets together.
+  static void enqueueBatch(Command* const* commands, size_t count);
+
   //! Return the event encapsulating this command's status.
   const Event& event() const { return *this; }
   Event& event() { return *this; }
@@ -647,6 +697,7 @@ class WriteMemoryCommand : public OneMemoryArgCommand {
   BufferRect bufRect_;   //!< Buffer rectangle information
   BufferRect hostRect_;  //!< Host memory rectangle information
   amd::CopyMetadata copyMetadata_;
+  amd::CopyConversion conversion_;  //!< Element conversion applied while uploading
 
  public:
   WriteMemoryCommand(HostQueue& queue, cl_command_type cmdType, const EventWaitList& eventWaitList,
@@ -705,6 +756,10 @@ class WriteMemoryCommand : public OneMemoryArgCommand {
   const BufferRect& hostRect() const { return hostRect_; }
   //! Return the copy MetaData
   amd::CopyMetadata copyMetadata() const { return copyMetadata_; }
+  //! Return the element conversion of the write
+  const amd::CopyConversion& conversion() const { return conversion_; }
+  //! Updates the element conversion, size() stays in destination bytes
+  void setConversion(const amd::CopyConversion& conversion) { conversion_ = conversion; }
   //! Updates the host memory to read from
   void setSource(const void* hostPtr) { hostPtr_ = hostPtr; }
   //! Updates the host memory to write to
@@ -1791,14 +1846,16 @@ class VirtualMapCommand : public Command {
 protected:
   Memory* memory_;  //!< Memory to map, nullptr means unmap
   size_t size_;     //!< Size of the mapping in bytes
+  size_t offset_;   //!< Offset of the mapping in the memory
 
 public:
   //! Construct a new VirtualMapCommand
   VirtualMapCommand(HostQueue& queue, const EventWaitList& eventWaitList,
-                   void* ptr, size_t size, Memory* memory)
+                   void* ptr, size_t size, Memory* memory, size_t offset = 0)
       : Command(queue, 1, eventWaitList),
         ptr_(ptr),
         size_(size),
+        offset_(offset),
         memory_(memory) {
     // Sanity checks
     assert(size > 0 && "invalid");
@@ -1817,6 +1874,8 @@ public:
   Memory* memory() const { return memory_; }
   //! Read the size
   size_t size() const { return size_; }
+  //! Read the offset in the memory
+  size_t offset() const { return offset_; }
   //! Read the pointer
   const void* ptr() const { return ptr_; }
 };
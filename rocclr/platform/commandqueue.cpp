@@ -122,12 +122,12 @@ bool HostQueue::terminate() {
   return true;
 }
 
-void HostQueue::finish(bool cpu_wait) {
+Command* HostQueue::submitFinish(bool cpu_wait) {
   Command* command = nullptr;
   if (IS_HIP) {
     command = getLastQueuedCommand(true);
     if (command == nullptr) {
-      return;
+      return nullptr;
     }
   }
   // If command doesn't contain HW event and runtime didn't request CPU wait,
@@ -146,11 +146,18 @@ void HostQueue::finish(bool cpu_wait) {
     // Send a finish to make sure we finished all commands
     command = new Marker(*this, false);
     if (command == NULL) {
-      return;
+      return nullptr;
     }
     ClPrint(LOG_DEBUG, LOG_CMD, "Marker queued to ensure finish");
     command->enqueue();
   }
+  return command;
+}
+
+void HostQueue::completeFinish(Command* command, bool cpu_wait) {
+  if (command == nullptr) {
+    return;
+  }
   // Check HW status of the ROCcrl event. Note: not all ROCclr modes support HW status
   static constexpr bool kWaitCompletion = true;
   if (cpu_wait || !device().IsHwEventReady(command->event(), kWaitCompletion)) {
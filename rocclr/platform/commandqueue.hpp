@@ -231,7 +231,14 @@ class HostQueue : public CommandQueue {
   }
 
   //! Finish all queued commands
-  void finish(bool cpu_wait = false);
+  void finish(bool cpu_wait = false) { completeFinish(submitFinish(cpu_wait), cpu_wait); }
+
+  //! First half of finish(): submits a marker if required and returns the retained command,
+  //! which completes the queue, or nullptr if the queue is idle. Doesn't wait.
+  Command* submitFinish(bool cpu_wait = false);
+
+  //! Second half of finish(): waits for the command from submitFinish() and releases it
+  void completeFinish(Command* command, bool cpu_wait = false);
 
   //! Check if hostQueue empty snapshot
   bool isEmpty();
@@ -282,17 +289,24 @@ class HostQueue : public CommandQueue {
   void ResetSubmissionBatch() { head_ = nullptr; }
 
   //! Set queue status
-  void SetQueueStatus() { isActive_ = true; }
+  void SetQueueStatus() {
+    if (!isActive_.load(std::memory_order_relaxed) && !isActive_.exchange(true)) {
+      QueueActivated();
+    }
+  }
 
   //! Get queue status
-  bool GetQueueStatus() { return isActive_; }
+  bool GetQueueStatus() { return isActive_.load(std::memory_order_relaxed); }
+
+  //! Called once, when the first command was enqueued into the queue
+  virtual void QueueActivated() {}
 
 private:
   Command* head_;   //!< Head of the batch list
   Command* tail_;   //!< Tail of the batch list
 
   //! True if this command queue is active
-  bool isActive_;
+  std::atomic<bool> isActive_;
 };
 
 class DeviceQueue : public CommandQueue {
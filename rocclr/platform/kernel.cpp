@@ -105,6 +105,32 @@ address KernelParameters::alloc(device::VirtualDevice& vDev) {
 
 // =================================================================================================
 bool KernelParameters::captureAndSet(void** kernelParams, address kernArgs, address mem) {
+  const KernelArgPlan& plan = signature_.argPlan();
+  if (plan.valid_) {
+    plan.pack(kernelParams, kernArgs, mem);
+    amd::Memory** memories = reinterpret_cast<amd::Memory**>(mem + memoryObjOffset());
+    for (const auto& pointer : plan.pointers_) {
+      Memory* memArg = amd::MemObjMap::FindMemObj(
+          *reinterpret_cast<const void* const*>(mem + pointer.offset_));
+      memories[pointer.index_] = memArg;
+      if (memArg != nullptr) {
+        memArg->retain();
+      }
+    }
+    // The descriptor state is the same for every launch, update it only once
+    if (!argsMarked_) {
+      for (size_t idx = 0; idx < signature_.numParameters(); ++idx) {
+        KernelParameterDescriptor& desc = signature_.params()[idx];
+        if (desc.type_ == T_POINTER && (desc.addressQualifier_ != CL_KERNEL_ARG_ADDRESS_LOCAL)) {
+          desc.info_.rawPointer_ = true;
+        }
+        desc.info_.defined_ = true;
+      }
+      argsMarked_ = true;
+    }
+    execInfoOffset_ = totalSize_;
+    return true;
+  }
 
   for (size_t idx = 0; idx < signature_.numParameters(); ++idx) {
     KernelParameterDescriptor& desc = signature_.params()[idx];
@@ -431,5 +457,36 @@ KernelSignature::KernelSignature(const std::vector<KernelParameterDescriptor>& p
     // 16 bytes is the current HW alignment for the arguments
     paramsSize_ = alignUp(paramsSize_, 16);
   }
+
+  buildArgPlan();
+}
+
+void KernelSignature::buildArgPlan() {
+  KernelArgPlan& plan = argPlan_;
+
+  for (size_t idx = 0; idx < numParameters_; ++idx) {
+    const KernelParameterDescriptor& desc = params_[idx];
+    const uint32_t offset = static_cast<uint32_t>(desc.offset_);
+    const uint32_t size = static_cast<uint32_t>(desc.size_);
+    if ((desc.type_ == T_SAMPLER) || (desc.type_ == T_QUEUE)) {
+      // Not supported by captureAndSet(), the generic path reports the error
+      plan = KernelArgPlan();
+      return;
+    }
+    if ((desc.addressQualifier_ == CL_KERNEL_ARG_ADDRESS_LOCAL) &&
+        ((size == sizeof(uint32_t)) || (size == sizeof(uint64_t)))) {
+      // Local memory arguments get their size as the value
+      plan.constants_.push_back({offset, size, size});
+      continue;
+    }
+    if (desc.type_ == T_POINTER && (desc.addressQualifier_ != CL_KERNEL_ARG_ADDRESS_LOCAL)) {
+      plan.pointers_.push_back({offset, desc.info_.arrayIndex_});
+    }
+    if (size == 0) {
+      continue;
+    }
+    plan.addValue(offset, size, static_cast<uint32_t>(idx));
+  }
+  plan.valid_ = true;
 }
 }  // namespace amd
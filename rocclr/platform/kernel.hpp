@@ -23,6 +23,7 @@
 
 #include "top.hpp"
 #include "platform/object.hpp"
+#include "platform/kernel_arg_plan.hpp"
 
 #include "amdocl/cl_kernel.h"
 
@@ -53,6 +54,7 @@ class KernelSignature : public HeapObject {
  private:
   std::vector<KernelParameterDescriptor> params_;
   std::string attributes_;  //!< The kernel attributes
+  KernelArgPlan argPlan_;   //!< Packing plan of the explicit arguments
 
   uint32_t  numParameters_; //!< Number of OCL arguments in the kernel
   uint32_t  paramsSize_;    //!< The size of all arguments
@@ -113,6 +115,13 @@ class KernelSignature : public HeapObject {
 
   const std::vector<KernelParameterDescriptor>& parameters() const
     { return params_; }
+
+  //! Returns the packing plan of the explicit arguments
+  const KernelArgPlan& argPlan() const { return argPlan_; }
+
+ private:
+  //! Builds the packing plan of the explicit arguments
+  void buildArgPlan();
 };
 
 // @todo: look into a copy-on-write model instead of copy-on-read.
@@ -141,7 +150,8 @@ class KernelParameters : protected HeapObject {
     uint32_t execNewVcop_ : 1;      //!< special new VCOP for kernel execution
     uint32_t execPfpaVcop_ : 1;     //!< special PFPA VCOP for kernel execution
     uint32_t deviceKernelArgs_:1;   //!< Kernel arguments allocated on device
-    uint32_t unused : 28;           //!< unused
+    uint32_t argsMarked_ : 1;       //!< Descriptors were marked by captureAndSet()
+    uint32_t unused : 27;           //!< unused
   };
 
  public:
@@ -156,7 +166,8 @@ class KernelParameters : protected HeapObject {
         validated_(0),
         execNewVcop_(0),
         execPfpaVcop_(0),
-        deviceKernelArgs_(false) {
+        deviceKernelArgs_(false),
+        argsMarked_(0) {
     totalSize_ = signature.paramsSize() + (signature.numMemories() +
         signature.numSamplers() + signature.numQueues()) * sizeof(void*);
     values_ = reinterpret_cast<address>(this) + alignUp(sizeof(KernelParameters), PARAMETERS_MIN_ALIGNMENT);
@@ -182,7 +193,8 @@ class KernelParameters : protected HeapObject {
         validated_(rhs.validated_),
         execNewVcop_(rhs.execNewVcop_),
         execPfpaVcop_(rhs.execPfpaVcop_),
-        deviceKernelArgs_(false) {
+        deviceKernelArgs_(false),
+        argsMarked_(rhs.argsMarked_) {
     values_ = reinterpret_cast<address>(this) + alignUp(sizeof(KernelParameters), PARAMETERS_MIN_ALIGNMENT);
     memoryObjOffset_ = signature_.paramsSize();
     memoryObjects_ = reinterpret_cast<amd::Memory**>(values_ + memoryObjOffset_);
@@ -0,0 +1,125 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#ifndef KERNEL_ARG_PLAN_HPP_
+#define KERNEL_ARG_PLAN_HPP_
+
+#include "top.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace amd {
+
+/*! \brief Precompiled packing of the explicit kernel arguments.
+ *
+ *  Built once per signature, so KernelParameters::captureAndSet() can copy the arguments of a
+ *  launch without inspecting the parameter descriptors.
+ */
+struct KernelArgPlan {
+  //! Copy of one argument from the HIP array of argument pointers
+  struct Value {
+    uint32_t offset_;  //!< Offset in the parameter's stack
+    uint32_t size_;    //!< Size in bytes
+    uint32_t param_;   //!< Index of the argument
+  };
+  //! Copy of contiguous arguments from a packed argument buffer, which has the stack layout
+  struct Run {
+    uint32_t offset_;  //!< Offset in both the buffer and the parameter's stack
+    uint32_t size_;    //!< Size in bytes, including the padding between the arguments
+  };
+  //! Argument with a launch independent value, i.e. the size of a local memory argument
+  struct Constant {
+    uint32_t offset_;  //!< Offset in the parameter's stack
+    uint32_t size_;    //!< 4 or 8 bytes
+    uint64_t value_;   //!< The value
+  };
+  //! Pointer argument, which has to be resolved to a memory object
+  struct Pointer {
+    uint32_t offset_;  //!< Offset in the parameter's stack
+    uint32_t index_;   //!< Index in the memory objects array
+  };
+
+  //! Padding between the arguments is copied along in the packed buffer path, but a run
+  //! doesn't bridge gaps larger than the HW alignment of the arguments
+  static constexpr uint32_t kMaxRunGap = 16;
+
+  std::vector<Value> values_;        //!< Copies from the argument pointers
+  std::vector<Run> runs_;            //!< Copies from a packed argument buffer
+  std::vector<Constant> constants_;  //!< Arguments with a fixed value
+  std::vector<Pointer> pointers_;    //!< Pointer arguments
+  bool valid_ = false;               //!< False if the signature needs the generic path
+
+  //! Adds an argument copied from the launch, a run is extended over the padding before it
+  void addValue(uint32_t offset, uint32_t size, uint32_t param) {
+    values_.push_back({offset, size, param});
+
+    // Arguments are sorted by offset in the ABI, but don't rely on it for the runs
+    if (!runs_.empty()) {
+      Run& run = runs_.back();
+      const uint32_t runEnd = run.offset_ + run.size_;
+      if ((offset >= runEnd) && ((offset - runEnd) < kMaxRunGap)) {
+        run.size_ = offset + size - run.offset_;
+        return;
+      }
+    }
+    runs_.push_back({offset, size});
+  }
+
+  //! Copies the arguments of a launch into the parameter's stack, either from the array of
+  //! argument pointers or from a packed argument buffer. The pointers aren't resolved.
+  void pack(void** kernelParams, const_address kernArgs, address mem) const {
+    if (kernelParams != nullptr) {
+      for (const auto& value : values_) {
+        address param = mem + value.offset_;
+        const void* src = kernelParams[value.param_];
+        switch (value.size_) {
+          case sizeof(uint32_t):
+            *reinterpret_cast<uint32_t*>(param) = *static_cast<const uint32_t*>(src);
+            break;
+          case sizeof(uint64_t):
+            *reinterpret_cast<uint64_t*>(param) = *static_cast<const uint64_t*>(src);
+            break;
+          default:
+            ::memcpy(param, src, value.size_);
+            break;
+        }
+      }
+    } else {
+      for (const auto& run : runs_) {
+        ::memcpy(mem + run.offset_, kernArgs + run.offset_, run.size_);
+      }
+    }
+    for (const auto& constant : constants_) {
+      if (constant.size_ == sizeof(uint32_t)) {
+        *reinterpret_cast<uint32_t*>(mem + constant.offset_) =
+            static_cast<uint32_t>(constant.value_);
+      } else {
+        *reinterpret_cast<uint64_t*>(mem + constant.offset_) = constant.value_;
+      }
+    }
+  }
+};
+
+}  // namespace amd
+
+#endif  // KERNEL_ARG_PLAN_HPP_
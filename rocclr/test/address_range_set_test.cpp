@@ -0,0 +1,192 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Compares AddressRangeSet with a model, which tracks the access state of every address of a
+// small address space. Random reads and writes are inserted, and after each one the ranges and
+// the conflict queries must match the model.
+
+#include "device/devmemdep.hpp"
+#include "clr_test_common.hpp"
+
+#include <random>
+#include <vector>
+
+using amd::device::AddressRangeSet;
+
+namespace {
+
+constexpr uint64_t kSpace = 256;  //!< Size of the modeled address space
+
+enum State : uint8_t { Free = 0, Read, Write };
+
+//! Access state of every address
+class Model {
+ public:
+  Model() : state_(kSpace, Free) {}
+
+  void insert(uint64_t start, uint64_t end, bool readOnly) {
+    for (uint64_t a = start; a < end; ++a) {
+      if (!readOnly) {
+        state_[a] = Write;
+      } else if (state_[a] == Free) {
+        state_[a] = Read;
+      }
+    }
+  }
+
+  bool conflicts(uint64_t start, uint64_t end, bool readOnly) const {
+    for (uint64_t a = start; a < end; ++a) {
+      if ((state_[a] == Write) || (!readOnly && (state_[a] == Read))) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //! Returns the maximal runs of addresses with the same state
+  std::vector<AddressRangeSet::Range> ranges() const {
+    std::vector<AddressRangeSet::Range> ranges;
+    for (uint64_t a = 0; a < kSpace; ++a) {
+      if (state_[a] == Free) {
+        continue;
+      }
+      const bool readOnly = (state_[a] == Read);
+      if (!ranges.empty() && (ranges.back().end_ == a) && (ranges.back().readOnly_ == readOnly)) {
+        ranges.back().end_ = a + 1;
+      } else {
+        ranges.push_back({a, a + 1, readOnly});
+      }
+    }
+    return ranges;
+  }
+
+ private:
+  std::vector<State> state_;
+};
+
+void CheckEqual(const AddressRangeSet& set, const Model& model) {
+  const auto expected = model.ranges();
+  const auto& ranges = set.ranges();
+  CLR_TEST_CHECK(ranges.size() == expected.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    CLR_TEST_CHECK(ranges[i].start_ == expected[i].start_);
+    CLR_TEST_CHECK(ranges[i].end_ == expected[i].end_);
+    CLR_TEST_CHECK(ranges[i].readOnly_ == expected[i].readOnly_);
+  }
+}
+
+void CheckConflicts(const AddressRangeSet& set, const Model& model, std::mt19937& rng) {
+  std::uniform_int_distribution<uint64_t> addr(0, kSpace);
+  for (int q = 0; q < 16; ++q) {
+    uint64_t start = addr(rng);
+    uint64_t end = addr(rng);
+    if (start > end) {
+      std::swap(start, end);
+    }
+    for (bool readOnly : {true, false}) {
+      CLR_TEST_CHECK(set.conflicts(start, end, readOnly) ==
+                     model.conflicts(start, end, readOnly));
+    }
+  }
+}
+
+//! Inserts random accesses, short ones give many touching and nested ranges
+void TestRandom(uint32_t seed, uint64_t maxLength, int writePercent) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<uint64_t> addr(0, kSpace - 1);
+  std::uniform_int_distribution<uint64_t> length(0, maxLength);
+  std::uniform_int_distribution<int> percent(0, 99);
+
+  AddressRangeSet set;
+  Model model;
+  for (int step = 0; step < 200; ++step) {
+    const uint64_t start = addr(rng);
+    const uint64_t end = std::min(kSpace, start + length(rng));
+    const bool readOnly = percent(rng) >= writePercent;
+    set.insert(start, end, readOnly);
+    model.insert(start, end, readOnly);
+    CheckEqual(set, model);
+    CheckConflicts(set, model, rng);
+  }
+}
+
+//! Merges whole sets, as the dependency tracking does when it folds the ranges of a dispatch
+void TestMergeSets(uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<uint64_t> addr(0, kSpace - 1);
+  std::uniform_int_distribution<uint64_t> length(1, 24);
+  std::uniform_int_distribution<int> coin(0, 1);
+
+  AddressRangeSet total;
+  Model model;
+  for (int round = 0; round < 20; ++round) {
+    AddressRangeSet part;
+    for (int step = 0; step < 8; ++step) {
+      const uint64_t start = addr(rng);
+      const uint64_t end = std::min(kSpace, start + length(rng));
+      const bool readOnly = coin(rng) != 0;
+      part.insert(start, end, readOnly);
+      model.insert(start, end, readOnly);
+    }
+    total.insert(part);
+    CheckEqual(total, model);
+  }
+  total.clear();
+  CLR_TEST_CHECK(total.empty());
+  CLR_TEST_CHECK(!total.conflicts(0, kSpace, false));
+}
+
+void TestBasic() {
+  AddressRangeSet set;
+  set.insert(16, 16, false);
+  CLR_TEST_CHECK(set.empty());
+
+  set.insert(16, 32, true);
+  set.insert(32, 48, true);
+  CLR_TEST_CHECK(set.size() == 1);
+  // Reads never depend on reads, touching ranges don't overlap
+  CLR_TEST_CHECK(!set.conflicts(20, 40, true));
+  CLR_TEST_CHECK(set.conflicts(20, 40, false));
+  CLR_TEST_CHECK(!set.conflicts(48, 64, false));
+  CLR_TEST_CHECK(!set.conflicts(0, 16, false));
+
+  // A write splits the read range, a later read keeps the write
+  set.insert(24, 28, false);
+  CLR_TEST_CHECK(set.size() == 3);
+  set.insert(0, 64, true);
+  CLR_TEST_CHECK(set.size() == 3);
+  CLR_TEST_CHECK(set.conflicts(27, 28, true));
+  CLR_TEST_CHECK(!set.conflicts(28, 64, true));
+}
+
+}  // namespace
+
+int main() {
+  TestBasic();
+  for (uint32_t seed = 1; seed <= 50; ++seed) {
+    TestRandom(seed, 4, 30);
+    TestRandom(seed, 32, 50);
+    TestRandom(seed, kSpace, 10);
+    TestMergeSets(seed);
+  }
+  std::printf("address range set: passed\n");
+  return 0;
+}
@@ -0,0 +1,202 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Replays doorbell writes through the doorbell batcher with a fake doorbell and a fake clock.
+// Covers the immediate doorbell of an idle queue, the packet limit, the time window, held
+// batches with Flush(), and a queue whose packet processor consumes the packets late.
+
+#include "device/devdoorbell.hpp"
+#include "clr_test_common.hpp"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+//! Records the rung indices, the batcher copies its backend
+struct FakeDoorbell {
+  std::shared_ptr<std::vector<uint64_t>> rings_ = std::make_shared<std::vector<uint64_t>>();
+  void Ring(uint64_t index) { rings_->push_back(index); }
+};
+
+using Batcher = amd::device::DoorbellBatcher<FakeDoorbell>;
+
+void TestDisabled() {
+  Batcher batcher(FakeDoorbell{});
+  CLR_TEST_CHECK(!batcher.Enabled());
+  // Every packet rings, even if the queue is busy
+  for (uint64_t index = 0; index < 4; ++index) {
+    CLR_TEST_CHECK(batcher.Publish(index, 0, false, 0));
+  }
+  CLR_TEST_CHECK((*batcher.backend().rings_ == std::vector<uint64_t>{0, 1, 2, 3}));
+  CLR_TEST_CHECK(!batcher.Pending());
+
+  // A limit of one packet doesn't coalesce either
+  batcher.SetLimits(1, 1000);
+  CLR_TEST_CHECK(!batcher.Enabled());
+  CLR_TEST_CHECK(batcher.Publish(4, 0, false, 0));
+}
+
+void TestIdleQueue() {
+  Batcher batcher(FakeDoorbell{}, 8, 1000);
+  auto& rings = *batcher.backend().rings_;
+  // The packet processor consumed everything, the first packet rings right away
+  CLR_TEST_CHECK(batcher.Publish(0, 0, false, 100));
+  CLR_TEST_CHECK(rings.back() == 0);
+
+  // The processor is still on packet 0, the next packets are deferred
+  CLR_TEST_CHECK(!batcher.Publish(1, 0, false, 110));
+  CLR_TEST_CHECK(!batcher.Publish(2, 0, false, 120));
+  CLR_TEST_CHECK(batcher.Pending());
+
+  // The processor caught up with the published packets, it would starve without a ring
+  CLR_TEST_CHECK(batcher.Publish(3, 1, false, 130));
+  CLR_TEST_CHECK(rings.back() == 3);
+  CLR_TEST_CHECK(!batcher.Pending());
+  CLR_TEST_CHECK(batcher.packets() == 4);
+  CLR_TEST_CHECK(batcher.rings() == 2);
+}
+
+void TestPacketLimit() {
+  Batcher batcher(FakeDoorbell{}, 4, 1000000);
+  auto& rings = *batcher.backend().rings_;
+  CLR_TEST_CHECK(batcher.Publish(0, 0, false, 0));
+  for (uint64_t index = 1; index <= 12; ++index) {
+    const bool rung = batcher.Publish(index, 0, false, index);
+    CLR_TEST_CHECK(rung == ((index % 4) == 0));
+  }
+  CLR_TEST_CHECK((rings == std::vector<uint64_t>{0, 4, 8, 12}));
+}
+
+void TestWindow() {
+  Batcher batcher(FakeDoorbell{}, 64, 1000);
+  auto& rings = *batcher.backend().rings_;
+  CLR_TEST_CHECK(batcher.Publish(0, 0, false, 0));
+  CLR_TEST_CHECK(!batcher.Publish(1, 0, false, 5000));
+  CLR_TEST_CHECK(!batcher.Publish(2, 0, false, 5500));
+
+  // The window counts from the oldest deferred packet
+  CLR_TEST_CHECK(!batcher.Expire(5999));
+  CLR_TEST_CHECK(batcher.Expire(6000));
+  CLR_TEST_CHECK(rings.back() == 2);
+  CLR_TEST_CHECK(!batcher.Expire(9000));
+
+  // A packet past the window rings on its own
+  CLR_TEST_CHECK(!batcher.Publish(3, 0, false, 10000));
+  CLR_TEST_CHECK(batcher.Publish(4, 0, false, 11000));
+  CLR_TEST_CHECK(rings.back() == 4);
+  CLR_TEST_CHECK(batcher.rings() == 3);
+}
+
+void TestHold() {
+  Batcher batcher(FakeDoorbell{}, 2, 10);
+  auto& rings = *batcher.backend().rings_;
+  CLR_TEST_CHECK(!batcher.Flush());
+
+  // A held batch ignores the idle queue, the limit and the window
+  for (uint64_t index = 0; index < 5; ++index) {
+    CLR_TEST_CHECK(!batcher.Publish(index, index, true, index * 100));
+  }
+  CLR_TEST_CHECK(rings.empty());
+  CLR_TEST_CHECK(batcher.Pending());
+
+  // Flush() rings once for the whole batch
+  CLR_TEST_CHECK(batcher.Flush());
+  CLR_TEST_CHECK((rings == std::vector<uint64_t>{4}));
+  CLR_TEST_CHECK(!batcher.Flush());
+  CLR_TEST_CHECK(!batcher.Pending());
+
+  // Held batches work without the coalescing too
+  Batcher direct(FakeDoorbell{});
+  CLR_TEST_CHECK(!direct.Publish(0, 0, true, 0));
+  CLR_TEST_CHECK(!direct.Publish(1, 0, true, 0));
+  CLR_TEST_CHECK(direct.backend().rings_->empty());
+  CLR_TEST_CHECK(direct.Flush());
+  CLR_TEST_CHECK(direct.backend().rings_->back() == 1);
+}
+
+//! Packets arrive at random times, the packet processor only sees the rung packets and runs
+//! one packet per step. A background thread expires the window. No packet waits longer than
+//! the window plus the expiry period, and the processor never idles with a packet deferred
+//! behind a doorbell once the next packet arrives.
+void TestReplay() {
+  constexpr uint32_t kMaxPackets = 16;
+  constexpr uint64_t kWindowNs = 20000;
+  constexpr uint64_t kExpireNs = 5000;
+  std::mt19937 rng(7);
+  Batcher batcher(FakeDoorbell{}, kMaxPackets, kWindowNs);
+  auto& rings = *batcher.backend().rings_;
+
+  uint64_t now = 0;
+  uint64_t read = 0;        //!< Packets consumed by the processor
+  uint64_t doorbell = 0;    //!< Packets visible to the processor
+  uint64_t next = 0;        //!< Next packet index
+  uint64_t nextExpire = kExpireNs;
+  std::vector<uint64_t> submitNs;
+  for (uint32_t step = 0; step < 200000; ++step) {
+    now += 1 + rng() % 200;
+    if (!rings.empty()) {
+      doorbell = rings.back() + 1;
+    }
+    // The processor runs a packet every few steps
+    if ((read < doorbell) && ((rng() % 3) == 0)) {
+      ++read;
+    }
+    if ((rng() % 2) == 0) {
+      const bool idle = (read == doorbell);
+      const bool rung = batcher.Publish(next, read, false, now);
+      CLR_TEST_CHECK(!idle || rung);
+      submitNs.push_back(now);
+      ++next;
+    }
+    if (now >= nextExpire) {
+      batcher.Expire(now);
+      nextExpire = now + kExpireNs;
+    }
+    // Every deferred packet is within its latency bound
+    if (batcher.Pending()) {
+      const uint64_t oldest = rings.empty() ? 0 : rings.back() + 1;
+      CLR_TEST_CHECK(now - submitNs[oldest] <= kWindowNs + kExpireNs + 200);
+      CLR_TEST_CHECK(next - oldest < kMaxPackets);
+    }
+  }
+  batcher.Flush();
+  CLR_TEST_CHECK(rings.back() + 1 == next);
+  // The coalescing saved doorbells
+  CLR_TEST_CHECK(batcher.rings() < batcher.packets());
+  for (size_t ii = 1; ii < rings.size(); ++ii) {
+    CLR_TEST_CHECK(rings[ii] > rings[ii - 1]);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestDisabled();
+  TestIdleQueue();
+  TestPacketLimit();
+  TestWindow();
+  TestHold();
+  TestReplay();
+  std::printf("doorbell_batcher_test passed\n");
+  return 0;
+}
@@ -0,0 +1,276 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Replays kernel argument allocations through the fenced ring against a simulated GPU,
+// which completes the packets of the queue in order and some time after their submission.
+// Covers the skip at the end of the ring, fences between the allocations of one packet,
+// stale and skipped completion values, a reset with fences in flight and the replacement
+// of a full ring by a larger one.
+
+#include "device/devfencedring.hpp"
+#include "clr_test_common.hpp"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+using amd::device::FencedRing;
+
+void TestWrap() {
+  FencedRing ring(1024);
+  uint64_t offset = 0;
+  CLR_TEST_CHECK(ring.Allocate(600, 64, &offset) && (offset == 0));
+  // The rest of the ring can't hold the allocation and the start is still in use
+  CLR_TEST_CHECK(!ring.Allocate(600, 64, &offset));
+  ring.Commit();
+  CLR_TEST_CHECK(ring.Unfenced() == 600);
+  CLR_TEST_CHECK(ring.Fence(1));
+  CLR_TEST_CHECK(ring.Unfenced() == 0);
+  CLR_TEST_CHECK(!ring.Fence(2));
+  ring.Retire(0);
+  CLR_TEST_CHECK(!ring.Allocate(600, 64, &offset));
+  ring.Retire(1);
+  CLR_TEST_CHECK(!ring.HasFences());
+  CLR_TEST_CHECK(ring.Used() == 0);
+
+  // The end of the ring is skipped, the allocation starts over at 0
+  CLR_TEST_CHECK(ring.Allocate(600, 64, &offset) && (offset == 0));
+  // The skipped end stays in use until the allocation after it retires
+  CLR_TEST_CHECK(ring.Used() == 1024);
+  CLR_TEST_CHECK(!ring.Allocate(16, 16, &offset));
+  ring.Commit();
+  CLR_TEST_CHECK(ring.Fence(2));
+  ring.Retire(2);
+  CLR_TEST_CHECK(ring.Used() == 0);
+
+  // Allocations continue after the wrapped one, aligned
+  CLR_TEST_CHECK(ring.Allocate(100, 128, &offset) && (offset == 640));
+  CLR_TEST_CHECK(ring.Allocate(24, 8, &offset) && (offset == 744));
+  CLR_TEST_CHECK(!ring.Allocate(2048, 8, &offset));
+}
+
+void TestUncommitted() {
+  FencedRing ring(4096);
+  uint64_t first = 0;
+  uint64_t second = 0;
+  CLR_TEST_CHECK(ring.Allocate(256, 16, &first));
+  ring.Commit();
+  // A fence issued between two allocations of the same packet covers only the committed one
+  CLR_TEST_CHECK(ring.Allocate(256, 16, &second));
+  CLR_TEST_CHECK(ring.Fence(1));
+  ring.Retire(1);
+  CLR_TEST_CHECK(ring.Used() == 256);
+  CLR_TEST_CHECK(!ring.Fence(2));
+  ring.Commit();
+  CLR_TEST_CHECK(ring.Fence(2));
+  ring.Retire(2);
+  CLR_TEST_CHECK(ring.Used() == 0);
+}
+
+void TestRetireOrder() {
+  FencedRing ring(4096);
+  uint64_t offset = 0;
+  for (uint64_t fence = 1; fence <= 4; ++fence) {
+    CLR_TEST_CHECK(ring.Allocate(512, 16, &offset));
+    ring.Commit();
+    CLR_TEST_CHECK(ring.Fence(fence * 10));
+  }
+  CLR_TEST_CHECK(ring.OldestFence() == 10);
+
+  // A completion value between two fences releases only the older one
+  ring.Retire(25);
+  CLR_TEST_CHECK(ring.OldestFence() == 30);
+  CLR_TEST_CHECK(ring.Used() == 1024);
+
+  // A stale completion value, read before the last one, releases nothing
+  ring.Retire(10);
+  CLR_TEST_CHECK(ring.Used() == 1024);
+
+  // A value past several fences releases all of them at once
+  ring.Retire(1000);
+  CLR_TEST_CHECK(!ring.HasFences());
+  CLR_TEST_CHECK(ring.Used() == 0);
+}
+
+void TestReset() {
+  FencedRing ring(2048);
+  uint64_t offset = 0;
+  CLR_TEST_CHECK(ring.Allocate(1024, 16, &offset));
+  ring.Commit();
+  CLR_TEST_CHECK(ring.Fence(7));
+  CLR_TEST_CHECK(ring.Allocate(512, 16, &offset));
+
+  // The queue went idle, all space is free and the fences in flight are dropped
+  ring.Reset();
+  CLR_TEST_CHECK(!ring.HasFences());
+  CLR_TEST_CHECK(ring.Used() == 0);
+  CLR_TEST_CHECK(ring.Unfenced() == 0);
+  CLR_TEST_CHECK(ring.Allocate(2048, 16, &offset) && (offset == 0));
+
+  // The completion of a dropped fence doesn't release the new allocation
+  ring.Retire(7);
+  CLR_TEST_CHECK(ring.Used() == 2048);
+  ring.Commit();
+  CLR_TEST_CHECK(ring.Fence(8));
+  ring.Retire(8);
+  CLR_TEST_CHECK(ring.Used() == 0);
+
+  // A new size starts from an empty ring too
+  ring.Reset(8192);
+  CLR_TEST_CHECK(ring.size() == 8192);
+  CLR_TEST_CHECK(ring.Allocate(8192, 16, &offset) && (offset == 0));
+}
+
+/*! \brief The kernel arg pool of a queue over a simulated GPU.
+ *
+ *  Follows VirtualGPU::allocKernArg(): a fence is issued once enough committed space isn't
+ *  covered, a full ring retires the completed fences, then grows up to a limit, and only
+ *  then waits for the oldest fence. Every byte remembers the packet which reads it, an
+ *  allocation must never hand out a byte of a packet the GPU hasn't completed.
+ */
+class Simulation {
+ public:
+  Simulation(uint64_t size, uint64_t maxSize, uint32_t seed)
+      : maxSize_(maxSize), rng_(seed) {
+    Reset(size);
+  }
+
+  void Run(uint32_t packets) {
+    for (uint32_t ii = 0; ii < packets; ++ii) {
+      const uint32_t args = 1 + rng_() % 3;
+      pending_.clear();
+      for (uint32_t arg = 0; arg < args; ++arg) {
+        const uint64_t alignment = 16ull << (rng_() % 4);
+        Allocate(16 + rng_() % 600, alignment);
+      }
+      // The dispatch packet is written, its args are referenced now
+      ++submitted_;
+      for (auto byte : pending_) {
+        owner_[byte] = submitted_;
+      }
+      ring_.Commit();
+      Advance(rng_() % 3);
+      if ((rng_() % 5000) == 0) {
+        // The queue went idle
+        Advance(submitted_);
+        Reset(ring_.size());
+      }
+    }
+  }
+
+  uint32_t grows_ = 0;
+  uint32_t waits_ = 0;
+
+ private:
+  static constexpr uint64_t kPending = ~0ull;
+
+  FencedRing ring_;
+  std::vector<uint64_t> owner_;  //!< Packet, which reads the byte of the current pool
+  std::vector<uint64_t> pending_;  //!< Bytes of the dispatch, which isn't submitted yet
+  const uint64_t maxSize_;
+  std::mt19937 rng_;
+  uint64_t submitted_ = 0;       //!< Packets submitted, dispatches and fences
+  uint64_t completed_ = 0;       //!< Packets completed by the GPU, in order
+  std::vector<uint64_t> fences_;  //!< Packet of each fence, index + 1 is the fence value
+
+  //! Replaces the pool, the args allocated so far stay in the old one
+  void Reset(uint64_t size) {
+    ring_.Reset(size);
+    owner_.assign(size, 0);
+    pending_.clear();
+  }
+
+  //! The GPU completes up to count more packets
+  void Advance(uint64_t count) { completed_ = std::min(submitted_, completed_ + count); }
+
+  uint64_t CompletedFences() const {
+    uint64_t count = 0;
+    while ((count < fences_.size()) && (fences_[count] <= completed_)) {
+      ++count;
+    }
+    return count;
+  }
+
+  void IssueFence() {
+    if (ring_.Fence(fences_.size() + 1)) {
+      // The barrier packet goes before the dispatch, whose args are being allocated
+      fences_.push_back(++submitted_);
+    }
+  }
+
+  void Allocate(uint64_t size, uint64_t alignment) {
+    if (ring_.Unfenced() >= ring_.size() / 4) {
+      IssueFence();
+    }
+    uint64_t offset = 0;
+    while (!ring_.Allocate(size, alignment, &offset)) {
+      ring_.Retire(CompletedFences());
+      if (ring_.Allocate(size, alignment, &offset)) {
+        break;
+      }
+      if (ring_.size() * 2 <= maxSize_) {
+        // The packets in flight keep reading the old pool
+        Reset(ring_.size() * 2);
+        ++grows_;
+        continue;
+      }
+      IssueFence();
+      CLR_TEST_CHECK(ring_.HasFences());
+      // Wait for the oldest fence
+      completed_ = std::max(completed_, fences_[ring_.OldestFence() - 1]);
+      CLR_TEST_CHECK(completed_ <= submitted_);
+      ++waits_;
+    }
+    CLR_TEST_CHECK(offset % alignment == 0);
+    CLR_TEST_CHECK(offset + size <= ring_.size());
+    for (uint64_t byte = offset; byte < offset + size; ++byte) {
+      CLR_TEST_CHECK(owner_[byte] <= completed_);
+      owner_[byte] = kPending;
+      pending_.push_back(byte);
+    }
+  }
+};
+
+void TestSimulation() {
+  for (uint32_t seed = 1; seed <= 4; ++seed) {
+    Simulation fixed(16384, 16384, seed);
+    fixed.Run(50000);
+    CLR_TEST_CHECK(fixed.grows_ == 0);
+    CLR_TEST_CHECK(fixed.waits_ > 0);
+
+    Simulation growing(4096, 65536, seed);
+    growing.Run(50000);
+    CLR_TEST_CHECK(growing.grows_ > 0);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestWrap();
+  TestUncommitted();
+  TestRetireOrder();
+  TestReset();
+  TestSimulation();
+  std::printf("fenced_ring_test passed\n");
+  return 0;
+}
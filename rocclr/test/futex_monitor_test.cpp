@@ -0,0 +1,139 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Runs the inline futex monitor. A recursive owner waits with the monitor locked more than once,
+// so the notifier must be able to take the lock, and the waiter must own it again with the same
+// count afterwards. A producer and consumer pair checks wait()/notify() of a plain monitor.
+
+#include "thread/monitor.hpp"
+#include "clr_test_common.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if !defined(ROCCLR_USE_FUTEX_MONITOR)
+#error "The test expects the futex monitor"
+#endif
+
+using Monitor = amd::futex_monitor::Monitor;
+
+namespace {
+
+//! Tries to take the lock for a while, a failed wait would leave it held forever
+bool TryLockFor(Monitor& monitor, std::chrono::milliseconds timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!monitor.tryLock()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+void TestRecursiveWait() {
+  Monitor monitor(true);
+  bool ready = false;
+  std::atomic<bool> waiting{false};
+
+  std::thread notifier([&]() {
+    while (!waiting.load()) {
+      std::this_thread::yield();
+    }
+    // The waiter holds the monitor twice, wait() must release it completely
+    CLR_TEST_CHECK(TryLockFor(monitor, std::chrono::seconds(10)));
+    ready = true;
+    monitor.notifyAll();
+    monitor.unlock();
+  });
+
+  monitor.lock();
+  monitor.lock();
+  waiting = true;
+  while (!ready) {
+    monitor.wait();
+  }
+  // The waiter owns the monitor again, so a nested lock succeeds right away
+  CLR_TEST_CHECK(monitor.tryLock());
+  monitor.unlock();
+  monitor.unlock();
+  monitor.unlock();
+  notifier.join();
+
+  // All levels were released, another thread can take the monitor
+  std::thread other([&]() {
+    CLR_TEST_CHECK(TryLockFor(monitor, std::chrono::seconds(10)));
+    monitor.unlock();
+  });
+  other.join();
+}
+
+void TestProducerConsumer(bool recursive) {
+  constexpr int kItems = 20000;
+  Monitor monitor(recursive);
+  int queued = 0;
+  int consumed = 0;
+
+  std::thread consumer([&]() {
+    monitor.lock();
+    while (consumed < kItems) {
+      while (queued == 0) {
+        monitor.wait();
+      }
+      --queued;
+      ++consumed;
+      monitor.notify();
+    }
+    monitor.unlock();
+  });
+
+  for (int i = 0; i < kItems; ++i) {
+    monitor.lock();
+    if (recursive) {
+      monitor.lock();
+    }
+    while (queued >= 4) {
+      monitor.wait();
+    }
+    ++queued;
+    monitor.notify();
+    if (recursive) {
+      monitor.unlock();
+    }
+    monitor.unlock();
+  }
+  consumer.join();
+  CLR_TEST_CHECK(consumed == kItems);
+  CLR_TEST_CHECK(queued == 0);
+}
+
+}  // namespace
+
+int main() {
+  for (int i = 0; i < 100; ++i) {
+    TestRecursiveWait();
+  }
+  TestProducerConsumer(false);
+  TestProducerConsumer(true);
+  std::printf("futex monitor: passed\n");
+  return 0;
+}
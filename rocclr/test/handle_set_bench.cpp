@@ -0,0 +1,145 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Measures multithreaded graph construction against the handle registry. Every thread builds
+// graphs of fake nodes: each node is registered, validated with two of its dependencies, like
+// hipGraphAddKernelNode does, and the graph is validated and unregistered on destruction. The
+// lock-free ConcurrentHandleSet is compared with the registry it replaced, an unordered_set
+// under a monitor.
+//
+// Usage: handle_set_bench [nodes per graph] [graphs per thread]
+
+#include "utils/concurrent.hpp"
+#include "os/os.hpp"
+#include "thread/monitor.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+struct FakeNode {
+  uint64_t handle_ = 0;  //!< Token of the node in the registry
+};
+
+//! Registry of the nodes, as it was before the lock-free set
+class LockedRegistry {
+ public:
+  void Insert(FakeNode* node) {
+    amd::ScopedLock lock(lock_);
+    set_.insert(node);
+  }
+  void Erase(FakeNode* node) {
+    amd::ScopedLock lock(lock_);
+    set_.erase(node);
+  }
+  bool Contains(const FakeNode* node) {
+    amd::ScopedLock lock(lock_);
+    return set_.find(node) != set_.end();
+  }
+
+ private:
+  amd::Monitor lock_;
+  std::unordered_set<const FakeNode*> set_;
+};
+
+//! Registry of the nodes with the lock-free set
+class HandleSetRegistry {
+ public:
+  void Insert(FakeNode* node) { node->handle_ = set_.insert(node); }
+  void Erase(FakeNode* node) { set_.erase(node, node->handle_); }
+  bool Contains(const FakeNode* node) { return set_.contains(node); }
+
+ private:
+  amd::ConcurrentHandleSet<FakeNode> set_;
+};
+
+//! Builds and destroys the graphs of one thread, returns the number of failed validations
+template <typename Registry>
+size_t BuildGraphs(Registry& registry, size_t nodes, size_t graphs) {
+  size_t failures = 0;
+  std::vector<std::unique_ptr<FakeNode>> graph(nodes);
+  for (size_t g = 0; g < graphs; ++g) {
+    for (size_t i = 0; i < nodes; ++i) {
+      graph[i].reset(new FakeNode());
+      registry.Insert(graph[i].get());
+      // The node and its dependencies are validated by the API
+      failures += registry.Contains(graph[i].get()) ? 0 : 1;
+      if (i >= 2) {
+        failures += registry.Contains(graph[i - 1].get()) ? 0 : 1;
+        failures += registry.Contains(graph[i - 2].get()) ? 0 : 1;
+      }
+    }
+    for (auto& node : graph) {
+      failures += registry.Contains(node.get()) ? 0 : 1;
+      registry.Erase(node.get());
+      failures += registry.Contains(node.get()) ? 1 : 0;
+      node.reset();
+    }
+  }
+  return failures;
+}
+
+//! Returns the time per node in ns
+template <typename Registry>
+double Run(size_t threads, size_t nodes, size_t graphs) {
+  Registry registry;
+  std::vector<std::thread> workers;
+  std::vector<size_t> failures(threads, 0);
+  const uint64_t start = amd::Os::timeNanos();
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&registry, &failures, t, nodes, graphs]() {
+      failures[t] = BuildGraphs(registry, nodes, graphs);
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  const uint64_t end = amd::Os::timeNanos();
+  for (size_t count : failures) {
+    if (count != 0) {
+      std::fprintf(stderr, "%zu failed validations\n", count);
+      std::exit(1);
+    }
+  }
+  return static_cast<double>(end - start) / (threads * nodes * graphs);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t nodes = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 500;
+  const size_t graphs = (argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 200;
+
+  std::printf("%zu nodes per graph, %zu graphs per thread, %u processors\n", nodes, graphs,
+              amd::Os::processorCount());
+  std::printf("%8s %16s %16s\n", "threads", "locked ns/node", "lock-free ns/node");
+  for (size_t threads : {1, 2, 4, 8, 16}) {
+    const double locked = Run<LockedRegistry>(threads, nodes, graphs);
+    const double lockFree = Run<HandleSetRegistry>(threads, nodes, graphs);
+    std::printf("%8zu %16.1f %16.1f\n", threads, locked, lockFree);
+  }
+  return 0;
+}
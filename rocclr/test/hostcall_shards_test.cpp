@@ -0,0 +1,229 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Runs the hostcall buffer shards of the listener workers with fake buffers and doorbells.
+// Covers the balance of the shards, the growth of a shard table by chunks, workers woken by
+// their own doorbells, and removals racing with the walks of the workers.
+
+#include "device/devhostcallshards.hpp"
+#include "clr_test_common.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kAlive = 0xa11fe;
+constexpr uint32_t kDead = 0xdead;
+
+struct FakeBuffer {
+  std::atomic<uint32_t> state_{kAlive};     //!< kDead once the buffer was removed
+  std::atomic<uint64_t>* doorbell_ = nullptr;
+  uint32_t shard_ = 0;                      //!< Shard, which got the buffer
+  std::atomic<uint32_t> pending_{0};        //!< Requests not processed yet
+  std::atomic<uint32_t> processed_{0};      //!< Processed requests
+  std::atomic<uint32_t> foreign_{0};        //!< Walks of another shard, which saw the buffer
+  std::atomic<uint32_t> walks_{0};          //!< Walks, which saw the buffer
+};
+
+using Shards = amd::HostcallShards<FakeBuffer>;
+
+//! Waits until the condition holds, a lost wake up would otherwise hang the test
+template <typename F> bool WaitFor(F condition) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+void TestBalance() {
+  Shards shards(4);
+  std::vector<FakeBuffer> buffers(10);
+  std::vector<uint32_t> sizes(4, 0);
+  for (auto& buffer : buffers) {
+    const uint32_t next = shards.NextShard();
+    const uint32_t shard = shards.Add(&buffer);
+    CLR_TEST_CHECK(shard == next);
+    sizes[shard]++;
+  }
+  for (uint32_t i = 0; i < 4; ++i) {
+    CLR_TEST_CHECK(shards.Size(i) == sizes[i]);
+    CLR_TEST_CHECK((sizes[i] == 2) || (sizes[i] == 3));
+  }
+  CLR_TEST_CHECK(shards.Size() == 10);
+  // The emptied shard takes the next buffer
+  CLR_TEST_CHECK(shards.Remove(&buffers[0]));
+  CLR_TEST_CHECK(shards.Remove(&buffers[4]));
+  CLR_TEST_CHECK(shards.Remove(&buffers[8]));
+  CLR_TEST_CHECK(shards.Size(0) == 0);
+  CLR_TEST_CHECK(shards.Add(&buffers[0]) == 0);
+  FakeBuffer unknown;
+  CLR_TEST_CHECK(!shards.Remove(&unknown));
+  CLR_TEST_CHECK(shards.Size() == 8);
+}
+
+void TestGrowth() {
+  // Several chunks of one shard, with holes refilled after the removals
+  constexpr size_t kCount = 300;
+  Shards shards(1);
+  std::vector<FakeBuffer> buffers(kCount);
+  for (auto& buffer : buffers) {
+    shards.Add(&buffer);
+  }
+  for (size_t i = 0; i < kCount; i += 3) {
+    CLR_TEST_CHECK(shards.Remove(&buffers[i]));
+  }
+  for (size_t i = 0; i < kCount; i += 6) {
+    shards.Add(&buffers[i]);
+  }
+  shards.Walk(0, [](FakeBuffer* buffer) { buffer->walks_++; });
+  size_t registered = 0;
+  for (size_t i = 0; i < kCount; ++i) {
+    const uint32_t expected = ((i % 3) != 0) || ((i % 6) == 0) ? 1 : 0;
+    CLR_TEST_CHECK(buffers[i].walks_.load() == expected);
+    registered += expected;
+  }
+  CLR_TEST_CHECK(shards.Size() == registered);
+}
+
+//! Listener worker, which walks its shard whenever its doorbell changes
+void RunWorker(Shards& shards, uint32_t shard, std::atomic<uint64_t>& doorbell,
+               std::atomic<bool>& stop) {
+  uint64_t seen = 0;
+  while (!stop.load()) {
+    const uint64_t value = doorbell.load();
+    if (value == seen) {
+      std::this_thread::yield();
+      continue;
+    }
+    seen = value;
+    shards.Walk(shard, [shard](FakeBuffer* buffer) {
+      CLR_TEST_CHECK(buffer->state_.load() == kAlive);
+      if (buffer->shard_ != shard) {
+        buffer->foreign_++;
+      }
+      buffer->processed_ += buffer->pending_.exchange(0);
+    });
+  }
+}
+
+void TestDoorbells() {
+  constexpr uint32_t kNumWorkers = 4;
+  constexpr size_t kNumBuffers = 130;
+  constexpr uint32_t kRequests = 200;
+  Shards shards(kNumWorkers);
+  std::vector<std::atomic<uint64_t>> doorbells(kNumWorkers);
+  std::vector<FakeBuffer> buffers(kNumBuffers);
+  for (auto& buffer : buffers) {
+    // The buffer rings the doorbell of the worker, which owns its shard
+    buffer.doorbell_ = &doorbells[shards.NextShard()];
+    buffer.shard_ = shards.Add(&buffer);
+    CLR_TEST_CHECK(buffer.doorbell_ == &doorbells[buffer.shard_]);
+  }
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> workers;
+  for (uint32_t i = 0; i < kNumWorkers; ++i) {
+    workers.emplace_back(RunWorker, std::ref(shards), i, std::ref(doorbells[i]), std::ref(stop));
+  }
+  // Devices submit the requests from several threads
+  std::vector<std::thread> producers;
+  for (size_t first = 0; first < 2; ++first) {
+    producers.emplace_back([&buffers, first]() {
+      for (uint32_t request = 0; request < kRequests; ++request) {
+        for (size_t i = first; i < buffers.size(); i += 2) {
+          buffers[i].pending_++;
+          buffers[i].doorbell_->fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  for (auto& buffer : buffers) {
+    CLR_TEST_CHECK(WaitFor([&buffer]() { return buffer.processed_.load() == kRequests; }));
+  }
+  stop = true;
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (auto& buffer : buffers) {
+    CLR_TEST_CHECK(buffer.foreign_.load() == 0);
+    CLR_TEST_CHECK(buffer.pending_.load() == 0);
+  }
+}
+
+void TestRemoveRace() {
+  constexpr uint32_t kNumWorkers = 2;
+  constexpr uint32_t kRounds = 20000;
+  Shards shards(kNumWorkers);
+  std::vector<std::atomic<uint64_t>> doorbells(kNumWorkers);
+  std::atomic<bool> stop{false};
+  // The workers walk all the time and give up the CPU while they hold a buffer
+  std::vector<std::thread> workers;
+  for (uint32_t i = 0; i < kNumWorkers; ++i) {
+    workers.emplace_back([&shards, &stop, i]() {
+      while (!stop.load()) {
+        shards.Walk(i, [](FakeBuffer* buffer) {
+          CLR_TEST_CHECK(buffer->state_.load() == kAlive);
+          std::this_thread::yield();
+          CLR_TEST_CHECK(buffer->state_.load() == kAlive);
+          buffer->walks_++;
+        });
+      }
+    });
+  }
+  // A removed buffer is dead right away, as if the queue freed it
+  std::vector<FakeBuffer> buffers(kRounds);
+  std::vector<FakeBuffer> resident(3);
+  for (auto& buffer : resident) {
+    shards.Add(&buffer);
+  }
+  for (uint32_t round = 0; round < kRounds; ++round) {
+    shards.Add(&buffers[round]);
+    // Let a worker reach the buffer before it's removed
+    std::this_thread::yield();
+    CLR_TEST_CHECK(shards.Remove(&buffers[round]));
+    buffers[round].state_ = kDead;
+  }
+  stop = true;
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  CLR_TEST_CHECK(shards.Size() == resident.size());
+}
+
+}  // namespace
+
+int main() {
+  TestBalance();
+  TestGrowth();
+  TestDoorbells();
+  TestRemoveRace();
+
+  std::printf("hostcall shards: passed\n");
+  return 0;
+}
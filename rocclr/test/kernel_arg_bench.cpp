@@ -0,0 +1,226 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Measures the argument packing of a kernel launch. The generic path is the descriptor walk
+// of KernelParameters::captureAndSet(), which switches on the type, size and address
+// qualifier of every argument, the plan path runs the KernelArgPlan of the signature. Both
+// pack from the HIP array of argument pointers and from a packed argument buffer. The
+// memory object lookup of the pointer arguments is the same in both paths and is left out.
+//
+// Usage: kernel_arg_bench [launches]
+
+#include "platform/kernel_arg_plan.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+//! The parts of KernelParameterDescriptor, which the packing looks at
+struct Param {
+  enum Kind { Value, Pointer, Local } kind_;
+  uint32_t offset_;
+  uint32_t size_;
+};
+
+struct Signature {
+  const char* name_;
+  std::vector<Param> params_;
+  uint32_t size_ = 0;
+  amd::KernelArgPlan plan_;
+
+  Signature(const char* name, const std::vector<Param::Kind>& kinds,
+            const std::vector<uint32_t>& sizes)
+      : name_(name) {
+    for (size_t ii = 0; ii < kinds.size(); ++ii) {
+      const uint32_t size = sizes[ii];
+      const uint32_t align = (size >= 8) ? 8 : size;
+      size_ = (size_ + align - 1) & ~(align - 1);
+      params_.push_back({kinds[ii], size_, size});
+      size_ += size;
+    }
+    // The rules of KernelSignature::buildArgPlan()
+    for (size_t ii = 0; ii < params_.size(); ++ii) {
+      const Param& param = params_[ii];
+      if (param.kind_ == Param::Local) {
+        plan_.constants_.push_back({param.offset_, param.size_, param.size_});
+        continue;
+      }
+      if (param.kind_ == Param::Pointer) {
+        plan_.pointers_.push_back({param.offset_, static_cast<uint32_t>(plan_.pointers_.size())});
+      }
+      plan_.addValue(param.offset_, param.size_, static_cast<uint32_t>(ii));
+    }
+    plan_.valid_ = true;
+  }
+};
+
+//! The descriptor walk of captureAndSet() without the memory object lookup
+void PackGeneric(const Signature& signature, void** kernelParams, const_address kernArgs,
+                 address mem) {
+  for (size_t idx = 0; idx < signature.params_.size(); ++idx) {
+    const Param& desc = signature.params_[idx];
+    const void* value = (kernelParams != nullptr) ? kernelParams[idx] : kernArgs + desc.offset_;
+    void* param = mem + desc.offset_;
+    uint32_t uint32_value = 0;
+    uint64_t uint64_value = 0;
+    if (desc.kind_ == Param::Pointer) {
+      uint64_value = *static_cast<const uint64_t*>(value);
+    } else {
+      switch (desc.size_) {
+        case 4:
+          if (desc.kind_ == Param::Local) {
+            uint32_value = desc.size_;
+          } else {
+            uint32_value = *(static_cast<const uint32_t*>(value));
+          }
+          break;
+        case 8:
+          if (desc.kind_ == Param::Local) {
+            uint64_value = desc.size_;
+          } else {
+            uint64_value = *(static_cast<const uint64_t*>(value));
+          }
+          break;
+      }
+    }
+    switch (desc.size_) {
+      case sizeof(uint32_t):
+        *static_cast<uint32_t*>(param) = uint32_value;
+        break;
+      case sizeof(uint64_t):
+        *static_cast<uint64_t*>(param) = uint64_value;
+        break;
+      default:
+        ::memcpy(param, value, desc.size_);
+        break;
+    }
+  }
+}
+
+template <typename F>
+double NsPerLaunch(size_t launches, F pack) {
+  double best = 1e30;
+  for (int round = 0; round < 3; ++round) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t ii = 0; ii < launches; ++ii) {
+      pack(ii);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() * 1e9 / launches);
+  }
+  return best;
+}
+
+void Run(const Signature& signature, size_t launches) {
+  std::vector<uint8_t> buffer(signature.size_ + 64);
+  for (size_t ii = 0; ii < buffer.size(); ++ii) {
+    buffer[ii] = static_cast<uint8_t>(ii * 7 + 1);
+  }
+  std::vector<void*> pointers;
+  for (const auto& param : signature.params_) {
+    pointers.push_back(buffer.data() + param.offset_);
+  }
+  std::vector<uint8_t> expected(signature.size_ + 64);
+  std::vector<uint8_t> stack(signature.size_ + 64);
+
+  // Both paths produce the same stack before anything is timed
+  for (int packed = 0; packed < 2; ++packed) {
+    void** params = packed ? nullptr : pointers.data();
+    PackGeneric(signature, params, buffer.data(), expected.data());
+    signature.plan_.pack(params, buffer.data(), stack.data());
+    for (const auto& param : signature.params_) {
+      if (memcmp(expected.data() + param.offset_, stack.data() + param.offset_, param.size_)) {
+        std::fprintf(stderr, "%s: the plan packed argument at %u differently\n", signature.name_,
+                     param.offset_);
+        std::exit(EXIT_FAILURE);
+      }
+    }
+  }
+
+  // The launch index goes into the first argument, so the copies can't be hoisted
+  volatile uint8_t sink = 0;
+  auto launch = [&](size_t ii, void** params, bool plan) {
+    buffer[0] = static_cast<uint8_t>(ii);
+    if (plan) {
+      signature.plan_.pack(params, buffer.data(), stack.data());
+    } else {
+      PackGeneric(signature, params, buffer.data(), stack.data());
+    }
+    sink = stack[ii % signature.size_];
+  };
+  const double genericArray = NsPerLaunch(launches, [&](size_t ii) {
+    launch(ii, pointers.data(), false);
+  });
+  const double planArray = NsPerLaunch(launches, [&](size_t ii) {
+    launch(ii, pointers.data(), true);
+  });
+  const double genericBuffer = NsPerLaunch(launches, [&](size_t ii) {
+    launch(ii, nullptr, false);
+  });
+  const double planBuffer = NsPerLaunch(launches, [&](size_t ii) {
+    launch(ii, nullptr, true);
+  });
+  (void)sink;
+  std::printf("%-14s %4zu %5u %9.1f %9.1f %9.1f %9.1f %5zu\n", signature.name_,
+              signature.params_.size(), signature.size_, genericArray, planArray, genericBuffer,
+              planBuffer, signature.plan_.runs_.size());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t launches = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 2000000;
+  using K = Param::Kind;
+
+  std::vector<Signature> signatures;
+  signatures.emplace_back("saxpy", std::vector<K>{K::Value, K::Pointer, K::Pointer, K::Value},
+                          std::vector<uint32_t>{4, 8, 8, 4});
+  std::vector<K> kinds;
+  std::vector<uint32_t> sizes;
+  for (int ii = 0; ii < 4; ++ii) {
+    kinds.insert(kinds.end(), {K::Pointer, K::Pointer, K::Value});
+    sizes.insert(sizes.end(), {8, 8, 4});
+  }
+  signatures.emplace_back("mixed 12", kinds, sizes);
+  kinds.clear();
+  sizes.clear();
+  for (int ii = 0; ii < 8; ++ii) {
+    kinds.insert(kinds.end(), {K::Pointer, K::Value, K::Value, K::Value});
+    sizes.insert(sizes.end(), {8, 4, 24, 8});
+  }
+  signatures.emplace_back("structs 32", kinds, sizes);
+  signatures.emplace_back("local memory",
+                          std::vector<K>{K::Pointer, K::Local, K::Value, K::Local, K::Pointer},
+                          std::vector<uint32_t>{8, 4, 4, 8, 8});
+
+  std::printf("%zu launches, ns per launch, best of 3\n", launches);
+  std::printf("%-14s %4s %5s %9s %9s %9s %9s %5s\n", "signature", "args", "bytes", "generic",
+              "plan", "generic", "plan", "runs");
+  std::printf("%-14s %4s %5s %9s %9s %9s %9s\n", "", "", "", "array", "array", "buffer",
+              "buffer");
+  for (const auto& signature : signatures) {
+    Run(signature, launches);
+  }
+  return 0;
+}
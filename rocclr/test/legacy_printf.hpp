@@ -0,0 +1,256 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// The device printf decoding of the runtime before the format strings were parsed once. It
+// splits the format string on every record and calls vfprintf() per literal slice and per
+// conversion. The printf test compares the parsed decoders against it, the printf benchmark
+// measures both.
+
+#pragma once
+
+#include <cassert>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace legacy_printf {
+
+inline void checkPrintf(FILE* stream, int* outCount, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int retval = vfprintf(stream, fmt, args);
+  *outCount = retval < 0 ? retval : *outCount + retval;
+  va_end(args);
+}
+
+inline int countStars(const std::string& spec) {
+  int stars = 0;
+  for (auto c : spec) {
+    if (c == '*') {
+      ++stars;
+    }
+  }
+  return stars;
+}
+
+template <typename... Args>
+const uint64_t* consumeInteger(FILE* stream, int* outCount, const std::string& spec,
+                               const uint64_t* ptr, Args... args) {
+  checkPrintf(stream, outCount, spec.c_str(), args..., ptr[0]);
+  return ptr + 1;
+}
+
+template <typename... Args>
+const uint64_t* consumeFloatingPoint(FILE* stream, int* outCount, const std::string& spec,
+                                     const uint64_t* ptr, Args... args) {
+  double d;
+  memcpy(&d, ptr, 8);
+  checkPrintf(stream, outCount, spec.c_str(), args..., d);
+  return ptr + 1;
+}
+
+template <typename... Args>
+const uint64_t* consumeCstring(FILE* stream, int* outCount, const std::string& spec,
+                               const uint64_t* ptr, Args... args) {
+  auto str = reinterpret_cast<const char*>(ptr);
+  auto old = *outCount;
+  checkPrintf(stream, outCount, spec.c_str(), args..., str);
+  auto stringMemSize = *outCount - old + 1;
+  return ptr + (stringMemSize + 7) / 8;
+}
+
+template <typename... Args>
+const uint64_t* consumePointer(FILE* stream, int* outCount, const std::string& spec,
+                               const uint64_t* ptr, Args... args) {
+  auto vptr = reinterpret_cast<void*>(*ptr);
+  checkPrintf(stream, outCount, spec.c_str(), args..., vptr);
+  return ptr + 1;
+}
+
+template <typename... Args>
+const uint64_t* consumeArgument(FILE* stream, int* outCount, const std::string& spec,
+                                const uint64_t* ptr, const uint64_t* end, Args... args) {
+  switch (spec.back()) {
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'c':
+      return consumeInteger(stream, outCount, spec, ptr, args...);
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      return consumeFloatingPoint(stream, outCount, spec, ptr, args...);
+    case 's':
+      return consumeCstring(stream, outCount, spec, ptr, args...);
+    case 'p':
+      return consumePointer(stream, outCount, spec, ptr, args...);
+    case 'n':
+      return ptr + 1;
+  }
+
+  // Undefined behaviour with an unknown flag
+  return end;
+}
+
+inline const uint64_t* processSpec(FILE* stream, int* outCount, const std::string& spec,
+                                   const uint64_t* ptr, const uint64_t* end) {
+  auto stars = countStars(spec);
+  assert(stars < 3 && "cannot have more than two placeholders");
+  switch (stars) {
+    case 0:
+      return consumeArgument(stream, outCount, spec, ptr, end);
+    case 1:
+      // Undefined behaviour if there are not enough arguments.
+      if (end - ptr < 2) {
+        return end;
+      }
+      return consumeArgument(stream, outCount, spec, ptr + 1, end, ptr[0]);
+    case 2:
+      // Undefined behaviour if there are not enough arguments.
+      if (end - ptr < 3) {
+        return end;
+      }
+      return consumeArgument(stream, outCount, spec, ptr + 2, end, ptr[0], ptr[1]);
+  }
+
+  // Undefined behaviour if three are more than two stars.
+  return end;
+}
+
+inline int format(FILE* stream, const uint64_t* begin, const uint64_t* end) {
+  const char convSpecifiers[] = "diouxXfFeEgGaAcspn";
+  auto ptr = begin;
+
+  const std::string fmt(reinterpret_cast<const char*>(ptr));
+  ptr += (fmt.length() + 7 + 1) / 8;  // the extra '1' is for the null
+
+  int outCount = 0;
+  size_t point = 0;
+  while (true) {
+    auto mark = point;
+    point = fmt.find('%', point);
+
+    if (point == std::string::npos) {
+      checkPrintf(stream, &outCount, "%s", &fmt[mark]);
+      return outCount;
+    }
+    checkPrintf(stream, &outCount, "%.*s", (int)(point - mark), &fmt[mark]);
+    if (outCount < 0) {
+      return outCount;
+    }
+
+    mark = point;
+    ++point;
+
+    if (fmt[point] == '%') {
+      checkPrintf(stream, &outCount, "%%");
+      if (outCount < 0) {
+        return outCount;
+      }
+      ++point;
+      continue;
+    }
+
+    if (ptr == end) {
+      return outCount;
+    }
+
+    point = fmt.find_first_of(convSpecifiers, point);
+    if (point == std::string::npos) {
+      return outCount;
+    }
+    ++point;
+
+    const std::string spec(fmt, mark, point - mark);
+    ptr = processSpec(stream, &outCount, spec, ptr, end);
+    if (outCount < 0) {
+      return outCount;
+    }
+  }
+}
+
+//! The hostcall printf message handler
+inline void handlePrintf(uint64_t* output, const uint64_t* input, uint64_t len) {
+  auto end = input + len;
+  auto control = *input++;
+  FILE* stream = stdout;
+  uint64_t CTRL_MASK = 1;
+  if (control & ~CTRL_MASK) {
+    *output = -1;
+    return;
+  }
+  if (control & CTRL_MASK) {
+    stream = stderr;
+  }
+  *output = format(stream, input, end);
+}
+
+//! The decoding of the HIP non-hostcall printf buffer, which rebuilt a hostcall message for
+//! every record
+inline void handlePrintfBuffer(const uint32_t* buffer, uint64_t size,
+                               std::map<uint64_t, std::string>& strMap) {
+  uint64_t sbt = 0;
+  while (sbt < size) {
+    auto controlDword = *buffer++;
+    auto PB = reinterpret_cast<const uint64_t*>(buffer);
+    uint64_t nextOffset = controlDword >> 2;
+
+    std::vector<uint8_t> PBuffer;
+    uint64_t BufferLen = 0;
+    if (controlDword & 2U) {
+      auto ArgsLen = nextOffset - 12;
+      uint64_t hash;
+      memcpy(&hash, PB, sizeof(hash));
+      auto Str = strMap[hash];
+      auto StrLenWithNull = Str.size() + 1;
+      auto StrLenAligned = (StrLenWithNull + 7) & ~size_t(7);
+      BufferLen = ArgsLen + StrLenAligned;
+      PBuffer.resize(BufferLen, 0);
+      memcpy(PBuffer.data(), Str.c_str(), StrLenWithNull);
+      memcpy(PBuffer.data() + StrLenAligned, buffer + 2, ArgsLen);
+    } else {
+      BufferLen = nextOffset - /*ControlDWord*/4;
+      PBuffer.resize(BufferLen);
+      memcpy(PBuffer.data(), buffer, BufferLen);
+    }
+
+    FILE* stream = (controlDword & 1) ? stderr : stdout;
+    std::vector<uint64_t> words(BufferLen / 8);
+    memcpy(words.data(), PBuffer.data(), words.size() * sizeof(uint64_t));
+    format(stream, words.data(), words.data() + words.size());
+    buffer += (nextOffset / 4) - /*ControlDWord*/1;
+    sbt += nextOffset;
+  }
+}
+
+}  // namespace legacy_printf
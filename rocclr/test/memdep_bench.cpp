@@ -0,0 +1,225 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Replays synthetic kernel launches through the memory dependency tracking of the ROCm queue
+// and reports the barriers it requests and the CPU time per launch. The legacy tracker is the
+// fixed array of the old runtime, which compares each argument with every tracked range and
+// forces a barrier when the array fills up. The interval tracker is the AddressRangeSet pair
+// of VirtualGPU::MemoryDependency. Both follow the queue: newKernel() before the arguments of
+// a launch, validate() per argument and clear(false) after a barrier.
+//
+// Usage: memdep_bench [launches] [GPU_NUM_MEM_DEPENDENCY]
+
+#include "device/devmemdep.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+//! The tracker of the old runtime, a fixed array of the ranges in the queue
+class LegacyDependency {
+ public:
+  explicit LegacyDependency(size_t numMemObj) : memObjectsInQueue_(numMemObj) {}
+
+  void newKernel() { endMemObjectsInQueue_ = numMemObjectsInQueue_; }
+
+  //! Returns true if the argument needs a barrier
+  bool validate(uint64_t curStart, uint64_t curEnd, bool readOnly) {
+    bool flushL1Cache = false;
+    for (size_t j = 0; j < endMemObjectsInQueue_; ++j) {
+      uint64_t busyStart = memObjectsInQueue_[j].start_;
+      uint64_t busyEnd = memObjectsInQueue_[j].end_;
+      if ((((curStart >= busyStart) && (curStart < busyEnd)) ||
+           ((curEnd > busyStart) && (curEnd <= busyEnd)) ||
+           ((curStart <= busyStart) && (curEnd >= busyEnd))) &&
+          (!memObjectsInQueue_[j].readOnly_ || !readOnly)) {
+        flushL1Cache = true;
+        break;
+      }
+    }
+    if (memObjectsInQueue_.size() <= numMemObjectsInQueue_) {
+      flushL1Cache = true;
+    }
+    if (flushL1Cache) {
+      clear(false);
+    }
+    memObjectsInQueue_[numMemObjectsInQueue_] = {curStart, curEnd, readOnly};
+    numMemObjectsInQueue_++;
+    return flushL1Cache;
+  }
+
+  void clear(bool all) {
+    if (numMemObjectsInQueue_ > 0) {
+      if (all) {
+        endMemObjectsInQueue_ = numMemObjectsInQueue_;
+      }
+      if (0 != endMemObjectsInQueue_) {
+        size_t i, j;
+        for (i = 0, j = endMemObjectsInQueue_; j < numMemObjectsInQueue_; i++, j++) {
+          memObjectsInQueue_[i] = memObjectsInQueue_[j];
+        }
+      } else if (numMemObjectsInQueue_ >= memObjectsInQueue_.size()) {
+        memObjectsInQueue_.resize(memObjectsInQueue_.size() << 1);
+      }
+      numMemObjectsInQueue_ -= endMemObjectsInQueue_;
+      endMemObjectsInQueue_ = 0;
+    }
+  }
+
+ private:
+  std::vector<amd::device::AddressRangeSet::Range> memObjectsInQueue_;
+  size_t endMemObjectsInQueue_ = 0;
+  size_t numMemObjectsInQueue_ = 0;
+};
+
+//! The tracker of VirtualGPU::MemoryDependency
+class IntervalDependency {
+ public:
+  explicit IntervalDependency(size_t numMemObj) {
+    busy_.reserve(numMemObj);
+    current_.reserve(numMemObj);
+  }
+
+  void newKernel() {
+    busy_.insert(current_);
+    current_.clear();
+  }
+
+  bool validate(uint64_t curStart, uint64_t curEnd, bool readOnly) {
+    const bool barrier = busy_.conflicts(curStart, curEnd, readOnly);
+    if (barrier) {
+      clear(false);
+    }
+    current_.insert(curStart, curEnd, readOnly);
+    return barrier;
+  }
+
+  void clear(bool all) {
+    busy_.clear();
+    if (all) {
+      current_.clear();
+    }
+  }
+
+ private:
+  amd::device::AddressRangeSet busy_;
+  amd::device::AddressRangeSet current_;
+};
+
+struct Arg {
+  uint64_t start_;
+  uint64_t end_;
+  bool readOnly_;
+};
+
+typedef std::vector<std::vector<Arg>> Launches;
+
+constexpr uint64_t kBase = 0x7f0000000000ULL;
+constexpr uint64_t kBufferSize = 1 << 20;
+
+uint64_t Buffer(size_t index) { return kBase + index * 2 * kBufferSize; }
+
+//! Each kernel reads the output of the previous one, every launch depends on the last
+Launches Chain(size_t count) {
+  Launches launches(count);
+  for (size_t ii = 0; ii < count; ++ii) {
+    launches[ii] = {{Buffer(ii % 2), Buffer(ii % 2) + kBufferSize, true},
+                    {Buffer(1 - ii % 2), Buffer(1 - ii % 2) + kBufferSize, false}};
+  }
+  return launches;
+}
+
+//! Independent kernels sharing read-only weights, each writes its own output buffer
+Launches Independent(size_t count, size_t numArgs) {
+  Launches launches(count);
+  for (size_t ii = 0; ii < count; ++ii) {
+    for (size_t arg = 0; arg + 1 < numArgs; ++arg) {
+      launches[ii].push_back({Buffer(arg), Buffer(arg) + kBufferSize, true});
+    }
+    const uint64_t out = Buffer(numArgs + ii % 4096);
+    launches[ii].push_back({out, out + kBufferSize, false});
+  }
+  return launches;
+}
+
+//! Kernels reading and writing random slices of a few buffers, with sparse dependencies
+Launches Random(size_t count, size_t numArgs, uint32_t seed) {
+  std::mt19937_64 rng(seed);
+  Launches launches(count);
+  for (size_t ii = 0; ii < count; ++ii) {
+    for (size_t arg = 0; arg < numArgs; ++arg) {
+      const uint64_t start = Buffer(rng() % 64) + (rng() % 16) * (kBufferSize / 16);
+      launches[ii].push_back({start, start + kBufferSize / 16, (rng() % 16) != 0});
+    }
+  }
+  return launches;
+}
+
+template <typename Tracker>
+void Replay(const Launches& launches, size_t numMemObj, size_t* barriers, double* seconds) {
+  Tracker tracker(numMemObj);
+  size_t count = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto& launch : launches) {
+    tracker.newKernel();
+    bool barrier = false;
+    for (const auto& arg : launch) {
+      barrier |= tracker.validate(arg.start_, arg.end_, arg.readOnly_);
+    }
+    count += barrier ? 1 : 0;
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  *barriers = count;
+  *seconds = elapsed.count();
+}
+
+void Report(const char* name, const Launches& launches, size_t numMemObj) {
+  size_t legacyBarriers, intervalBarriers;
+  double legacySeconds, intervalSeconds;
+  Replay<LegacyDependency>(launches, numMemObj, &legacyBarriers, &legacySeconds);
+  Replay<IntervalDependency>(launches, numMemObj, &intervalBarriers, &intervalSeconds);
+  const double perLaunch = 1e9 / launches.size();
+  std::printf("%-16s %9zu %9zu %11.1f %11.1f\n", name, legacyBarriers, intervalBarriers,
+              legacySeconds * perLaunch, intervalSeconds * perLaunch);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 100000;
+  const size_t numMemObj = (argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 256;
+
+  std::printf("%zu launches, %zu tracked ranges reserved\n", count, numMemObj);
+  std::printf("%-16s %9s %9s %11s %11s\n", "workload", "barriers", "barriers", "ns/launch",
+              "ns/launch");
+  std::printf("%-16s %9s %9s %11s %11s\n", "", "legacy", "interval", "legacy", "interval");
+  Report("chain", Chain(count), numMemObj);
+  Report("independent 4", Independent(count, 4), numMemObj);
+  Report("independent 16", Independent(count, 16), numMemObj);
+  Report("independent 64", Independent(count, 64), numMemObj);
+  Report("random 8", Random(count, 8, 1), numMemObj);
+  Report("random 32", Random(count, 32, 2), numMemObj);
+  return 0;
+}
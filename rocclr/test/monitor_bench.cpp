@@ -0,0 +1,210 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+// Lock microbenchmarks of the amd::Monitor implementations. The futex monitor is called
+// inline, as the ROCCLR_FUTEX_MONITOR build calls it. The legacy spin/semaphore monitor and
+// the std::mutex monitor are called through MonitorBase, as the default amd::Monitor wrapper
+// calls them. A bare std::mutex is the reference of the lock workloads.
+// - uncontended: one thread locks and unlocks
+// - recursive: one thread locks a recursive monitor twice
+// - contended N: N threads increment a shared counter under the lock
+// - handoff: two threads pass a turn back and forth with wait()/notify()
+//
+// Usage: monitor_bench [iterations]
+
+#include "thread/monitor.hpp"
+#include "thread/thread.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if !defined(ROCCLR_USE_FUTEX_MONITOR)
+#error "The benchmark expects the futex monitor"
+#endif
+
+namespace {
+
+//! The inline futex monitor
+class FutexLock {
+ public:
+  explicit FutexLock(bool recursive) : monitor_(recursive) {}
+  void lock() { monitor_.lock(); }
+  void unlock() { monitor_.unlock(); }
+  void wait() { monitor_.wait(); }
+  void notify() { monitor_.notify(); }
+
+ private:
+  amd::futex_monitor::Monitor monitor_;
+};
+
+//! The default amd::Monitor wrapper, which selects the implementation at run time
+template <typename Impl> class VirtualLock {
+ public:
+  explicit VirtualLock(bool recursive) : monitor_(new Impl(recursive)) {}
+  ~VirtualLock() { delete monitor_; }
+  void lock() { monitor_->lock(); }
+  void unlock() { monitor_->unlock(); }
+  void wait() { monitor_->wait(); }
+  void notify() { monitor_->notify(); }
+
+ private:
+  amd::MonitorBase* monitor_;
+};
+
+typedef VirtualLock<amd::legacy_monitor::Monitor> LegacyLock;
+typedef VirtualLock<amd::mutex_monitor::Monitor> MutexMonitorLock;
+
+//! Bare std::mutex, only for the lock workloads
+class StdMutex {
+ public:
+  explicit StdMutex(bool recursive) {}
+  void lock() { mutex_.lock(); }
+  void unlock() { mutex_.unlock(); }
+
+ private:
+  std::mutex mutex_;
+};
+
+//! The legacy monitor needs the amd::Thread of the caller, as in the runtime API threads
+void AttachThread() {
+  if (amd::Thread::current() == nullptr) {
+    new amd::HostThread();
+  }
+}
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+//! Returns ns per lock and unlock pair
+template <typename Lock> double Uncontended(size_t iterations) {
+  Lock lock(false);
+  volatile size_t counter = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < iterations; ++ii) {
+    lock.lock();
+    counter = counter + 1;
+    lock.unlock();
+  }
+  return Seconds(start) * 1e9 / iterations;
+}
+
+//! Returns ns per nested lock and unlock of a recursive monitor
+template <typename Lock> double Recursive(size_t iterations) {
+  Lock lock(true);
+  volatile size_t counter = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < iterations; ++ii) {
+    lock.lock();
+    lock.lock();
+    counter = counter + 1;
+    lock.unlock();
+    lock.unlock();
+  }
+  return Seconds(start) * 1e9 / iterations;
+}
+
+//! Returns the total number of critical sections per us of all threads
+template <typename Lock> double Contended(size_t numThreads, size_t iterations) {
+  Lock lock(false);
+  size_t counter = 0;
+  std::vector<std::thread> threads;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t tt = 0; tt < numThreads; ++tt) {
+    threads.emplace_back([&]() {
+      AttachThread();
+      for (size_t ii = 0; ii < iterations; ++ii) {
+        lock.lock();
+        ++counter;
+        lock.unlock();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const double seconds = Seconds(start);
+  if (counter != numThreads * iterations) {
+    std::fprintf(stderr, "Lost %zu increments\n", numThreads * iterations - counter);
+    std::exit(EXIT_FAILURE);
+  }
+  return counter / seconds / 1e6;
+}
+
+//! Returns ns per handoff of the turn between two threads
+template <typename Lock> double Handoff(size_t rounds) {
+  Lock lock(false);
+  size_t turn = 0;
+  auto player = [&](size_t self) {
+    AttachThread();
+    for (size_t ii = 0; ii < rounds; ++ii) {
+      lock.lock();
+      while ((turn & 1) != self) {
+        lock.wait();
+      }
+      ++turn;
+      lock.notify();
+      lock.unlock();
+    }
+  };
+  const auto start = std::chrono::steady_clock::now();
+  std::thread other(player, 1);
+  player(0);
+  other.join();
+  return Seconds(start) * 1e9 / (2 * rounds);
+}
+
+template <typename Lock> void ReportLock(const char* name, size_t iterations) {
+  std::printf("%-14s %12.1f %12.1f %10.1f %10.1f %10.1f\n", name, Uncontended<Lock>(iterations),
+              Recursive<Lock>(iterations), Contended<Lock>(2, iterations / 4),
+              Contended<Lock>(4, iterations / 8), Contended<Lock>(8, iterations / 16));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t iterations = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 4000000;
+
+  AttachThread();
+  std::printf("%zu iterations\n", iterations);
+  std::printf("%-14s %12s %12s %10s %10s %10s\n", "", "uncontended", "recursive", "2 threads",
+              "4 threads", "8 threads");
+  std::printf("%-14s %12s %12s %10s %10s %10s\n", "", "ns/lock", "ns/lock", "locks/us",
+              "locks/us", "locks/us");
+  ReportLock<FutexLock>("futex", iterations);
+  ReportLock<LegacyLock>("legacy", iterations);
+  ReportLock<MutexMonitorLock>("mutex monitor", iterations);
+  std::printf("%-14s %12.1f %12s %10.1f %10.1f %10.1f\n", "std::mutex",
+              Uncontended<StdMutex>(iterations), "-", Contended<StdMutex>(2, iterations / 4),
+              Contended<StdMutex>(4, iterations / 8), Contended<StdMutex>(8, iterations / 16));
+
+  const size_t rounds = iterations / 100;
+  std::printf("\nhandoff, ns per wait()/notify() turn, %zu rounds\n", rounds);
+  std::printf("%-14s %12.1f\n", "futex", Handoff<FutexLock>(rounds));
+  std::printf("%-14s %12.1f\n", "legacy", Handoff<LegacyLock>(rounds));
+  std::printf("%-14s %12.1f\n", "mutex monitor", Handoff<MutexMonitorLock>(rounds));
+  return 0;
+}
@@ -0,0 +1,169 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Measures the host decoding of device printf. The per-call parser, which the runtime used
+// before, splits the format string of every record and calls vfprintf() per slice, the
+// parsed path looks up the split format and batches the output. Both write to /dev/null, so
+// the numbers are the decoding and formatting cost per record without the terminal.
+//
+// Usage: printf_format_bench [records] [iterations]
+
+#include "device/devhcprintf.hpp"
+#include "legacy_printf.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! A record mix of a typical debug kernel, integers, floats, strings and plain text
+struct Record {
+  const char* fmt_;
+  std::vector<uint64_t> args_;
+};
+
+uint64_t Bits(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+uint64_t Chars(const char* value) {
+  uint64_t word = 0;
+  memcpy(&word, value, strlen(value) + 1);
+  return word;
+}
+
+const std::vector<Record>& Records() {
+  static const std::vector<Record> records = {
+      {"thread %d block %d value %d\n", {17, 3, 42}},
+      {"sum[%u] = %f, err = %e\n", {5, Bits(3.25), Bits(1.5e-7)}},
+      {"iteration %d done\n", {1000}},
+      {"%s: %5.2f%% of %lu\n", {Chars("load"), Bits(75.5), 1u << 20}},
+      {"ptr %p idx %x\n", {0x7f0012345678, 0xbeef}},
+      {"checkpoint reached\n", {}},
+  };
+  return records;
+}
+
+uint64_t Hash(size_t index) { return 0x5eed000000000000ULL + index; }
+
+//! A HIP non-hostcall printf buffer of constant records, the hostcall messages of the same
+//! records
+struct Workload {
+  std::vector<uint32_t> buffer_;
+  std::vector<std::vector<uint64_t>> messages_;
+  std::map<uint64_t, std::string> strMap_;
+  amd::PrintfFormatMap formats_;
+
+  explicit Workload(size_t count) {
+    for (size_t ii = 0; ii < Records().size(); ++ii) {
+      strMap_[Hash(ii)] = Records()[ii].fmt_;
+      formats_.emplace(Hash(ii), amd::PrintfFormat(Records()[ii].fmt_));
+    }
+    for (size_t ii = 0; ii < count; ++ii) {
+      const size_t index = ii % Records().size();
+      const Record& record = Records()[index];
+      const uint32_t size = static_cast<uint32_t>(12 + record.args_.size() * 8);
+      buffer_.push_back((size << 2) | 2U);
+      const uint64_t hash = Hash(index);
+      const size_t old = buffer_.size();
+      buffer_.resize(old + 2 + record.args_.size() * 2);
+      memcpy(&buffer_[old], &hash, sizeof(hash));
+      memcpy(&buffer_[old + 2], record.args_.data(), record.args_.size() * 8);
+
+      const size_t fmtSlots = (strlen(record.fmt_) + 8) / 8;
+      std::vector<uint64_t> message(1 + fmtSlots, 0);
+      memcpy(&message[1], record.fmt_, strlen(record.fmt_));
+      message.insert(message.end(), record.args_.begin(), record.args_.end());
+      messages_.push_back(std::move(message));
+    }
+  }
+};
+
+double BestSeconds(uint32_t iterations, const std::function<void()>& run) {
+  double best = 1e30;
+  for (uint32_t ii = 0; ii < iterations; ++ii) {
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    fflush(stdout);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+void Print(const char* path, size_t records, double legacy, double parsed) {
+  fprintf(stderr, "%-10s per-call %7.1f ns/record, parsed %7.1f ns/record, %.2fx\n", path,
+          legacy * 1e9 / records, parsed * 1e9 / records, legacy / parsed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t records = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 200000;
+  const uint32_t iterations = (argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 5;
+  Workload workload(records);
+  const uint64_t size = workload.buffer_.size() * sizeof(uint32_t);
+
+  // The decoders print to stdout, the results go to stderr
+  fflush(stdout);
+  const int null = open("/dev/null", O_WRONLY);
+  if (null < 0 || dup2(null, STDOUT_FILENO) < 0) {
+    perror("/dev/null");
+    return EXIT_FAILURE;
+  }
+  close(null);
+
+  fprintf(stderr, "%zu records, best of %u\n", records, iterations);
+  const double legacyBuffer = BestSeconds(iterations, [&] {
+    legacy_printf::handlePrintfBuffer(workload.buffer_.data(), size, workload.strMap_);
+  });
+  const double parsedBuffer = BestSeconds(iterations, [&] {
+    amd::PrintfOutput out;
+    amd::handlePrintfBuffer(workload.buffer_.data(), size, workload.formats_, out);
+  });
+  Print("buffer", records, legacyBuffer, parsedBuffer);
+
+  const double legacyHostcall = BestSeconds(iterations, [&] {
+    uint64_t ret;
+    for (const auto& message : workload.messages_) {
+      legacy_printf::handlePrintf(&ret, message.data(), message.size());
+    }
+  });
+  const double parsedHostcall = BestSeconds(iterations, [&] {
+    amd::PrintfOutput out;
+    uint64_t ret;
+    for (const auto& message : workload.messages_) {
+      amd::handlePrintf(&ret, message.data(), message.size(), out);
+    }
+  });
+  Print("hostcall", records, legacyHostcall, parsedHostcall);
+  return 0;
+}
@@ -0,0 +1,329 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Decodes device printf messages and buffer records with the parsed format strings and
+// compares the output with the per-call parser, which the runtime used before. Covers every
+// conversion specifier, length modifiers, width and precision arguments, vector specs, the
+// "%%" escape, bad specifiers and records with missing arguments.
+
+#include "device/devkernel.hpp"
+#include "device/devhcprintf.hpp"
+#include "legacy_printf.hpp"
+#include "clr_test_common.hpp"
+
+#include <unistd.h>
+
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! One argument of a printf message
+struct Arg {
+  enum Kind { Int, Double, String } kind_;
+  uint64_t int_;
+  double double_;
+  std::string string_;
+
+  Arg(int value) : kind_(Int), int_(static_cast<uint64_t>(static_cast<int64_t>(value))) {}
+  Arg(uint64_t value) : kind_(Int), int_(value) {}
+  Arg(double value) : kind_(Double), int_(0), double_(value) {}
+  Arg(const char* value) : kind_(String), int_(0), double_(0), string_(value) {}
+};
+
+struct Case {
+  const char* fmt_;
+  std::vector<Arg> args_;
+};
+
+const std::vector<Case>& Cases() {
+  static const std::vector<Case> cases = {
+      {"plain text without conversions\n", {}},
+      {"", {}},
+      {"%d %i %u\n", {-5, 7, 42}},
+      {"%x %X %o %#x %#o %08x\n", {0xbeef, 0xbeef, 8, 255, 8, 0x1f}},
+      {"%c%c%c\n", {'h', 'i', '!'}},
+      {"[%s] [%10s] [%-6s] [%.2s]\n", {"str", "right", "left", "cut"}},
+      {"%s|%s|%s\n", {"", "seven77", "eight888"}},
+      {"%p %p\n", {uint64_t(0), uint64_t(0x7f0012345678)}},
+      {"%e %E %f %F\n", {1.5e-7, -2.25e10, 3.14159, -0.5}},
+      {"%g %G %a %A\n", {1e-5, 6.02e23, 1.0, -0.375}},
+      {"%5.2f|%-10.3e|%+g|% d|%+05d\n", {2.71828, 12345.678, 1.0, 7, 42}},
+      {"%*d|%-*d|%.*f|%*.*f\n", {6, 12, 6, 12, 3, 1.23456, 10, 2, 9.87654}},
+      {"%*s|%.*s\n", {8, "pad", 2, "trim"}},
+      {"%ld %lld %lu %llx\n", {uint64_t(-1), uint64_t(-9000000000LL), uint64_t(1) << 40,
+                               uint64_t(0xdeadbeefcafe)}},
+      {"%hd %hu %hhd %hhx\n", {70000, 70000, 300, 0x1ff}},
+      {"%zu %jd %td\n", {uint64_t(123456789), -3, 11}},
+      {"%v2d %v4f\n", {1, 2.0}},
+      {"100%% done %d%%\n", {99}},
+      {"%%%%%d%%\n", {1}},
+      {"skip%n after %d\n", {uint64_t(0), 5}},
+      {"bad %y spec %d\n", {3}},
+      {"%-#+ 012.3d\n", {-77}},
+      {"missing %d %d %s\n", {1}},
+      {"no args %d %f\n", {}},
+      {"dangling %5", {1}},
+      {"dangling %", {}},
+      {"%s %s\n", {"first string, which spans several slots", "second"}},
+      {"mixed %s=%d (%5.1f%%) at %p\n", {"load", 3, 75.25, uint64_t(0x1000)}},
+  };
+  return cases;
+}
+
+//! Appends bytes to a message as whole 64-bit slots, padding with NULs
+void AppendPadded(std::vector<uint64_t>& words, const void* data, size_t size) {
+  const size_t slots = (size + 7) / 8;
+  const size_t old = words.size();
+  words.resize(old + slots, 0);
+  memcpy(words.data() + old, data, size);
+}
+
+//! Encodes the arguments of a case, one slot per scalar and padded strings
+std::vector<uint64_t> EncodeArgs(const Case& c) {
+  std::vector<uint64_t> words;
+  for (const auto& arg : c.args_) {
+    switch (arg.kind_) {
+      case Arg::Int:
+        words.push_back(arg.int_);
+        break;
+      case Arg::Double: {
+        uint64_t bits;
+        memcpy(&bits, &arg.double_, sizeof(bits));
+        words.push_back(bits);
+        break;
+      }
+      case Arg::String:
+        AppendPadded(words, arg.string_.c_str(), arg.string_.size() + 1);
+        break;
+    }
+  }
+  return words;
+}
+
+//! Encodes the format string followed by the arguments, the layout of a hostcall message
+std::vector<uint64_t> EncodeMessage(const Case& c) {
+  std::vector<uint64_t> words;
+  AppendPadded(words, c.fmt_, strlen(c.fmt_) + 1);
+  auto args = EncodeArgs(c);
+  words.insert(words.end(), args.begin(), args.end());
+  return words;
+}
+
+uint64_t Hash(size_t index) { return 0x1234567800000000ULL + index; }
+
+//! Appends a record of the HIP non-hostcall printf buffer. A constant record carries the
+//! hash of the format string, the others the format string itself.
+void AppendRecord(std::vector<uint32_t>& buffer, size_t index, bool constant) {
+  const Case& c = Cases()[index];
+  std::vector<uint32_t> payload;
+  auto append = [&payload](const std::vector<uint64_t>& words) {
+    const size_t old = payload.size();
+    payload.resize(old + words.size() * 2);
+    memcpy(payload.data() + old, words.data(), words.size() * sizeof(uint64_t));
+  };
+  if (constant) {
+    append({Hash(index)});
+    append(EncodeArgs(c));
+  } else {
+    append(EncodeMessage(c));
+  }
+  const uint32_t size = static_cast<uint32_t>((payload.size() + 1) * sizeof(uint32_t));
+  buffer.push_back((size << 2) | (constant ? 2U : 0U));
+  buffer.insert(buffer.end(), payload.begin(), payload.end());
+}
+
+//! Returns the text, which the function writes to the stream
+std::string Capture(const std::function<void(FILE*)>& run) {
+  FILE* file = tmpfile();
+  CLR_TEST_CHECK(file != nullptr);
+  run(file);
+  fflush(file);
+  std::string text(static_cast<size_t>(ftell(file)), '\0');
+  rewind(file);
+  CLR_TEST_CHECK(fread(&text[0], 1, text.size(), file) == text.size());
+  fclose(file);
+  return text;
+}
+
+//! Returns the text, which the function writes to stdout
+std::string CaptureStdout(const std::function<void()>& run) {
+  return Capture([&run](FILE* file) {
+    fflush(stdout);
+    const int saved = dup(STDOUT_FILENO);
+    CLR_TEST_CHECK(saved >= 0);
+    CLR_TEST_CHECK(dup2(fileno(file), STDOUT_FILENO) >= 0);
+    run();
+    fflush(stdout);
+    CLR_TEST_CHECK(dup2(saved, STDOUT_FILENO) >= 0);
+    close(saved);
+  });
+}
+
+//! Prints both outputs if they differ
+bool Report(const std::string& what, const std::string& expected, const std::string& actual) {
+  if (expected == actual) {
+    return true;
+  }
+  fprintf(stderr, "%s\n  expected: \"%s\"\n  actual:   \"%s\"\n", what.c_str(),
+          expected.c_str(), actual.c_str());
+  return false;
+}
+
+std::string CaseName(const char* path, size_t index) {
+  return std::string(path) + " \"" + Cases()[index].fmt_ + "\"";
+}
+
+//! The parsed format against the per-call parser, output and return value
+bool TestFormat() {
+  bool ok = true;
+  for (size_t ii = 0; ii < Cases().size(); ++ii) {
+    const auto message = EncodeMessage(Cases()[ii]);
+    const uint64_t* begin = message.data();
+    const uint64_t* end = begin + message.size();
+    int expectedCount = 0;
+    int actualCount = 0;
+    const auto expected = Capture([&](FILE* file) {
+      expectedCount = legacy_printf::format(file, begin, end);
+    });
+
+    const amd::PrintfFormat parsed(Cases()[ii].fmt_);
+    const auto args = EncodeArgs(Cases()[ii]);
+    const auto actual = Capture([&](FILE* file) {
+      amd::PrintfOutput out;
+      actualCount = out.format(file, parsed, args.data(), args.data() + args.size());
+    });
+    ok &= Report(CaseName("format", ii), expected, actual);
+    CLR_TEST_CHECK(expectedCount == actualCount);
+  }
+  return ok;
+}
+
+//! Hostcall messages, one at a time and batched in one output, and the return values
+bool TestHostcall() {
+  bool ok = true;
+  std::string expectedAll;
+  for (size_t ii = 0; ii < Cases().size(); ++ii) {
+    auto message = EncodeMessage(Cases()[ii]);
+    message.insert(message.begin(), 0);  // control word, stdout
+    uint64_t expectedRet = 0;
+    uint64_t actualRet = 0;
+    const auto expected = CaptureStdout([&] {
+      legacy_printf::handlePrintf(&expectedRet, message.data(), message.size());
+    });
+    const auto actual = CaptureStdout([&] {
+      amd::PrintfOutput out;
+      amd::handlePrintf(&actualRet, message.data(), message.size(), out);
+    });
+    ok &= Report(CaseName("hostcall", ii), expected, actual);
+    CLR_TEST_CHECK(expectedRet == actualRet);
+    expectedAll += expected;
+  }
+
+  // One accumulator keeps the parses of all format strings, the second round hits the cache
+  amd::PrintfOutput out;
+  for (int round = 0; round < 2; ++round) {
+    const auto actualAll = CaptureStdout([&] {
+      for (const auto& c : Cases()) {
+        auto message = EncodeMessage(c);
+        message.insert(message.begin(), 0);
+        uint64_t ret = 0;
+        amd::handlePrintf(&ret, message.data(), message.size(), out);
+      }
+      out.flush();
+    });
+    CLR_TEST_CHECK(expectedAll == actualAll);
+  }
+
+  // Unknown control bits are rejected without output
+  std::vector<uint64_t> message = EncodeMessage(Cases()[2]);
+  message.insert(message.begin(), 2);
+  uint64_t ret = 0;
+  const auto rejected = CaptureStdout([&] {
+    amd::handlePrintf(&ret, message.data(), message.size(), out);
+    out.flush();
+  });
+  CLR_TEST_CHECK(ret == static_cast<uint64_t>(-1));
+  CLR_TEST_CHECK(rejected.empty());
+  return ok;
+}
+
+//! Buffers of constant and non-constant records against the old decoding of the buffer
+bool TestBuffer() {
+  std::vector<amd::device::PrintfInfo> infos;
+  std::map<uint64_t, std::string> strMap;
+  for (size_t ii = 0; ii < Cases().size(); ++ii) {
+    char hash[32];
+    snprintf(hash, sizeof(hash), "%llx", static_cast<unsigned long long>(Hash(ii)));
+    infos.push_back({std::string(hash) + "," + Cases()[ii].fmt_, {}});
+    strMap[Hash(ii)] = Cases()[ii].fmt_;
+  }
+  amd::PrintfFormatMap formats;
+  CLR_TEST_CHECK(amd::populateFormatStringHashMap(infos, formats));
+  CLR_TEST_CHECK(formats.size() == Cases().size());
+
+  bool ok = true;
+  for (int constant = 0; constant < 2; ++constant) {
+    std::vector<uint32_t> buffer;
+    for (size_t ii = 0; ii < Cases().size(); ++ii) {
+      AppendRecord(buffer, ii, constant != 0);
+    }
+    const uint64_t size = buffer.size() * sizeof(uint32_t);
+    const auto expected = CaptureStdout([&] {
+      legacy_printf::handlePrintfBuffer(buffer.data(), size, strMap);
+    });
+    uint64_t consumed = 0;
+    const auto actual = CaptureStdout([&] {
+      amd::PrintfOutput out;
+      consumed = amd::handlePrintfBuffer(buffer.data(), size, formats, out);
+    });
+    CLR_TEST_CHECK(consumed == size);
+    ok &= Report(constant ? "constant buffer" : "buffer", expected, actual);
+
+    // A record cut by the end of the staging window is left for the next call
+    const auto cut = CaptureStdout([&] {
+      amd::PrintfOutput out;
+      consumed = amd::handlePrintfBuffer(buffer.data(), size - sizeof(uint32_t), formats, out);
+      out.flush();
+      auto rest = reinterpret_cast<const uint32_t*>(
+          reinterpret_cast<const uint8_t*>(buffer.data()) + consumed);
+      CLR_TEST_CHECK(amd::handlePrintfBuffer(rest, size - consumed, formats, out) ==
+                     size - consumed);
+    });
+    CLR_TEST_CHECK(consumed < size);
+    ok &= Report(constant ? "constant cut buffer" : "cut buffer", expected, cut);
+  }
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = TestFormat();
+  ok &= TestHostcall();
+  ok &= TestBuffer();
+  CLR_TEST_CHECK(ok);
+  printf("printf_format_test passed\n");
+  return 0;
+}
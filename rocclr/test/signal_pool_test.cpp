@@ -0,0 +1,325 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+// Runs the completion signal pool over a mocked backend. Covers the pointer queue on its own,
+// the refill between the watermarks, recycles above the high watermark, a failing backend,
+// and concurrent producers and consumers on the queue and the pool.
+
+#include "device/devsignalpool.hpp"
+#include "clr_test_common.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct FakeSignal {
+  uint32_t id_;
+  std::atomic<uint32_t> users_{0};  //!< Threads, which hold the signal
+};
+
+//! Signals created and destroyed by the mocked backend
+struct BackendState {
+  std::atomic<uint32_t> created_{0};
+  std::atomic<uint32_t> destroyed_{0};
+  std::atomic<int32_t> budget_{1 << 30};  //!< Creations left before Create() fails
+};
+
+//! The pool copies its backend, the copies share one state
+class MockBackend {
+ public:
+  explicit MockBackend(std::shared_ptr<BackendState> state) : state_(std::move(state)) {}
+
+  FakeSignal* Create() {
+    if (state_->budget_.fetch_sub(1) <= 0) {
+      return nullptr;
+    }
+    auto signal = new FakeSignal;
+    signal->id_ = state_->created_.fetch_add(1);
+    return signal;
+  }
+
+  void Destroy(FakeSignal* signal) {
+    state_->destroyed_.fetch_add(1);
+    delete signal;
+  }
+
+ private:
+  std::shared_ptr<BackendState> state_;
+};
+
+using Pool = amd::device::SignalPool<FakeSignal, MockBackend>;
+
+//! Fails the test instead of spinning forever on a corrupted queue
+void CheckProgress(std::chrono::steady_clock::time_point deadline) {
+  CLR_TEST_CHECK(std::chrono::steady_clock::now() < deadline);
+  std::this_thread::yield();
+}
+
+void TestQueue() {
+  amd::device::PointerQueue<FakeSignal> queue(5);
+  CLR_TEST_CHECK(queue.capacity() == 8);
+  CLR_TEST_CHECK(queue.pop() == nullptr);
+
+  // FIFO order across many wraps of the ring, a full queue rejects the push
+  std::vector<FakeSignal> signals(8);
+  size_t next = 0;
+  for (int round = 0; round < 100; ++round) {
+    for (auto& signal : signals) {
+      CLR_TEST_CHECK(queue.push(&signal));
+    }
+    CLR_TEST_CHECK(queue.size() == 8);
+    CLR_TEST_CHECK(!queue.push(&signals[0]));
+    for (size_t ii = 0; ii < 3; ++ii) {
+      CLR_TEST_CHECK(queue.pop() == &signals[next++ % 8]);
+    }
+    for (size_t ii = 0; ii < 3; ++ii) {
+      CLR_TEST_CHECK(queue.push(&signals[(next + 5 + ii) % 8]));
+    }
+    while (queue.pop() != nullptr) {
+    }
+    next = 0;
+    CLR_TEST_CHECK(queue.size() == 0);
+  }
+}
+
+void TestWatermarks() {
+  auto state = std::make_shared<BackendState>();
+  {
+    Pool pool(MockBackend(state), 4, 16);
+    CLR_TEST_CHECK(pool.size() == 0);
+    CLR_TEST_CHECK(pool.NeedsRefill());
+
+    // Refill tops up to twice the low watermark
+    CLR_TEST_CHECK(pool.Refill());
+    CLR_TEST_CHECK(pool.size() == 8);
+    CLR_TEST_CHECK(!pool.NeedsRefill());
+    CLR_TEST_CHECK(state->created_ == 8);
+
+    // Acquires are served from the pool until it runs dry, then created on demand
+    std::vector<FakeSignal*> held;
+    for (int ii = 0; ii < 5; ++ii) {
+      held.push_back(pool.Acquire());
+    }
+    CLR_TEST_CHECK(pool.size() == 3);
+    CLR_TEST_CHECK(pool.NeedsRefill());
+    for (int ii = 0; ii < 5; ++ii) {
+      held.push_back(pool.Acquire());
+    }
+    CLR_TEST_CHECK(state->created_ == 10);
+    auto stats = pool.GetStats();
+    CLR_TEST_CHECK(stats.hits_ == 8);
+    CLR_TEST_CHECK(stats.created_ == 2);
+    CLR_TEST_CHECK(stats.refilled_ == 8);
+
+    // Recycled signals are handed out again before new ones are created
+    for (auto signal : held) {
+      CLR_TEST_CHECK(pool.Recycle(signal));
+    }
+    CLR_TEST_CHECK(pool.size() == 10);
+    CLR_TEST_CHECK(pool.Refill());
+    CLR_TEST_CHECK(pool.size() == 10);
+    CLR_TEST_CHECK(pool.Acquire() == held[0]);
+    CLR_TEST_CHECK(pool.Recycle(held[0]));
+    CLR_TEST_CHECK(state->created_ == 10);
+    CLR_TEST_CHECK(pool.GetStats().recycled_ == 11);
+  }
+  // The idle signals are destroyed with the pool
+  CLR_TEST_CHECK(state->destroyed_ == 10);
+}
+
+void TestRecycleAboveHigh() {
+  auto state = std::make_shared<BackendState>();
+  {
+    // The high watermark isn't a power of two, the queue behind it is larger
+    Pool pool(MockBackend(state), 2, 10);
+    MockBackend backend(state);
+    std::vector<FakeSignal*> signals;
+    for (int ii = 0; ii < 13; ++ii) {
+      signals.push_back(backend.Create());
+    }
+    size_t rejected = 0;
+    for (auto signal : signals) {
+      if (!pool.Recycle(signal)) {
+        // The caller destroys the signals, which the pool rejected
+        backend.Destroy(signal);
+        ++rejected;
+      }
+    }
+    CLR_TEST_CHECK(rejected == 3);
+    CLR_TEST_CHECK(pool.size() == 10);
+    CLR_TEST_CHECK(pool.GetStats().recycled_ == 10);
+    CLR_TEST_CHECK(pool.GetStats().destroyed_ == 3);
+
+    // A low watermark above the high one is clamped
+    Pool clamped(MockBackend(state), 100, 6);
+    CLR_TEST_CHECK(clamped.Refill());
+    CLR_TEST_CHECK(clamped.size() == 6);
+  }
+  CLR_TEST_CHECK(state->created_ == state->destroyed_);
+}
+
+void TestRefillFailure() {
+  auto state = std::make_shared<BackendState>();
+  {
+    Pool pool(MockBackend(state), 8, 32);
+    state->budget_ = 3;
+    CLR_TEST_CHECK(!pool.Refill());
+    CLR_TEST_CHECK(pool.size() == 3);
+    CLR_TEST_CHECK(pool.GetStats().refilled_ == 3);
+    CLR_TEST_CHECK(pool.NeedsRefill());
+
+    // The pool still serves what it holds, then reports the failure of the backend
+    std::vector<FakeSignal*> held;
+    for (int ii = 0; ii < 3; ++ii) {
+      held.push_back(pool.Acquire());
+      CLR_TEST_CHECK(held.back() != nullptr);
+    }
+    CLR_TEST_CHECK(pool.Acquire() == nullptr);
+    CLR_TEST_CHECK(pool.GetStats().created_ == 0);
+
+    // A later refill recovers once the backend creates signals again
+    state->budget_ = 1 << 30;
+    CLR_TEST_CHECK(pool.Refill());
+    CLR_TEST_CHECK(pool.size() == 16);
+    for (auto signal : held) {
+      CLR_TEST_CHECK(pool.Recycle(signal));
+    }
+  }
+  CLR_TEST_CHECK(state->created_ == 19);
+  CLR_TEST_CHECK(state->destroyed_ == 19);
+}
+
+//! Producers push distinct pointers, consumers pop them, every pointer arrives exactly once
+void TestQueueThreads() {
+  constexpr uint32_t kThreads = 4;
+  constexpr uint32_t kPerProducer = 20000;
+  amd::device::PointerQueue<FakeSignal> queue(64);
+  std::vector<FakeSignal> signals(kThreads * kPerProducer);
+  std::atomic<uint32_t> consumed{0};
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+
+  std::vector<std::thread> threads;
+  for (uint32_t tt = 0; tt < kThreads; ++tt) {
+    threads.emplace_back([&, tt] {
+      for (uint32_t ii = 0; ii < kPerProducer; ++ii) {
+        while (!queue.push(&signals[tt * kPerProducer + ii])) {
+          CheckProgress(deadline);
+        }
+        if ((ii % 7) == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    threads.emplace_back([&] {
+      while (consumed.load() < signals.size()) {
+        FakeSignal* signal = queue.pop();
+        if (signal == nullptr) {
+          CheckProgress(deadline);
+          continue;
+        }
+        CLR_TEST_CHECK(signal->users_.fetch_add(1) == 0);
+        consumed.fetch_add(1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& signal : signals) {
+    CLR_TEST_CHECK(signal.users_ == 1);
+  }
+  CLR_TEST_CHECK(queue.pop() == nullptr);
+}
+
+//! Threads acquire and recycle concurrently, no signal is ever held by two threads
+void TestPoolThreads() {
+  constexpr uint32_t kThreads = 4;
+  constexpr uint32_t kIterations = 20000;
+  auto state = std::make_shared<BackendState>();
+  std::atomic<uint32_t> failures{0};
+  {
+    Pool pool(MockBackend(state), 8, 24);
+    CLR_TEST_CHECK(pool.Refill());
+
+    std::vector<std::thread> threads;
+    for (uint32_t tt = 0; tt < kThreads; ++tt) {
+      threads.emplace_back([&, tt] {
+        MockBackend backend(state);
+        std::vector<FakeSignal*> held;
+        for (uint32_t ii = 0; ii < kIterations; ++ii) {
+          FakeSignal* signal = pool.Acquire();
+          if (signal->users_.fetch_add(1) != 0) {
+            failures.fetch_add(1);
+          }
+          held.push_back(signal);
+          if ((ii % 5) == tt) {
+            std::this_thread::yield();
+          }
+          // Keep up to 8 signals in flight, like the signal ring of a queue
+          if (held.size() > (ii % 8)) {
+            for (auto recycled : held) {
+              recycled->users_.fetch_sub(1);
+              if (!pool.Recycle(recycled)) {
+                backend.Destroy(recycled);
+              }
+            }
+            held.clear();
+          }
+          if (pool.NeedsRefill() && (tt == 0)) {
+            CLR_TEST_CHECK(pool.Refill());
+          }
+        }
+        for (auto recycled : held) {
+          recycled->users_.fetch_sub(1);
+          if (!pool.Recycle(recycled)) {
+            backend.Destroy(recycled);
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    CLR_TEST_CHECK(pool.size() <= 24);
+    auto stats = pool.GetStats();
+    CLR_TEST_CHECK(stats.hits_ + stats.created_ == kThreads * kIterations);
+    CLR_TEST_CHECK(stats.recycled_ + stats.destroyed_ == kThreads * kIterations);
+  }
+  CLR_TEST_CHECK(failures == 0);
+  CLR_TEST_CHECK(state->created_ == state->destroyed_);
+}
+
+}  // namespace
+
+int main() {
+  TestQueue();
+  TestWatermarks();
+  TestRecycleAboveHigh();
+  TestRefillFailure();
+  TestQueueThreads();
+  TestPoolThreads();
+  std::printf("signal_pool_test passed\n");
+  return 0;
+}
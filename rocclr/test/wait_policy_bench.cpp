@@ -0,0 +1,182 @@
+/* Copyright (c) 2024 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+// Measures the wake-up latency and the CPU time of host waits under the modes of the wait
+// policy. The fake completion source acts like a GPU signal: the command completes at a fixed
+// time, a poll sees the completion as soon as the time has passed, and a thread in the role of
+// the completion interrupt notifies the blocked waiter. The wait is the adaptive path of
+// Event::awaitCompletion(): spin, poll with a yield, then block on the monitor.
+//
+// Usage: wait_policy_bench [waits per duration]
+
+#include "device/devwaitpolicy.hpp"
+#include "os/os.hpp"
+#include "thread/monitor.hpp"
+
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+using amd::device::WaitPolicy;
+
+uint64_t ThreadCpuNs() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+//! Commands, which complete at a given time, and the interrupt of their completion
+class FakeCompletion {
+ public:
+  FakeCompletion() : thread_([this]() { Run(); }) {}
+
+  ~FakeCompletion() {
+    {
+      amd::ScopedLock lock(lock_);
+      exit_ = true;
+      lock_.notifyAll();
+    }
+    thread_.join();
+  }
+
+  //! Starts a command, which completes after the duration
+  void Start(uint64_t durationNs) {
+    amd::ScopedLock lock(lock_);
+    end_ = amd::Os::timeNanos() + durationNs;
+    interrupted_ = false;
+    pending_ = true;
+    lock_.notifyAll();
+  }
+
+  uint64_t End() const { return end_; }
+
+  //! Status poll of the command, the event status of the runtime
+  bool Done() const { return interrupted_.load() || (amd::Os::timeNanos() >= end_); }
+
+  //! Blocks until the interrupt, the monitor wait of the event
+  void Block() {
+    amd::ScopedLock lock(lock_);
+    while (!interrupted_) {
+      lock_.wait();
+    }
+  }
+
+  //! Waits until the interrupt of the last command was delivered
+  void Drain() {
+    amd::ScopedLock lock(lock_);
+    while (pending_) {
+      lock_.wait();
+    }
+  }
+
+ private:
+  void Run() {
+    amd::ScopedLock lock(lock_);
+    while (true) {
+      while (!pending_ && !exit_) {
+        lock_.wait();
+      }
+      if (exit_) {
+        return;
+      }
+      const uint64_t end = end_;
+      lock_.unlock();
+      const uint64_t now = amd::Os::timeNanos();
+      if (now < end) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(end - now));
+      }
+      lock_.lock();
+      interrupted_ = true;
+      pending_ = false;
+      lock_.notifyAll();
+    }
+  }
+
+  amd::Monitor lock_;
+  std::atomic<uint64_t> end_{0};
+  std::atomic<bool> interrupted_{false};
+  bool pending_ = false;
+  bool exit_ = false;
+  std::thread thread_;
+};
+
+//! Waits like Event::awaitCompletion() with the policy enabled, returns the wake-up latency
+uint64_t Wait(FakeCompletion& completion, WaitPolicy& policy) {
+  const WaitPolicy::Plan plan = policy.GetPlan();
+  const uint64_t start = amd::Os::timeNanos();
+  while (!completion.Done() && ((amd::Os::timeNanos() - start) < plan.spinNs_)) {
+    amd::Os::spinPause();
+  }
+  const uint64_t yieldStart = amd::Os::timeNanos();
+  while (!completion.Done() && ((amd::Os::timeNanos() - yieldStart) < plan.yieldNs_)) {
+    amd::Os::yield();
+  }
+  if (!completion.Done()) {
+    completion.Block();
+  }
+  const uint64_t end = amd::Os::timeNanos();
+  policy.Record(end - start);
+  return (end > completion.End()) ? (end - completion.End()) : 0;
+}
+
+void Report(uint64_t durationNs, uint32_t mode, const char* name, size_t waits) {
+  FakeCompletion completion;
+  WaitPolicy policy(mode);
+  // Let the adaptive mode learn the wait time
+  for (size_t ii = 0; ii < 16; ++ii) {
+    completion.Start(durationNs);
+    Wait(completion, policy);
+    completion.Drain();
+  }
+  uint64_t latency = 0;
+  uint64_t cpu = 0;
+  for (size_t ii = 0; ii < waits; ++ii) {
+    completion.Start(durationNs);
+    const uint64_t cpuStart = ThreadCpuNs();
+    latency += Wait(completion, policy);
+    cpu += ThreadCpuNs() - cpuStart;
+    completion.Drain();
+  }
+  std::printf("%10.1f %-9s %12.2f %12.2f %7.0f%%\n", durationNs / 1000.0, name,
+              latency / 1000.0 / waits, cpu / 1000.0 / waits,
+              100.0 * cpu / (static_cast<double>(durationNs) * waits));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t waits = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 200;
+
+  std::printf("%zu waits per duration\n", waits);
+  std::printf("%10s %-9s %12s %12s %8s\n", "wait us", "mode", "wake-up us", "cpu us", "cpu");
+  for (uint64_t durationNs : {2000, 20000, 200000, 2000000}) {
+    Report(durationNs, WaitPolicy::Spin, "spin", waits);
+    Report(durationNs, WaitPolicy::Yield, "yield", waits);
+    Report(durationNs, WaitPolicy::Block, "block", waits);
+    Report(durationNs, WaitPolicy::Adaptive, "adaptive", waits);
+  }
+  return 0;
+}
@@ -31,6 +31,15 @@
 #include <tuple>
 #include <utility>
 
+#if defined(ROCCLR_FUTEX_MONITOR) && defined(__linux__)
+#define ROCCLR_USE_FUTEX_MONITOR 1
+#include <algorithm>
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace amd {
 
 /*! \addtogroup Threads
@@ -239,6 +248,169 @@ class Monitor final: public HeapObject, public MonitorBase {
 };
 } // namespace mutex_monitor
 
+#if defined(ROCCLR_USE_FUTEX_MONITOR)
+namespace futex_monitor {
+/*! \brief Inline monitor on a single futex word.
+ *
+ *  The lock word is 0 if unlocked, 1 if locked and 2 if locked with possible sleepers.
+ *  A contended lock spins for a bounded, adaptive number of iterations before it sleeps in the
+ *  kernel. wait()/notify() sleep on a separate sequence word, which notify() bumps, so a waiter
+ *  may wake up spuriously and must recheck its condition, as with std::condition_variable.
+ */
+class Monitor final {
+ public:
+  explicit Monitor(bool recursive = false)
+      : state_(0), seq_(0), spin_(kMaxSpinIter / 2), owner_(nullptr), lockCount_(0),
+        recursive_(recursive) {}
+
+  //! Try to acquire the lock, return true if successful, false if failed.
+  bool tryLock() {
+    if (recursive_ && (owner_.load(std::memory_order_relaxed) == self())) {
+      ++lockCount_;
+      return true;
+    }
+    uint32_t unlocked = 0;
+    if (state_.compare_exchange_strong(unlocked, 1, std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+      setOwner();
+      return true;
+    }
+    return false;
+  }
+
+  //! Acquire the lock or suspend the calling thread.
+  void lock() {
+    if (recursive_ && (owner_.load(std::memory_order_relaxed) == self())) {
+      ++lockCount_;
+      return;
+    }
+    uint32_t unlocked = 0;
+    if (!state_.compare_exchange_strong(unlocked, 1, std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      lockContended();
+    }
+    setOwner();
+  }
+
+  //! Release the lock and wake a single waiting thread if any.
+  void unlock() {
+    if (recursive_) {
+      if (--lockCount_ != 0) {
+        return;
+      }
+      owner_.store(nullptr, std::memory_order_relaxed);
+    }
+    if (state_.exchange(0, std::memory_order_release) == 2) {
+      futex(&state_, FUTEX_WAKE_PRIVATE, 1);
+    }
+  }
+
+  /*! \brief Give up the lock and go to sleep.
+   *
+   *  \note The monitor must be owned before calling wait().
+   */
+  void wait() {
+    const uint32_t seq = seq_.load(std::memory_order_relaxed);
+    // Preserve the lock count (for recursive monitors), the lock is released completely
+    const uint32_t lockCount = lockCount_;
+    if (recursive_) {
+      lockCount_ = 1;
+    }
+    unlock();
+    futex(&seq_, FUTEX_WAIT_PRIVATE, seq);
+    // Reacquire as contended, since other waiters may sleep on the lock word
+    lockContended();
+    if (recursive_) {
+      owner_.store(self(), std::memory_order_relaxed);
+      lockCount_ = lockCount;
+    }
+  }
+
+  /*! \brief Wake up a single thread waiting on this monitor.
+   *
+   *  \note The monitor may or may not be owned before calling notify().
+   */
+  void notify() {
+    seq_.fetch_add(1, std::memory_order_relaxed);
+    futex(&seq_, FUTEX_WAKE_PRIVATE, 1);
+  }
+
+  /*! \brief Wake up all threads that are waiting on this monitor.
+   *
+   *  \note The monitor may or may not be owned before calling notifyAll().
+   */
+  void notifyAll() {
+    seq_.fetch_add(1, std::memory_order_relaxed);
+    futex(&seq_, FUTEX_WAKE_PRIVATE, INT_MAX);
+  }
+
+ private:
+  static constexpr int32_t kMaxSpinIter = 100;  //!< Max spin iterations of a contended lock
+
+  static long futex(std::atomic<uint32_t>* word, int op, uint32_t value) {
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value, nullptr, nullptr, 0);
+  }
+
+  //! Returns a unique tag of the calling thread
+  static const void* self() {
+    static thread_local char tag;
+    return &tag;
+  }
+
+  void setOwner() {
+    if (recursive_) {
+      owner_.store(self(), std::memory_order_relaxed);
+      lockCount_ = 1;
+    }
+  }
+
+  //! Finish locking the monitor (contended case)
+  void lockContended() {
+    // Spin a little longer than the recent successful spins. With a single processor the
+    // owner can't release the lock while this thread spins, so go to sleep right away.
+    const int32_t spin = spin_.load(std::memory_order_relaxed);
+    const int32_t limit = (Os::processorCount() > 1) ? std::min(kMaxSpinIter, 2 * spin + 10) : 0;
+    for (int32_t i = 0; i < limit; ++i) {
+      uint32_t unlocked = 0;
+      if ((state_.load(std::memory_order_relaxed) == 0) &&
+          state_.compare_exchange_weak(unlocked, 1, std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        spin_.store(spin + (i - spin) / 8, std::memory_order_relaxed);
+        return;
+      }
+      Os::spinPause();
+    }
+    spin_.store(spin + (limit - spin) / 8, std::memory_order_relaxed);
+    // Mark the lock as contended and sleep until the owner releases it
+    while (state_.exchange(2, std::memory_order_acquire) != 0) {
+      futex(&state_, FUTEX_WAIT_PRIVATE, 2);
+    }
+  }
+
+  std::atomic<uint32_t> state_;       //!< Lock word
+  std::atomic<uint32_t> seq_;         //!< Notification sequence for wait()
+  std::atomic<int32_t> spin_;         //!< Average spin iterations of the contended locks
+  std::atomic<const void*> owner_;    //!< Owner of a recursive monitor
+  uint32_t lockCount_;                //!< The amount of times the owner acquired the monitor
+  const bool recursive_;              //!< True if this is a recursive monitor
+};
+} // namespace futex_monitor
+
+// Monitor API wrapper to user, the futex monitor is selected at compile time
+class Monitor {
+public:
+  explicit Monitor(bool recursive = false) : monitor_(recursive) {}
+  inline bool tryLock() { return monitor_.tryLock(); }
+  inline void lock() { monitor_.lock(); }
+  inline void unlock() { monitor_.unlock(); }
+  inline void wait() { monitor_.wait(); }
+  inline void notify() { monitor_.notify(); }
+  inline void notifyAll() { monitor_.notifyAll(); }
+
+private:
+  futex_monitor::Monitor monitor_;
+};
+#else
 // Monitor API wrapper to user
 class Monitor {
 public:
@@ -261,6 +433,7 @@ public:
 private:
   MonitorBase* monitor_;
 };
+#endif  // ROCCLR_USE_FUTEX_MONITOR
 
 class ScopedLock : StackObject {
  public:
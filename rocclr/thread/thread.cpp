@@ -83,7 +83,7 @@ void* Thread::main() {
 
   // Notify the parent thread that we are up and running.
   {
-    ScopedLock sl(selfSuspendLock_);
+    ScopedLock sl(*selfSuspendLock_);
     setState(INITIALIZED);
     created_->post();
     selfSuspendLock_->wait();
@@ -104,7 +104,7 @@ bool Thread::start(void* data) {
 
   data_ = data;
   {
-    ScopedLock sl(selfSuspendLock_);
+    ScopedLock sl(*selfSuspendLock_);
     setState(RUNNABLE);
     selfSuspendLock_->notify();
   }
@@ -113,7 +113,7 @@ bool Thread::start(void* data) {
 }
 
 void Thread::resume() {
-  ScopedLock sl(selfSuspendLock_);
+  ScopedLock sl(*selfSuspendLock_);
   selfSuspendLock_->notify();
 }
 
@@ -111,6 +111,60 @@ template <typename T, int N = 5> class ConcurrentLinkedQueue : public HeapObject
   inline bool empty();
 };
 
+/*! \brief A lock-free set of object handles.
+ *
+ * The objects are registered in an open-addressing table of tagged slots. A slot
+ * keeps the object address in the low bits and a generation in the high bits,
+ * which increments on every reuse of the slot. A lookup hashes the address and
+ * compares at most a cache-line-sized window of slots in each level without a
+ * lock, an insertion claims a free slot with a single CAS and returns a token
+ * of the slot index and generation, so the removal is one CAS, which can't
+ * clear a slot reused by another object. The slots never return to the empty
+ * state, so a lookup can stop at the first empty slot. A new level, twice as
+ * large as the previous one, is added when a window is full in all levels.
+ * The levels are released only with the set.
+ */
+template <typename T> class ConcurrentHandleSet {
+ public:
+  typedef uint64_t Token;                  //!< Level, slot index and generation
+  static constexpr Token InvalidToken = 0;  //!< Token of an unregistered object
+
+ private:
+  static constexpr uint32_t AddressBits = 48;  //!< Bits of a user space address
+  static constexpr uint64_t AddressMask = (1ull << AddressBits) - 1;
+  static constexpr uint32_t IndexBits = AddressBits - 5;  //!< Slot index bits in a token
+  static constexpr uint32_t MaxLevels = 32;        //!< Max number of levels
+  static constexpr uint32_t FirstLevelSize = 1024;  //!< Number of slots in the first level
+  static constexpr uint32_t WindowSize = 16;        //!< Max probes in one level
+
+  std::atomic<std::atomic<uint64_t>*> levels_[MaxLevels] = {};  //!< Slot arrays
+  std::atomic<uint32_t> numLevels_ = {0};                        //!< Published levels
+
+  //! Returns the home slot of the address in a level
+  static size_t home(uint64_t address, uint32_t level) {
+    uint64_t hash = (address >> 4) * 0x9E3779B97F4A7C15ull;
+    return (hash ^ (hash >> 32)) & ((size_t(FirstLevelSize) << level) - 1);
+  }
+
+  //! Adds the level after the last known one, if no other thread did
+  void grow(uint32_t level);
+
+ public:
+  constexpr ConcurrentHandleSet() = default;
+
+  //! Releases the levels
+  ~ConcurrentHandleSet();
+
+  //! Registers the object and returns the token for its removal
+  inline Token insert(const T* object);
+
+  //! Removes the object, registered with the token. A second removal is a nop
+  inline void erase(const T* object, Token token);
+
+  //! Returns true if the object is registered
+  inline bool contains(const T* object) const;
+};
+
 /*@}*/
 
 template <typename T, int N> inline ConcurrentLinkedQueue<T, N>::ConcurrentLinkedQueue() {
@@ -204,6 +258,95 @@ template <typename T, int N> inline bool ConcurrentLinkedQueue<T, N>::empty() {
   }
 }
 
+template <typename T> inline ConcurrentHandleSet<T>::~ConcurrentHandleSet() {
+  for (auto& level : levels_) {
+    delete[] level.load(std::memory_order_relaxed);
+  }
+}
+
+template <typename T> void ConcurrentHandleSet<T>::grow(uint32_t level) {
+  if (level >= MaxLevels) {
+    return;
+  }
+  if (levels_[level].load(std::memory_order_acquire) == nullptr) {
+    auto slots = new std::atomic<uint64_t>[size_t(FirstLevelSize) << level]();
+    std::atomic<uint64_t>* expected = nullptr;
+    if (!levels_[level].compare_exchange_strong(expected, slots, std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+      delete[] slots;
+    }
+  }
+  uint32_t count = level;
+  numLevels_.compare_exchange_strong(count, level + 1, std::memory_order_acq_rel,
+                                     std::memory_order_acquire);
+}
+
+template <typename T>
+inline typename ConcurrentHandleSet<T>::Token ConcurrentHandleSet<T>::insert(const T* object) {
+  const uint64_t address = reinterpret_cast<uintptr_t>(object);
+  assert(((address & ~AddressMask) == 0) && (address != 0) && "Invalid handle address");
+  for (;;) {
+    const uint32_t numLevels = numLevels_.load(std::memory_order_acquire);
+    for (uint32_t level = 0; level < numLevels; ++level) {
+      std::atomic<uint64_t>* slots = levels_[level].load(std::memory_order_acquire);
+      const size_t mask = (size_t(FirstLevelSize) << level) - 1;
+      const size_t first = home(address, level);
+      for (size_t i = 0; i < WindowSize; ++i) {
+        const size_t index = (first + i) & mask;
+        uint64_t slot = slots[index].load(std::memory_order_relaxed);
+        // Claim an empty slot or a slot of a removed object
+        while ((slot & AddressMask) == 0) {
+          uint64_t generation = (slot >> AddressBits) + 1;
+          generation = ((generation & 0xFFFF) == 0) ? 1 : generation;
+          if (slots[index].compare_exchange_weak(slot, (generation << AddressBits) | address,
+                                                 std::memory_order_acq_rel,
+                                                 std::memory_order_relaxed)) {
+            return (generation << AddressBits) | (uint64_t(level) << IndexBits) | index;
+          }
+        }
+      }
+    }
+    grow(numLevels);
+  }
+}
+
+template <typename T>
+inline void ConcurrentHandleSet<T>::erase(const T* object, Token token) {
+  if (token == InvalidToken) {
+    return;
+  }
+  const uint64_t generation = token >> AddressBits;
+  const uint32_t level = (token & AddressMask) >> IndexBits;
+  const size_t index = token & ((1ull << IndexBits) - 1);
+  uint64_t slot = (generation << AddressBits) | reinterpret_cast<uintptr_t>(object);
+  // Keep the generation in the slot, so the slot stays non-empty for the lookups
+  levels_[level].load(std::memory_order_acquire)[index].compare_exchange_strong(
+      slot, generation << AddressBits, std::memory_order_acq_rel, std::memory_order_relaxed);
+}
+
+template <typename T> inline bool ConcurrentHandleSet<T>::contains(const T* object) const {
+  const uint64_t address = reinterpret_cast<uintptr_t>(object);
+  if ((address == 0) || ((address & ~AddressMask) != 0)) {
+    return false;
+  }
+  const uint32_t numLevels = numLevels_.load(std::memory_order_acquire);
+  for (uint32_t level = 0; level < numLevels; ++level) {
+    const std::atomic<uint64_t>* slots = levels_[level].load(std::memory_order_acquire);
+    const size_t mask = (size_t(FirstLevelSize) << level) - 1;
+    const size_t first = home(address, level);
+    for (size_t i = 0; i < WindowSize; ++i) {
+      const uint64_t slot = slots[(first + i) & mask].load(std::memory_order_acquire);
+      if (slot == 0) {
+        break;
+      }
+      if ((slot & AddressMask) == address) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 }  // namespace amd
 
 #endif /*CONCURRENT_HPP_*/
@@ -261,6 +261,53 @@ release(bool, DEBUG_CLR_USE_STDMUTEX_IN_AMD_MONITOR, false,                   \
         "Use std::mutex in amd::monotor")                                     \
 release(bool, DEBUG_CLR_KERNARG_HDP_FLUSH_WA, false,                          \
         "Toggle kernel arg copy workaround")                                  \
+release(bool, DEBUG_HIP_HOST_CONVERT_SIMD, true,                              \
+        "Use F16C/AVX2/AVX-512 paths for host array conversions")             \
+release(uint, DEBUG_CLR_HOSTCALL_WORKERS, 1,                                  \
+        "Number of hostcall listener threads, buffers are sharded by queue")  \
+release(uint, DEBUG_CLR_HOSTCALL_SPIN_US, 0,                                  \
+        "Max time in us a hostcall listener spins before it blocks")          \
+release(uint, DEBUG_CLR_SIGNAL_POOL_LOW, 64,                                  \
+        "Device signal pool is refilled in the background below this size")   \
+release(uint, DEBUG_CLR_SIGNAL_POOL_HIGH, 1024,                               \
+        "Max number of idle HSA signals kept in the device signal pool")      \
+release(uint, DEBUG_CLR_KERNARG_POOL_FENCES, 4,                               \
+        "Number of kernel arg fences issued per pass over the kernel arg pool") \
+release(uint, DEBUG_CLR_KERNARG_POOL_GROWTH, 4,                               \
+        "Max growth factor of the kernel arg pool before it waits for the GPU") \
+release(bool, DEBUG_CLR_KERNARG_RING, true,                                   \
+        "Retire the kernel arg pool with fences, false waits for 4 fixed chunks") \
+release(uint, DEBUG_CLR_DOORBELL_COALESCE_PACKETS, 0,                         \
+        "Max AQL packets published with one doorbell in direct dispatch, "    \
+        "0 or 1 rings the doorbell for every packet")                         \
+release(uint, DEBUG_CLR_DOORBELL_COALESCE_US, 20,                             \
+        "Max time in us a dispatched packet waits for its coalesced doorbell") \
+release(uint, DEBUG_CLR_WAIT_POLICY, 0,                                       \
+        "Host wait policy: 0 = static active/blocked selection, 1 = adaptive " \
+        "spin/yield/block, 2 = spin, 3 = yield, 4 = block")                  \
+release(uint, DEBUG_CLR_WAIT_SPIN_US, 50,                                     \
+        "Max spin time in us of the adaptive wait policy")                    \
+release(uint, DEBUG_HIP_GRAPH_PASSES, 0,                                      \
+        "Mask of the graph instantiate passes: 0x1 = child graph inlining, "   \
+        "0x2 = empty node elimination, 0x4 = transitive edge reduction, "     \
+        "0x8 = memset/memcpy merging")                                        \
+release(bool, DEBUG_HIP_GRAPH_MEM_PLAN, false,                                \
+        "Back the graph allocations, freed in the same graph, with one "      \
+        "arena, planned and mapped at instantiate")                           \
+release(cstring, DEBUG_HIP_GRAPH_PACKET_DUMP, "",                             \
+        "Append the decoded AQL packets of the executable graphs to the "     \
+        "file at instantiate and update")                                     \
+release(uint, DEBUG_HIP_GRAPH_INSTANTIATE_CACHE, 0,                           \
+        "Max number of graph structures, whose schedule and parallel "        \
+        "streams are reused by the instantiation of an equal graph, "         \
+        "0 = disabled")                                                       \
+release(uint, HIP_HOST_CALLBACK_THREADS, 0,                                   \
+        "Number of threads, which run the host functions of the stream "      \
+        "callbacks and the graph host nodes, 0 = run them in the callback")   \
+release(cstring, DEBUG_HIP_GRAPH_PROFILE, "",                                 \
+        "Profile the nodes of the executable graphs and append the timings "  \
+        "with the critical path to the file at the graph destruction, DOT "   \
+        "if the name ends with .dot, JSON otherwise")                         \
 
 namespace amd {
 